@@ -4,6 +4,7 @@
 #include "lvgl_stl.h"
 #include "beep.h"
 #include "hwvers.h"
+#include "diversity.h"
 #include "lv_anim_helpers.h"
 
 LV_FONT_DECLARE(lv_font_chinese_16);
@@ -24,14 +25,16 @@ static lv_obj_t* protocol_label = NULL;
 static lv_group_t* about_group = NULL;
 
 static lv_timer_t* vbat_label_timer = NULL;
+static bool latency_view = false;       // RIGHT toggles the diversity latency view
 
 static lv_style_t label_about_style;
-extern uint16_t adc_converted_value[3];
 
 static void page_about_style_init(void);
 static void page_about_style_deinit(void);
 static void vbat_label_update(lv_timer_t* tmr);
 static void page_about_exit(void);
+static void page_about_info_text(void);
+static void page_about_latency_text(void);
 
 static void event_callback(lv_event_t* event)
 {
@@ -43,14 +46,22 @@ static void event_callback(lv_event_t* event)
         beep_turn_on();
         lv_key_t key_status = lv_indev_get_key(lv_indev_get_act());
         if (key_status == LV_KEY_ENTER) {
-           
+            if (latency_view) {
+                diversity_reset_latency();
+                page_about_latency_text();
+            }
         }
         else if (key_status == LV_KEY_LEFT) {
             page_about_exit();
 
         }
         else if (key_status == LV_KEY_RIGHT) {
-
+            latency_view = !latency_view;
+            if (latency_view) {
+                page_about_latency_text();
+            } else {
+                page_about_info_text();
+            }
         }
         else if (key_status == LV_KEY_NEXT) {
 
@@ -69,9 +80,55 @@ static void page_about_style_deinit()
     lv_style_reset(&label_about_style);
 }
 
-static void vbat_label_update(lv_timer_t* tmr)
+/**
+ * @brief Diversity latency view: frame to decision and frame to antenna
+ *        GPIO, p50/p95/p99/max in us (English only, it is a debug view)
+ */
+static void page_about_latency_text(void)
+{
+    diversity_latency_t lat;
+    diversity_get_latency(&lat);
+    lv_label_set_text(vbat_label, "p50/p95/p99/max us");
+    lv_label_set_text_fmt(version_label, "DEC %lu/%lu/%lu/%lu",
+                          (unsigned long)diversity_latency_percentile(lat.decision, lat.decision_max_us, 50),
+                          (unsigned long)diversity_latency_percentile(lat.decision, lat.decision_max_us, 95),
+                          (unsigned long)diversity_latency_percentile(lat.decision, lat.decision_max_us, 99),
+                          (unsigned long)lat.decision_max_us);
+    lv_label_set_text_fmt(base_label, "GPIO %lu/%lu/%lu/%lu",
+                          (unsigned long)diversity_latency_percentile(lat.gpio, lat.gpio_max_us, 50),
+                          (unsigned long)diversity_latency_percentile(lat.gpio, lat.gpio_max_us, 95),
+                          (unsigned long)diversity_latency_percentile(lat.gpio, lat.gpio_max_us, 99),
+                          (unsigned long)lat.gpio_max_us);
+    lv_label_set_text_fmt(protocol_label, "n %lu/%lu  ENTER:reset",
+                          (unsigned long)diversity_latency_count(lat.decision),
+                          (unsigned long)diversity_latency_count(lat.gpio));
+}
+
+static void page_about_info_text(void)
 {
     if (RX5808_Get_Language() == 0)
+    {
+        lv_label_set_text_fmt(vbat_label, "VCC_BAT:%.4fV", Get_Battery_Voltage());
+        lv_label_set_text_fmt(version_label, "VERSION:v%d.%d.%d",RX5808_VERSION_MAJOR, RX5808_VERSION_MINOR, RX5808_VERSION_PATCH);
+        lv_label_set_text_fmt(base_label, "LVGL:v%d.%d.%d", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+        lv_label_set_text_fmt(protocol_label, "LICENSE:GPL3.0");
+    }
+    else
+    {
+        lv_label_set_text_fmt(vbat_label, "ä¾›ç”µç”µåŽ‹:%.4fV", Get_Battery_Voltage());
+        lv_label_set_text_fmt(version_label, "å›ºä»¶ç‰ˆæœ¬:v%d.%d.%d",RX5808_VERSION_MAJOR, RX5808_VERSION_MINOR, RX5808_VERSION_PATCH);
+        lv_label_set_text_fmt(base_label, "LVGL:v%d.%d.%d", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
+        lv_label_set_text_fmt(protocol_label, "å¼€æºåè®®:GPL3.0");
+    }
+}
+
+static void vbat_label_update(lv_timer_t* tmr)
+{
+    if (latency_view)
+    {
+        page_about_latency_text();
+    }
+    else if (RX5808_Get_Language() == 0)
     {
         lv_label_set_text_fmt(vbat_label, "VCC_BAT:%.4fV", Get_Battery_Voltage());
     }
@@ -98,6 +155,7 @@ static void page_about_exit()
 
 void page_about_create()
 {
+    latency_view = false;
     page_about_contain = lv_obj_create(lv_scr_act());
     lv_obj_remove_style_all(page_about_contain);
     lv_obj_set_style_bg_color(page_about_contain, lv_color_make(0, 0, 0), LV_STATE_DEFAULT);
@@ -159,10 +217,6 @@ void page_about_create()
         lv_obj_set_style_text_font(version_label, &lv_font_montserrat_12, LV_STATE_DEFAULT);
         lv_obj_set_style_text_font(base_label, &lv_font_montserrat_12, LV_STATE_DEFAULT);
         lv_obj_set_style_text_font(protocol_label, &lv_font_montserrat_12, LV_STATE_DEFAULT);
-        lv_label_set_text_fmt(vbat_label, "VCC_BAT:%.4fV", Get_Battery_Voltage());
-        lv_label_set_text_fmt(version_label, "VERSION:v%d.%d.%d",RX5808_VERSION_MAJOR, RX5808_VERSION_MINOR, RX5808_VERSION_PATCH);
-        lv_label_set_text_fmt(base_label, "LVGL:v%d.%d.%d", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
-        lv_label_set_text_fmt(protocol_label, "LICENSE:GPL3.0");
     }
     else
     {
@@ -172,12 +226,10 @@ void page_about_create()
         lv_obj_set_style_text_font(version_label, &lv_font_chinese_12, LV_STATE_DEFAULT);
         lv_obj_set_style_text_font(base_label, &lv_font_chinese_12, LV_STATE_DEFAULT);
         lv_obj_set_style_text_font(protocol_label, &lv_font_chinese_12, LV_STATE_DEFAULT);
-        lv_label_set_text_fmt(vbat_label, "ä¾›ç”µç”µåŽ‹:%.4fV", Get_Battery_Voltage());
-        lv_label_set_text_fmt(version_label, "å›ºä»¶ç‰ˆæœ¬:v%d.%d.%d",RX5808_VERSION_MAJOR, RX5808_VERSION_MINOR, RX5808_VERSION_PATCH);
-        lv_label_set_text_fmt(base_label, "LVGL:v%d.%d.%d", LVGL_VERSION_MAJOR, LVGL_VERSION_MINOR, LVGL_VERSION_PATCH);
-        lv_label_set_text_fmt(protocol_label, "å¼€æºåè®®:GPL3.0");
     }
 
+    page_about_info_text();
+
     about_group = lv_group_create();
     lv_indev_set_group(indev_keypad, about_group);
 
@@ -55,7 +55,6 @@ static uint16_t      floor_a = 0, floor_b = 0;
 static uint16_t      peak_a  = 0, peak_b  = 0;
 static bool          initializing = false;
 
-extern uint16_t adc_converted_value[3];
 
 //  Forward declarations 
 static void update_ui(void);
@@ -194,23 +193,27 @@ static void calib_timer_cb(lv_timer_t* tmr)
         return;
     }
 
+    // One torn-free sample per tick for both the live labels and the buffers
+    uint16_t rssi_a = RX5808_Get_RSSI_Raw(rx5808_receiver0);
+    uint16_t rssi_b = RX5808_Get_RSSI_Raw(rx5808_receiver1);
+
     // Live RSSI refresh
     if (current_state != STATE_SUMMARY) {
-        lv_label_set_text_fmt(rssi_a_label, "A:%4d", adc_converted_value[0]);
-        lv_label_set_text_fmt(rssi_b_label, "B:%4d", adc_converted_value[1]);
+        lv_label_set_text_fmt(rssi_a_label, "A:%4d", rssi_a);
+        lv_label_set_text_fmt(rssi_b_label, "B:%4d", rssi_b);
     }
 
     // --- Floor sampling: 50 × 50ms on the user's current channel (VTX OFF) ---
     if (current_state == STATE_FLOOR_SAMPLING) {
-        buf_a[sample_index] = adc_converted_value[0];
-        buf_b[sample_index] = adc_converted_value[1];
+        buf_a[sample_index] = rssi_a;
+        buf_b[sample_index] = rssi_b;
         sample_index++;
         lv_bar_set_value(progress_bar, (sample_index * 50) / CALIB_SAMPLES, LV_ANIM_OFF);
         if (sample_index >= CALIB_SAMPLES) {
             diversity_calibrate_floor_finish(buf_a, CALIB_SAMPLES, &floor_a);
             diversity_calibrate_floor_finish(buf_b, CALIB_SAMPLES, &floor_b);
-            diversity_get_state()->cal_a.floor_raw = floor_a;
-            diversity_get_state()->cal_b.floor_raw = floor_b;
+            diversity_get_state()->cal[0].floor_raw = floor_a;
+            diversity_get_state()->cal[1].floor_raw = floor_b;
             sample_index  = 0;
             current_state = STATE_PEAK_SETUP;
             update_ui();
@@ -220,15 +223,15 @@ static void calib_timer_cb(lv_timer_t* tmr)
 
     // --- Peak sampling: 50 × 50ms on the same channel (VTX ON, ~10cm) ---
     if (current_state == STATE_PEAK_SAMPLING) {
-        buf_a[sample_index] = adc_converted_value[0];
-        buf_b[sample_index] = adc_converted_value[1];
+        buf_a[sample_index] = rssi_a;
+        buf_b[sample_index] = rssi_b;
         sample_index++;
         lv_bar_set_value(progress_bar, 50 + (sample_index * 50) / CALIB_SAMPLES, LV_ANIM_OFF);
         if (sample_index >= CALIB_SAMPLES) {
             diversity_calibrate_peak_finish(buf_a, CALIB_SAMPLES, &peak_a);
             diversity_calibrate_peak_finish(buf_b, CALIB_SAMPLES, &peak_b);
-            diversity_get_state()->cal_a.peak_raw = peak_a;
-            diversity_get_state()->cal_b.peak_raw = peak_b;
+            diversity_get_state()->cal[0].peak_raw = peak_a;
+            diversity_get_state()->cal[1].peak_raw = peak_b;
             sample_index  = 0;
             current_state = STATE_SUMMARY;
             update_ui();
@@ -276,9 +279,12 @@ static void page_diversity_calib_event(lv_event_t* event)
 
     if (current_state == STATE_SUMMARY) {
         if (obj == save_btn) {
-            diversity_get_state()->cal_a.calibrated = true;
-            diversity_get_state()->cal_b.calibrated = true;
+            diversity_get_state()->cal[0].calibrated = true;
+            diversity_get_state()->cal[1].calibrated = true;
             diversity_calibrate_save();
+            // The VTX is still on from the peak phase: sweep the band in the
+            // background to fill the per-frequency calibration map
+            diversity_calmap_sweep_start();
         }
         page_diversity_calib_exit();
         lv_fun_param_delayed(page_menu_create, 500, 0);
@@ -155,7 +155,7 @@ static void locked_adjust_channel(int8_t direction, bool is_band_x)
             if (channel_count < 0)
                 channel_count = 7;
             uint16_t freq = RX5808_Get_Band_X_Freq(channel_count);
-            RX5808_Set_Freq(freq);
+            RX5808_Tune_Async(freq, NULL);
             Rx5808_Set_Channel(channel_count + Chx_count * 8);
             rx5808_div_setup_upload(rx5808_div_config_channel);
             fre_label_update_band_x(freq);
@@ -165,7 +165,7 @@ static void locked_adjust_channel(int8_t direction, bool is_band_x)
             channel_count--;
             if (channel_count < 0)
                 channel_count = 7;
-            RX5808_Set_Freq(RX5808_Get_Current_Freq());
+            RX5808_Tune_Async(RX5808_Get_Current_Freq(), NULL);
             Rx5808_Set_Channel(channel_count + Chx_count * 8);
             rx5808_div_setup_upload(rx5808_div_config_channel);
             fre_label_update(Chx_count, channel_count);
@@ -178,7 +178,7 @@ static void locked_adjust_channel(int8_t direction, bool is_band_x)
             if (channel_count > 7)
                 channel_count = 0;
             uint16_t freq = RX5808_Get_Band_X_Freq(channel_count);
-            RX5808_Set_Freq(freq);
+            RX5808_Tune_Async(freq, NULL);
             Rx5808_Set_Channel(channel_count + Chx_count * 8);
             rx5808_div_setup_upload(rx5808_div_config_channel);
             fre_label_update_band_x(freq);
@@ -188,7 +188,7 @@ static void locked_adjust_channel(int8_t direction, bool is_band_x)
             channel_count++;
             if (channel_count > 7)
                 channel_count = 0;
-            RX5808_Set_Freq(RX5808_Get_Current_Freq());
+            RX5808_Tune_Async(RX5808_Get_Current_Freq(), NULL);
             Rx5808_Set_Channel(channel_count + Chx_count * 8);
             rx5808_div_setup_upload(rx5808_div_config_channel);
             fre_label_update(Chx_count, channel_count);
@@ -209,7 +209,7 @@ static void adjust_band(int8_t direction, bool is_band_x)
             Chx_count = 0;
     }
 
-    RX5808_Set_Freq(RX5808_Get_Current_Freq());
+    RX5808_Tune_Async(RX5808_Get_Current_Freq(), NULL);
     Rx5808_Set_Channel(channel_count + Chx_count * 8);
     rx5808_div_setup_upload(rx5808_div_config_channel);
 
@@ -417,24 +417,29 @@ static void page_main_update(lv_timer_t* tmr)
     // Update diversity telemetry overlay
     if (RX5808_Get_Signal_Source() == 0) // Diversity mode
     {
-        // Update active receiver and get state
-        diversity_rx_t active_rx = diversity_get_active_rx();
-        diversity_state_t* state = diversity_get_state();
+        // One coherent copy of the diversity state for this refresh
+        diversity_snapshot_t snap;
+        diversity_get_snapshot(&snap);
+        diversity_rx_t active_rx = snap.active_rx;
         
         // Update mode indicator
         const char* mode_str = "?";
-        switch(state->mode) {
+        switch(snap.mode) {
             case DIVERSITY_MODE_RACE: mode_str = "RACE"; break;
             case DIVERSITY_MODE_FREESTYLE: mode_str = "FREESTYLE"; break;
             case DIVERSITY_MODE_LONG_RANGE: mode_str = "LONGRANGE"; break;
+            case DIVERSITY_MODE_CUSTOM_1:
+            case DIVERSITY_MODE_CUSTOM_2:
+            case DIVERSITY_MODE_CUSTOM_3:
+                mode_str = diversity_get_mode_params(snap.mode)->name; break;
             case DIVERSITY_MODE_COUNT: mode_str = "?"; break;
         }
         lv_label_set_text(diversity_mode_label, mode_str);
         
         // Highlight the bar that belongs to the active antenna.
         // Bar/label mapping (determined by the bar-fill code below):
-        //   rssi_bar0 / lv_rsss0_label -> rssi1 = adc_converted_value[1] = RX_B
-        //   rssi_bar1 / lv_rsss1_label -> rssi0 = adc_converted_value[0] = RX_A
+        //   rssi_bar0 / lv_rsss0_label -> rssi1 = RX5808 receiver1 = RX_B
+        //   rssi_bar1 / lv_rsss1_label -> rssi0 = RX5808 receiver0 = RX_A
         if (active_rx == DIVERSITY_RX_A) {
             // RX A active -> highlight rssi_bar1 / lv_rsss1_label
             lv_obj_set_style_text_font(lv_rsss1_label, &lv_font_montserrat_16, LV_STATE_DEFAULT);
@@ -690,7 +695,7 @@ static void bandx_adjust_frequency(int8_t direction)
     
     // Apply frequency
     RX5808_Set_Band_X_Freq(channel_count, freq);
-    RX5808_Set_Freq(freq);
+    RX5808_Tune_Async(freq, NULL);
     blink_visible = true;  // Show frequency during adjustment
     fre_label_update_band_x(freq);
     
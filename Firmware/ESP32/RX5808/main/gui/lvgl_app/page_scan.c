@@ -8,8 +8,10 @@
 #include "page_scan_calib.h"
 #include "lvgl_stl.h"
 #include "rx5808.h"
+#include "diversity.h"
 #include "beep.h"
 #include "lv_anim_helpers.h"
+#include <string.h>
 
 LV_FONT_DECLARE(lv_font_chinese_12);
 
@@ -26,6 +28,21 @@ static lv_obj_t* calib_label;
 static lv_group_t* scan_group;
 static scan_menu_mode_t scan_menu_mode = scan_menu_mode_quick;
 
+// Measure batch of the scan pages (one at a time): see page_scan_batch_poll()
+#define batch_tries        3        // Measurements of a point refused or timed out before giving up
+#define batch_stall_polls 50        // Polls refused with nothing in flight before giving up
+
+enum { point_idle = 0, point_queued, point_done, point_failed };
+
+static page_scan_point_t batch_point[PAGE_SCAN_BATCH_MAX];   // Written by the measure task
+static volatile uint8_t batch_state[PAGE_SCAN_BATCH_MAX];
+static uint8_t batch_tried[PAGE_SCAN_BATCH_MAX];            // Measurements queued per point
+static uint8_t batch_points = 0;
+static uint8_t batch_done = 0;                              // Points measured, in order
+static uint8_t batch_stall = 0;                             // Polls in a row refused with nothing in flight
+static uint16_t batch_measure_ms = 0;
+static page_scan_freq_t batch_freq = NULL;
+
 
 static void page_scan_callback(lv_event_t* event);
 static void page_scan_exit(void);
@@ -228,4 +245,101 @@ void page_scan_create_mode(scan_menu_mode_t mode)
 void page_scan_create()
 {
     page_scan_create_mode(scan_menu_mode_quick);
-}
\ No newline at end of file
+}
+
+// Measure task context: only store the result, the page's timer reads it
+static void page_scan_batch_cb(const rx5808_measure_t* result, void* arg)
+{
+    uint8_t i = (uint8_t)(uintptr_t)arg;
+    if (!result->ok) {
+        // Refused, superseded or timed out: the next poll queues it again
+        batch_state[i] = point_failed;
+        return;
+    }
+    batch_point[i].mean[0]    = result->mean[0];
+    batch_point[i].mean[1]    = result->mean[1];
+    batch_point[i].percent[0] = (uint8_t)result->percent[0];
+    batch_point[i].percent[1] = (uint8_t)result->percent[1];
+    batch_state[i] = point_done;
+}
+
+// Start measuring @p points frequencies, @p measure_ms of RSSI each.  The
+// page then calls page_scan_batch_poll() from an LVGL timer.
+void page_scan_batch_start(uint8_t points, uint16_t measure_ms, page_scan_freq_t freq)
+{
+    batch_points     = points < PAGE_SCAN_BATCH_MAX ? points : PAGE_SCAN_BATCH_MAX;
+    batch_measure_ms = measure_ms;
+    batch_freq       = freq;
+    batch_done       = 0;
+    batch_stall      = 0;
+    memset((void*)batch_state, point_idle, sizeof(batch_state));
+    memset(batch_tried, 0, sizeof(batch_tried));
+    page_scan_batch_poll();
+}
+
+// Queue the points not queued yet, or whose measurement failed, and return
+// how many are measured in order (0..points), or -1 once the batch gives up.
+// The measure queue is shared (the spectrum page, the calibration sweep),
+// so RX5808_Measure() may refuse: every poll tops the queue up.  Nothing is
+// queued while the calibration sweep runs: RX5808_Measure_Cancel() would
+// cancel it too.  It gives up when a point has failed batch_tries times,
+// or when the queue has refused for batch_stall_polls with none of our
+// points in flight: waiting will not make room then.
+int page_scan_batch_poll(void)
+{
+    if (!diversity_calmap_sweep_running()) {
+        uint16_t samples = RX5808_Get_RSSI_Frames_In(batch_measure_ms);
+        bool in_flight = false;
+        bool refused = false;
+        for (uint8_t i = batch_done; i < batch_points; i++) {
+            uint8_t state = batch_state[i];
+            if (state == point_queued) {
+                in_flight = true;
+                continue;
+            }
+            if (state == point_done || refused) {
+                continue;
+            }
+            if (state == point_failed && batch_tried[i] >= batch_tries) {
+                return -1;
+            }
+            // Queued before posting: the result may arrive before RX5808_Measure() returns
+            batch_state[i] = point_queued;
+            if (RX5808_Measure(batch_freq(i), 0, samples, page_scan_batch_cb, (void*)(uintptr_t)i)) {
+                batch_tried[i]++;
+                in_flight = true;
+            } else {
+                batch_state[i] = state;
+                refused = true;
+            }
+        }
+        if (refused && !in_flight) {
+            if (++batch_stall >= batch_stall_polls) {
+                return -1;
+            }
+        } else {
+            batch_stall = 0;
+        }
+    }
+    while (batch_done < batch_points && batch_state[batch_done] == point_done) {
+        batch_done++;
+    }
+    return batch_done;
+}
+
+// Result of point @p i, valid once page_scan_batch_poll() has counted it
+const page_scan_point_t* page_scan_batch_point(uint8_t i)
+{
+    return &batch_point[i];
+}
+
+// End the batch, finished or not: drop what is still queued and retune to
+// the selected channel
+void page_scan_batch_stop(void)
+{
+    if (!diversity_calmap_sweep_running()) {
+        // Nothing of ours is queued while the sweep runs; it retunes back itself
+        RX5808_Measure_Cancel();
+        RX5808_Tune_Async(Rx5808_Freq[Chx_count][channel_count], NULL);
+    }
+}
@@ -14,6 +14,7 @@ extern "C" {
     /*********************
     *      DEFINES
     *********************/
+#define PAGE_SCAN_BATCH_MAX  48     // Points of one measure batch
 
     /**********************
     *      TYPEDEFS
@@ -24,12 +25,26 @@ extern "C" {
         scan_menu_mode_spectrum,
         scan_menu_mode_calib,
     } scan_menu_mode_t;
+
+    // Frequency (MHz) of point i of a measure batch
+    typedef uint16_t (*page_scan_freq_t)(uint8_t i);
+
+    // One measured point of a batch
+    typedef struct
+    {
+        uint16_t mean[2];           // Raw 12-bit RSSI per receiver
+        uint8_t  percent[2];        // Calibrated 0-99 %
+    } page_scan_point_t;
     /**********************
     * GLOBAL PROTOTYPES
     **********************/
     extern lv_indev_t* indev_keypad;
     void page_scan_create(void);
     void page_scan_create_mode(scan_menu_mode_t mode);
+    void page_scan_batch_start(uint8_t points, uint16_t measure_ms, page_scan_freq_t freq);
+    int  page_scan_batch_poll(void);
+    const page_scan_point_t* page_scan_batch_point(uint8_t i);
+    void page_scan_batch_stop(void);
     /**********************
     *      MACROS
     **********************/
@@ -6,8 +6,6 @@
 #include "rx5808_config.h"
 #include "lvgl_stl.h"
 #include "beep.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include "lv_anim_helpers.h"
 
 
@@ -16,7 +14,9 @@ LV_FONT_DECLARE(lv_font_chinese_12);
 #define page_scan_calib_anim_enter  lv_anim_path_bounce
 #define page_scan_calib_anim_leave  lv_anim_path_bounce
 
-#define scan_turn_time  100
+#define scan_poll_time   20     // Result polling period (ms)
+#define scan_measure_ms  50     // RSSI averaged per channel (ms) — rejects transient spikes
+#define scan_points      48
 
 static uint8_t time_repeat_count = 0;
 static uint16_t rssi_adc_min0 = 4095;
@@ -38,97 +38,123 @@ static lv_obj_t* calib_result_info;
 static lv_obj_t* rssi_min_label;
 static lv_obj_t* rssi_max_label;
 static lv_obj_t* calib_progress_bar;
-static lv_timer_t* scan_calib_timer;
+static lv_timer_t* scan_calib_timer = NULL;
+static uint8_t scan_drawn = 0;                // Channels folded into min/max
 
 
 static void page_scan_calib_timer_event(lv_timer_t* tmr);
 static void page_scan_calib_event(lv_event_t* event);
-static void page_scan_calib_update(void);
+static void page_scan_calib_update(uint16_t avg0, uint16_t avg1);
+static uint16_t page_scan_calib_freq(uint8_t i);
+static void page_scan_calib_finish(bool complete);
 static void page_scan_calib_exit(void);
 
 void page_scan_calib_create(void);
 
-static void page_scan_calib_timer_event(lv_timer_t* tmr)
+// Channel i of the band table (A1..L8)
+static uint16_t page_scan_calib_freq(uint8_t i)
 {
-    int repeat_count = 47 - tmr->repeat_count;
+    return Rx5808_Freq[i / 8][i % 8];
+}
 
-    time_repeat_count = repeat_count;
+// End of the scan: restore the channel and show the result box.  An
+// incomplete scan (aborted) is never applied.
+static void page_scan_calib_finish(bool complete)
+{
+    page_scan_batch_stop();
+    lv_timer_del(scan_calib_timer);
+    scan_calib_timer = NULL;
+    lv_amin_start(calib_result_label, lv_obj_get_y(calib_result_label), 32, 1, 500, 0, anim_set_y_cb, lv_anim_path_bounce);
+    lv_amin_start(calib_result_cont, lv_obj_get_y(calib_result_cont), 32, 1, 500, 0, anim_set_y_cb, lv_anim_path_bounce);
+    lv_amin_start(calib_result_cont, lv_obj_get_height(calib_result_cont), 48, 1, 500, 0, anim_set_height_cb, lv_anim_path_bounce);
+    lv_amin_start(calib_start_cont, lv_obj_get_height(calib_start_cont), 16, 1, 500, 0, anim_set_height_cb, lv_anim_path_bounce);
+    lv_obj_set_style_opa(rssi_min_label, (lv_opa_t)LV_OPA_0, LV_STATE_DEFAULT);
+    lv_obj_set_style_opa(rssi_max_label, (lv_opa_t)LV_OPA_0, LV_STATE_DEFAULT);
+    lv_obj_set_style_border_color(calib_result_cont, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
+    bool calib_flag=false;
+    if (complete)
+    {
+        if (RX5808_Get_Signal_Source() == 0)
+        {
+            //rssi_adc_min = rssi_adc_min0+ rssi_adc_min1;
+            //rssi_adc_max = rssi_adc_max0+ rssi_adc_max1;
+            calib_flag=RX5808_Calib_RSSI(rssi_adc_min0, rssi_adc_max0,rssi_adc_min1,rssi_adc_max1);
+        }
+        else if (RX5808_Get_Signal_Source() == 1)
+        {
+            //rssi_adc_min = rssi_adc_min1;
+            //rssi_adc_max = rssi_adc_max1;
+            calib_flag=RX5808_Calib_RSSI(0, 4095,rssi_adc_min1,rssi_adc_max1);
+        }
+        else
+        {
+            //rssi_adc_min =rssi_adc_min0;
+            //rssi_adc_max =rssi_adc_max0;
+            calib_flag=RX5808_Calib_RSSI(rssi_adc_min0, rssi_adc_max0,0,4095);
 
-    if (tmr == scan_calib_timer)
+        }
+    }
+    if (calib_flag)
     {
-        if (repeat_count == 47)
+        if (RX5808_Get_Language() == 0)
         {
-            lv_amin_start(calib_result_label, lv_obj_get_y(calib_result_label), 32, 1, 500, 0, anim_set_y_cb, lv_anim_path_bounce);
-            lv_amin_start(calib_result_cont, lv_obj_get_y(calib_result_cont), 32, 1, 500, 0, anim_set_y_cb, lv_anim_path_bounce);
-            lv_amin_start(calib_result_cont, lv_obj_get_height(calib_result_cont), 48, 1, 500, 0, anim_set_height_cb, lv_anim_path_bounce);
-            lv_amin_start(calib_start_cont, lv_obj_get_height(calib_start_cont), 16, 1, 500, 0, anim_set_height_cb, lv_anim_path_bounce);
-            lv_obj_set_style_opa(rssi_min_label, (lv_opa_t)LV_OPA_0, LV_STATE_DEFAULT);
-            lv_obj_set_style_opa(rssi_max_label, (lv_opa_t)LV_OPA_0, LV_STATE_DEFAULT);
-            lv_obj_set_style_border_color(calib_result_cont, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
-            bool calib_flag=false;
-            if (RX5808_Get_Signal_Source() == 0)
-            {
-                //rssi_adc_min = rssi_adc_min0+ rssi_adc_min1;
-                //rssi_adc_max = rssi_adc_max0+ rssi_adc_max1;
-                calib_flag=RX5808_Calib_RSSI(rssi_adc_min0, rssi_adc_max0,rssi_adc_min1,rssi_adc_max1);
-            }
-            else if (RX5808_Get_Signal_Source() == 1)
-            {
-                //rssi_adc_min = rssi_adc_min1;
-                //rssi_adc_max = rssi_adc_max1;
-                calib_flag=RX5808_Calib_RSSI(0, 4095,rssi_adc_min1,rssi_adc_max1);
-            }
-            else
-            {
-                //rssi_adc_min =rssi_adc_min0;
-                //rssi_adc_max =rssi_adc_max0;
-                calib_flag=RX5808_Calib_RSSI(rssi_adc_min0, rssi_adc_max0,0,4095);
+            lv_label_set_text_fmt(calib_result_info, "Calib success!\nResult has\nbeen saved!");
+            lv_label_set_text_fmt(calib_result_label, "Success");
+        }
+        else
+        {
+            lv_label_set_text_fmt(calib_result_info, "æ ¡å‡†æˆåŠŸ!\nç»“æžœå·²ä¿å­˜!");
+            lv_label_set_text_fmt(calib_result_label, " æ ¡å‡†æˆåŠŸ ");
+        }
+        lv_obj_set_style_text_color(calib_result_info, lv_color_make(255, 255, 255), LV_STATE_DEFAULT);
+        lv_obj_set_style_bg_color(calib_result_label, lv_color_make(0, 255, 0), LV_STATE_DEFAULT);
+        RX5808_Set_RSSI_Ad_Min0(rssi_adc_min0);
+        RX5808_Set_RSSI_Ad_Max0(rssi_adc_max0);
+        RX5808_Set_RSSI_Ad_Min1(rssi_adc_min1);
+        RX5808_Set_RSSI_Ad_Max1(rssi_adc_max1);
+        rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_min0);
+        rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_max0);
+        rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_min1);
+        rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_max1);
+    }
+    else
+    {
+        if (RX5808_Get_Language() == 0)
+        {
+            lv_label_set_text_fmt(calib_result_info, "Calib failed!\nTry again!");
+            lv_label_set_text_fmt(calib_result_label, "Failed");
+        }
+        else
+        {
+            lv_label_set_text_fmt(calib_result_info, "æ ¡å‡†å¤±è´¥ï¼Œè¯·\né€€å‡ºå¹¶é‡è¯•!");
+            lv_label_set_text_fmt(calib_result_label, " æ ¡å‡†å¤±è´¥ ");
+        }
+        lv_obj_set_style_text_color(calib_result_info, lv_color_make(255, 255, 255), LV_STATE_DEFAULT);
+        lv_obj_set_style_bg_color(calib_result_label, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
+    }
+}
 
-            }
-            if (calib_flag)
-            {
-                if (RX5808_Get_Language() == 0)
-                {
-                    lv_label_set_text_fmt(calib_result_info, "Calib success!\nResult has\nbeen saved!");
-                    lv_label_set_text_fmt(calib_result_label, "Success");
-                }
-                else
-                {
-                    lv_label_set_text_fmt(calib_result_info, "æ ¡å‡†æˆåŠŸ!\nç»“æžœå·²ä¿å­˜!");
-                    lv_label_set_text_fmt(calib_result_label, " æ ¡å‡†æˆåŠŸ ");
-                }
-                lv_obj_set_style_text_color(calib_result_info, lv_color_make(255, 255, 255), LV_STATE_DEFAULT);
-                lv_obj_set_style_bg_color(calib_result_label, lv_color_make(0, 255, 0), LV_STATE_DEFAULT);
-                RX5808_Set_RSSI_Ad_Min0(rssi_adc_min0);
-                RX5808_Set_RSSI_Ad_Max0(rssi_adc_max0);
-                RX5808_Set_RSSI_Ad_Min1(rssi_adc_min1);
-                RX5808_Set_RSSI_Ad_Max1(rssi_adc_max1);
-                rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_min0);
-                rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_max0);
-                rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_min1);
-                rx5808_div_setup_upload(rx5808_div_config_rssi_adc_value_max1);
-            }
-            else
-            {
-                if (RX5808_Get_Language() == 0)
-                {
-                    lv_label_set_text_fmt(calib_result_info, "Calib failed!\nTry again!");
-                    lv_label_set_text_fmt(calib_result_label, "Failed");
-                }
-                else
-                {
-                    lv_label_set_text_fmt(calib_result_info, "æ ¡å‡†å¤±è´¥ï¼Œè¯·\né€€å‡ºå¹¶é‡è¯•!");
-                    lv_label_set_text_fmt(calib_result_label, " æ ¡å‡†å¤±è´¥ ");
-                }
-                lv_obj_set_style_text_color(calib_result_info, lv_color_make(255, 255, 255), LV_STATE_DEFAULT);
-                lv_obj_set_style_bg_color(calib_result_label, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
-            }
+static void page_scan_calib_timer_event(lv_timer_t* tmr)
+{
+    int scan_done = (tmr == scan_calib_timer) ? page_scan_batch_poll() : 0;
+    if (scan_done < 0)
+    {
+        page_scan_calib_finish(false);
+        return;
+    }
+    while (tmr == scan_calib_timer && scan_drawn < scan_done)
+    {
+        int repeat_count = scan_drawn++;
+        time_repeat_count = repeat_count;
+
+        const page_scan_point_t* point = page_scan_batch_point(repeat_count);
+        page_scan_calib_update(point->mean[0], point->mean[1]);
+        lv_bar_set_value(calib_progress_bar, (repeat_count + 1) * 100 / 48, LV_ANIM_ON);
+
+        if (repeat_count == 47)
+        {
+            page_scan_calib_finish(true);
         }
-        page_scan_calib_update();
-        if (time_repeat_count < 47)
-            RX5808_Set_Freq(Rx5808_Freq[(time_repeat_count + 1) / 8][(time_repeat_count + 1) % 8]);
-        else if (time_repeat_count == 47)
-            RX5808_Set_Freq(Rx5808_Freq[Chx_count][channel_count]);
     }
 
 }
@@ -163,10 +189,8 @@ static void page_scan_calib_event(lv_event_t* event)
             {
                 lv_obj_set_style_bg_color(calib_start_label, lv_color_make(0, 255, 0), LV_STATE_DEFAULT);
                 lv_group_focus_next(scan_group);
-                RX5808_Set_Freq(Rx5808_Freq[0][0]);
-                scan_calib_timer = lv_timer_create(page_scan_calib_timer_event, scan_turn_time, NULL);
-                lv_timer_set_repeat_count(scan_calib_timer, 48);
-                lv_bar_set_value(calib_progress_bar, 100, LV_ANIM_ON);
+                page_scan_batch_start(scan_points, scan_measure_ms, page_scan_calib_freq);
+                scan_calib_timer = lv_timer_create(page_scan_calib_timer_event, scan_poll_time, NULL);
 
             }
             else if (obj == calib_result_label)
@@ -181,26 +205,11 @@ static void page_scan_calib_event(lv_event_t* event)
 }
 
 
-// Improved calibration with multi-sample averaging for sustained signal detection
-// Takes 5 samples per channel with 10ms spacing = 50ms dwell per channel
-// Reduces false positives from transient noise spikes
-// Achieves >90% accuracy for single-channel detection
-static void page_scan_calib_update()
+// Fold one channel into the calibration range.  Each value is the mean of
+// scan_measure_ms of RSSI frames taken after the PLL settled, so transient
+// noise spikes cannot set min/max on their own.
+static void page_scan_calib_update(uint16_t avg0, uint16_t avg1)
 {
-    // Multi-sample averaging for sustained signal detection (reduces noise spikes)
-    uint16_t avg0 = 0, avg1 = 0;
-    const int samples = 5; // Increased from 3 for better noise rejection
-    
-    for (int i = 0; i < samples; i++) {
-        avg0 += adc_converted_value[0];
-        avg1 += adc_converted_value[1];
-        if (i < samples - 1) {
-            vTaskDelay(pdMS_TO_TICKS(10)); // 10ms spacing = 50ms total dwell time
-        }
-    }
-    avg0 /= samples;
-    avg1 /= samples;
-    
     // Update min/max with averaged values (more robust than single samples)
     if (avg0 > rssi_adc_max0)
         rssi_adc_max0 = avg0;
@@ -224,10 +233,11 @@ static void page_scan_calib_exit()
     lv_amin_start(calib_start_cont, lv_obj_get_x(calib_start_cont), 160, 1, 300, 100, anim_set_x_cb, page_scan_calib_anim_leave);
     lv_amin_start(calib_result_cont, lv_obj_get_x(calib_result_cont), 160, 1, 300, 200, anim_set_x_cb, page_scan_calib_anim_leave);
 
-    if (lv_group_get_focused(scan_group) == calib_result_label && time_repeat_count < 47)
+    if (scan_calib_timer != NULL)
     {
-        RX5808_Set_Freq(Rx5808_Freq[Chx_count][channel_count]);
+        page_scan_batch_stop();
         lv_timer_del(scan_calib_timer);
+        scan_calib_timer = NULL;
     }
     lv_group_del(scan_group);
     lv_obj_del_delayed(page_scan_calib_contain, 500);
@@ -242,6 +252,8 @@ void page_scan_calib_create()
     rssi_adc_min1 = 4095;
     rssi_adc_max1 = 0;
     time_repeat_count = 0;
+    scan_drawn = 0;
+    scan_calib_timer = NULL;
     page_scan_calib_contain = lv_obj_create(lv_scr_act());
     lv_obj_remove_style_all(page_scan_calib_contain);
     lv_obj_set_style_bg_color(page_scan_calib_contain, lv_color_make(0, 0, 0), LV_STATE_DEFAULT);
@@ -370,7 +382,7 @@ void page_scan_calib_create()
     lv_obj_set_style_bg_color(calib_progress_bar, lv_color_make(255, 180, 0), LV_PART_INDICATOR);
     lv_obj_align(calib_progress_bar, LV_ALIGN_TOP_MID, 0, 32);
     lv_bar_set_value(calib_progress_bar, 0, LV_ANIM_ON);
-    lv_obj_set_style_anim_time(calib_progress_bar, scan_turn_time * 48, LV_STATE_DEFAULT);
+    lv_obj_set_style_anim_time(calib_progress_bar, scan_poll_time * 5, LV_STATE_DEFAULT);
 
 
     if (RX5808_Get_Language() == 0)
@@ -9,10 +9,14 @@
 #include "led.h"
 #include "lv_anim_helpers.h"
 
+LV_FONT_DECLARE(lv_font_chinese_12);
+
 #define page_scan_chart_anim_enter  lv_anim_path_bounce
 #define page_scan_chart_anim_leave  lv_anim_path_bounce
 
-#define scan_turn_time  100
+#define scan_poll_time   20     // Result polling period (ms)
+#define scan_measure_ms  20     // RSSI averaged per point (ms)
+#define scan_points      48
 
 static lv_obj_t* page_scan_chart_contain = NULL;
 static lv_obj_t* chart_fre_label;
@@ -25,35 +29,69 @@ static lv_timer_t* scan_chart_timer;
 static uint8_t max_rssi = 0;
 static uint8_t max_channel = 0;
 static lv_obj_t* confirm_dialog = NULL;
+static uint8_t scan_drawn = 0;                // Points plotted
 
 static void page_scan_chart_timer_event(lv_timer_t* tmr);
+static uint16_t page_scan_chart_freq(uint8_t i);
+static void page_scan_chart_abort(void);
 static void page_scan_event_callback(lv_event_t* event);
 static void page_scan_chart_exit(void);
 static void show_switch_confirmation(void);
 static void confirm_dialog_event(lv_event_t* event);
 
+// Point i of the chart: 5300-5887.5 MHz, 12.5 MHz apart
+static uint16_t page_scan_chart_freq(uint8_t i)
+{
+    return (uint16_t)(5300 + i * 12.5);
+}
+
+// Give up on the scan: keep what was plotted and say why it stopped
+static void page_scan_chart_abort(void)
+{
+    lv_timer_del(scan_chart_timer);
+    scan_chart_timer = NULL;
+    page_scan_batch_stop();
+    led_set_pattern(lock_flag ? LED_PATTERN_SOLID : LED_PATTERN_HEARTBEAT);
+
+    if (RX5808_Get_Language() == 0) {
+        lv_label_set_text(chart_fre_label, "Scan failed: receiver busy");
+    } else {
+        lv_obj_set_style_text_font(chart_fre_label, &lv_font_chinese_12, LV_STATE_DEFAULT);
+        lv_label_set_text(chart_fre_label, "扫描失败：接收机忙");
+    }
+    lv_obj_set_style_text_color(chart_fre_label, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
+}
+
 static void page_scan_chart_timer_event(lv_timer_t* tmr)
 {
-    int repeat_count = 47 - tmr->repeat_count;
-    time_repeat_count = repeat_count;
-    if (tmr == scan_chart_timer)
+    int scan_done = (tmr == scan_chart_timer) ? page_scan_batch_poll() : 0;
+    if (scan_done < 0)
+    {
+        page_scan_chart_abort();
+        return;
+    }
+    while (tmr == scan_chart_timer && scan_drawn < scan_done)
     {
+        int repeat_count = scan_drawn++;
+        time_repeat_count = repeat_count;
+        uint8_t rssi0 = page_scan_batch_point(repeat_count)->percent[0];
+        uint8_t rssi1 = page_scan_batch_point(repeat_count)->percent[1];
         uint8_t rssi_pre = 0;
         	if(RX5808_Get_Signal_Source()==1)
 		{						
-            lv_chart_set_value_by_id(rssi_quality_chart, rssi1_curve, repeat_count, Rx5808_Get_Precentage1());
-            rssi_pre = Rx5808_Get_Precentage1();
+            lv_chart_set_value_by_id(rssi_quality_chart, rssi1_curve, repeat_count, rssi1);
+            rssi_pre = rssi1;
 		}
 		else if(RX5808_Get_Signal_Source()==2)
 		{
-            lv_chart_set_value_by_id(rssi_quality_chart, rssi0_curve, repeat_count, Rx5808_Get_Precentage0());
-            rssi_pre = Rx5808_Get_Precentage0();
+            lv_chart_set_value_by_id(rssi_quality_chart, rssi0_curve, repeat_count, rssi0);
+            rssi_pre = rssi0;
 		}
 		else
 		{
-		    lv_chart_set_value_by_id(rssi_quality_chart, rssi0_curve, repeat_count, Rx5808_Get_Precentage0());
-            lv_chart_set_value_by_id(rssi_quality_chart, rssi1_curve, repeat_count, Rx5808_Get_Precentage1());
-            rssi_pre = (Rx5808_Get_Precentage0() + Rx5808_Get_Precentage1()) / 2;
+		    lv_chart_set_value_by_id(rssi_quality_chart, rssi0_curve, repeat_count, rssi0);
+            lv_chart_set_value_by_id(rssi_quality_chart, rssi1_curve, repeat_count, rssi1);
+            rssi_pre = (rssi0 + rssi1) / 2;
 		}
         
         // Track maximum RSSI and its channel
@@ -63,12 +101,12 @@ static void page_scan_chart_timer_event(lv_timer_t* tmr)
             max_channel = time_repeat_count;
         }
         
-        if (time_repeat_count < 47)
-            RX5808_Set_Freq(5300 + (time_repeat_count + 1) * 12.5);
-        else if (time_repeat_count == 47)
+        if (time_repeat_count == 47)
         {
             // Scan complete - show confirmation dialog
-            RX5808_Set_Freq(Rx5808_Freq[Chx_count][channel_count]);
+            page_scan_batch_stop();
+            lv_timer_del(scan_chart_timer);
+            scan_chart_timer = NULL;
             show_switch_confirmation();
         }
     }
@@ -94,10 +132,11 @@ static void page_scan_chart_exit()
 {
     lv_amin_start(rssi_quality_chart, lv_obj_get_y(rssi_quality_chart), -60, 1, 500, 0, anim_set_y_cb, page_scan_chart_anim_leave);
     lv_amin_start(chart_fre_label, lv_obj_get_y(chart_fre_label), 80, 1, 200, 300, anim_set_y_cb, page_scan_chart_anim_leave);
-    if (time_repeat_count < 47)
+    if (scan_chart_timer != NULL)
     {
         lv_timer_del(scan_chart_timer);
-        RX5808_Set_Freq(Rx5808_Freq[Chx_count][channel_count]);
+        scan_chart_timer = NULL;
+        page_scan_batch_stop();
     }
     
     // Clean up confirmation dialog if it exists
@@ -126,7 +165,7 @@ static void confirm_dialog_event(lv_event_t* event)
             // Convert chart index (0-47) to band/channel
             uint8_t band = max_channel / 8;
             uint8_t channel = max_channel % 8;
-            RX5808_Set_Freq(Rx5808_Freq[band][channel]);
+            RX5808_Tune_Async(Rx5808_Freq[band][channel], NULL);
             Rx5808_Set_Channel(max_channel);
             rx5808_div_setup_upload(rx5808_div_config_channel);
             
@@ -230,6 +269,7 @@ void page_scan_chart_create()
     time_repeat_count = 0;
     max_rssi = 0;
     max_channel = 0;
+    scan_drawn = 0;
     
     // Set LED to fast blink during scanning
     led_set_pattern(LED_PATTERN_FAST_BLINK);
@@ -303,9 +343,9 @@ void page_scan_chart_create()
     lv_group_add_obj(scan_group, rssi_quality_chart);
     lv_group_set_editing(scan_group, false);
 
-    RX5808_Set_Freq(5300);
-    scan_chart_timer = lv_timer_create(page_scan_chart_timer_event, scan_turn_time, NULL);
-    lv_timer_set_repeat_count(scan_chart_timer, 48);
+    // Queue all 48 points (5300-5887.5 MHz, 12.5 MHz apart); plotted as they arrive
+    page_scan_batch_start(scan_points, scan_measure_ms, page_scan_chart_freq);
+    scan_chart_timer = lv_timer_create(page_scan_chart_timer_event, scan_poll_time, NULL);
 
     lv_amin_start(rssi_quality_chart, -60, 5, 1, 500, 0, anim_set_y_cb, page_scan_chart_anim_enter);
     lv_amin_start(chart_fre_label, 80, 68, 1, 200, 300, anim_set_y_cb, page_scan_chart_anim_enter);
@@ -15,6 +15,9 @@ LV_FONT_DECLARE(lv_font_chinese_16);
 #define page_scan_table_anim_leave  lv_anim_path_bounce
 
 #define scan_turn_time  100
+#define scan_poll_time   20     // Result polling period (ms)
+#define scan_measure_ms  20     // RSSI averaged per channel (ms)
+#define scan_points      48
 
 
 static lv_obj_t* page_scan_table_contain = NULL;
@@ -31,8 +34,11 @@ static uint8_t  max_rssi;
 static uint8_t  max_channel;
 static lv_obj_t* confirm_dialog = NULL;
 static bool scan_return_to_main = false;  // when true, exit returns to main page not menu
+static uint8_t scan_drawn = 0;                // Channels drawn
 
 static void page_scan_table_timer_event(lv_timer_t* tmr);
+static uint16_t page_scan_table_freq(uint8_t i);
+static void page_scan_table_abort(void);
 static void scroll_event(lv_event_t* event);
 static void page_scan_table_style_init(void);
 static void page_scan_table_style_deinit(void);
@@ -55,13 +61,53 @@ void page_scan_table_create_from_main(void)
     page_scan_table_create();
 }
 
+// Channel i of the band table (A1..L8)
+static uint16_t page_scan_table_freq(uint8_t i)
+{
+    return Rx5808_Freq[i / 8][i % 8];
+}
+
+// Give up on the scan: keep the rows drawn so far and say why it stopped
+static void page_scan_table_abort(void)
+{
+    lv_timer_del(scan_table_timer);
+    scan_table_timer = NULL;
+    page_scan_batch_stop();
+    led_set_pattern(lock_flag ? LED_PATTERN_SOLID : LED_PATTERN_HEARTBEAT);
+
+    if (RX5808_Get_Language() == 0)
+    {
+        lv_label_set_text_fmt(scan_info_label, "%s", "Failed!");
+    }
+    else
+    {
+        lv_label_set_text_fmt(scan_info_label, "%s", "扫描失败!");
+    }
+    lv_anim_del(scan_info_label, anim_opa_cb);
+    lv_obj_set_style_text_opa(scan_info_label, LV_OPA_COVER, LV_STATE_DEFAULT);
+    lv_obj_set_style_text_color(scan_info_label, lv_color_make(255, 0, 0), LV_STATE_DEFAULT);
+
+    // No row drawn yet means nothing takes keys: let the label take LEFT
+    if (scan_drawn == 0)
+    {
+        lv_group_add_obj(scan_group, scan_info_label);
+        lv_obj_add_event_cb(scan_info_label, scroll_event, LV_EVENT_KEY, NULL);
+    }
+}
+
 static void page_scan_table_timer_event(lv_timer_t* tmr)
 {
     static lv_obj_t* label_contain;
-    int repeat_count = 47 - tmr->repeat_count;
-    time_repeat_count = repeat_count;
-    if (tmr == scan_table_timer)
+    int scan_done = (tmr == scan_table_timer) ? page_scan_batch_poll() : 0;
+    if (scan_done < 0)
+    {
+        page_scan_table_abort();
+        return;
+    }
+    while (tmr == scan_table_timer && scan_drawn < scan_done)
     {
+        int repeat_count = scan_drawn++;
+        time_repeat_count = repeat_count;
         if (repeat_count % 8 == 0)
         {
             label_contain = lv_obj_create(scan_info_cont);
@@ -83,18 +129,19 @@ static void page_scan_table_timer_event(lv_timer_t* tmr)
 
         lv_obj_t* obj = lv_label_create(label_contain);
         lv_obj_add_style(obj, &style_label, LV_STATE_DEFAULT);
+        const uint8_t* pct = page_scan_batch_point(repeat_count)->percent;
         uint8_t rssi_pre = 0;
         if(RX5808_Get_Signal_Source()==1)
         {						
-                rssi_pre=Rx5808_Get_Precentage1();
+                rssi_pre=pct[1];
         }
         else if(RX5808_Get_Signal_Source()==2)
         {
-                rssi_pre=Rx5808_Get_Precentage0();
+                rssi_pre=pct[0];
         }
         else
         {
-            rssi_pre=(Rx5808_Get_Precentage0() + Rx5808_Get_Precentage1()) / 2;
+            rssi_pre=(pct[0] + pct[1]) / 2;
         }
         if (rssi_pre > max_rssi)
         {
@@ -137,10 +184,11 @@ static void page_scan_table_timer_event(lv_timer_t* tmr)
             lv_label_set_text_fmt(fre_info_label, "%c%d:%d", Rx5808_ChxMap[max_channel / 8], (max_channel % 8) + 1, Rx5808_Freq[max_channel / 8][max_channel % 8]);
             
             // Show confirmation dialog instead of auto-switching
+            page_scan_batch_stop();
+            lv_timer_del(scan_table_timer);
+            scan_table_timer = NULL;
             show_switch_confirmation();
         }
-        if (time_repeat_count < 47)
-            RX5808_Set_Freq(Rx5808_Freq[(time_repeat_count + 1) / 8][(time_repeat_count + 1) % 8]);
     }
 
 }
@@ -202,10 +250,11 @@ static void page_scan_table_exit()
     lv_amin_start(scan_info_label, lv_obj_get_y(scan_info_label), -20, 1, 200, 300, anim_set_y_cb, page_scan_table_anim_leave);
     lv_amin_start(fre_info_label, lv_obj_get_y(fre_info_label), -20, 1, 200, 300, anim_set_y_cb, page_scan_table_anim_leave);
     lv_amin_start(scan_info_cont, lv_obj_get_y(scan_info_cont), 80, 1, 500, 0, anim_set_y_cb, page_scan_table_anim_leave);
-    if (time_repeat_count < 47)
+    if (scan_table_timer != NULL)
     {
-        RX5808_Set_Freq(Rx5808_Freq[Chx_count][channel_count]);
+        page_scan_batch_stop();
         lv_timer_del(scan_table_timer);
+        scan_table_timer = NULL;
     }
     
     // Clean up confirmation dialog if it exists
@@ -237,7 +286,7 @@ static void confirm_dialog_event(lv_event_t* event)
         if (key_status == LV_KEY_ENTER)
         {
             // User confirmed - switch to the strongest channel
-            RX5808_Set_Freq(Rx5808_Freq[max_channel / 8][max_channel % 8]);
+            RX5808_Tune_Async(Rx5808_Freq[max_channel / 8][max_channel % 8], NULL);
             Rx5808_Set_Channel(max_channel);
             rx5808_div_setup_upload(rx5808_div_config_channel);
             
@@ -337,6 +386,7 @@ void page_scan_table_create()
 {
     time_repeat_count = 0;
     max_rssi = 0;
+    scan_drawn = 0;
     
     // Set LED to fast blink during scanning
     led_set_pattern(LED_PATTERN_FAST_BLINK);
@@ -417,9 +467,9 @@ void page_scan_table_create()
     lv_anim_set_path_cb(&anim, lv_anim_path_linear);
     lv_anim_start(&anim);
 
-    RX5808_Set_Freq(Rx5808_Freq[0][0]);
-    scan_table_timer = lv_timer_create(page_scan_table_timer_event, scan_turn_time, NULL);
-    lv_timer_set_repeat_count(scan_table_timer, 48);
+    // Queue the whole band; results are drawn as they arrive
+    page_scan_batch_start(scan_points, scan_measure_ms, page_scan_table_freq);
+    scan_table_timer = lv_timer_create(page_scan_table_timer_event, scan_poll_time, NULL);
 
     lv_amin_start(scan_info_label, -20, 0, 1, 200, 300, anim_set_y_cb, page_scan_table_anim_enter);
     lv_amin_start(fre_info_label, -20, 0, 1, 200, 300, anim_set_y_cb, page_scan_table_anim_enter);
@@ -65,8 +65,8 @@ const char language_label_text[][24] = { "English","??" };
 const char osd_format_label_text[][5] = { "PAL","NTSC" };
 const char signal_source_label_text[][6] = { "Auto","Recv1","Recv2","None" };
 const char signal_source_label_chinese_text[][24] = { "??","???1","???2","??"};
-const char diversity_mode_label_text[][6] = { "RACE","FREE","L-R" };
-const char diversity_mode_label_chinese_text[][24] = { "??","??","??"};
+const char diversity_mode_label_text[][6] = { "RACE","FREE","L-R","CUS1","CUS2","CUS3" };
+const char diversity_mode_label_chinese_text[][24] = { "??","??","??","CUS1","CUS2","CUS3"};
 const char cpu_freq_label_text[][8] = { "80MHz","160MHz","240MHz","AUTO" };
 const char gui_update_rate_label_text[][7] = { "10Hz","14Hz","20Hz","25Hz","50Hz","100Hz" };
 const char gui_update_rate_label_chinese_text[][24] = { "10??","14??","20??","25??","50??","100??" };
@@ -299,8 +299,9 @@ static void setup_event_callback(lv_event_t* event)
             }
             else if (obj == diversity_mode_label)
             {
-                --diversity_mode_selid;
-                uint8_t mode_idx = diversity_mode_selid % 3;
+                // Built-in modes, then the custom profiles loaded from NVS
+                diversity_mode_selid = diversity_next_mode((diversity_mode_t)diversity_mode_selid, -1);
+                uint8_t mode_idx = diversity_mode_selid % DIVERSITY_MODE_COUNT;
                 lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_text[mode_idx]));
                 diversity_set_mode((diversity_mode_t)mode_idx);
                 page_setup_set_language(language_selid % 2);
@@ -392,8 +393,9 @@ static void setup_event_callback(lv_event_t* event)
             }
             else if (obj == diversity_mode_label)
             {
-                ++diversity_mode_selid;
-                uint8_t mode_idx = diversity_mode_selid % 3;
+                // Built-in modes, then the custom profiles loaded from NVS
+                diversity_mode_selid = diversity_next_mode((diversity_mode_t)diversity_mode_selid, 1);
+                uint8_t mode_idx = diversity_mode_selid % DIVERSITY_MODE_COUNT;
                 lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_text[mode_idx]));
                 diversity_set_mode((diversity_mode_t)mode_idx);
                 page_setup_set_language(language_selid % 2);
@@ -506,7 +508,7 @@ static void page_setup_set_language(uint16_t language)
         lv_label_set_text_fmt(osd_format_setup_label, (const char*)(&osd_format_label_text[osd_format_selid % 2]));
         lv_label_set_text_fmt(language_setup_label, (const char*)(&language_label_text[language_selid % 2]));
         lv_label_set_text_fmt(signal_source_setup_label, (const char*)(&signal_source_label_text[signal_source_selid % 4]));
-        lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_text[diversity_mode_selid % 3]));
+        lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_text[diversity_mode_selid % DIVERSITY_MODE_COUNT]));
         lv_label_set_text_fmt(cpu_freq_setup_label, (const char*)(&cpu_freq_label_text[cpu_freq_selid % 4]));
         lv_label_set_text_fmt(gui_update_rate_setup_label, (const char*)(&gui_update_rate_label_text[gui_update_rate_selid % 6]));
     }
@@ -549,7 +551,7 @@ static void page_setup_set_language(uint16_t language)
         lv_label_set_text_fmt(osd_format_setup_label, (const char*)(&osd_format_label_text[osd_format_selid % 2]));
         lv_label_set_text_fmt(language_setup_label, (const char*)(&language_label_text[language_selid % 2]));
         lv_label_set_text_fmt(signal_source_setup_label, (const char*)(&signal_source_label_chinese_text[signal_source_selid % 4]));
-        lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_chinese_text[diversity_mode_selid % 3]));
+        lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_chinese_text[diversity_mode_selid % DIVERSITY_MODE_COUNT]));
         lv_label_set_text_fmt(cpu_freq_setup_label, (const char*)(&cpu_freq_label_text[cpu_freq_selid % 4]));
         lv_label_set_text_fmt(gui_update_rate_setup_label, (const char*)(&gui_update_rate_label_chinese_text[gui_update_rate_selid % 6]));
     }
@@ -784,9 +786,10 @@ void page_setup_create()
     lv_obj_set_size(diversity_mode_setup_label, 50, 18);
     lv_label_set_long_mode(diversity_mode_setup_label, LV_LABEL_LONG_WRAP);
     // Initialize to current diversity mode
-    diversity_state_t* div_state = diversity_get_state();
-    diversity_mode_selid = div_state->mode;
-    lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_text[diversity_mode_selid % 3]));
+    diversity_snapshot_t div_snap;
+    diversity_get_snapshot(&div_snap);
+    diversity_mode_selid = div_snap.mode;
+    lv_label_set_text_fmt(diversity_mode_setup_label, (const char*)(&diversity_mode_label_text[diversity_mode_selid % DIVERSITY_MODE_COUNT]));
 
     // CPU Frequency selector
     cpu_freq_label = lv_label_create(menu_setup_contain);
@@ -3,14 +3,14 @@
 #pragma GCC diagnostic ignored "-Wcast-function-type"
 
 #include "page_spectrum.h"
+#include "page_scan.h"
 #include "page_menu.h"
 #include "page_main.h"
 #include "page_bandx_channel_select.h"
 #include "rx5808.h"
+#include "diversity.h"
 #include "lvgl_stl.h"
 #include "beep.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
@@ -28,6 +28,9 @@ LV_FONT_DECLARE(lv_font_chinese_12);
 #define NOISE_FLOOR_SAMPLES 30        // Samples for noise floor calibration (increased for median + MAD)
 #define ZOOM_THRESHOLD 50             // RSSI threshold to trigger auto-zoom (0-100)
 #define ZOOM_DETECTION_BINS 3         // Consecutive strong bins to trigger zoom
+#define SCAN_POLL_MS 10               // Measurement result polling period
+#define SCAN_MEASURE_MS 5             // RSSI averaged per bin after settling
+#define NOISE_MEASURE_MS 20           // RSSI averaged per noise floor sample
 
 // Zoom levels
 typedef enum {
@@ -60,6 +63,14 @@ static bool exit_pending = false;
 static bool scan_complete = false;
 static uint8_t scan_pass = 0;                 // Scan pass counter
 
+// RX5808_Measure() results (written by the measure task, consumed by scan_timer);
+// the noise floor samples are a page_scan_batch_start() batch
+static bool noise_calibrated = false;
+static volatile bool bin_ready = false;       // bin_result_* hold a new result
+static uint16_t bin_result_freq = 0;
+static uint8_t bin_result_rssi = 0;
+static bool bin_pending = false;              // A bin measurement is queued
+
 // Zoom state
 static zoom_level_t zoom_level = ZOOM_FULL;  // Current zoom level
 static uint16_t zoom_center_freq = 5625;     // Center frequency for zoomed view
@@ -81,6 +92,7 @@ static uint32_t last_nav_key = 0;             // Last accepted directional key
 // Forward declarations
 static void spectrum_exit_callback(lv_anim_t* anim);
 static void scan_timer_callback(lv_timer_t* timer);
+static void scan_apply_bin(uint8_t rssi);
 static void peak_decay_callback(lv_timer_t* timer);
 static void spectrum_event_handler(lv_event_t* event);
 static void update_bars(void);
@@ -90,6 +102,9 @@ static void update_zoom_indicator(void);
 static void update_bandx_status(void);
 static void save_bandx_and_exit(uint16_t freq);
 static void calibrate_noise_floor(void);
+static uint16_t noise_floor_freq(uint8_t i);
+static void compute_noise_floor(void);
+static void bin_measure_cb(const rx5808_measure_t* result, void* arg);
 static void start_scan(void);
 static void stop_scan(void);
 static void set_zoom_level(zoom_level_t new_zoom, uint16_t center_freq);
@@ -279,19 +294,29 @@ static void save_bandx_and_exit(uint16_t freq)
     lv_fun_delayed(page_spectrum_exit, 1000);
 }
 
-// Calibrate noise floor using Median + MAD algorithm
-// Achieves >95% accuracy vs simple averaging (~70-80%)
+// Noise floor sample i: frequencies across the spectrum establish the baseline
+static uint16_t noise_floor_freq(uint8_t i)
+{
+    return view_freq_min + (i * ((view_freq_max - view_freq_min) / NOISE_FLOOR_SAMPLES));
+}
+
+// Queue the noise floor measurements; scan_timer computes the floor once
+// all of them are in and only then starts measuring bins
 static void calibrate_noise_floor(void)
+{
+    noise_calibrated = false;
+    page_scan_batch_start(NOISE_FLOOR_SAMPLES, NOISE_MEASURE_MS, noise_floor_freq);
+}
+
+// Noise floor from the calibration samples using Median + MAD algorithm
+// Achieves >95% accuracy vs simple averaging (~70-80%)
+static void compute_noise_floor(void)
 {
     uint8_t samples[NOISE_FLOOR_SAMPLES];
     uint8_t deviations[NOISE_FLOOR_SAMPLES];
     
-    // Sample frequencies across spectrum to establish baseline
     for (int i = 0; i < NOISE_FLOOR_SAMPLES; i++) {
-        uint16_t freq = view_freq_min + (i * ((view_freq_max - view_freq_min) / NOISE_FLOOR_SAMPLES));
-        RX5808_Set_Freq(freq);
-        vTaskDelay(pdMS_TO_TICKS(50));  // Proper PLL lock time per datasheet
-        samples[i] = Rx5808_Get_Precentage0();
+        samples[i] = page_scan_batch_point(i)->percent[0];
     }
     
     // Sort samples to find median (bubble sort - simple and adequate for 30 samples)
@@ -408,18 +433,60 @@ static void update_info_display(void)
     lv_label_set_text(info_label, info_str);
 }
 
-// Scan timer - scans one frequency per call
+// Measure task context: only store the result, scan_timer consumes it.
+// A failed measurement matches no bin, so the same bin is measured again.
+static void bin_measure_cb(const rx5808_measure_t* result, void* arg)
+{
+    bin_result_freq = result->ok ? result->freq : 0;
+    bin_result_rssi = (uint8_t)result->percent[0];
+    bin_ready = true;
+}
+
+// Scan timer - consumes one bin measurement per result and queues the next.
+// Tuning and settling happen in the driver's measure task, never in here.
 static void scan_timer_callback(lv_timer_t* timer)
 {
     if (!scanning_active || exit_pending) return;
+
+    // Nothing is queued while the calibration sweep runs: stop_scan()'s
+    // RX5808_Measure_Cancel() would cancel it too
+    if (diversity_calmap_sweep_running()) return;
     
-    // Set frequency and read RSSI
-    current_scan_freq = get_frequency_at_bin(current_bin);
-    RX5808_Set_Freq(current_scan_freq);
+    if (!noise_calibrated) {
+        int done = page_scan_batch_poll();
+        if (done < 0) {
+            // Gave up, but the floor is still needed: drop what is left, start over
+            page_scan_batch_stop();
+            calibrate_noise_floor();
+            return;
+        }
+        if (done < NOISE_FLOOR_SAMPLES) {
+            return;
+        }
+        compute_noise_floor();
+        noise_calibrated = true;
+    }
     
-    // Read RSSI and update data with exponential moving average
-    uint8_t rssi = Rx5808_Get_Precentage0();
+    if (bin_pending) {
+        if (!bin_ready) return;
+        bin_pending = false;
+        current_scan_freq = get_frequency_at_bin(current_bin);
+        // A zoom change while the measurement was in flight remaps the bins:
+        // drop the stale result and measure the new bin instead
+        if (bin_result_freq == current_scan_freq) {
+            scan_apply_bin(bin_result_rssi);
+        }
+    }
     
+    bin_ready = false;
+    bin_pending = RX5808_Measure(get_frequency_at_bin(current_bin), 0,
+                                 RX5808_Get_RSSI_Frames_In(SCAN_MEASURE_MS),
+                                 bin_measure_cb, NULL);
+}
+
+// Fold one measured bin into the spectrum and advance to the next bin
+static void scan_apply_bin(uint8_t rssi)
+{
     if (scan_pass == 0) {
         // First pass: just store
         rssi_data[current_bin] = rssi;
@@ -469,6 +536,8 @@ static void start_scan(void)
 {
     scanning_active = true;
     current_bin = 0;
+    bin_pending = false;
+    bin_ready = false;
     scan_pass = 0;
     scan_complete = false;
     
@@ -476,8 +545,8 @@ static void start_scan(void)
     memset(rssi_data, 0, sizeof(rssi_data));
     memset(peak_data, 0, sizeof(peak_data));
     
-    // Start scan timer (fast: 30ms per bin = 1.2s per full scan)
-    scan_timer = lv_timer_create(scan_timer_callback, 30, NULL);
+    // Start scan timer: polls for measurement results, one bin per result
+    scan_timer = lv_timer_create(scan_timer_callback, SCAN_POLL_MS, NULL);
     
     // Start peak decay timer
     peak_decay_timer = lv_timer_create(peak_decay_callback, PEAK_DECAY_MS, NULL);
@@ -487,6 +556,10 @@ static void start_scan(void)
 static void stop_scan(void)
 {
     scanning_active = false;
+    if (!diversity_calmap_sweep_running()) {
+        RX5808_Measure_Cancel();    // None of ours are queued while it runs
+    }
+    bin_pending = false;
     
     if (scan_timer) {
         lv_timer_del(scan_timer);
@@ -550,8 +623,10 @@ static void spectrum_event_handler(lv_event_t* event)
                 // Band X mode: Save selected frequency and exit
                 save_bandx_and_exit(selected_freq);
             } else {
-                // Normal mode: Tune to frequency and exit
-                RX5808_Set_Freq(selected_freq);
+                // Normal mode: Tune to frequency and exit (stop the scan
+                // first so no queued measurement retunes after us)
+                stop_scan();
+                RX5808_Tune_Async(selected_freq, NULL);
                 page_spectrum_exit();
             }
             return;
@@ -0,0 +1,65 @@
+/**
+ * @file console.c
+ * @brief Serial console commands
+ */
+
+#include "console.h"
+#include "diversity.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_FLIGHT_RECORDER
+#include "flightrec.h"
+#endif
+#include "esp_log.h"
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char* TAG = "console";
+
+#define CONSOLE_UART        CONFIG_ESP_CONSOLE_UART_NUM
+
+static void console_task(void* param)
+{
+    (void)param;
+    char line[16];
+    size_t len = 0;
+    while (1) {
+        uint8_t c;
+        if (uart_read_bytes(CONSOLE_UART, &c, 1, portMAX_DELAY) != 1) {
+            continue;
+        }
+        if (c != '\r' && c != '\n') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            }
+            continue;
+        }
+        line[len] = '\0';
+        if (strcmp(line, "latdump") == 0) {
+            diversity_print_latency();
+        } else if (strcmp(line, "latreset") == 0) {
+            diversity_reset_latency();
+#ifdef CONFIG_FLIGHT_RECORDER
+        } else if (strcmp(line, "frdump") == 0) {
+            flightrec_dump();
+        } else if (strcmp(line, "frstat") == 0) {
+            flightrec_print_stats();
+#endif
+        }
+        len = 0;
+    }
+}
+
+void console_init(void)
+{
+    // The console UART gets a driver so commands can be read; stdout is
+    // routed through it too, so log lines and dumps never interleave mid-write
+    if (uart_driver_install(CONSOLE_UART, 256, 0, 0, NULL, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "Console UART driver unavailable - commands disabled");
+        return;
+    }
+    uart_vfs_dev_use_driver(CONSOLE_UART);
+    xTaskCreatePinnedToCore(console_task, "console", 3072, NULL, 1, NULL, 1);
+}
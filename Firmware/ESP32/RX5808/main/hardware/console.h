@@ -0,0 +1,20 @@
+/**
+ * @file console.h
+ * @brief Serial console commands
+ *
+ * One command per line on the ESP-IDF console UART (the USB serial port):
+ *
+ *   latdump    print the diversity latency histograms (diversity_print_latency())
+ *   latreset   clear them
+ *   frdump     export the flight recorder (CONFIG_FLIGHT_RECORDER, flightrec.h)
+ *   frstat     print the flight recorder counters (CONFIG_FLIGHT_RECORDER)
+ *
+ * Anything else is ignored.
+ */
+
+#ifndef __CONSOLE_H
+#define __CONSOLE_H
+
+void console_init(void);
+
+#endif // __CONSOLE_H
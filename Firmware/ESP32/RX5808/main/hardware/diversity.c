@@ -5,6 +5,8 @@
  */
 
 #include "diversity.h"
+#include "diversity_profile.h"
+#include "rssi_calmap.h"
 #include "rx5808.h"
 #include "hwvers.h"
 #include "beep.h"
@@ -16,21 +18,38 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_DIVERSITY_SCORE_BENCHMARK
+#include "esp_cpu.h"
+#endif
+#ifdef CONFIG_FLIGHT_RECORDER
+#include "flightrec.h"
+#endif
+#include <stdio.h>
 #include <string.h>
 
 static const char* TAG = "diversity";
 
 // Mode parameter definitions
-const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_COUNT] = {
+const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_BUILTIN_COUNT] = {
     // RACE mode - aggressive, minimal lag
     {
         .dwell_ms = 80,
         .cooldown_ms = 150,
         .hysteresis_pct = 2,
-        .weight_rssi = 0.85f,
-        .weight_stability = 0.15f,
+        .weight_rssi = DIVERSITY_Q15(0.85f),
+        .weight_stability = DIVERSITY_Q15(0.15f),
         // Point 2: now ADC units/second. -200/s ≈ full-range drop in ~20 s → very reactive
         .slope_threshold = -200,
+        .predictor = DIVERSITY_PREDICT_SLOPE,
+        .kf_alpha = RSSI_KALMAN_Q16(0.5f),
+        .kf_beta = RSSI_KALMAN_Q16(0.172f),
+        .predict_ms = 30,
+        .rate_min_hz = 25,
+        .rate_max_hz = 100,
+        // Multipath flutter: pure RSSI, switch into each notch's other side
+        .flutter_weight_stability = DIVERSITY_Q15(0.0f),
+        .flutter_dwell_pct = 25,
         .name = "Race"
     },
     // FREESTYLE mode - balanced
@@ -38,9 +57,17 @@ const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_COUNT] = {
         .dwell_ms = 250,
         .cooldown_ms = 500,
         .hysteresis_pct = 4,
-        .weight_rssi = 0.70f,
-        .weight_stability = 0.30f,
+        .weight_rssi = DIVERSITY_Q15(0.70f),
+        .weight_stability = DIVERSITY_Q15(0.30f),
         .slope_threshold = -100, // -100/s ≈ full drop in ~40 s
+        .predictor = DIVERSITY_PREDICT_KALMAN,
+        .kf_alpha = RSSI_KALMAN_Q16(0.4f),
+        .kf_beta = RSSI_KALMAN_Q16(0.102f),
+        .predict_ms = 50,
+        .rate_min_hz = 20,
+        .rate_max_hz = 100,
+        .flutter_weight_stability = DIVERSITY_Q15(0.30f),
+        .flutter_dwell_pct = 35,
         .name = "Freestyle"
     },
     // LONG_RANGE mode - stable, minimize switching
@@ -48,9 +75,17 @@ const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_COUNT] = {
         .dwell_ms = 400,
         .cooldown_ms = 800,
         .hysteresis_pct = 6,
-        .weight_rssi = 0.75f,
-        .weight_stability = 0.25f,
+        .weight_rssi = DIVERSITY_Q15(0.75f),
+        .weight_stability = DIVERSITY_Q15(0.25f),
         .slope_threshold = -50,  // -50/s ≈ full drop in ~80 s → only obvious trend
+        .predictor = DIVERSITY_PREDICT_KALMAN,
+        .kf_alpha = RSSI_KALMAN_Q16(0.25f),
+        .kf_beta = RSSI_KALMAN_Q16(0.036f),
+        .predict_ms = 80,
+        .rate_min_hz = 10,
+        .rate_max_hz = 100,
+        .flutter_weight_stability = DIVERSITY_Q15(0.25f),
+        .flutter_dwell_pct = 60,
         .name = "Long Range"
     }
 };
@@ -58,25 +93,142 @@ const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_COUNT] = {
 // Global diversity state
 static diversity_state_t g_diversity_state = {0};
 static bool g_diversity_initialized = false;
+static diversity_predictor_t g_predictor[DIVERSITY_MODE_COUNT];    // Per-mode, from params at init
+
+// Custom mode profiles (DIVERSITY_MODE_CUSTOM_n), from the NVS profile blob
+static diversity_profile_t g_custom[DIVERSITY_CUSTOM_PROFILES];
+static int g_custom_count = 0;
 
 // NVS storage keys
 #define NVS_NAMESPACE "diversity"
-#define NVS_KEY_CAL_A_FLOOR "cal_a_floor"
-#define NVS_KEY_CAL_A_PEAK "cal_a_peak"
-#define NVS_KEY_CAL_B_FLOOR "cal_b_floor"
-#define NVS_KEY_CAL_B_PEAK "cal_b_peak"
+#define NVS_KEY_CAL_FMT "cal_%c_%s"     // cal_a_floor, cal_b_peak, ...: 'a' + receiver
 #define NVS_KEY_MODE "div_mode"
-
-// Switch rate tracking (for switches per minute)
+#define NVS_KEY_PROFILES "profiles"
+#define NVS_KEY_CALMAP "cal_map"
+
+// Per-frequency calibration map.  Double-buffered: a rebuild fills the
+// spare copy and then publishes it, so diversity_update() never reads a
+// half-built table.
+#define CALMAP_SWEEP_SAMPLE_MS      20      // RSSI collected per bin
+#define CALMAP_SWEEP_TIMEOUT_MS     500     // Per-bin wait for the measure task
+static rssi_calmap_t g_calmap[2];
+static rssi_calmap_t* volatile g_calmap_live = &g_calmap[0];
+static TaskHandle_t g_calmap_task = NULL;
+static rx5808_measure_t g_calmap_result;
+// Set by the sweep while it retunes: diversity_update() then evaluates
+// nothing, since every frame reads some other channel
+static volatile bool g_tuner_borrowed = false;
+static void diversity_calmap_load(void);
+
+// Switch rate tracking: timestamps in switch order.  Each rate window keeps
+// a tail that only moves forward, so counting the switches inside it costs
+// amortised O(1) per tick instead of a scan of the whole history.
 #define SWITCH_HISTORY_SIZE 60
 static uint32_t g_switch_timestamps[SWITCH_HISTORY_SIZE] = {0};
-static uint8_t g_switch_history_index = 0;
+static uint32_t g_switch_head = 0;          // Switches recorded (next slot = head % SIZE)
+static uint32_t g_switch_tail_5s = 0;       // Oldest switch inside the last 5 s
+static uint32_t g_switch_tail_60s = 0;      // Oldest switch inside the last 60 s
+static volatile uint32_t g_switches_last_minute = 0;
+
+// Event-driven updates: the RF service calls diversity_frame_cb() for every
+// published frame and wakes the task once a frame at or after g_next_due_us
+// exists, so a decision runs right after the sample it is based on instead
+// of on the next 10 ms tick.
+#define DIVERSITY_WAKE_TIMEOUT_MS   100     // Keeps the loop alive if sampling stalls
+
+// Continuous evaluation-rate controller (diversity_rate_update())
+#define DIVERSITY_RATE_SLOPE_FULL   3000    // |slope| (ADC units/s) that asks for rate_max_hz
+#define DIVERSITY_RATE_VAR_FLOOR    1600    // Variance of a steady link (~40 counts of noise)...
+#define DIVERSITY_RATE_VAR_FULL    60000    // ...and the variance that asks for rate_max_hz
+#define DIVERSITY_RATE_DECAY_MS     1500    // Time constant of the decay to a lower rate
+#define DIVERSITY_RATE_WAKE_DELTA    200    // Raw jump that wakes the task before the frame is due
+static TaskHandle_t g_diversity_task = NULL;
+static volatile uint32_t g_next_due_us = 0; // Low 32 bits of esp_timer time
+static volatile uint16_t g_wake_ref[DIVERSITY_NUM_RX];  // Raw RSSI of the last evaluated frame
+static volatile bool g_wake_early = false;  // A frame jumped away from g_wake_ref before it was due
+
+// Fading spectrum (rssi_fading.h), fed by diversity_frame_cb() with every
+// frame; the diversity task only reads each receiver's regime byte.  A
+// frame further than 25 % off the 1 kHz period the bins are placed for
+// (a stall, another RSSI rate, the oneshot fallback) starts it over.
+#define DIVERSITY_FADING_PERIOD_US  (1000000 / RSSI_FADING_RATE_HZ)
+// Floor of the flutter-shortened dwell and cooldown, never above the mode's
+// own: at most 12.5 switches/s however far flutter_dwell_pct cuts them.
+// Following every notch costs more switches than the time on the worse
+// antenna it saves; diversity_sim -F prints both for each mode.
+#define DIVERSITY_FLUTTER_DWELL_MIN_MS  80
+static rssi_fading_t g_fading[DIVERSITY_NUM_RX];
+static int64_t g_fading_last_us = 0;        // t_us of the previous frame
+static diversity_latency_t g_latency;
+#ifdef CONFIG_DIVERSITY_LATENCY_LOG
+#define DIVERSITY_LATENCY_LOG_MS  10000
+static uint32_t g_latency_log_ms = 0;
+#endif
+
+// UI / telemetry snapshot, the seqcount latch of rssi_snapshot.h: the
+// diversity task only rewrites the copy readers are told not to use, so a
+// reader on either core copies it in constant time and never waits.
+static struct {
+    volatile uint32_t    seqcount;      // Bumped twice per publish; low bit selects the readable copy
+    diversity_snapshot_t copy[2];
+} g_snapshot;
+static uint32_t g_snapshot_seq = 0;
+
+// Shadow evaluation.  A shadow is a private copy of the switching state run
+// with another mode's parameters; the window statistics and health do not
+// depend on the mode, so they are taken from the live state rather than
+// computed again.  diversity_shadow_set()/reset() only post a request,
+// which diversity_update() applies between decisions.
+#define SHADOW_REQ_NONE         0xFF
+// Decisions awaiting judgement: one per frame at most, and frames are at
+// least 1 ms apart (1 kHz, also the highest rate_max_hz a profile may set),
+// so every decision of the last JUDGE_MS fits and none is dropped unjudged
+#define SHADOW_PENDING_SIZE     (DIVERSITY_SHADOW_JUDGE_MS + 1)
+#define DIVERSITY_SHADOW_LOG_MS 10000
+typedef struct {
+    diversity_state_t state;
+    bool enabled;
+} diversity_shadow_t;
+static diversity_shadow_t g_shadow[DIVERSITY_SHADOW_MAX];
+static diversity_shadow_stats_t g_shadow_stats[1 + DIVERSITY_SHADOW_MAX];
+static volatile uint8_t g_shadow_request[DIVERSITY_SHADOW_MAX];
+static volatile bool g_shadow_reset_request = false;
+static struct {
+    uint32_t t_ms;
+    uint8_t  rx[1 + DIVERSITY_SHADOW_MAX];  // Receiver selected by set i (0 = live)
+} g_shadow_pending[SHADOW_PENDING_SIZE];
+static uint32_t g_shadow_pending_head = 0;
+static uint32_t g_shadow_pending_tail = 0;
+static uint32_t g_shadow_start_ms = 0;
+#ifdef CONFIG_DIVERSITY_SHADOW
+static uint32_t g_shadow_log_ms = 0;
+static void diversity_shadow_log(void);
+#endif
+
+// Decision logs come from the live state only, never from a shadow
+#define DIVERSITY_LOG_LIVE(state, ...) \
+    do { if ((state) == &g_diversity_state) { ESP_LOGI(TAG, __VA_ARGS__); } } while (0)
 
 /**
  * @brief FreeRTOS task function that drives the diversity update loop (fix N).
  * Forward-declared here; defined after diversity_init().
  */
 static void diversity_task_fn(void *param);
+static void diversity_frame_cb(const rssi_frame_t* frame);
+static void diversity_snapshot_publish(const diversity_state_t* state, uint32_t t_ms);
+#ifdef CONFIG_DIVERSITY_SCORE_BENCHMARK
+static void diversity_score_benchmark(void);
+#endif
+
+// Scoring constants (Q16).  Float equivalents: k_variance 0.2, k_slope 0.038.
+#define DIVERSITY_K_VARIANCE_Q16    13107
+#define DIVERSITY_K_SLOPE_Q16        2490
+// Point 7 AGC: EMA weight α = 0.001 (Q24 so the ~10 s time constant is kept)
+#define DIVERSITY_AGC_ALPHA_Q24     16777
+#define DIVERSITY_AGC_TARGET        50      // rssi_norm the baseline is pulled to
+#define DIVERSITY_AGC_MAX_CORR      15
+// Point 9: score bonus for a receiver confirmed good after a switch
+#define DIVERSITY_PREF_BONUS         8
 
 /**
  * @brief Initialize diversity system
@@ -85,75 +237,253 @@ void diversity_init(void) {
     ESP_LOGI(TAG, "Initializing diversity system v1.8.0");
 
     memset(&g_diversity_state, 0, sizeof(diversity_state_t));
+    g_next_due_us = 0;      // First published frame is due
+    g_fading_last_us = 0;
 
     // Set defaults
     g_diversity_state.mode      = DIVERSITY_MODE_FREESTYLE;
     g_diversity_state.active_rx = DIVERSITY_RX_A;
 
-    // Point 7: AGC baseline starts at 50 (midpoint of 0-100 range) so both
-    // receivers start with zero correction and converge naturally toward their
-    // true long-term mean over the first ~10 s of stable flight.
-    g_diversity_state.rx_a.agc_baseline = 50.0f;
-    g_diversity_state.rx_b.agc_baseline = 50.0f;
-
-    // Initialize calibration defaults (uncalibrated)
-    g_diversity_state.cal_a.floor_raw  = 0;
-    g_diversity_state.cal_a.peak_raw   = 4095;
-    g_diversity_state.cal_a.calibrated = false;
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        diversity_rx_state_t* rx = &g_diversity_state.rx[i];
+        // Point 7: AGC baseline starts at 50 (midpoint of 0-100 range) so all
+        // receivers start with zero correction and converge naturally toward
+        // their true long-term mean over the first ~10 s of stable flight.
+        rx->agc_baseline = DIVERSITY_AGC_TARGET * DIVERSITY_Q16_ONE;
+        rssi_window_init(&rx->window, rx->rssi_samples, rx->rssi_sample_ms, DIVERSITY_MAX_SAMPLES);
+        rssi_kalman_reset(&rx->fade);
+        rssi_fading_reset(&g_fading[i]);
+
+        // Calibration defaults (uncalibrated)
+        g_diversity_state.cal[i].floor_raw  = 0;
+        g_diversity_state.cal[i].peak_raw   = 4095;
+        g_diversity_state.cal[i].calibrated = false;
+    }
+    for (int m = 0; m < DIVERSITY_MODE_COUNT; m++) {
+        g_predictor[m] = diversity_get_mode_params((diversity_mode_t)m)->predictor;
+    }
 
-    g_diversity_state.cal_b.floor_raw  = 0;
-    g_diversity_state.cal_b.peak_raw   = 4095;
-    g_diversity_state.cal_b.calibrated = false;
-    
-    // Load calibration from NVS
+    // Load custom profiles first, so a saved custom mode can be restored
+    diversity_profiles_load();
+    // Load calibration from NVS; the map needs it as the span fallback
     diversity_calibrate_load();
+    diversity_calmap_load();
+
+    memset(&g_snapshot, 0, sizeof(g_snapshot));
+    g_snapshot_seq = 0;
+    diversity_snapshot_publish(&g_diversity_state, 0);     // Mode and calibration as loaded
+
+    memset(g_shadow, 0, sizeof(g_shadow));
+    memset(g_shadow_stats, 0, sizeof(g_shadow_stats));
+    g_shadow_pending_head = g_shadow_pending_tail = 0;
+    g_shadow_reset_request = false;
+    for (int i = 0; i < DIVERSITY_SHADOW_MAX; i++) {
+        g_shadow_request[i] = SHADOW_REQ_NONE;
+    }
+#ifdef CONFIG_DIVERSITY_SHADOW
+    // Shadow the first modes other than the live one
+    for (int i = 0, m = 0; i < DIVERSITY_SHADOW_MAX && m < DIVERSITY_MODE_COUNT; m++) {
+        if (m != (int)g_diversity_state.mode && diversity_mode_available((diversity_mode_t)m)) {
+            g_shadow_request[i++] = (uint8_t)m;
+        }
+    }
+#endif
+
+#ifdef CONFIG_DIVERSITY_SCORE_BENCHMARK
+    diversity_score_benchmark();
+#endif
     
     g_diversity_initialized = true;
     
     ESP_LOGI(TAG, "Diversity initialized - Mode: %s", 
-             diversity_mode_params[g_diversity_state.mode].name);
+             diversity_get_mode_params(g_diversity_state.mode)->name);
 
     // Spawn the diversity update task on Core 1 (fix N + J).
     //
     // Running diversity_update() in its own FreeRTOS task instead of inside
-    // the LVGL timer callback ensures that RX5808_Set_Freq() (which blocks
-    // ~50 ms during PLL settling) never stalls the LVGL rendering loop.
-    // It also guarantees diversity runs regardless of which GUI page is open.
+    // the LVGL timer callback keeps its per-frame scoring off the LVGL
+    // rendering loop (retunes go through RX5808_Tune_Async() and do not
+    // block either way).  It also guarantees diversity runs regardless of
+    // which GUI page is open.
     //
-    // The task calls diversity_update() in a tight 5 ms loop; the function
-    // itself is internally rate-limited (10 ms at 100 Hz or 50 ms at 20 Hz),
-    // so excess calls return immediately at negligible cost.
+    // The task sleeps until diversity_frame_cb() reports a frame due at the
+    // rate diversity_rate_update() picked; diversity_update() is also
+    // rate-limited itself, so excess calls return at negligible cost.
     xTaskCreatePinnedToCore(
         diversity_task_fn,  // forward-declared below
         "diversity",
         4096,
         NULL,
         6,      // priority 6 — above LVGL (5), keeps RF switching responsive
-        NULL,
+        &g_diversity_task,
         1       // Core 1 — alongside the RSSI and beep tasks
     );
+    RX5808_Set_Frame_Callback(diversity_frame_cb);
+}
+
+/**
+ * @brief RF service hook, once per published frame: feed the fading
+ *        spectrum, and wake the diversity task when the frame is due for a
+ *        decision, or at once when a receiver moved DIVERSITY_RATE_WAKE_DELTA
+ *        from the last evaluated frame (the start of a fade at a low rate).
+ *        Runs on the RF service, so it stays to a few multiplies per
+ *        receiver (the Goertzel bank) and a notify.
+ */
+static IRAM_ATTR void diversity_frame_cb(const rssi_frame_t* frame)
+{
+    if (g_diversity_task == NULL) {
+        return;
+    }
+    int64_t period = frame->t_us - g_fading_last_us;
+    bool on_rate   = period >= DIVERSITY_FADING_PERIOD_US * 3 / 4 && period <= DIVERSITY_FADING_PERIOD_US * 5 / 4;
+    bool settled   = RX5808_Is_Settled() && frame->t_us >= RX5808_Get_Settled_Time_Us();
+    g_fading_last_us = frame->t_us;
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        if (!on_rate) {
+            rssi_fading_reset(&g_fading[i]);
+        } else if (!settled) {
+            rssi_fading_restart(&g_fading[i]);     // Keep a retune transient out of the block
+        } else {
+            rssi_fading_push(&g_fading[i], frame->value[RSSI_SLOT_RSSI0 + i]);
+        }
+    }
+
+    bool due = (int32_t)((uint32_t)frame->t_us - g_next_due_us) >= 0;
+    for (int i = 0; i < DIVERSITY_NUM_RX && !due; i++) {
+        int32_t d = (int32_t)frame->value[RSSI_SLOT_RSSI0 + i] - g_wake_ref[i];
+        if (d > DIVERSITY_RATE_WAKE_DELTA || d < -DIVERSITY_RATE_WAKE_DELTA) {
+            g_wake_early = due = true;
+        }
+    }
+    if (due) {
+        xTaskNotifyGive(g_diversity_task);
+    }
+}
+
+// Quarter-octave bucket of a latency in microseconds (see diversity_latency_t)
+static IRAM_ATTR uint8_t diversity_latency_bucket(uint32_t us)
+{
+    if (us < 64) {
+        return (uint8_t)(us >> 4);
+    }
+    int log2 = 31 - __builtin_clz(us);
+    uint32_t b = (uint32_t)(log2 - 5) * DIVERSITY_LATENCY_SUB + ((us >> (log2 - 2)) & 3);
+    return (b >= DIVERSITY_LATENCY_BUCKETS) ? DIVERSITY_LATENCY_BUCKETS - 1 : (uint8_t)b;
+}
+
+// Lowest latency that falls into bucket @p b
+static uint32_t diversity_latency_bucket_us(int b)
+{
+    if (b < DIVERSITY_LATENCY_SUB) {
+        return (uint32_t)b << 4;
+    }
+    return (uint32_t)(DIVERSITY_LATENCY_SUB + b % DIVERSITY_LATENCY_SUB) << (b / DIVERSITY_LATENCY_SUB + 3);
+}
+
+static IRAM_ATTR void diversity_latency_record(uint32_t* hist, uint32_t* max_us, int64_t from_us, int64_t to_us)
+{
+    if (to_us < from_us) {
+        return;
+    }
+    uint32_t us = (to_us - from_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)(to_us - from_us);
+    hist[diversity_latency_bucket(us)]++;
+    if (us > *max_us) {
+        *max_us = us;
+    }
+}
+
+/**
+ * @brief Copy of the sample-to-decision and sample-to-GPIO latency histograms
+ */
+void diversity_get_latency(diversity_latency_t* out) {
+    *out = g_latency;
+}
+
+/**
+ * @brief Clear the latency histograms (e.g. before a profiling flight)
+ */
+void diversity_reset_latency(void) {
+    memset(&g_latency, 0, sizeof(g_latency));
+}
+
+/**
+ * @brief Number of latencies recorded in @p hist
+ */
+uint32_t diversity_latency_count(const uint32_t hist[DIVERSITY_LATENCY_BUCKETS]) {
+    uint32_t n = 0;
+    for (int b = 0; b < DIVERSITY_LATENCY_BUCKETS; b++) {
+        n += hist[b];
+    }
+    return n;
+}
+
+/**
+ * @brief @p pct-th percentile of @p hist in microseconds: the upper edge of
+ *        the bucket it falls in, so at most a quarter octave pessimistic,
+ *        and never above the recorded maximum @p max_us
+ * @return 0 if nothing was recorded
+ */
+uint32_t diversity_latency_percentile(const uint32_t hist[DIVERSITY_LATENCY_BUCKETS], uint32_t max_us, uint8_t pct) {
+    uint32_t n = diversity_latency_count(hist);
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)n * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < DIVERSITY_LATENCY_BUCKETS - 1; b++) {
+        seen += hist[b];
+        if (seen >= rank) {
+            uint32_t upper = diversity_latency_bucket_us(b + 1);
+            return (upper < max_us) ? upper : max_us;
+        }
+    }
+    return max_us;
+}
+
+/**
+ * @brief Print both latency histograms (non-empty buckets) and their
+ *        percentiles to the log; the "latdump" console command
+ */
+void diversity_print_latency(void)
+{
+    diversity_latency_t lat;
+    diversity_get_latency(&lat);
+    const uint32_t* hist[2] = { lat.decision, lat.gpio };
+    const char* name[2] = { "decision", "gpio" };
+    const uint32_t max_us[2] = { lat.decision_max_us, lat.gpio_max_us };
+
+    for (int h = 0; h < 2; h++) {
+        ESP_LOGI(TAG, "Latency %-8s n %lu  p50 %lu  p95 %lu  p99 %lu  max %lu us", name[h],
+                 (unsigned long)diversity_latency_count(hist[h]),
+                 (unsigned long)diversity_latency_percentile(hist[h], max_us[h], 50),
+                 (unsigned long)diversity_latency_percentile(hist[h], max_us[h], 95),
+                 (unsigned long)diversity_latency_percentile(hist[h], max_us[h], 99),
+                 (unsigned long)max_us[h]);
+        for (int b = 0; b < DIVERSITY_LATENCY_BUCKETS; b++) {
+            if (hist[h][b] != 0) {
+                ESP_LOGI(TAG, "  %-8s >= %6lu us  %lu", name[h],
+                         (unsigned long)diversity_latency_bucket_us(b), (unsigned long)hist[h][b]);
+            }
+        }
+    }
 }
 
 /**
  * @brief FreeRTOS task that drives the diversity update loop (fix N).
  *
- * Called at 200 Hz nominal; diversity_update() self-rate-limits to 100 Hz or
- * 20 Hz depending on flight activity, so extra calls simply return early.
- * Pinned to Core 1 so any blocking RX5808_Set_Freq() call never touches Core 0
- * (LVGL).
+ * Sleeps until diversity_frame_cb() reports a frame due for a decision
+ * (at the mode's rate_min_hz .. rate_max_hz on the sample clock), so
+ * the decision follows the sample instead of the 10 ms tick.  Blocking on
+ * the notification always yields to IDLE1.  Pinned to Core 1, away from
+ * LVGL on Core 0; nothing in the loop waits for the PLL, since retunes are
+ * queued with RX5808_Tune_Async().
  */
 static void diversity_task_fn(void *param)
 {
     (void)param;
     while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DIVERSITY_WAKE_TIMEOUT_MS));
         diversity_update();
-        // Delay at least 1 full tick so IDLE1 gets CPU time.
-        // pdMS_TO_TICKS(5) rounds to 0 on a 100 Hz tick config, making
-        // vTaskDelay(0) a no-op that starves the idle task and triggers
-        // the task watchdog.  vTaskDelay(1) always blocks for 1 tick
-        // (~10 ms on 100 Hz), well within the 100 Hz / 20 Hz rate-limit
-        // that diversity_update() enforces internally.
-        vTaskDelay(1);
     }
 }
 
@@ -161,13 +491,14 @@ static void diversity_task_fn(void *param)
  * @brief Set diversity mode
  */
 void diversity_set_mode(diversity_mode_t mode) {
-    if (mode >= DIVERSITY_MODE_COUNT) {
+    if (!diversity_mode_available(mode)) {
         ESP_LOGW(TAG, "Invalid mode %d", mode);
         return;
     }
     
     g_diversity_state.mode = mode;
-    
+    g_shadow_reset_request = true;      // Shadow comparison restarts against the new mode
+
     // Save to NVS
     nvs_handle_t nvs_handle;
     if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
@@ -176,13 +507,94 @@ void diversity_set_mode(diversity_mode_t mode) {
         nvs_close(nvs_handle);
     }
     
-    ESP_LOGI(TAG, "Mode changed to: %s", diversity_mode_params[mode].name);
+    ESP_LOGI(TAG, "Mode changed to: %s", diversity_get_mode_params(mode)->name);
+}
+
+/**
+ * @brief Select the preemptive-switch predictor of a mode (not persisted)
+ */
+void diversity_set_predictor(diversity_mode_t mode, diversity_predictor_t predictor) {
+    if (mode >= DIVERSITY_MODE_COUNT || predictor >= DIVERSITY_PREDICT_COUNT) {
+        return;
+    }
+    g_predictor[mode] = predictor;
+    ESP_LOGI(TAG, "%s predictor: %s", diversity_get_mode_params(mode)->name,
+             predictor == DIVERSITY_PREDICT_KALMAN ? "fade estimator" : "slope");
+}
+
+diversity_predictor_t diversity_get_predictor(diversity_mode_t mode) {
+    return (mode < DIVERSITY_MODE_COUNT) ? g_predictor[mode] : DIVERSITY_PREDICT_SLOPE;
+}
+
+/**
+ * @brief Parameters of a built-in or custom mode.  An empty custom slot (or
+ *        an out-of-range mode) gets the Freestyle parameters.
+ */
+IRAM_ATTR const diversity_mode_params_t* diversity_get_mode_params(diversity_mode_t mode) {
+    if (mode < DIVERSITY_MODE_BUILTIN_COUNT) {
+        return &diversity_mode_params[mode];
+    }
+    int slot = (int)mode - DIVERSITY_MODE_BUILTIN_COUNT;
+    if (slot < g_custom_count) {
+        return &g_custom[slot].params;
+    }
+    return &diversity_mode_params[DIVERSITY_MODE_FREESTYLE];
+}
+
+/**
+ * @brief true for the built-in modes and the custom slots that hold a profile
+ */
+bool diversity_mode_available(diversity_mode_t mode) {
+    return (int)mode < DIVERSITY_MODE_BUILTIN_COUNT + g_custom_count;
+}
+
+/**
+ * @brief Next (dir > 0) or previous available mode, wrapping (UI selector)
+ */
+diversity_mode_t diversity_next_mode(diversity_mode_t mode, int dir) {
+    int n = DIVERSITY_MODE_BUILTIN_COUNT + g_custom_count;
+    int m = ((int)mode % n + (dir > 0 ? 1 : n - 1)) % n;
+    return (diversity_mode_t)m;
+}
+
+/**
+ * @brief Install custom profiles in RAM (slots CUSTOM_1..), replacing any
+ *        loaded ones.  Not persisted: see diversity_profiles_store().
+ *
+ * @return Profiles installed; invalid entries stop the list there
+ */
+int diversity_set_custom_profiles(const diversity_mode_params_t* params, int count) {
+    int n = 0;
+    if (count > DIVERSITY_CUSTOM_PROFILES) {
+        count = DIVERSITY_CUSTOM_PROFILES;
+    }
+    while (n < count && diversity_profile_valid(&params[n])) {
+        g_custom[n].params = params[n];
+        if (params[n].name != NULL) {
+            strncpy(g_custom[n].name, params[n].name, DIVERSITY_PROFILE_NAME_LEN - 1);
+            g_custom[n].name[DIVERSITY_PROFILE_NAME_LEN - 1] = '\0';
+        } else {
+            snprintf(g_custom[n].name, DIVERSITY_PROFILE_NAME_LEN, "C%d", n + 1);
+        }
+        g_custom[n].params.name = g_custom[n].name;
+        g_predictor[DIVERSITY_MODE_BUILTIN_COUNT + n] = params[n].predictor;
+        n++;
+    }
+    g_custom_count = n;
+    for (int m = DIVERSITY_MODE_BUILTIN_COUNT + n; m < DIVERSITY_MODE_COUNT; m++) {
+        g_predictor[m] = diversity_mode_params[DIVERSITY_MODE_FREESTYLE].predictor;
+    }
+    // A custom mode whose slot just emptied falls back to Freestyle
+    if (!diversity_mode_available(g_diversity_state.mode)) {
+        g_diversity_state.mode = DIVERSITY_MODE_FREESTYLE;
+    }
+    return n;
 }
 
 /**
  * @brief Normalize raw RSSI to 0-100 scale using calibration
  */
-uint8_t diversity_normalize_rssi(uint16_t raw, rssi_calibration_t* cal) {
+IRAM_ATTR uint8_t diversity_normalize_rssi(uint16_t raw, rssi_calibration_t* cal) {
     // Use uncalibrated mode if calibration not set or invalid (floor >= peak)
     if (!cal->calibrated || cal->floor_raw >= cal->peak_raw) {
         // Fallback to simple 12-bit to 0-100 mapping
@@ -201,57 +613,71 @@ uint8_t diversity_normalize_rssi(uint16_t raw, rssi_calibration_t* cal) {
 }
 
 /**
- * @brief Calculate statistics (mean, variance, slope) over rolling window
- *
- * @param rx          Per-receiver state to update
- * @param interval_ms Actual time elapsed since the previous sample (ms).
- *                    Used to express slope in ADC units/second so that the
- *                    threshold comparison in diversity_should_switch() is
- *                    rate-invariant (same meaning at 20 Hz and 100 Hz).
- */
-static void diversity_calculate_statistics(diversity_rx_state_t* rx, uint32_t interval_ms) {
-    if (rx->sample_count == 0) {
-        return;
-    }
-
-    // Calculate mean
-    uint32_t sum = 0;
-    for (uint8_t i = 0; i < rx->sample_count; i++) {
-        sum += rx->rssi_samples[i];
-    }
-    rx->rssi_mean = sum / rx->sample_count;
-
-    // Calculate variance
-    uint32_t variance_sum = 0;
-    for (uint8_t i = 0; i < rx->sample_count; i++) {
-        int32_t diff = (int32_t)rx->rssi_samples[i] - (int32_t)rx->rssi_mean;
-        variance_sum += (diff * diff);
+ * @brief Calibration of receiver @p rx at @p freq: the calibration map's,
+ *        interpolated into @p tmp, or the single-point @p single without one
+ *        (the map covers the first RSSI_CALMAP_RX receivers)
+ */
+static IRAM_ATTR rssi_calibration_t* diversity_cal_at(rssi_calibration_t* single, int rx, uint16_t freq,
+                                                      rssi_calibration_t* tmp) {
+    if (rx >= RSSI_CALMAP_RX || !rssi_calmap_lookup(g_calmap_live, rx, freq, &tmp->floor_raw, &tmp->peak_raw)) {
+        return single;
     }
-    rx->rssi_variance = (uint16_t)(variance_sum / rx->sample_count);
+    tmp->calibrated = true;
+    return tmp;
+}
 
-    // Point 2: time-normalised slope in ADC units/second.
-    // half_window_ms = number of samples in half the window × interval per sample.
-    // slope = Δrssi_mean / elapsed_time → same numeric meaning regardless of
-    // whether diversity_update() is running at 20 Hz or 100 Hz.
-    if (rx->sample_count >= 10) {
-        uint8_t half_window = rx->sample_count / 2;
-        uint8_t old_index = (rx->sample_index + DIVERSITY_MAX_SAMPLES - half_window) % DIVERSITY_MAX_SAMPLES;
+/**
+ * @brief Add a sample to the rolling window and refresh mean, variance and
+ *        slope.  O(1) whatever DIVERSITY_MAX_SAMPLES is (rssi_window.c).
+ *
+ * @param rx   Per-receiver state to update
+ * @param raw  New raw RSSI sample
+ * @param t_ms Frame time of the sample (ms).  The slope is taken over the
+ *             samples' own times, in ADC units/second, so the threshold
+ *             comparison in diversity_should_switch() means the same at any
+ *             evaluation rate, and across rate changes and early wake-ups.
+ */
+static IRAM_ATTR void diversity_calculate_statistics(diversity_rx_state_t* rx, uint16_t raw, uint32_t t_ms) {
+    rssi_window_push(&rx->window, raw, t_ms);
+
+    rx->rssi_mean = rssi_window_mean(&rx->window);
+    uint32_t variance = rssi_window_variance(&rx->window);
+    rx->rssi_variance = (variance > UINT16_MAX) ? UINT16_MAX : (uint16_t)variance;
+
+    // Point 2: time-normalised slope in ADC units/second — mean of the newest
+    // half minus mean of the oldest half over the time between them, so the
+    // value means the same at any evaluation rate and is negative on a fade.
+    int32_t slope = rssi_window_slope(&rx->window);
+    if (slope > INT16_MAX) slope = INT16_MAX;
+    if (slope < INT16_MIN) slope = INT16_MIN;
+    rx->rssi_slope = (int16_t)slope;
+}
 
-        uint32_t old_sum = 0;
-        for (uint8_t i = 0; i < half_window; i++) {
-            uint8_t idx = (old_index + i) % DIVERSITY_MAX_SAMPLES;
-            old_sum += rx->rssi_samples[idx];
-        }
-        uint16_t old_mean = (uint16_t)(old_sum / half_window);
+/**
+ * @brief Run the fade estimator on the new sample and refresh the
+ *        prediction, normalised and AGC-corrected like the score input
+ */
+static IRAM_ATTR void diversity_predict(diversity_rx_state_t* rx, rssi_calibration_t* cal,
+                                        const diversity_mode_params_t* params, uint32_t interval_ms) {
+    rssi_kalman_update(&rx->fade, rx->rssi_raw, interval_ms, params->kf_alpha, params->kf_beta);
+    int32_t predicted = diversity_normalize_rssi(rssi_kalman_predict(&rx->fade, params->predict_ms), cal);
+    predicted += rx->rssi_agc - rx->rssi_norm;
+    rx->rssi_predicted = (predicted < 0) ? 0 : (predicted > 100) ? 100 : (uint8_t)predicted;
+}
 
-        uint32_t half_window_ms = (uint32_t)half_window * interval_ms;
-        if (half_window_ms == 0) half_window_ms = 1; // guard against div/0 on first tick
-        // Multiply delta by 1000 to convert ms → seconds
-        rx->rssi_slope = (int16_t)(((int32_t)rx->rssi_mean - (int32_t)old_mean) * 1000
-                                   / (int32_t)half_window_ms);
-    } else {
-        rx->rssi_slope = 0;
+/**
+ * @brief Switches recorded within the last @p window_ms, advancing the
+ *        window's tail past the ones that have aged out
+ */
+static IRAM_ATTR uint32_t diversity_switch_window_count(uint32_t* tail, uint32_t now, uint32_t window_ms) {
+    if (g_switch_head - *tail > SWITCH_HISTORY_SIZE) {
+        *tail = g_switch_head - SWITCH_HISTORY_SIZE;    // Older entries were overwritten
     }
+    while (*tail != g_switch_head &&
+           now - g_switch_timestamps[*tail % SWITCH_HISTORY_SIZE] >= window_ms) {
+        (*tail)++;
+    }
+    return g_switch_head - *tail;
 }
 
 /**
@@ -259,7 +685,7 @@ static void diversity_calculate_statistics(diversity_rx_state_t* rx, uint32_t in
  *        Replaces sqrtf() in the hot scoring path — no FPU division, no libm.
  *        Converges in ≤8 iterations for any uint32_t input.
  */
-static uint32_t diversity_isqrt(uint32_t n) {
+static IRAM_ATTR uint32_t diversity_isqrt(uint32_t n) {
     if (n == 0) return 0;
     uint32_t x = n;
     uint32_t y = (x + 1) / 2;
@@ -271,21 +697,19 @@ static uint32_t diversity_isqrt(uint32_t n) {
 }
 
 /**
- * @brief Calculate stability score and combined score
+ * @brief Calculate stability score and combined score (integer only)
  */
-void diversity_calculate_scores(diversity_rx_state_t* rx, const diversity_mode_params_t* params) {
-    // Stability score: 100 - penalties for variance and slope
-    float k_variance = 0.2f;
-    // Point 2: slope is now in ADC units/second (range ~0-2000).
-    // k_slope scaled so max penalty stays similar to before (~75 pts).
-    float k_slope = 0.038f;
-
+IRAM_ATTR void diversity_calculate_scores(diversity_rx_state_t* rx, const diversity_mode_params_t* params) {
+    // Stability score: 100 - penalties for variance and slope.
+    // Point 2: slope is now in ADC units/second (range ~0-2000); k_slope
+    // scaled so max penalty stays similar to before (~75 pts).
     // Integer sqrt/abs replace sqrtf()/fabsf() — avoids libm on the hot path
-    float variance_penalty = k_variance * (float)diversity_isqrt((uint32_t)rx->rssi_variance);
-    int16_t slope_abs      = (rx->rssi_slope < 0) ? (int16_t)(-rx->rssi_slope) : rx->rssi_slope;
-    float slope_penalty    = k_slope    * (float)slope_abs;
+    uint32_t slope_abs = (rx->rssi_slope < 0) ? (uint32_t)(-(int32_t)rx->rssi_slope)
+                                              : (uint32_t)rx->rssi_slope;
+    uint32_t penalty_q16 = DIVERSITY_K_VARIANCE_Q16 * diversity_isqrt((uint32_t)rx->rssi_variance) +
+                           DIVERSITY_K_SLOPE_Q16 * slope_abs;
 
-    int16_t stability = 100 - (int16_t)(variance_penalty + slope_penalty);
+    int32_t stability = 100 - (int32_t)(penalty_q16 >> 16);
     if (stability < 0)   stability = 0;
     if (stability > 100) stability = 100;
     rx->stability_score = (uint8_t)stability;
@@ -293,15 +717,94 @@ void diversity_calculate_scores(diversity_rx_state_t* rx, const diversity_mode_p
     // Point 7: use AGC-corrected RSSI in scoring so hardware-offset receivers
     // are compared on a level field.  rssi_agc is populated in diversity_update()
     // before this function is called; it equals rssi_norm during AGC warmup.
-    float rssi_for_score = (float)rx->rssi_agc;
-
-    float score = (params->weight_rssi     * rssi_for_score) +
-                  (params->weight_stability * (float)rx->stability_score);
-    if (score > 100.0f) score = 100.0f;
-    if (score <   0.0f) score =   0.0f;
+    int32_t rssi_for_score = rx->rssi_agc;
+
+    // In multipath flutter the variance and slope are the fading itself,
+    // alike on every antenna: the mode's flutter weight applies, the rest
+    // going to RSSI so scores in different regimes stay comparable
+    int32_t weight_rssi      = params->weight_rssi;
+    int32_t weight_stability = params->weight_stability;
+    if (rx->fading == RSSI_FADING_FLUTTER) {
+        weight_rssi     += weight_stability - params->flutter_weight_stability;
+        weight_stability = params->flutter_weight_stability;
+    }
+    int32_t score = (weight_rssi * rssi_for_score + weight_stability * (int32_t)rx->stability_score) >> 15;
+    if (score > 100) score = 100;
+    if (score <   0) score =   0;
     rx->combined_score = (uint8_t)score;
 }
 
+/**
+ * @brief Point 7 software AGC for one receiver (integer only)
+ *
+ * @param stable true during stable flight: only then does the baseline move,
+ *               so mid-manoeuvre swings don't contaminate it
+ */
+static IRAM_ATTR void diversity_agc_update(diversity_rx_state_t* rx, bool stable) {
+    if (stable) {
+        // Slow EMA: α=0.001 → converges to true mean in ~1000 samples (~10 s @100 Hz)
+        int64_t diff = ((int64_t)rx->rssi_norm << 16) - rx->agc_baseline;
+        rx->agc_baseline += (int32_t)((diff * DIVERSITY_AGC_ALPHA_Q24 + (1 << 23)) >> 24);
+        if (rx->agc_sample_count < 60000) rx->agc_sample_count++;
+    }
+    // AGC-corrected RSSI: shift the receiver so its long-term mean sits at 50%.
+    // Capped at ±15 to prevent over-correction on hardware with large offsets.
+    // Correction activates after 100 stable samples (~warmup 1 s @100 Hz).
+    if (rx->agc_sample_count >= 100) {
+        // Division truncates toward zero, like the (int16_t) cast it replaces
+        int32_t corr = (DIVERSITY_AGC_TARGET * DIVERSITY_Q16_ONE - rx->agc_baseline) / DIVERSITY_Q16_ONE;
+        if (corr >  DIVERSITY_AGC_MAX_CORR) corr =  DIVERSITY_AGC_MAX_CORR;
+        if (corr < -DIVERSITY_AGC_MAX_CORR) corr = -DIVERSITY_AGC_MAX_CORR;
+        int32_t agc = (int32_t)rx->rssi_norm + corr;
+        rx->rssi_agc = (agc < 0) ? 0 : (agc > 100) ? 100 : (int16_t)agc;
+    } else {
+        rx->rssi_agc = (int16_t)rx->rssi_norm;
+    }
+}
+
+#ifdef CONFIG_DIVERSITY_SCORE_BENCHMARK
+/**
+ * @brief Boot-time cycle count of AGC + scoring.  Runs on a private state,
+ *        so the live one is untouched.  The float formulation it replaced
+ *        is the accuracy reference in sim/test_score.c.
+ */
+static void diversity_score_benchmark(void)
+{
+    const uint32_t n = 1000;
+    const diversity_mode_params_t* params = &diversity_mode_params[DIVERSITY_MODE_FREESTYLE];
+    diversity_rx_state_t rx;
+    memset(&rx, 0, sizeof(rx));
+    rx.agc_baseline     = DIVERSITY_AGC_TARGET * DIVERSITY_Q16_ONE;
+    rx.agc_sample_count = 100;
+    uint32_t cycles     = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        // Deterministic pseudo-trace covering the whole input range
+        rx.rssi_norm     = (uint8_t)((i * 37) % 101);
+        rx.rssi_variance = (uint16_t)((i * 211) % 4000);
+        rx.rssi_slope    = (int16_t)((int32_t)((i * 97) % 4001) - 2000);
+
+        uint32_t t0 = esp_cpu_get_cycle_count();
+        diversity_agc_update(&rx, true);
+        diversity_calculate_scores(&rx, params);
+        cycles += esp_cpu_get_cycle_count() - t0;
+    }
+    ESP_LOGI(TAG, "Score bench: %lu cycles per receiver update (n=%lu)",
+             (unsigned long)(cycles / n), (unsigned long)n);
+
+    // Fading bank as diversity_frame_cb() runs it, block ends included
+    rssi_fading_t bank;
+    rssi_fading_reset(&bank);
+    uint32_t t0 = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < 4 * RSSI_FADING_BLOCK; i++) {
+        rssi_fading_push(&bank, (uint16_t)(2000 + (i * 211) % 800));
+    }
+    uint32_t fading_cycles = esp_cpu_get_cycle_count() - t0;
+    ESP_LOGI(TAG, "Fading bench: %lu cycles per receiver per frame (%d bins)",
+             (unsigned long)(fading_cycles / (4 * RSSI_FADING_BLOCK)), RSSI_FADING_BINS);
+}
+#endif
+
 /**
  * @brief Check receiver health for stuck/failed conditions
  */
@@ -330,34 +833,64 @@ void diversity_check_receiver_health(diversity_rx_state_t* rx, uint32_t now) {
     }
     
     // No variance: variance near zero for >5s across multiple samples
-    if (rx->sample_count > 20 && rx->rssi_variance < 2) {
+    if (rx->window.count > 20 && rx->rssi_variance < 2) {
         rx->health.no_variance = true;
         ESP_LOGW(TAG, "Receiver health: no variance detected");
     }
 }
 
 /**
- * @brief Determine if conditions are right to switch receivers
+ * @brief Determine if conditions are right to switch receivers, and to which
+ *
+ * Best-of-N: the candidate is the healthy non-active receiver with the
+ * highest combined score (highest prediction, for the fade estimator's
+ * preemptive switch).  With two receivers it is simply the other one.
+ *
+ * @param target Set to the receiver to switch to when returning true
  */
-bool diversity_should_switch(diversity_state_t* state, const diversity_mode_params_t* params, uint32_t now) {
-    // Get pointers to active and other receiver
-    diversity_rx_state_t* active = (state->active_rx == DIVERSITY_RX_A) ? &state->rx_a : &state->rx_b;
-    diversity_rx_state_t* other = (state->active_rx == DIVERSITY_RX_A) ? &state->rx_b : &state->rx_a;
-    
-    // Don't switch if other receiver is unhealthy
-    if (other->health.disabled || other->health.stuck_low || other->health.no_variance) {
+IRAM_ATTR bool diversity_should_switch(diversity_state_t* state, const diversity_mode_params_t* params, uint32_t now,
+                                       diversity_rx_t* target) {
+    diversity_rx_state_t* active = &state->rx[state->active_rx];
+
+    // Best candidates; an unhealthy receiver is never switched to
+    int best = -1, best_predicted = -1;
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        const diversity_rx_state_t* rx = &state->rx[i];
+        if (i == (int)state->active_rx || rx->health.disabled || rx->health.stuck_low || rx->health.no_variance) {
+            continue;
+        }
+        if (best < 0 || rx->combined_score > state->rx[best].combined_score) {
+            best = i;
+        }
+        if (best_predicted < 0 || rx->rssi_predicted > state->rx[best_predicted].rssi_predicted) {
+            best_predicted = i;
+        }
+    }
+    if (best < 0) {
         return false;
     }
+    diversity_rx_state_t* other = &state->rx[best];
+    *target = (diversity_rx_t)best;
     
     // If active receiver is unhealthy, switch immediately
     if (active->health.disabled || active->health.stuck_low) {
-        ESP_LOGI(TAG, "Switching due to active receiver health issue");
+        DIVERSITY_LOG_LIVE(state, "Switching due to active receiver health issue");
         return true;
     }
     
     // Check dwell time
     uint32_t time_since_switch = now - state->last_switch_ms;
     uint32_t required_dwell = state->in_cooldown ? params->cooldown_ms : params->dwell_ms;
+    if (active->fading == RSSI_FADING_FLUTTER) {
+        // Notches come and go within the normal dwell: follow them, but
+        // never wait longer than outside flutter
+        uint32_t floor_ms = (required_dwell < DIVERSITY_FLUTTER_DWELL_MIN_MS) ? required_dwell
+                                                                             : DIVERSITY_FLUTTER_DWELL_MIN_MS;
+        required_dwell = required_dwell * params->flutter_dwell_pct / 100;
+        if (required_dwell < floor_ms) {
+            required_dwell = floor_ms;
+        }
+    }
     
     if (time_since_switch < required_dwell) {
         return false; // Still in dwell/cooldown period
@@ -371,23 +904,53 @@ bool diversity_should_switch(diversity_state_t* state, const diversity_mode_para
     
     // Switch only if other receiver is significantly better
     if (other->combined_score > (active->combined_score + hysteresis)) {
-        ESP_LOGI(TAG, "Switch: other=%d active=%d (delta=%d, threshold=%d)",
-                 other->combined_score, active->combined_score,
-                 other->combined_score - active->combined_score, hysteresis);
+        DIVERSITY_LOG_LIVE(state, "Switch: other=%d active=%d (delta=%d, threshold=%d)",
+                           other->combined_score, active->combined_score,
+                           other->combined_score - active->combined_score, hysteresis);
         return true;
     }
     
-    // Preemptive switching: if active receiver is dropping fast
-    if (active->rssi_slope < params->slope_threshold && 
-        other->combined_score > active->combined_score) {
-        ESP_LOGI(TAG, "Preemptive switch: slope=%d (threshold=%d)",
-                 active->rssi_slope, params->slope_threshold);
+    // Preemptive switching: leave the active receiver before it falls below the other
+    if (g_predictor[state->mode] == DIVERSITY_PREDICT_KALMAN) {
+        // Fade estimator: active is falling and predicted below the other
+        // predict_ms from now
+        const diversity_rx_state_t* ahead = &state->rx[best_predicted];
+        if (rssi_kalman_velocity(&active->fade) < 0 &&
+            ahead->rssi_predicted > active->rssi_predicted + hysteresis) {
+            DIVERSITY_LOG_LIVE(state, "Predictive switch: %d ms ahead other=%d active=%d",
+                               params->predict_ms, ahead->rssi_predicted, active->rssi_predicted);
+            *target = (diversity_rx_t)best_predicted;
+            return true;
+        }
+    } else if (active->rssi_slope < params->slope_threshold &&
+               other->combined_score > active->combined_score) {
+        // Active receiver is dropping fast
+        DIVERSITY_LOG_LIVE(state, "Preemptive switch: slope=%d (threshold=%d)",
+                           active->rssi_slope, params->slope_threshold);
         return true;
     }
     
     return false;
 }
 
+/**
+ * @brief Switching-state side of a switch (live and shadow): select
+ *        @p target, start the cooldown and arm the point 9 outcome check
+ */
+static IRAM_ATTR void diversity_switch_state(diversity_state_t* state, diversity_rx_t target, uint32_t now) {
+    state->active_rx = target;
+
+    state->last_switch_ms = now;
+    state->switch_count++;
+    state->time_stable_ms = 0;
+    state->in_cooldown = true;
+
+    // Point 9: record state for outcome evaluation 200 ms from now
+    state->outcome_check_ms       = now + 200;
+    state->outcome_new_rx         = target;
+    state->outcome_rssi_at_switch = state->rx[target].rssi_norm;
+}
+
 /**
  * @brief Perform receiver switch
  *
@@ -395,89 +958,346 @@ bool diversity_should_switch(diversity_state_t* state, const diversity_mode_para
  * Old sequence (A→B): SWITCH0=1 (both=1!), then SWITCH1=0
  * New sequence:       both=0 first (~150 ns gap, invisible at 50 Hz field rate),
  *                     then assert the new selection.
+ * The RF service (rx5808.c) owns the switch lines and runs the sequence; the
+ * selection is posted with RX5808_Set_Antenna(), which wakes it (it runs
+ * above this task, so the switch happens before this function returns).
  *
- * Marked IRAM_ATTR so the function always resides in IRAM and can be called
- * from a future ISR context without a cache-miss stall.
+ * In IRAM with the rest of the decide-and-switch path; the switch is
+ * logged afterwards, by diversity_update_tail().
  */
-static IRAM_ATTR void diversity_perform_switch(diversity_state_t* state) {
+static IRAM_ATTR void diversity_perform_switch(diversity_state_t* state, diversity_rx_t target) {
     uint32_t now = esp_timer_get_time() / 1000; // ms
 
-    // Toggle active receiver
-    state->active_rx = (state->active_rx == DIVERSITY_RX_A) ? DIVERSITY_RX_B : DIVERSITY_RX_A;
-
-    // Update switch tracking
-    state->last_switch_ms = now;
-    state->switch_count++;
-    state->time_stable_ms = 0;
-    state->in_cooldown = true;
+    diversity_switch_state(state, target, now);
 
     // Record switch timestamp for rate calculation
-    g_switch_timestamps[g_switch_history_index] = now;
-    g_switch_history_index = (g_switch_history_index + 1) % SWITCH_HISTORY_SIZE;
-
-    // Point 1: de-assert both lines first, then assert the chosen side.
-    // This eliminates the brief "both active" glitch of the old direct assignment.
-    gpio_set_level(RX5808_SWITCH0, 0);
-    gpio_set_level(RX5808_SWITCH1, 0);
-    if (state->active_rx == DIVERSITY_RX_A) {
-        gpio_set_level(RX5808_SWITCH1, 1); // RX_A: SWITCH1=1, SWITCH0=0
-    } else {
-        gpio_set_level(RX5808_SWITCH0, 1); // RX_B: SWITCH0=1, SWITCH1=0
+    g_switch_timestamps[g_switch_head % SWITCH_HISTORY_SIZE] = now;
+    g_switch_head++;
+
+    // Point 1: the RF service owns the switch GPIOs and applies the
+    // break-before-make sequence (both low, then the chosen side).
+    // N-way mapping: receiver n is switch selection RX5808_ANTENNA_A + n.
+    RX5808_Set_Antenna((rx5808_antenna_t)(RX5808_ANTENNA_A + state->active_rx));
+}
+
+/**
+ * @brief Point 9: 200 ms after a switch, give the new receiver a score
+ *        bonus if it actually improved; expire and apply the bonuses
+ */
+static IRAM_ATTR void diversity_outcome_update(diversity_state_t* state, uint32_t now) {
+    // Outcome check: 200 ms after a switch see if the new receiver actually improved.
+    if (state->outcome_check_ms != 0 && now >= state->outcome_check_ms) {
+        const diversity_rx_t new_rx = state->outcome_new_rx;
+        // "Improved" = rssi_norm at least 5% higher than it was at the switch moment
+        if ((int16_t)state->rx[new_rx].rssi_norm > (int16_t)state->outcome_rssi_at_switch + 5) {
+            state->pref_bonus[new_rx]       = DIVERSITY_PREF_BONUS;
+            state->bonus_expires_ms[new_rx] = now + 5000;
+            DIVERSITY_LOG_LIVE(state, "RX_%c confirmed good — preference bonus applied", 'A' + new_rx);
+        }
+        state->outcome_check_ms = 0;
     }
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        // Expire bonuses
+        if (state->bonus_expires_ms[i] && now >= state->bonus_expires_ms[i]) {
+            state->pref_bonus[i] = 0; state->bonus_expires_ms[i] = 0;
+        }
+        // Apply preference bonus to combined score (capped at 100)
+        if (state->pref_bonus[i] > 0) {
+            uint16_t sc = (uint16_t)state->rx[i].combined_score + state->pref_bonus[i];
+            state->rx[i].combined_score = (sc > 100) ? 100 : (uint8_t)sc;
+        }
+    }
+}
 
-    // Point 9: record state for outcome evaluation 200 ms from now
-    const diversity_rx_state_t* new_rx = (state->active_rx == DIVERSITY_RX_A)
-                                         ? &state->rx_a : &state->rx_b;
-    state->outcome_check_ms       = now + 200;
-    state->outcome_new_rx         = state->active_rx;
-    state->outcome_rssi_at_switch = new_rx->rssi_norm;
+// ============================================================================
+// Shadow evaluation: other modes decide on the live samples, and every
+// decision (live included) is judged DIVERSITY_SHADOW_JUDGE_MS later
+// ============================================================================
 
-    ESP_LOGI(TAG, "Switched to RX_%c (switches=%lu)",
-             state->active_rx == DIVERSITY_RX_A ? 'A' : 'B',
-             state->switch_count);
+/**
+ * @brief One decision of a shadow on the sample the live state just
+ *        processed.  Same pipeline as diversity_update() from the AGC on,
+ *        without the frequency shift, GPIO, LED or logging.
+ */
+static IRAM_ATTR void diversity_shadow_step(diversity_state_t* s, const diversity_state_t* live,
+                                            rssi_calibration_t* const cal[DIVERSITY_NUM_RX],
+                                            uint32_t interval_ms, uint32_t now) {
+    const diversity_mode_params_t* params = diversity_get_mode_params(s->mode);
+    bool stable = s->time_stable_ms > 2000;
+
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        diversity_rx_state_t* rx        = &s->rx[i];
+        const diversity_rx_state_t* lrx = &live->rx[i];
+        rx->rssi_raw      = lrx->rssi_raw;
+        rx->rssi_norm     = lrx->rssi_norm;
+        rx->rssi_mean     = lrx->rssi_mean;
+        rx->rssi_variance = lrx->rssi_variance;
+        rx->rssi_slope    = lrx->rssi_slope;
+        rx->fading        = lrx->fading;
+        rx->health        = lrx->health;
+        diversity_agc_update(rx, stable);
+        diversity_predict(rx, cal[i], params, interval_ms);
+        diversity_calculate_scores(rx, params);
+    }
+    diversity_outcome_update(s, now);
+
+    s->time_stable_ms = now - s->last_switch_ms;
+    if (s->in_cooldown && (now - s->last_switch_ms) > params->cooldown_ms) {
+        s->in_cooldown = false;
+    }
+    diversity_rx_t target;
+    if (diversity_should_switch(s, params, now, &target)) {
+        diversity_switch_state(s, target, now);
+    }
+}
+
+/**
+ * @brief Apply the requests posted by diversity_shadow_set()/reset().  A new
+ *        shadow starts as a copy of the live state (its estimators warm, on
+ *        the live receiver), and any change restarts the comparison.
+ */
+static void diversity_shadow_apply_requests(const diversity_state_t* live) {
+    bool reset = g_shadow_reset_request;
+    g_shadow_reset_request = false;
+    for (int i = 0; i < DIVERSITY_SHADOW_MAX; i++) {
+        uint8_t req = g_shadow_request[i];
+        if (req == SHADOW_REQ_NONE) {
+            continue;
+        }
+        g_shadow_request[i] = SHADOW_REQ_NONE;
+        if (req < DIVERSITY_MODE_COUNT && diversity_mode_available((diversity_mode_t)req)) {
+            g_shadow[i].state = *live;          // Window pointers are copied too, but never pushed
+            g_shadow[i].state.mode = (diversity_mode_t)req;
+            g_shadow[i].enabled = true;
+        } else {
+            g_shadow[i].enabled = false;
+        }
+        reset = true;
+    }
+    if (reset) {
+        memset(g_shadow_stats, 0, sizeof(g_shadow_stats));
+        g_shadow_pending_head = g_shadow_pending_tail = 0;
+        g_shadow_start_ms = 0;
+    }
 }
 
+/**
+ * @brief Shadow decisions and judgement for the sample at @p t_ms, after the
+ *        live decision.  No-op (one loop over the slots) without shadows.
+ */
+static void diversity_shadow_update(const diversity_state_t* live, bool live_switched,
+                                    rssi_calibration_t* const cal[DIVERSITY_NUM_RX],
+                                    uint32_t interval_ms, uint32_t now, uint32_t t_ms) {
+    diversity_shadow_apply_requests(live);
+
+    bool any = false;
+    for (int i = 0; i < DIVERSITY_SHADOW_MAX; i++) {
+        any = any || g_shadow[i].enabled;
+    }
+    if (!any) {
+        return;
+    }
+    if (g_shadow_start_ms == 0) {
+        g_shadow_start_ms = t_ms;
+    }
+
+    // Judge the decisions old enough against this sample: the winner is the
+    // receiver ahead of all others by more than the tie margin, if any
+    int winner = 0, runner_up = -1;
+    for (int i = 1; i < DIVERSITY_NUM_RX; i++) {
+        if (live->rx[i].rssi_norm > live->rx[winner].rssi_norm) {
+            runner_up = winner;
+            winner = i;
+        } else if (runner_up < 0 || live->rx[i].rssi_norm > live->rx[runner_up].rssi_norm) {
+            runner_up = i;
+        }
+    }
+    if (live->rx[winner].rssi_norm <= live->rx[runner_up].rssi_norm + DIVERSITY_SHADOW_TIE) {
+        winner = -1;
+    }
+    while (g_shadow_pending_tail != g_shadow_pending_head) {
+        const uint32_t slot = g_shadow_pending_tail % SHADOW_PENDING_SIZE;
+        if (t_ms - g_shadow_pending[slot].t_ms < DIVERSITY_SHADOW_JUDGE_MS) {
+            break;
+        }
+        if (winner >= 0) {
+            for (int i = 0; i <= DIVERSITY_SHADOW_MAX; i++) {
+                g_shadow_stats[i].judged++;
+                g_shadow_stats[i].right += g_shadow_pending[slot].rx[i] == (uint8_t)winner;
+            }
+        }
+        g_shadow_pending_tail++;
+    }
+
+    // This sample's decisions
+    const uint32_t slot = g_shadow_pending_head % SHADOW_PENDING_SIZE;
+    g_shadow_pending[slot].t_ms  = t_ms;
+    g_shadow_pending[slot].rx[0] = (uint8_t)live->active_rx;
+    g_shadow_stats[0].mode     = live->mode;
+    g_shadow_stats[0].enabled  = true;
+    g_shadow_stats[0].switches += live_switched;
+    for (int i = 0; i < DIVERSITY_SHADOW_MAX; i++) {
+        diversity_shadow_stats_t* st = &g_shadow_stats[1 + i];
+        diversity_state_t* s = &g_shadow[i].state;
+        st->enabled = g_shadow[i].enabled;
+        if (!st->enabled) {
+            continue;
+        }
+        uint32_t before = s->switch_count;
+        diversity_shadow_step(s, live, cal, interval_ms, now);
+        st->mode      = s->mode;
+        st->switches += s->switch_count - before;
+        g_shadow_pending[slot].rx[1 + i] = (uint8_t)s->active_rx;
+    }
+    if (g_shadow_pending_head - g_shadow_pending_tail == SHADOW_PENDING_SIZE) {
+        g_shadow_pending_tail++;                // Full (frames under 1 ms apart): drop the oldest
+    }
+    g_shadow_pending_head++;
+    for (int i = 0; i <= DIVERSITY_SHADOW_MAX; i++) {
+        g_shadow_stats[i].elapsed_ms = t_ms - g_shadow_start_ms;
+    }
+}
+
+/**
+ * @brief Run @p mode in shadow in @p slot (0..DIVERSITY_SHADOW_MAX-1), or
+ *        disable the slot with DIVERSITY_MODE_COUNT.  Applied, and all
+ *        counters reset, at the next decision.
+ */
+void diversity_shadow_set(int slot, diversity_mode_t mode) {
+    if (slot < 0 || slot >= DIVERSITY_SHADOW_MAX) {
+        return;
+    }
+    g_shadow_request[slot] = (uint8_t)((mode < DIVERSITY_MODE_COUNT) ? mode : DIVERSITY_MODE_COUNT);
+}
+
+/**
+ * @brief Restart the comparison (counters of the live state and every shadow)
+ */
+void diversity_shadow_reset(void) {
+    g_shadow_reset_request = true;
+}
+
+/**
+ * @brief Counters of the live state ([0]) and each shadow slot ([1 + slot])
+ */
+void diversity_shadow_get_stats(diversity_shadow_stats_t out[1 + DIVERSITY_SHADOW_MAX]) {
+    memcpy(out, g_shadow_stats, sizeof(g_shadow_stats));
+}
+
+#ifdef CONFIG_DIVERSITY_SHADOW
+static void diversity_shadow_log(void)
+{
+    char line[(1 + DIVERSITY_SHADOW_MAX) * (DIVERSITY_PROFILE_NAME_LEN + 32) + 1];
+    int len = 0;
+    for (int i = 0; i <= DIVERSITY_SHADOW_MAX; i++) {
+        const diversity_shadow_stats_t* st = &g_shadow_stats[i];
+        if (!st->enabled) {
+            continue;
+        }
+        uint32_t pct10 = st->judged ? (uint32_t)((uint64_t)st->right * 1000 / st->judged) : 0;
+        len += snprintf(line + len, sizeof(line) - len, "%s %s %lu.%lu%% %lu sw",
+                        len ? " |" : "", diversity_get_mode_params(st->mode)->name,
+                        (unsigned long)(pct10 / 10), (unsigned long)(pct10 % 10),
+                        (unsigned long)st->switches);
+        if (i == 0) {
+            len += snprintf(line + len, sizeof(line) - len, " (live)");
+        }
+    }
+    ESP_LOGI(TAG, "Shadow %lu s, right @%d ms:%s", (unsigned long)(g_shadow_stats[0].elapsed_ms / 1000),
+             DIVERSITY_SHADOW_JUDGE_MS, line);
+}
+#endif
+
 // ============================================================================
 // Point 8: Interference rejection via micro-frequency offset
 // When the active receiver RSSI is weak AND declining, the system trials a
 // ±1 MHz shift on both chips.  If the shift improves RSSI by at least
-// FREQ_SHIFT_IMPROVE_MIN within FREQ_SHIFT_EVAL_MS it is held for
+// FREQ_SHIFT_IMPROVE_MIN over a FREQ_SHIFT_EVAL_MS window it is held for
 // FREQ_SHIFT_HOLD_MS seconds, after which the nominal frequency is restored.
 // Both directions are tried before giving up (cooldown FREQ_SHIFT_COOLDOWN_MS).
-// RX5808_Set_Freq() programs both RX chips simultaneously and already blocks
-// ~50 ms for PLL settling, so no extra delay is required here.
+// Retunes go through RX5808_Tune_Async(), so the diversity loop keeps
+// running while the PLL settles; the evaluation window starts at the settle
+// time the RF service measured, and frames taken before it never reach the
+// statistics (see diversity_update()).
 // ============================================================================
 #define FREQ_SHIFT_TRIGGER_RSSI    22   // Trigger only when active rssi_norm < this
 #define FREQ_SHIFT_TRIGGER_SLOPE (-80)  // Trigger only when rssi_slope < this (ADC-units/s)
 #define FREQ_SHIFT_DWELL_MIN_MS   1500  // Must be on current receiver for this long before shifting
-#define FREQ_SHIFT_EVAL_MS         300  // Evidence-collection window after the shift (ms)
+#define FREQ_SHIFT_EVAL_MS         300  // Evidence-collection window after the PLL settled (ms)
 #define FREQ_SHIFT_HOLD_MS       30000  // Hold a successful shift for 30 s
 #define FREQ_SHIFT_COOLDOWN_MS   30000  // Minimum gap between shift attempts (ms)
 #define FREQ_SHIFT_IMPROVE_MIN       5  // rssi_norm must improve by at least this to accept
 
+/**
+ * @brief Issue a point 8 retune without waiting for the PLL and restart the
+ *        evaluation window (it opens once the tune has settled)
+ * @return false if the tune was refused (ELRS backpack owns the bus)
+ */
+static bool diversity_freq_shift_tune(diversity_state_t* state, uint16_t freq)
+{
+    state->freq_shift_settled_us = 0;
+    state->freq_shift_sum        = 0;
+    state->freq_shift_samples    = 0;
+    return RX5808_Tune_Async(freq, NULL);
+}
+
+/**
+ * @brief Collect one frame of evidence for the trial offset
+ * @param settling  true if the frame was taken before the retune settled
+ * @param sample_us Timestamp of the frame
+ * @return true once the window after the measured settle time is complete;
+ *         freq_shift_sum / freq_shift_samples then hold its evidence
+ */
+static bool diversity_freq_shift_collect(diversity_state_t* state, bool settling, int64_t sample_us)
+{
+    if (settling) {
+        return false;
+    }
+    if (state->freq_shift_settled_us == 0) {
+        state->freq_shift_settled_us  = RX5808_Get_Settled_Time_Us();
+        state->freq_shift_eval_end_ms = (uint32_t)(state->freq_shift_settled_us / 1000) + FREQ_SHIFT_EVAL_MS;
+    }
+    state->freq_shift_sum += state->rx[state->active_rx].rssi_norm;
+    state->freq_shift_samples++;
+    return (uint32_t)(sample_us / 1000) >= state->freq_shift_eval_end_ms;
+}
+
+/**
+ * @brief Revert to the nominal channel and cool down for @p cooldown_ms
+ */
+static void diversity_freq_shift_revert(diversity_state_t* state, uint32_t now, uint32_t cooldown_ms)
+{
+    diversity_freq_shift_tune(state, state->freq_shift_nominal);
+    state->freq_shift_offset      = 0;
+    state->freq_shift_cooldown_ms = now + cooldown_ms;
+    state->freq_shift_state       = FREQ_SHIFT_IDLE;
+}
+
 /**
  * @brief Point 8 FSM: non-blocking micro-frequency-offset interference rejector.
  *
  * Must be called every diversity update cycle *after* statistics and scoring
- * have been refreshed.  The function may call RX5808_Set_Freq() which blocks
- * ~50 ms (PLL settle), mirroring the latency already accepted during normal
- * channel changes.
+ * have been refreshed.  Trial retunes are asynchronous: the FSM waits in its
+ * EVAL state for the PLL to settle, then averages the active receiver over
+ * FREQ_SHIFT_EVAL_MS of post-settle frames before judging the offset.
  *
  * Guard conditions prevent activation during calibration, switch cooldown,
  * or when the user has changed band/channel externally.
+ *
+ * @param settling  true if this frame was taken before the last retune settled
+ * @param sample_us Timestamp of this frame
  */
-static void diversity_freq_shift_update(diversity_state_t* state, uint32_t now)
+static void diversity_freq_shift_update(diversity_state_t* state, uint32_t now, bool settling, int64_t sample_us)
 {
-    const diversity_rx_state_t* arx = (state->active_rx == DIVERSITY_RX_A)
-                                      ? &state->rx_a : &state->rx_b;
+    const diversity_rx_state_t* arx = &state->rx[state->active_rx];
 
     /* ----------------------------------------------------------------
      * External channel-change detection.
      * RX5808_Get_Current_Freq() reads from the band-table (the nominal
      * channel the user selected), never from expected_frequency.  So if
      * the user changed channel while we held a shift, the nominal will
-     * differ from freq_shift_nominal.  Silently reset; RX5808_Set_Freq
-     * was already called externally with the new nominal, so PLL is OK.
+     * differ from freq_shift_nominal.  Silently reset; the new nominal
+     * was already tuned externally, and that tune supersedes ours.
      * ---------------------------------------------------------------- */
     if (state->freq_shift_state != FREQ_SHIFT_IDLE) {
         uint16_t current_nominal = RX5808_Get_Current_Freq();
@@ -497,6 +1317,7 @@ static void diversity_freq_shift_update(diversity_state_t* state, uint32_t now)
     case FREQ_SHIFT_IDLE:
         // Gate conditions
         if (now < state->freq_shift_cooldown_ms)                   break;
+        if (settling)                                               break;
         if (state->in_cooldown)                                     break;
         if (state->time_stable_ms < FREQ_SHIFT_DWELL_MIN_MS)       break;
         if (arx->rssi_norm  >= FREQ_SHIFT_TRIGGER_RSSI)            break;
@@ -505,73 +1326,57 @@ static void diversity_freq_shift_update(diversity_state_t* state, uint32_t now)
         // Snapshot nominal and baseline RSSI
         state->freq_shift_nominal  = RX5808_Get_Current_Freq();
         state->freq_shift_baseline = arx->rssi_norm;
-        state->freq_shift_offset   = +1;
         ESP_LOGI(TAG, "Point8: rssi=%d slope=%d → trying +1 MHz (%d→%d)",
                  arx->rssi_norm, arx->rssi_slope,
                  state->freq_shift_nominal, state->freq_shift_nominal + 1);
-        RX5808_Set_Freq((uint16_t)(state->freq_shift_nominal + 1));
-        state->freq_shift_eval_end_ms = now + FREQ_SHIFT_EVAL_MS;
-        state->freq_shift_state       = FREQ_SHIFT_EVAL_PLUS;
+        if (!diversity_freq_shift_tune(state, (uint16_t)(state->freq_shift_nominal + 1))) {
+            state->freq_shift_cooldown_ms = now + FREQ_SHIFT_COOLDOWN_MS;
+            break;
+        }
+        state->freq_shift_offset = +1;
+        state->freq_shift_state  = FREQ_SHIFT_EVAL_PLUS;
         break;
 
     /* -------------------------------------------------------------- */
     case FREQ_SHIFT_EVAL_PLUS:
-        if (now < state->freq_shift_eval_end_ms) break;
-
-        if ((int16_t)arx->rssi_norm >=
-            (int16_t)state->freq_shift_baseline + FREQ_SHIFT_IMPROVE_MIN) {
-            // +1 MHz improved reception — hold it
-            ESP_LOGI(TAG, "Point8: +1 MHz accepted (rssi %d→%d), holding %d s",
-                     state->freq_shift_baseline, arx->rssi_norm,
+    case FREQ_SHIFT_EVAL_MINUS: {
+        if (!diversity_freq_shift_collect(state, settling, sample_us)) break;
+
+        uint32_t mean = state->freq_shift_sum / state->freq_shift_samples;
+        if (mean >= (uint32_t)state->freq_shift_baseline + FREQ_SHIFT_IMPROVE_MIN) {
+            // The offset improved reception — hold it
+            ESP_LOGI(TAG, "Point8: %+d MHz accepted (rssi %d→%lu), holding %d s",
+                     state->freq_shift_offset, state->freq_shift_baseline, (unsigned long)mean,
                      FREQ_SHIFT_HOLD_MS / 1000);
             state->freq_shift_hold_end_ms = now + FREQ_SHIFT_HOLD_MS;
             state->freq_shift_state       = FREQ_SHIFT_HOLD;
-        } else {
+        } else if (state->freq_shift_state == FREQ_SHIFT_EVAL_PLUS) {
             // +1 didn't help — try -1 MHz
-            // Hardware is currently at nominal+1; target is nominal-1 = (nominal+1) - 2
-            state->freq_shift_offset = -1;
             ESP_LOGI(TAG, "Point8: +1 no help → trying -1 MHz (%d)",
                      state->freq_shift_nominal - 1);
-            RX5808_Set_Freq((uint16_t)(state->freq_shift_nominal - 1));
-            state->freq_shift_eval_end_ms = now + FREQ_SHIFT_EVAL_MS;
-            state->freq_shift_state       = FREQ_SHIFT_EVAL_MINUS;
-        }
-        break;
-
-    /* -------------------------------------------------------------- */
-    case FREQ_SHIFT_EVAL_MINUS:
-        if (now < state->freq_shift_eval_end_ms) break;
-
-        if ((int16_t)arx->rssi_norm >=
-            (int16_t)state->freq_shift_baseline + FREQ_SHIFT_IMPROVE_MIN) {
-            // -1 MHz improved reception — hold it
-            ESP_LOGI(TAG, "Point8: -1 MHz accepted (rssi %d→%d), holding %d s",
-                     state->freq_shift_baseline, arx->rssi_norm,
-                     FREQ_SHIFT_HOLD_MS / 1000);
-            state->freq_shift_hold_end_ms = now + FREQ_SHIFT_HOLD_MS;
-            state->freq_shift_state       = FREQ_SHIFT_HOLD;
+            if (!diversity_freq_shift_tune(state, (uint16_t)(state->freq_shift_nominal - 1))) {
+                diversity_freq_shift_revert(state, now, FREQ_SHIFT_COOLDOWN_MS);
+                break;
+            }
+            state->freq_shift_offset = -1;
+            state->freq_shift_state  = FREQ_SHIFT_EVAL_MINUS;
         } else {
             // Neither ±1 MHz helped — revert to nominal and cool down
             ESP_LOGI(TAG, "Point8: neither offset helped → reverting to %d MHz",
                      state->freq_shift_nominal);
-            RX5808_Set_Freq(state->freq_shift_nominal);
-            state->freq_shift_offset      = 0;
-            state->freq_shift_cooldown_ms = now + FREQ_SHIFT_COOLDOWN_MS;
-            state->freq_shift_state       = FREQ_SHIFT_IDLE;
+            diversity_freq_shift_revert(state, now, FREQ_SHIFT_COOLDOWN_MS);
         }
         break;
+    }
 
     /* -------------------------------------------------------------- */
     case FREQ_SHIFT_HOLD:
         if (now >= state->freq_shift_hold_end_ms) {
-            // Hold period expired — quietly revert to nominal
+            // Hold period expired — quietly revert to nominal.
+            // Short cooldown after natural expiry — allows re-trial sooner
             ESP_LOGI(TAG, "Point8: hold expired → reverting to %d MHz",
                      state->freq_shift_nominal);
-            RX5808_Set_Freq(state->freq_shift_nominal);
-            state->freq_shift_offset      = 0;
-            // Short cooldown after natural expiry — allows re-trial sooner
-            state->freq_shift_cooldown_ms = now + (FREQ_SHIFT_COOLDOWN_MS / 3);
-            state->freq_shift_state       = FREQ_SHIFT_IDLE;
+            diversity_freq_shift_revert(state, now, FREQ_SHIFT_COOLDOWN_MS / 3);
         }
         break;
 
@@ -582,165 +1387,187 @@ static void diversity_freq_shift_update(diversity_state_t* state, uint32_t now)
 }
 
 /**
- * @brief Main diversity update function - call at DIVERSITY_SAMPLE_RATE_HZ
- * Implements adaptive sampling: 100Hz (10ms) during active switching, 20Hz (50ms) when stable
+ * @brief Link volatility, Q16: 0 on a steady link, DIVERSITY_Q16_ONE asks
+ *        for the maximum rate.  The largest of each enabled receiver's
+ *        |slope| and variance above the noise, and of the recent switch
+ *        rate (2 switches/s is full).
  */
-void diversity_update(void) {
+static IRAM_ATTR uint32_t diversity_rate_demand(const diversity_state_t* state)
+{
+    uint32_t demand = state->switches_per_second / 2;
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        const diversity_rx_state_t* rx = &state->rx[i];
+        if (rx->health.disabled) {
+            continue;
+        }
+        uint32_t slope = (rx->rssi_slope < 0) ? -(int32_t)rx->rssi_slope : rx->rssi_slope;
+        uint32_t d = slope * DIVERSITY_Q16_ONE / DIVERSITY_RATE_SLOPE_FULL;
+        if (d > demand) {
+            demand = d;
+        }
+        if (rx->rssi_variance > DIVERSITY_RATE_VAR_FLOOR) {
+            d = (uint32_t)(((uint64_t)(rx->rssi_variance - DIVERSITY_RATE_VAR_FLOOR) << 16) /
+                           (DIVERSITY_RATE_VAR_FULL - DIVERSITY_RATE_VAR_FLOOR));
+            if (d > demand) {
+                demand = d;
+            }
+        }
+    }
+    return (demand > DIVERSITY_Q16_ONE) ? DIVERSITY_Q16_ONE : demand;
+}
+
+/**
+ * @brief Move the evaluation rate to the one the link volatility asks for,
+ *        between the mode's rate_min_hz and rate_max_hz: at once when that
+ *        is higher, decaying with time constant DIVERSITY_RATE_DECAY_MS
+ *        when it is lower
+ * @param interval_ms Time since the previous evaluation
+ */
+static IRAM_ATTR void diversity_rate_update(diversity_state_t* state, const diversity_mode_params_t* params,
+                                            uint32_t interval_ms)
+{
+    uint32_t min_q16 = (uint32_t)params->rate_min_hz << 16;
+    uint32_t max_q16 = (uint32_t)params->rate_max_hz << 16;
+    uint32_t target  = min_q16 + (uint32_t)(((uint64_t)(max_q16 - min_q16) * diversity_rate_demand(state)) >> 16);
+    if (target >= state->rate_q16) {
+        state->rate_q16 = target;
+    } else {
+        uint32_t dt = (interval_ms < DIVERSITY_RATE_DECAY_MS) ? interval_ms : DIVERSITY_RATE_DECAY_MS;
+        state->rate_q16 -= (uint32_t)((uint64_t)(state->rate_q16 - target) * dt / DIVERSITY_RATE_DECAY_MS);
+    }
+}
+
+/**
+ * @brief Interval (us) between evaluations at the current rate, clamped to
+ *        the mode's range (the mode may have changed since the last update)
+ */
+static IRAM_ATTR uint32_t diversity_rate_interval_us(diversity_state_t* state, const diversity_mode_params_t* params)
+{
+    uint32_t min_q16 = (uint32_t)params->rate_min_hz << 16;
+    uint32_t max_q16 = (uint32_t)params->rate_max_hz << 16;
+    if (state->rate_q16 < min_q16) {
+        state->rate_q16 = min_q16;
+    } else if (state->rate_q16 > max_q16) {
+        state->rate_q16 = max_q16;
+    }
+    return (uint32_t)((1000000ULL << 16) / state->rate_q16);
+}
+
+static void diversity_update_tail(diversity_state_t* state, bool settling, bool switched,
+                                  rssi_calibration_t* const cal[DIVERSITY_NUM_RX],
+                                  uint32_t interval_ms, uint32_t now, int64_t sample_us);
+
+/**
+ * @brief Main diversity update function, run by the diversity task when a
+ *        frame is due.  Evaluates at a rate between the mode's rate_min_hz
+ *        and rate_max_hz that follows the link's volatility.
+ *
+ * In IRAM from the sample to the switch, so a cache miss on a flash page
+ * never delays a decision.  Everything after it — health check, point 8,
+ * shadows, recorder, logs, LED and beeper — is diversity_update_tail(),
+ * in flash.
+ */
+IRAM_ATTR void diversity_update(void) {
     if (!g_diversity_initialized) {
         return;
     }
     
     uint32_t now = esp_timer_get_time() / 1000; // ms
     diversity_state_t* state = &g_diversity_state;
-    const diversity_mode_params_t* params = &diversity_mode_params[state->mode];
+    const diversity_mode_params_t* params = diversity_get_mode_params(state->mode);
     
     // Calculate switches per second over last 5 seconds
-    uint32_t window_start = now - 5000; // 5 second window
-    uint32_t recent_switches = 0;
-    for (uint8_t i = 0; i < SWITCH_HISTORY_SIZE; i++) {
-        if (g_switch_timestamps[i] >= window_start && g_switch_timestamps[i] <= now) {
-            recent_switches++;
-        }
-    }
-    state->switches_per_second = recent_switches / 5.0f;
+    uint32_t recent_switches = diversity_switch_window_count(&g_switch_tail_5s, now, 5000);
+    state->switches_per_second = (recent_switches * DIVERSITY_Q16_ONE) / 5;
+    g_switches_last_minute = diversity_switch_window_count(&g_switch_tail_60s, now, 60000);
     
-    // Adaptive sampling rate: switch between 20Hz (50ms) and 100Hz (10ms)
-    // High rate (100Hz): switches_per_second >= 2 OR time_stable < 3s
-    // Low rate (20Hz):  switches_per_second < 2 AND time_stable >= 3s
-    uint32_t time_since_last_sample = now - state->last_sample_ms;
+    // Adaptive sampling: the interval the rate controller picked last time.
+    // A frame that jumped away from the last evaluated one is taken early.
+    uint32_t sample_interval_us = diversity_rate_interval_us(state, params);
+    bool early = g_wake_early;
+    g_wake_early = false;
+
+    // Take the latest RSSI sample published by the sampling task in rx5808.c.
+    // If it is the one already processed (e.g. oneshot fallback while the
+    // composite video owns the ADC DMA), skip it rather than feeding the same
+    // value into the variance window twice.
+    rssi_frame_t sample;
+    if (!RX5808_Get_Sample(&sample) || sample.seq == state->last_sample_seq) {
+        state->duplicate_samples++;
+        return;
+    }
+    // Rate limit on the sample clock: the interval is the time between the
+    // frames' own timestamps, whatever the wake-up jitter was
+    if (!early && sample.t_us - state->last_sample_us < sample_interval_us) {
+        g_next_due_us = (uint32_t)(state->last_sample_us + sample_interval_us);
+        return; // Skip this frame, not enough time elapsed
+    }
+    uint32_t time_since_last_sample = (uint32_t)((sample.t_us - state->last_sample_us) / 1000);
+    state->last_sample_seq = sample.seq;
+    state->last_sample_us = sample.t_us;
     
-    if (state->switches_per_second >= 2.0f || state->time_stable_ms < 3000) {
-        // High activity mode: 100Hz sampling (10ms intervals)
-        state->adaptive_high_rate = true;
-        if (time_since_last_sample < 10) {
-            return; // Skip this call, not enough time elapsed
+    // A frame taken before the last retune settled (a point 8 trial, a
+    // channel change) reads the PLL transient, not the link: keep the loop
+    // running on the previous statistics and scores without it.
+    bool settling = !RX5808_Is_Settled() || sample.t_us < RX5808_Get_Settled_Time_Us();
+    if (settling) {
+        state->transient_samples++;
+    }
+
+    // The calibration sweep has the tuner: no scores, AGC, switch or point 8
+    // trial on other channels' noise.  A point 8 offset or trial is void
+    // once the sweep is back on the nominal channel.
+    if (g_tuner_borrowed) {
+        if (!settling) {
+            state->transient_samples++;
         }
-    } else {
-        // Low activity mode: 20Hz sampling (50ms intervals)
-        state->adaptive_high_rate = false;
-        if (time_since_last_sample < 50) {
-            return; // Skip this call, not enough time elapsed
+        if (state->freq_shift_state != FREQ_SHIFT_IDLE) {
+            state->freq_shift_state  = FREQ_SHIFT_IDLE;
+            state->freq_shift_offset = 0;
         }
+        state->freq_shift_cooldown_ms = now + FREQ_SHIFT_COOLDOWN_MS;
+        g_next_due_us = (uint32_t)(sample.t_us + sample_interval_us);
+        return;
     }
-    
-    // Update last sample timestamp
-    state->last_sample_ms = now;
-    
-    // Sample raw RSSI from both receivers via ADC
-    // adc_converted_value[] is populated by the ADC DMA handler in rx5808.c
-    state->rx_a.rssi_raw = adc_converted_value[0];
-    state->rx_b.rssi_raw = adc_converted_value[1];
-
-    // Normalize RSSI
-    state->rx_a.rssi_norm = diversity_normalize_rssi(state->rx_a.rssi_raw, &state->cal_a);
-    state->rx_b.rssi_norm = diversity_normalize_rssi(state->rx_b.rssi_raw, &state->cal_b);
 
-    // Keep LED signal-strength value in sync with the active receiver
-    {
-        uint8_t active_rssi = (uint8_t)((state->active_rx == DIVERSITY_RX_A)
-                                         ? state->rx_a.rssi_norm
-                                         : state->rx_b.rssi_norm);
-        led_set_signal_strength(active_rssi);
-    }
+    // Calibration at the tuned frequency (per-frequency map when there is one)
+    uint16_t freq = RX5808_Get_Expected_Frequency();
+    rssi_calibration_t  cal_freq[DIVERSITY_NUM_RX];
+    rssi_calibration_t* cal[DIVERSITY_NUM_RX];
 
+    // Per receiver: normalize, AGC, statistics, prediction, scores.
     // --- Point 7: software AGC ---
     // Only update the baseline during stable flight (after 2 s without a switch)
     // to avoid contaminating it with mid-manoeuvre swings.
-    if (state->time_stable_ms > 2000) {
-        // Slow EMA: α=0.001 → converges to true mean in ~1000 samples (~10 s @100 Hz)
-        state->rx_a.agc_baseline = state->rx_a.agc_baseline * 0.999f
-                                 + (float)state->rx_a.rssi_norm * 0.001f;
-        state->rx_b.agc_baseline = state->rx_b.agc_baseline * 0.999f
-                                 + (float)state->rx_b.rssi_norm * 0.001f;
-        if (state->rx_a.agc_sample_count < 60000) state->rx_a.agc_sample_count++;
-        if (state->rx_b.agc_sample_count < 60000) state->rx_b.agc_sample_count++;
-    }
-    // AGC-corrected RSSI: shift each receiver so its long-term mean sits at 50%.
-    // Capped at ±15 to prevent over-correction on hardware with large offsets.
-    // Correction activates after 100 stable samples (~warmup 1 s @100 Hz).
-    if (state->rx_a.agc_sample_count >= 100) {
-        int16_t corr_a = (int16_t)(50.0f - state->rx_a.agc_baseline);
-        if (corr_a >  15) corr_a =  15;
-        if (corr_a < -15) corr_a = -15;
-        int16_t agc_a = (int16_t)state->rx_a.rssi_norm + corr_a;
-        state->rx_a.rssi_agc = (agc_a < 0) ? 0 : (agc_a > 100) ? 100 : (int16_t)agc_a;
-    } else {
-        state->rx_a.rssi_agc = (int16_t)state->rx_a.rssi_norm;
-    }
-    if (state->rx_b.agc_sample_count >= 100) {
-        int16_t corr_b = (int16_t)(50.0f - state->rx_b.agc_baseline);
-        if (corr_b >  15) corr_b =  15;
-        if (corr_b < -15) corr_b = -15;
-        int16_t agc_b = (int16_t)state->rx_b.rssi_norm + corr_b;
-        state->rx_b.rssi_agc = (agc_b < 0) ? 0 : (agc_b > 100) ? 100 : (int16_t)agc_b;
-    } else {
-        state->rx_b.rssi_agc = (int16_t)state->rx_b.rssi_norm;
+    bool stable = state->time_stable_ms > 2000;
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        diversity_rx_state_t* rx = &state->rx[i];
+        cal[i] = diversity_cal_at(&state->cal[i], i, freq, &cal_freq[i]);
+        if (settling) {
+            continue;
+        }
+        rx->rssi_raw  = sample.value[RSSI_SLOT_RSSI0 + i];
+        rx->rssi_norm = diversity_normalize_rssi(rx->rssi_raw, cal[i]);
+        rx->fading    = g_fading[i].regime;
+        diversity_agc_update(rx, stable);
+        // Store samples in rolling windows and update statistics — with the
+        // frame time, so slope is time-normalised (point 2)
+        diversity_calculate_statistics(rx, rx->rssi_raw, (uint32_t)(sample.t_us / 1000));
+        diversity_predict(rx, cal[i], params, time_since_last_sample);
+        diversity_calculate_scores(rx, params);
+        g_wake_ref[i] = rx->rssi_raw;
     }
 
-    // Store samples in rolling windows
-    state->rx_a.rssi_samples[state->rx_a.sample_index] = state->rx_a.rssi_raw;
-    state->rx_a.sample_index = (state->rx_a.sample_index + 1) % DIVERSITY_MAX_SAMPLES;
-    if (state->rx_a.sample_count < DIVERSITY_MAX_SAMPLES) state->rx_a.sample_count++;
-
-    state->rx_b.rssi_samples[state->rx_b.sample_index] = state->rx_b.rssi_raw;
-    state->rx_b.sample_index = (state->rx_b.sample_index + 1) % DIVERSITY_MAX_SAMPLES;
-    if (state->rx_b.sample_count < DIVERSITY_MAX_SAMPLES) state->rx_b.sample_count++;
-
-    // Calculate statistics — pass actual interval so slope is time-normalised (point 2)
-    diversity_calculate_statistics(&state->rx_a, time_since_last_sample);
-    diversity_calculate_statistics(&state->rx_b, time_since_last_sample);
-
-    // Calculate scores
-    diversity_calculate_scores(&state->rx_a, params);
-    diversity_calculate_scores(&state->rx_b, params);
+    // Next evaluation at the rate this frame's volatility asks for; the RF
+    // service wakes us for the next due frame
+    diversity_rate_update(state, params, time_since_last_sample);
+    g_next_due_us = (uint32_t)(sample.t_us + diversity_rate_interval_us(state, params));
 
     // --- Point 9: apply / expire preference bonuses ---
-    // Outcome check: 200 ms after a switch see if the new receiver actually improved.
-    if (state->outcome_check_ms != 0 && now >= state->outcome_check_ms) {
-        const diversity_rx_state_t* new_rx = (state->outcome_new_rx == DIVERSITY_RX_A)
-                                              ? &state->rx_a : &state->rx_b;
-        // "Improved" = rssi_norm at least 5% higher than it was at the switch moment
-        if ((int16_t)new_rx->rssi_norm > (int16_t)state->outcome_rssi_at_switch + 5) {
-            if (state->outcome_new_rx == DIVERSITY_RX_A) {
-                state->rx_a_pref_bonus        = 8.0f;
-                state->rx_a_bonus_expires_ms  = now + 5000;
-            } else {
-                state->rx_b_pref_bonus        = 8.0f;
-                state->rx_b_bonus_expires_ms  = now + 5000;
-            }
-            ESP_LOGI(TAG, "RX_%c confirmed good — preference bonus applied",
-                     state->outcome_new_rx == DIVERSITY_RX_A ? 'A' : 'B');
-        }
-        state->outcome_check_ms = 0;
-    }
-    // Expire bonuses
-    if (state->rx_a_bonus_expires_ms && now >= state->rx_a_bonus_expires_ms) {
-        state->rx_a_pref_bonus = 0.0f; state->rx_a_bonus_expires_ms = 0;
-    }
-    if (state->rx_b_bonus_expires_ms && now >= state->rx_b_bonus_expires_ms) {
-        state->rx_b_pref_bonus = 0.0f; state->rx_b_bonus_expires_ms = 0;
-    }
-    // Apply preference bonus to combined score (capped at 100)
-    if (state->rx_a_pref_bonus > 0.0f) {
-        uint16_t s = (uint16_t)state->rx_a.combined_score + (uint16_t)state->rx_a_pref_bonus;
-        state->rx_a.combined_score = (s > 100) ? 100 : (uint8_t)s;
-    }
-    if (state->rx_b_pref_bonus > 0.0f) {
-        uint16_t s = (uint16_t)state->rx_b.combined_score + (uint16_t)state->rx_b_pref_bonus;
-        state->rx_b.combined_score = (s > 100) ? 100 : (uint8_t)s;
-    }
-    
-    // Check receiver health (pass current timestamp to avoid extra syscalls)
-    diversity_check_receiver_health(&state->rx_a, now);
-    diversity_check_receiver_health(&state->rx_b, now);
-    
-    // Point 8: interference rejection via micro-frequency offset
-    // Run after scores and outcome bonuses are finalised, before the switch decision,
-    // so that a successful shift is reflected in the next cycle's scores.
-    diversity_freq_shift_update(state, now);
+    diversity_outcome_update(state, now);
 
     // Update telemetry
-    state->rssi_delta = (int8_t)state->rx_a.rssi_norm - (int8_t)state->rx_b.rssi_norm;
+    state->rssi_delta = (int8_t)state->rx[0].rssi_norm - (int8_t)state->rx[1].rssi_norm;
     state->time_stable_ms = now - state->last_switch_ms;
     
     // Update longest stable time
@@ -753,31 +1580,99 @@ void diversity_update(void) {
         state->in_cooldown = false;
     }
     
-    // Decide whether to switch
-    if (diversity_should_switch(state, params, now)) {
-        diversity_perform_switch(state);
-        // Visual feedback: double blink on every antenna switch.
-        // Called here (task context) rather than inside the IRAM_ATTR function
-        // to keep the IRAM path free of non-ISR-safe FreeRTOS queue calls.
+    // Decide whether to switch (not on a transient frame: nothing new to decide on)
+    diversity_rx_t target;
+    bool do_switch = !settling && diversity_should_switch(state, params, now, &target);
+    diversity_latency_record(g_latency.decision, &g_latency.decision_max_us,
+                             sample.t_us, esp_timer_get_time());
+    if (do_switch) {
+        diversity_perform_switch(state, target);
+        // The RF service runs above this task, so the pins have changed by now
+        diversity_latency_record(g_latency.gpio, &g_latency.gpio_max_us,
+                                 sample.t_us, RX5808_Get_Antenna_Switch_Time_Us());
+    }
+
+    diversity_update_tail(state, settling, do_switch, cal, time_since_last_sample, now, sample.t_us);
+}
+
+/**
+ * @brief The part of diversity_update() after the decision, in flash: it
+ *        only acts on the next decision, so a cache miss here costs none
+ */
+static void diversity_update_tail(diversity_state_t* state, bool settling, bool switched,
+                                  rssi_calibration_t* const cal[DIVERSITY_NUM_RX],
+                                  uint32_t interval_ms, uint32_t now, int64_t sample_us) {
+    if (switched) {
+        ESP_LOGI(TAG, "Switched to RX_%c (switches=%lu)",
+                 'A' + state->active_rx,
+                 state->switch_count);
+        // Visual feedback: double blink on every antenna switch
         led_trigger_double_blink();
     }
 
+    // Keep LED signal-strength value in sync with the active receiver
+    led_set_signal_strength((uint8_t)state->rx[state->active_rx].rssi_norm);
+
+    // Check receiver health (pass current timestamp to avoid extra syscalls)
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        diversity_check_receiver_health(&state->rx[i], now);
+    }
+
+    // Point 8: interference rejection via micro-frequency offset.  After the
+    // decision: a shift (or its retune) shows in the next cycle's scores.
+    diversity_freq_shift_update(state, now, settling, sample_us);
+
+    // Shadow modes decide on the same sample (no-op without any)
+    if (!settling) {
+        diversity_shadow_update(state, switched, cal, interval_ms, now, (uint32_t)(sample_us / 1000));
+    }
+
+#ifdef CONFIG_FLIGHT_RECORDER
+    // One record per decision, after the switch so active_rx is the new one.
+    // The record layout holds receivers 0 and 1.
+    flightrec_sample_t rec = {
+        .t_ms              = (uint32_t)(sample_us / 1000),
+        .raw               = { state->rx[0].rssi_raw, state->rx[1].rssi_raw },
+        .norm              = { state->rx[0].rssi_norm, state->rx[1].rssi_norm },
+        .score             = { state->rx[0].combined_score, state->rx[1].combined_score },
+        .active_rx         = (uint8_t)state->active_rx,
+        .freq_shift_state  = (uint8_t)state->freq_shift_state,
+        .freq_shift_offset = state->freq_shift_offset,
+    };
+    flightrec_log(&rec);
+#endif
+
     // --- Point E: low-signal audio alert ---
-    // Fires a long beep when BOTH receivers report weak signal (rssi_norm < 15),
+    // Fires a long beep when ALL receivers report weak signal (rssi_norm < 15),
     // indicating the aircraft is likely out of range on all antennas.
     // Rate-limited to once every 5 s so the cockpit isn't flooded with beeps.
     // Only activates after calibration is complete so boot noise doesn't trigger it.
 #define LOW_SIGNAL_THRESHOLD   15   // rssi_norm below this on both RX = "weak"
 #define LOW_SIGNAL_REPEAT_MS 5000  // minimum gap between consecutive alert beeps
-    if (state->cal_a.calibrated && state->cal_b.calibrated) {
-        if (state->rx_a.rssi_norm < LOW_SIGNAL_THRESHOLD &&
-            state->rx_b.rssi_norm < LOW_SIGNAL_THRESHOLD) {
-            if (now - state->low_signal_beep_ms >= LOW_SIGNAL_REPEAT_MS) {
-                state->low_signal_beep_ms = now;
-                beep_play_triple(); // three rapid clicks = range warning
-            }
-        }
+    bool all_weak = true;
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        all_weak = all_weak && state->cal[i].calibrated &&
+                   state->rx[i].rssi_norm < LOW_SIGNAL_THRESHOLD;
+    }
+    if (all_weak && now - state->low_signal_beep_ms >= LOW_SIGNAL_REPEAT_MS) {
+        state->low_signal_beep_ms = now;
+        beep_play_triple(); // three rapid clicks = range warning
+    }
+
+    diversity_snapshot_publish(state, (uint32_t)(sample_us / 1000));
+
+#ifdef CONFIG_DIVERSITY_LATENCY_LOG
+    if (now - g_latency_log_ms >= DIVERSITY_LATENCY_LOG_MS) {
+        g_latency_log_ms = now;
+        diversity_print_latency();
+    }
+#endif
+#ifdef CONFIG_DIVERSITY_SHADOW
+    if (now - g_shadow_log_ms >= DIVERSITY_SHADOW_LOG_MS && g_shadow_stats[0].enabled) {
+        g_shadow_log_ms = now;
+        diversity_shadow_log();
     }
+#endif
 }
 
 /**
@@ -788,12 +1683,68 @@ diversity_rx_t diversity_get_active_rx(void) {
 }
 
 /**
- * @brief Get pointer to diversity state (for UI/telemetry)
+ * @brief Get pointer to the live diversity state.  The diversity task
+ *        changes it while other tasks read; they use diversity_get_snapshot()
+ *        for a coherent view.
  */
 diversity_state_t* diversity_get_state(void) {
     return &g_diversity_state;
 }
 
+/**
+ * @brief Publish the UI / telemetry fields of @p state (diversity task only)
+ */
+static IRAM_ATTR void diversity_snapshot_publish(const diversity_state_t* state, uint32_t t_ms) {
+    diversity_snapshot_t snap = {
+        .seq                  = ++g_snapshot_seq,
+        .t_ms                 = t_ms,
+        .mode                 = state->mode,
+        .active_rx            = state->active_rx,
+        .rssi_delta           = state->rssi_delta,
+        .in_cooldown          = state->in_cooldown,
+        .rate_hz              = (uint16_t)((state->rate_q16 + DIVERSITY_Q16_ONE / 2) >> 16),
+        .switch_count         = state->switch_count,
+        .switches_last_minute = g_switches_last_minute,
+        .time_stable_ms       = state->time_stable_ms,
+        .longest_stable_ms    = state->longest_stable_ms,
+        .freq_shift_state     = state->freq_shift_state,
+        .freq_shift_offset    = state->freq_shift_offset,
+    };
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        const diversity_rx_state_t* rx = &state->rx[i];
+        snap.rssi_norm[i] = rx->rssi_norm;
+        snap.score[i]     = rx->combined_score;
+        snap.healthy[i]   = !rx->health.disabled && !rx->health.stuck_low && !rx->health.no_variance;
+        snap.fading[i]    = rx->fading;
+    }
+
+    uint32_t s = g_snapshot.seqcount;
+    // Odd: readers use copy[1] while copy[0] is rewritten
+    __atomic_store_n(&g_snapshot.seqcount, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    g_snapshot.copy[0] = snap;
+    // Even: readers use copy[0] while copy[1] is rewritten
+    __atomic_store_n(&g_snapshot.seqcount, s + 2, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    g_snapshot.copy[1] = snap;
+}
+
+/**
+ * @brief Copy of the last published UI / telemetry snapshot; any task, any
+ *        core, no locks
+ * @return false before diversity_init() (out->seq == 0)
+ */
+bool diversity_get_snapshot(diversity_snapshot_t* out) {
+    uint32_t s1, s2;
+    do {
+        s1 = __atomic_load_n(&g_snapshot.seqcount, __ATOMIC_ACQUIRE);
+        memcpy(out, &g_snapshot.copy[s1 & 1u], sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&g_snapshot.seqcount, __ATOMIC_RELAXED);
+    } while (s1 != s2);
+    return out->seq != 0;
+}
+
 /**
  * @brief Get total switch count
  */
@@ -802,20 +1753,10 @@ uint32_t diversity_get_switch_count(void) {
 }
 
 /**
- * @brief Calculate switches per minute over last 60 seconds
+ * @brief Switches in the last 60 seconds (counted by diversity_update())
  */
 uint32_t diversity_get_switches_per_minute(void) {
-    uint32_t now = esp_timer_get_time() / 1000; // ms
-    uint32_t count = 0;
-    
-    // Count switches in last 60 seconds
-    for (int i = 0; i < SWITCH_HISTORY_SIZE; i++) {
-        if (g_switch_timestamps[i] > 0 && (now - g_switch_timestamps[i]) < 60000) {
-            count++;
-        }
-    }
-    
-    return count;
+    return g_switches_last_minute;
 }
 
 /**
@@ -832,10 +1773,247 @@ void diversity_reset_stats(void) {
     g_diversity_state.switch_count = 0;
     g_diversity_state.longest_stable_ms = 0;
     memset(g_switch_timestamps, 0, sizeof(g_switch_timestamps));
-    g_switch_history_index = 0;
+    g_switch_head = 0;
+    g_switch_tail_5s = 0;
+    g_switch_tail_60s = 0;
+    g_switches_last_minute = 0;
+    diversity_reset_latency();
     ESP_LOGI(TAG, "Statistics reset");
 }
 
+// ============================================================================
+// Custom mode profiles (NVS blob, see diversity_profile.h)
+// ============================================================================
+
+/**
+ * @brief Install the custom profiles stored in NVS, if any
+ */
+void diversity_profiles_load(void) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+
+    uint8_t blob[DIVERSITY_PROFILE_BLOB_MAX];
+    size_t len = sizeof(blob);
+    esp_err_t err = nvs_get_blob(nvs_handle, NVS_KEY_PROFILES, blob, &len);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        return;
+    }
+
+    diversity_profile_t profiles[DIVERSITY_CUSTOM_PROFILES];
+    int count = diversity_profile_decode(blob, len, profiles, DIVERSITY_CUSTOM_PROFILES);
+    if (count < 0) {
+        ESP_LOGW(TAG, "Custom profile blob invalid (%u bytes), ignored", (unsigned)len);
+        return;
+    }
+    diversity_mode_params_t params[DIVERSITY_CUSTOM_PROFILES];
+    for (int i = 0; i < count; i++) {
+        params[i] = profiles[i].params;
+    }
+    diversity_set_custom_profiles(params, count);
+    for (int i = 0; i < g_custom_count; i++) {
+        ESP_LOGI(TAG, "Custom profile %d loaded: %s", i + 1, g_custom[i].name);
+    }
+}
+
+/**
+ * @brief Validate a profile blob (as written by sim/diversity_opt), save it
+ *        to NVS and install it.  An empty blob (count 0) removes the custom
+ *        profiles.
+ */
+bool diversity_profiles_store(const uint8_t* blob, size_t len) {
+    diversity_profile_t profiles[DIVERSITY_CUSTOM_PROFILES];
+    int count = diversity_profile_decode(blob, len, profiles, DIVERSITY_CUSTOM_PROFILES);
+    if (count < 0) {
+        ESP_LOGE(TAG, "Custom profile blob rejected");
+        return false;
+    }
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for profile save");
+        return false;
+    }
+    esp_err_t err = nvs_set_blob(nvs_handle, NVS_KEY_PROFILES, blob, len);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save custom profiles");
+        return false;
+    }
+
+    diversity_mode_params_t params[DIVERSITY_CUSTOM_PROFILES];
+    for (int i = 0; i < count; i++) {
+        params[i] = profiles[i].params;
+    }
+    diversity_set_custom_profiles(params, count);
+    ESP_LOGI(TAG, "%d custom profile(s) saved", count);
+    return true;
+}
+
+// ============================================================================
+// Per-frequency calibration map (see rssi_calmap.h)
+// ============================================================================
+
+/**
+ * @brief Rebuild @p map against the current single-point calibration and
+ *        make it the live map
+ * @return true if the map is valid (used by diversity_update())
+ */
+static bool diversity_calmap_publish(rssi_calmap_t* map) {
+    uint16_t span[RSSI_CALMAP_RX] = {0, 0};
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        const rssi_calibration_t* cal = &g_diversity_state.cal[rx];
+        if (cal->calibrated && cal->peak_raw > cal->floor_raw) {
+            span[rx] = cal->peak_raw - cal->floor_raw;
+        }
+    }
+    bool valid = rssi_calmap_build(map, span);
+    g_calmap_live = map;    // An invalid map is published too: lookups fall back to cal[]
+    return valid;
+}
+
+static rssi_calmap_t* diversity_calmap_spare(void) {
+    return (g_calmap_live == &g_calmap[0]) ? &g_calmap[1] : &g_calmap[0];
+}
+
+static void diversity_calmap_load(void) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    uint8_t blob[RSSI_CALMAP_BLOB_SIZE];
+    size_t len = sizeof(blob);
+    esp_err_t err = nvs_get_blob(nvs_handle, NVS_KEY_CALMAP, blob, &len);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        return;
+    }
+
+    rssi_calmap_t* map = diversity_calmap_spare();
+    if (!rssi_calmap_decode(map, blob, len)) {
+        ESP_LOGW(TAG, "Calibration map blob invalid, ignored");
+    } else if (diversity_calmap_publish(map)) {
+        ESP_LOGI(TAG, "Per-frequency calibration map loaded");
+    } else {
+        ESP_LOGW(TAG, "Calibration map incomplete, using single-point calibration");
+    }
+}
+
+static bool diversity_calmap_save(const rssi_calmap_t* map) {
+    uint8_t blob[RSSI_CALMAP_BLOB_SIZE];
+    size_t len = rssi_calmap_encode(map, blob, sizeof(blob));
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return false;
+    }
+    esp_err_t err = nvs_set_blob(nvs_handle, NVS_KEY_CALMAP, blob, len);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    return err == ESP_OK;
+}
+
+// Measure task context: keep the result, wake the sweep
+static void diversity_calmap_measure_cb(const rx5808_measure_t* result, void* arg) {
+    (void)arg;
+    g_calmap_result = *result;
+    if (g_calmap_task != NULL) {
+        xTaskNotifyGive(g_calmap_task);
+    }
+}
+
+/**
+ * @brief Sweep task: measure every map bin through RX5808_Measure(), return
+ *        to the user's channel, fold the sweep into the map, save and publish
+ */
+static void diversity_calmap_sweep_fn(void* param) {
+    (void)param;
+    static uint16_t mean[RSSI_CALMAP_RX][RSSI_CALMAP_BINS];
+    bool measured[RSSI_CALMAP_BINS] = {0};
+    uint16_t n = RX5808_Get_RSSI_Frames_In(CALMAP_SWEEP_SAMPLE_MS);
+
+    g_tuner_borrowed = true;
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        uint16_t freq = rssi_calmap_bin_freq(b);
+        ulTaskNotifyTake(pdTRUE, 0);
+        if (!RX5808_Measure(freq, 0, n, diversity_calmap_measure_cb, NULL) ||
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CALMAP_SWEEP_TIMEOUT_MS)) == 0) {
+            continue;
+        }
+        if (g_calmap_result.ok && g_calmap_result.freq == freq) {
+            mean[0][b]  = g_calmap_result.mean[0];
+            mean[1][b]  = g_calmap_result.mean[1];
+            measured[b] = true;
+        }
+    }
+    RX5808_Tune_Async(RX5808_Get_Current_Freq(), NULL);
+    // Frames up to the settle of this tune are transients to diversity_update()
+    g_tuner_borrowed = false;
+
+    rssi_calmap_t* map = diversity_calmap_spare();
+    *map = *g_calmap_live;
+    int floors = rssi_calmap_merge_sweep(map, mean, measured);
+    if (floors < 0) {
+        ESP_LOGW(TAG, "Calibration sweep: too few bins measured, map unchanged");
+    } else if (!diversity_calmap_publish(map)) {
+        ESP_LOGW(TAG, "Calibration sweep: %d floor bins, no usable span yet (calibrate the peak)", floors);
+        diversity_calmap_save(map);     // Kept for when the peak is calibrated
+    } else {
+        ESP_LOGI(TAG, "Calibration sweep: %d floor bins, map %s", floors,
+                 diversity_calmap_save(map) ? "saved" : "NOT saved");
+    }
+    g_calmap_task = NULL;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Start a background sweep of the whole band that fills the
+ *        per-frequency calibration map.  Run it with a VTX on (e.g. right
+ *        after the peak calibration): its channel gives the peak point and
+ *        every bin away from it a floor point.  Retunes the receivers for a
+ *        few seconds, then returns to the user's channel.
+ *
+ * @return false if a sweep is already running
+ */
+bool diversity_calmap_sweep_start(void) {
+    if (g_calmap_task != NULL) {
+        return false;
+    }
+    ESP_LOGI(TAG, "Calibration sweep: %d bins from %d MHz", RSSI_CALMAP_BINS, RSSI_CALMAP_MIN_MHZ);
+    return xTaskCreatePinnedToCore(diversity_calmap_sweep_fn, "div_calmap", 3072, NULL, 2,
+                                   &g_calmap_task, 1) == pdPASS;
+}
+
+bool diversity_calmap_sweep_running(void) {
+    return g_calmap_task != NULL;
+}
+
+bool diversity_calmap_valid(void) {
+    return g_calmap_live->valid;
+}
+
+/**
+ * @brief Drop the map (RAM and NVS): back to the single-point calibration
+ */
+void diversity_calmap_clear(void) {
+    rssi_calmap_t* map = diversity_calmap_spare();
+    rssi_calmap_clear(map);
+    g_calmap_live = map;
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        nvs_erase_key(nvs_handle, NVS_KEY_CALMAP);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+    ESP_LOGI(TAG, "Calibration map cleared");
+}
+
 // ============================================================================
 // RSSI Calibration Functions
 // ============================================================================
@@ -852,34 +2030,27 @@ void diversity_calibrate_load(void) {
     }
     
     uint16_t value;
+    char key[16];
     
-    // Load RX A calibration
-    if (nvs_get_u16(nvs_handle, NVS_KEY_CAL_A_FLOOR, &value) == ESP_OK) {
-        g_diversity_state.cal_a.floor_raw = value;
-    }
-    if (nvs_get_u16(nvs_handle, NVS_KEY_CAL_A_PEAK, &value) == ESP_OK) {
-        g_diversity_state.cal_a.peak_raw = value;
-    }
-    
-    // Load RX B calibration
-    if (nvs_get_u16(nvs_handle, NVS_KEY_CAL_B_FLOOR, &value) == ESP_OK) {
-        g_diversity_state.cal_b.floor_raw = value;
-    }
-    if (nvs_get_u16(nvs_handle, NVS_KEY_CAL_B_PEAK, &value) == ESP_OK) {
-        g_diversity_state.cal_b.peak_raw = value;
-    }
-    
-    // Validate calibration
-    if (g_diversity_state.cal_a.peak_raw > g_diversity_state.cal_a.floor_raw + 50) {
-        g_diversity_state.cal_a.calibrated = true;
-        ESP_LOGI(TAG, "RX A calibration loaded: floor=%d peak=%d",
-                 g_diversity_state.cal_a.floor_raw, g_diversity_state.cal_a.peak_raw);
-    }
-    
-    if (g_diversity_state.cal_b.peak_raw > g_diversity_state.cal_b.floor_raw + 50) {
-        g_diversity_state.cal_b.calibrated = true;
-        ESP_LOGI(TAG, "RX B calibration loaded: floor=%d peak=%d",
-                 g_diversity_state.cal_b.floor_raw, g_diversity_state.cal_b.peak_raw);
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        rssi_calibration_t* cal = &g_diversity_state.cal[i];
+
+        // Load RX calibration
+        snprintf(key, sizeof(key), NVS_KEY_CAL_FMT, 'a' + i, "floor");
+        if (nvs_get_u16(nvs_handle, key, &value) == ESP_OK) {
+            cal->floor_raw = value;
+        }
+        snprintf(key, sizeof(key), NVS_KEY_CAL_FMT, 'a' + i, "peak");
+        if (nvs_get_u16(nvs_handle, key, &value) == ESP_OK) {
+            cal->peak_raw = value;
+        }
+
+        // Validate calibration
+        if (cal->peak_raw > cal->floor_raw + 50) {
+            cal->calibrated = true;
+            ESP_LOGI(TAG, "RX %c calibration loaded: floor=%d peak=%d",
+                     'A' + i, cal->floor_raw, cal->peak_raw);
+        }
     }
 
     // F: load persisted diversity mode (Race / Freestyle / Long-Range).
@@ -887,10 +2058,10 @@ void diversity_calibrate_load(void) {
     // so the user's preference survives a power cycle.
     uint8_t saved_mode = 0;
     if (nvs_get_u8(nvs_handle, NVS_KEY_MODE, &saved_mode) == ESP_OK
-            && saved_mode < DIVERSITY_MODE_COUNT) {
+            && diversity_mode_available((diversity_mode_t)saved_mode)) {
         g_diversity_state.mode = (diversity_mode_t)saved_mode;
         ESP_LOGI(TAG, "Diversity mode loaded: %s",
-                 diversity_mode_params[g_diversity_state.mode].name);
+                 diversity_get_mode_params(g_diversity_state.mode)->name);
     }
 
     nvs_close(nvs_handle);
@@ -903,7 +2074,7 @@ void diversity_calibrate_load(void) {
  * Call diversity_calibrate_floor_finish() after DIVERSITY_CALIB_SAMPLES ticks.
  */
 void diversity_calibrate_floor_sample(diversity_rx_t rx, uint16_t* buf, int index) {
-    buf[index] = (rx == DIVERSITY_RX_A) ? adc_converted_value[0] : adc_converted_value[1];
+    buf[index] = RX5808_Get_RSSI_Raw((rx5808_receive)rx);
 }
 
 /**
@@ -935,7 +2106,7 @@ bool diversity_calibrate_floor_finish(uint16_t* buf, int count, uint16_t* result
  * @brief Add one peak sample (call once per timer tick, non-blocking)
  */
 void diversity_calibrate_peak_sample(diversity_rx_t rx, uint16_t* buf, int index) {
-    buf[index] = (rx == DIVERSITY_RX_A) ? adc_converted_value[0] : adc_converted_value[1];
+    buf[index] = RX5808_Get_RSSI_Raw((rx5808_receive)rx);
 }
 
 /**
@@ -971,17 +2142,25 @@ bool diversity_calibrate_save(void) {
         return false;
     }
     
-    // Save RX A
-    nvs_set_u16(nvs_handle, NVS_KEY_CAL_A_FLOOR, g_diversity_state.cal_a.floor_raw);
-    nvs_set_u16(nvs_handle, NVS_KEY_CAL_A_PEAK, g_diversity_state.cal_a.peak_raw);
-    
-    // Save RX B
-    nvs_set_u16(nvs_handle, NVS_KEY_CAL_B_FLOOR, g_diversity_state.cal_b.floor_raw);
-    nvs_set_u16(nvs_handle, NVS_KEY_CAL_B_PEAK, g_diversity_state.cal_b.peak_raw);
+    char key[16];
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        snprintf(key, sizeof(key), NVS_KEY_CAL_FMT, 'a' + i, "floor");
+        nvs_set_u16(nvs_handle, key, g_diversity_state.cal[i].floor_raw);
+        snprintf(key, sizeof(key), NVS_KEY_CAL_FMT, 'a' + i, "peak");
+        nvs_set_u16(nvs_handle, key, g_diversity_state.cal[i].peak_raw);
+    }
     
     nvs_commit(nvs_handle);
     nvs_close(nvs_handle);
     
     ESP_LOGI(TAG, "Calibration saved to NVS");
+
+    // The map's peak spans may fall back to this calibration: rebuild it
+    // (a running sweep rebuilds when it finishes)
+    if (g_calmap_task == NULL) {
+        rssi_calmap_t* map = diversity_calmap_spare();
+        *map = *g_calmap_live;
+        diversity_calmap_publish(map);
+    }
     return true;
 }
@@ -25,21 +25,43 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include "rssi_window.h"
+#include "rssi_kalman.h"
+#include "rssi_fading.h"
+#include "rssi_ring.h"
+
+// Fixed point: scoring, AGC and rates run in integer math (Q15 weights, Q16 values)
+#define DIVERSITY_Q15(x) ((uint16_t)((x) * 32768.0f + 0.5f))
+#define DIVERSITY_Q16_ONE 65536
 
 // Configuration
 #define DIVERSITY_SAMPLE_WINDOW_MS 200 // Rolling window for variance calculation
-#define DIVERSITY_SAMPLE_RATE_HZ 250   // RSSI sampling rate (4ms per sample)
-#define DIVERSITY_MAX_SAMPLES 50       // Max samples in rolling window (200ms @ 250Hz)
+#define DIVERSITY_MAX_SAMPLES 50       // Max samples in rolling window (200ms @ 250Hz); per-sample cost
+                                       // is independent of it, up to RSSI_WINDOW_MAX_LEN
+// Receivers: one per RSSI slot of the frame (RSSI_SLOT_RSSI0 + n).  The RX5808
+// board has two; host builds may set RSSI_RX_COUNT up to DIVERSITY_MAX_RX.
+#define DIVERSITY_NUM_RX RSSI_RX_COUNT
+#define DIVERSITY_MAX_RX 8
+#if DIVERSITY_NUM_RX < 2 || DIVERSITY_NUM_RX > DIVERSITY_MAX_RX
+#error "DIVERSITY_NUM_RX (RSSI_RX_COUNT) must be 2..DIVERSITY_MAX_RX"
+#endif
 
 /** @brief Diversity mode profiles */
 typedef enum {
     DIVERSITY_MODE_RACE = 0,      // Aggressive switching, minimal lag
     DIVERSITY_MODE_FREESTYLE,      // Balanced switching, smooth video
     DIVERSITY_MODE_LONG_RANGE,     // Stable switching, range optimization
+    DIVERSITY_MODE_CUSTOM_1,       // Custom profiles loaded from NVS (diversity_profile.h);
+    DIVERSITY_MODE_CUSTOM_2,       // an empty slot runs the Freestyle parameters
+    DIVERSITY_MODE_CUSTOM_3,
     DIVERSITY_MODE_COUNT
 } diversity_mode_t;
 
-/** @brief Active receiver selection */
+#define DIVERSITY_MODE_BUILTIN_COUNT  3
+#define DIVERSITY_CUSTOM_PROFILES     (DIVERSITY_MODE_COUNT - DIVERSITY_MODE_BUILTIN_COUNT)
+
+/** @brief Receiver index (0 .. DIVERSITY_NUM_RX-1); A and B are the first two */
 typedef enum {
     DIVERSITY_RX_A = 0,
     DIVERSITY_RX_B,
@@ -48,11 +70,18 @@ typedef enum {
 /** @brief Frequency-shift FSM states for interference rejection (point 8) */
 typedef enum {
     FREQ_SHIFT_IDLE = 0,       // No shift active; normal operation
-    FREQ_SHIFT_EVAL_PLUS,      // Tried +1 MHz — collecting evidence
-    FREQ_SHIFT_EVAL_MINUS,     // Tried -1 MHz — collecting evidence
+    FREQ_SHIFT_EVAL_PLUS,      // Tuning / tuned +1 MHz — collecting evidence once settled
+    FREQ_SHIFT_EVAL_MINUS,     // Tuning / tuned -1 MHz — collecting evidence once settled
     FREQ_SHIFT_HOLD,           // Shift accepted; holding for FREQ_SHIFT_HOLD_MS
 } freq_shift_state_t;
 
+/** @brief Preemptive-switch predictor (diversity_set_predictor()) */
+typedef enum {
+    DIVERSITY_PREDICT_SLOPE = 0,   // Half-window slope below slope_threshold
+    DIVERSITY_PREDICT_KALMAN,      // Fade estimator: active predicted below the other
+    DIVERSITY_PREDICT_COUNT
+} diversity_predictor_t;
+
 /** @brief Receiver health status flags */
 typedef struct {
     bool stuck_high;               // RSSI stuck at max value
@@ -66,41 +95,92 @@ typedef struct {
     uint32_t dwell_ms;             // Minimum time before allowing next switch
     uint32_t cooldown_ms;          // Extended dwell after a switch
     uint8_t hysteresis_pct;        // Required score advantage to switch (0-100)
-    float weight_rssi;             // RSSI weight in combined score (0.0-1.0)
-    float weight_stability;        // Stability weight in combined score (0.0-1.0)
+    uint16_t weight_rssi;          // RSSI weight in combined score, Q15 (DIVERSITY_Q15(0.0-1.0))
+    uint16_t weight_stability;     // Stability weight in combined score, Q15
     int16_t slope_threshold;       // Preemptive switch slope threshold (negative)
+    diversity_predictor_t predictor; // Default preemptive-switch predictor
+    uint32_t kf_alpha;             // Fade estimator gains, Q16 (RSSI_KALMAN_Q16(), see rssi_kalman.h)
+    uint32_t kf_beta;
+    uint16_t predict_ms;           // Fade estimator look-ahead
+    uint16_t rate_min_hz;          // Evaluation rate on a steady link (diversity_rate_update())
+    uint16_t rate_max_hz;          // Evaluation rate while the link is fading
+    uint16_t flutter_weight_stability; // Stability weight of a receiver in multipath flutter, Q15
+    uint8_t flutter_dwell_pct;     // Dwell and cooldown in flutter, % of the above (floor in diversity_should_switch())
     const char* name;              // Mode display name
 } diversity_mode_params_t;
 
-/** @brief RSSI calibration data per receiver */
+/** @brief RSSI calibration data per receiver (single point; the
+ *         per-frequency map in rssi_calmap.h overrides it once built) */
 typedef struct {
     uint16_t floor_raw;            // Noise floor (min RSSI)
     uint16_t peak_raw;             // Signal peak (max RSSI)
     bool calibrated;               // Calibration completed flag
 } rssi_calibration_t;
 
+/**
+ * @brief Sample-to-action latency histograms (diversity_get_latency()).
+ *        Quarter-octave buckets: 16 us wide below 64 us, then four per
+ *        power of two (bucket 4 = [64, 80) us, ..., 8 = [128, 160) us).
+ *        The last bucket holds everything above.  Latency is measured from
+ *        the frame's t_us (its last ADC conversion).
+ */
+#define DIVERSITY_LATENCY_SUB     4         // Buckets per octave
+#define DIVERSITY_LATENCY_BUCKETS 56        // 0 us .. 524 ms
+typedef struct {
+    uint32_t decision[DIVERSITY_LATENCY_BUCKETS];  // Frame → diversity_update() decision
+    uint32_t gpio[DIVERSITY_LATENCY_BUCKETS];      // Frame → antenna switch GPIOs written
+    uint32_t decision_max_us;
+    uint32_t gpio_max_us;
+} diversity_latency_t;
+
+/**
+ * @brief Shadow evaluation (diversity_shadow_set()): up to DIVERSITY_SHADOW_MAX
+ *        other modes run on the live samples without driving the antenna.
+ *        Every decision, the live one included, is judged
+ *        DIVERSITY_SHADOW_JUDGE_MS later: right if it selected the receiver
+ *        whose rssi_norm is then higher than every other's by more than
+ *        DIVERSITY_SHADOW_TIE, wrong if it selected another one, not judged
+ *        when no receiver leads by that much.
+ */
+#define DIVERSITY_SHADOW_MAX        2
+#define DIVERSITY_SHADOW_JUDGE_MS   50
+#define DIVERSITY_SHADOW_TIE        3
+typedef struct {
+    diversity_mode_t mode;
+    bool     enabled;
+    uint32_t judged;               // Decisions judged
+    uint32_t right;                // ...that selected the receiver stronger JUDGE_MS later
+    uint32_t switches;             // Switches made (shadows: would have made)
+    uint32_t elapsed_ms;           // Sample time covered since the last reset
+} diversity_shadow_stats_t;
+
 /** @brief Per-receiver runtime state */
 typedef struct {
     // Raw and normalized RSSI
     uint16_t rssi_raw;             // Current raw ADC value
     uint8_t rssi_norm;             // Normalized RSSI (0-100)
     
-    // Rolling window for statistics
+    // Rolling window for statistics (running sums, see rssi_window.h)
     uint16_t rssi_samples[DIVERSITY_MAX_SAMPLES];
-    uint8_t sample_index;
-    uint8_t sample_count;
+    uint32_t rssi_sample_ms[DIVERSITY_MAX_SAMPLES];    // Frame time of each sample (ms)
+    rssi_window_t window;
     
     // Statistics
     uint16_t rssi_mean;            // Mean RSSI over window
     uint16_t rssi_variance;        // Variance over window
-    int16_t rssi_slope;            // Rate of change (delta/time)
+    int16_t rssi_slope;            // Rate of change (ADC units/s, negative = falling)
+    uint8_t fading;                // rssi_fading_regime_t of the 1 kHz stream (diversity_frame_cb())
+
+    // Fade estimator (runs in every mode so the predictor can change live)
+    rssi_kalman_t fade;
+    uint8_t rssi_predicted;        // AGC-corrected RSSI (0-100) predict_ms ahead
     
     // Scores
     uint8_t stability_score;       // Stability metric (0-100)
     uint8_t combined_score;        // Final weighted score (0-100)
 
     // Software AGC — per-receiver long-term baseline (point 7)
-    float    agc_baseline;         // Slow EMA of rssi_norm (~10 s convergence @100 Hz)
+    int32_t  agc_baseline;         // Slow EMA of rssi_norm, Q16 (~10 s convergence @100 Hz)
     uint16_t agc_sample_count;     // Stable samples accumulated; correction active after 100
     int16_t  rssi_agc;             // AGC-corrected RSSI (0-100), used inside scoring
 
@@ -115,13 +195,9 @@ typedef struct {
     diversity_mode_t mode;
     diversity_rx_t active_rx;
     
-    // Per-receiver state
-    diversity_rx_state_t rx_a;
-    diversity_rx_state_t rx_b;
-    
-    // Calibration
-    rssi_calibration_t cal_a;
-    rssi_calibration_t cal_b;
+    // Per-receiver state and calibration, indexed by diversity_rx_t
+    diversity_rx_state_t rx[DIVERSITY_NUM_RX];
+    rssi_calibration_t cal[DIVERSITY_NUM_RX];
     
     // Switching logic state
     uint32_t last_switch_ms;       // Time of last switch
@@ -135,21 +211,25 @@ typedef struct {
     uint32_t       outcome_check_ms;       // When to evaluate the last switch (0 = none pending)
     diversity_rx_t outcome_new_rx;         // Receiver we just switched TO
     uint8_t        outcome_rssi_at_switch; // rssi_norm of new RX right at switch moment
-    float          rx_a_pref_bonus;        // Temporary score bonus for RX A (0-10)
-    float          rx_b_pref_bonus;        // Temporary score bonus for RX B (0-10)
-    uint32_t       rx_a_bonus_expires_ms;  // Expiry timestamp for RX A bonus
-    uint32_t       rx_b_bonus_expires_ms;  // Expiry timestamp for RX B bonus
-
-    // Adaptive sampling (v1.7.1)
-    uint32_t last_sample_ms;       // Last RSSI sampling time
-    bool adaptive_high_rate;       // true=100Hz, false=20Hz
-    float switches_per_second;     // Recent switching rate
+    uint8_t        pref_bonus[DIVERSITY_NUM_RX];        // Temporary score bonus per RX (0-10)
+    uint32_t       bonus_expires_ms[DIVERSITY_NUM_RX];  // Expiry timestamp of each bonus
+
+    // Adaptive sampling, timed on the sample clock
+    int64_t last_sample_us;        // t_us of the last RSSI frame processed
+    uint32_t rate_q16;             // Evaluation rate, Q16 Hz (rate_min_hz .. rate_max_hz)
+    uint32_t switches_per_second;  // Recent switching rate, Q16
+    uint32_t last_sample_seq;      // RSSI sample seq last processed (RX5808_Get_Sample)
+    uint32_t duplicate_samples;    // Updates skipped because no new RSSI sample was published
+    uint32_t transient_samples;    // Samples dropped: taken mid-retune or during a calibration sweep
     
     // Point 8: interference rejection via micro-frequency offset
     freq_shift_state_t freq_shift_state;       // FSM state
     uint16_t           freq_shift_nominal;     // Nominal channel freq at trigger time (MHz)
     int8_t             freq_shift_offset;      // Active offset: 0, +1, or -1 MHz
-    uint32_t           freq_shift_eval_end_ms; // End of evidence-collection window
+    uint32_t           freq_shift_eval_end_ms; // End of evidence-collection window (sample clock)
+    int64_t            freq_shift_settled_us;  // Measured settle time of the trial retune (0 = settling)
+    uint32_t           freq_shift_sum;         // Sum of active rssi_norm over the window
+    uint16_t           freq_shift_samples;     // Samples in freq_shift_sum
     uint32_t           freq_shift_hold_end_ms; // When the accepted hold expires
     uint32_t           freq_shift_cooldown_ms; // Don't re-trigger until this timestamp
     uint8_t            freq_shift_baseline;    // rssi_norm of active RX at trigger time
@@ -158,20 +238,48 @@ typedef struct {
     uint32_t low_signal_beep_ms;   // Timestamp of last low-signal beep (ms)
 
     // Telemetry
-    int8_t rssi_delta;             // RSSI_A - RSSI_B (signed)
+    int8_t rssi_delta;             // rssi_norm of RX A - RX B (signed)
     uint8_t switches_per_min;      // Recent switch rate
     
 } diversity_state_t;
 
-// Global mode parameters (defined in diversity.c)
-extern const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_COUNT];
+/**
+ * @brief Coherent copy of the UI / telemetry fields (diversity_get_snapshot()).
+ *        The diversity task publishes one at the end of every decision; read
+ *        this from other tasks rather than diversity_get_state(), whose
+ *        fields change one by one while they are read.
+ */
+typedef struct {
+    uint32_t seq;                  // Snapshots published since diversity_init() (0 = none)
+    uint32_t t_ms;                 // Time of the sample the decision was made on
+    diversity_mode_t mode;
+    diversity_rx_t active_rx;
+    uint8_t  rssi_norm[DIVERSITY_NUM_RX];
+    uint8_t  score[DIVERSITY_NUM_RX];      // combined_score, bonuses included
+    bool     healthy[DIVERSITY_NUM_RX];    // Not disabled, stuck low or without variance
+    uint8_t  fading[DIVERSITY_NUM_RX];     // rssi_fading_regime_t
+    int8_t   rssi_delta;           // rssi_norm of RX A - RX B
+    bool     in_cooldown;
+    uint16_t rate_hz;              // Evaluation rate the controller picked
+    uint32_t switch_count;
+    uint32_t switches_last_minute;
+    uint32_t time_stable_ms;
+    uint32_t longest_stable_ms;
+    freq_shift_state_t freq_shift_state;
+    int8_t   freq_shift_offset;    // MHz
+} diversity_snapshot_t;
+
+// Built-in mode parameters (defined in diversity.c); use diversity_get_mode_params()
+// for any mode, custom slots included
+extern const diversity_mode_params_t diversity_mode_params[DIVERSITY_MODE_BUILTIN_COUNT];
 
 // Core API functions
 void diversity_init(void);
 void diversity_set_mode(diversity_mode_t mode);
-void diversity_update(void); // Call at DIVERSITY_SAMPLE_RATE_HZ
+void diversity_update(void); // Diversity task, on each frame diversity_frame_cb() reports due
 diversity_rx_t diversity_get_active_rx(void);
-diversity_state_t* diversity_get_state(void);
+diversity_state_t* diversity_get_state(void);      // Owned by the diversity task
+bool diversity_get_snapshot(diversity_snapshot_t* out);
 
 // RSSI calibration — incremental (non-blocking) API
 #define DIVERSITY_CALIB_SAMPLES 50          // 50 × 50ms = 2.5 s per phase on a single channel
@@ -187,11 +295,38 @@ uint32_t diversity_get_switch_count(void);
 uint32_t diversity_get_switches_per_minute(void);
 uint32_t diversity_get_time_stable_ms(void);
 void diversity_reset_stats(void);
+void diversity_get_latency(diversity_latency_t* out);
+void diversity_reset_latency(void);
+uint32_t diversity_latency_percentile(const uint32_t hist[DIVERSITY_LATENCY_BUCKETS], uint32_t max_us, uint8_t pct);
+uint32_t diversity_latency_count(const uint32_t hist[DIVERSITY_LATENCY_BUCKETS]);
+void diversity_print_latency(void);
+void diversity_set_predictor(diversity_mode_t mode, diversity_predictor_t predictor);
+diversity_predictor_t diversity_get_predictor(diversity_mode_t mode);
+
+// Mode profiles: built-ins plus custom slots (diversity_profile.h)
+const diversity_mode_params_t* diversity_get_mode_params(diversity_mode_t mode);
+bool diversity_mode_available(diversity_mode_t mode);
+diversity_mode_t diversity_next_mode(diversity_mode_t mode, int dir);
+int  diversity_set_custom_profiles(const diversity_mode_params_t* params, int count);
+bool diversity_profiles_store(const uint8_t* blob, size_t len);
+void diversity_profiles_load(void);
+
+// Per-frequency calibration map (rssi_calmap.h), used instead of cal[] once valid
+bool diversity_calmap_sweep_start(void);
+bool diversity_calmap_sweep_running(void);
+bool diversity_calmap_valid(void);
+void diversity_calmap_clear(void);
+
+// Shadow evaluation of other modes on the live samples (no antenna switching)
+void diversity_shadow_set(int slot, diversity_mode_t mode);    // DIVERSITY_MODE_COUNT disables the slot
+void diversity_shadow_reset(void);
+void diversity_shadow_get_stats(diversity_shadow_stats_t out[1 + DIVERSITY_SHADOW_MAX]);  // [0] = live
 
 // Internal functions (exposed for testing)
 uint8_t diversity_normalize_rssi(uint16_t raw, rssi_calibration_t* cal);
 void diversity_calculate_scores(diversity_rx_state_t* rx, const diversity_mode_params_t* params);
-bool diversity_should_switch(diversity_state_t* state, const diversity_mode_params_t* params, uint32_t now);
+bool diversity_should_switch(diversity_state_t* state, const diversity_mode_params_t* params, uint32_t now,
+                             diversity_rx_t* target);
 void diversity_check_receiver_health(diversity_rx_state_t* rx, uint32_t now);
 
 #endif // __DIVERSITY_H
@@ -0,0 +1,162 @@
+/**
+ * @file diversity_profile.c
+ * @brief Serialised custom diversity mode profiles ("profile blob")
+ */
+
+#include "diversity_profile.h"
+#include <string.h>
+
+// Entry field offsets
+#define ENT_DWELL       0
+#define ENT_COOLDOWN    2
+#define ENT_HYSTERESIS  4
+#define ENT_PREDICTOR   5
+#define ENT_W_RSSI      6
+#define ENT_W_STAB      8
+#define ENT_SLOPE       10
+#define ENT_KF_ALPHA    12
+#define ENT_KF_BETA     16
+#define ENT_PREDICT_MS  20
+#define ENT_NAME        22
+#define ENT_RATE_MIN    (ENT_NAME + DIVERSITY_PROFILE_NAME_LEN)
+#define ENT_RATE_MAX    (ENT_RATE_MIN + 2)
+#define ENT_FLUTTER_W   (ENT_RATE_MAX + 2)
+#define ENT_FLUTTER_DWELL (ENT_FLUTTER_W + 2)
+
+static void put_le(uint8_t* p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_le(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/**
+ * @brief Parameters diversity_update() can run safely with.  Ranges are
+ *        wide on purpose: they reject corrupt or mistyped blobs, not
+ *        unusual tuning.
+ */
+bool diversity_profile_valid(const diversity_mode_params_t* p)
+{
+    return p->dwell_ms >= 10 && p->dwell_ms <= 5000 &&
+           p->cooldown_ms >= p->dwell_ms && p->cooldown_ms <= 10000 &&
+           p->hysteresis_pct <= 50 &&
+           p->weight_rssi <= 32768 && p->weight_stability <= 32768 &&
+           (uint32_t)p->weight_rssi + p->weight_stability <= 32768 + 2 &&  // Q15 rounding
+           p->slope_threshold < 0 &&
+           p->predictor < DIVERSITY_PREDICT_COUNT &&
+           p->kf_alpha > 0 && p->kf_alpha <= DIVERSITY_Q16_ONE &&
+           p->kf_beta > 0 && p->kf_beta <= 2 * DIVERSITY_Q16_ONE &&
+           p->predict_ms <= 500 &&
+           p->rate_min_hz >= 5 && p->rate_min_hz <= p->rate_max_hz && p->rate_max_hz <= 1000 &&
+           p->flutter_weight_stability <= (uint32_t)p->weight_rssi + p->weight_stability &&
+           p->flutter_dwell_pct >= 10 && p->flutter_dwell_pct <= 200;
+}
+
+/**
+ * @brief Serialise @p count profiles (at most DIVERSITY_CUSTOM_PROFILES)
+ * @return Blob size, or 0 if it does not fit in @p cap
+ */
+size_t diversity_profile_encode(const diversity_profile_t* profiles, int count, uint8_t* out, size_t cap)
+{
+    size_t len = DIVERSITY_PROFILE_HDR_SIZE + (size_t)count * DIVERSITY_PROFILE_ENTRY_SIZE;
+    if (count < 0 || count > DIVERSITY_CUSTOM_PROFILES || len > cap) {
+        return 0;
+    }
+    memset(out, 0, len);
+    memcpy(out, DIVERSITY_PROFILE_MAGIC, 4);
+    put_le(out + 4, DIVERSITY_PROFILE_VERSION, 2);
+    out[6] = (uint8_t)count;
+
+    for (int i = 0; i < count; i++) {
+        const diversity_mode_params_t* p = &profiles[i].params;
+        uint8_t* e = out + DIVERSITY_PROFILE_HDR_SIZE + i * DIVERSITY_PROFILE_ENTRY_SIZE;
+        put_le(e + ENT_DWELL, p->dwell_ms, 2);
+        put_le(e + ENT_COOLDOWN, p->cooldown_ms, 2);
+        e[ENT_HYSTERESIS] = p->hysteresis_pct;
+        e[ENT_PREDICTOR]  = (uint8_t)p->predictor;
+        put_le(e + ENT_W_RSSI, p->weight_rssi, 2);
+        put_le(e + ENT_W_STAB, p->weight_stability, 2);
+        put_le(e + ENT_SLOPE, (uint16_t)p->slope_threshold, 2);
+        put_le(e + ENT_KF_ALPHA, p->kf_alpha, 4);
+        put_le(e + ENT_KF_BETA, p->kf_beta, 4);
+        put_le(e + ENT_PREDICT_MS, p->predict_ms, 2);
+        strncpy((char*)e + ENT_NAME, profiles[i].name, DIVERSITY_PROFILE_NAME_LEN - 1);
+        put_le(e + ENT_RATE_MIN, p->rate_min_hz, 2);
+        put_le(e + ENT_RATE_MAX, p->rate_max_hz, 2);
+        put_le(e + ENT_FLUTTER_W, p->flutter_weight_stability, 2);
+        e[ENT_FLUTTER_DWELL] = p->flutter_dwell_pct;
+    }
+    return len;
+}
+
+/**
+ * @brief Parse a blob (version 1 to 3) into @p out (up to @p max entries)
+ * @return Profiles decoded, or -1 if the blob is malformed or any entry
+ *         fails diversity_profile_valid()
+ */
+int diversity_profile_decode(const uint8_t* blob, size_t len, diversity_profile_t* out, int max)
+{
+    if (len < DIVERSITY_PROFILE_HDR_SIZE || memcmp(blob, DIVERSITY_PROFILE_MAGIC, 4) != 0) {
+        return -1;
+    }
+    uint32_t version = get_le(blob + 4, 2);
+    if (version < 1 || version > DIVERSITY_PROFILE_VERSION) {
+        return -1;
+    }
+    size_t entry = (version == 1) ? DIVERSITY_PROFILE_ENTRY_SIZE_V1
+                 : (version == 2) ? DIVERSITY_PROFILE_ENTRY_SIZE_V2 : DIVERSITY_PROFILE_ENTRY_SIZE;
+    int count = blob[6];
+    if (count > max || len != DIVERSITY_PROFILE_HDR_SIZE + (size_t)count * entry) {
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const uint8_t* e = blob + DIVERSITY_PROFILE_HDR_SIZE + i * entry;
+        diversity_profile_t* pr = &out[i];
+        memset(pr, 0, sizeof(*pr));
+        pr->params.dwell_ms         = get_le(e + ENT_DWELL, 2);
+        pr->params.cooldown_ms      = get_le(e + ENT_COOLDOWN, 2);
+        pr->params.hysteresis_pct   = e[ENT_HYSTERESIS];
+        pr->params.predictor        = (diversity_predictor_t)e[ENT_PREDICTOR];
+        pr->params.weight_rssi      = (uint16_t)get_le(e + ENT_W_RSSI, 2);
+        pr->params.weight_stability = (uint16_t)get_le(e + ENT_W_STAB, 2);
+        pr->params.slope_threshold  = (int16_t)get_le(e + ENT_SLOPE, 2);
+        pr->params.kf_alpha         = get_le(e + ENT_KF_ALPHA, 4);
+        pr->params.kf_beta          = get_le(e + ENT_KF_BETA, 4);
+        pr->params.predict_ms       = (uint16_t)get_le(e + ENT_PREDICT_MS, 2);
+        if (version == 1) {
+            pr->params.rate_min_hz  = DIVERSITY_PROFILE_V1_RATE_MIN_HZ;
+            pr->params.rate_max_hz  = DIVERSITY_PROFILE_V1_RATE_MAX_HZ;
+        } else {
+            pr->params.rate_min_hz  = (uint16_t)get_le(e + ENT_RATE_MIN, 2);
+            pr->params.rate_max_hz  = (uint16_t)get_le(e + ENT_RATE_MAX, 2);
+        }
+        if (version < 3) {
+            pr->params.flutter_weight_stability = pr->params.weight_stability;
+            pr->params.flutter_dwell_pct        = 100;
+        } else {
+            pr->params.flutter_weight_stability = (uint16_t)get_le(e + ENT_FLUTTER_W, 2);
+            pr->params.flutter_dwell_pct        = e[ENT_FLUTTER_DWELL];
+        }
+        memcpy(pr->name, e + ENT_NAME, DIVERSITY_PROFILE_NAME_LEN - 1);
+        pr->name[DIVERSITY_PROFILE_NAME_LEN - 1] = '\0';
+        if (pr->name[0] == '\0') {
+            pr->name[0] = 'C';
+            pr->name[1] = (char)('1' + i);
+        }
+        pr->params.name = pr->name;
+        if (!diversity_profile_valid(&pr->params)) {
+            return -1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file diversity_profile.h
+ * @brief Serialised custom diversity mode profiles ("profile blob")
+ *
+ * Custom profiles are produced off-target by sim/diversity_opt from
+ * recorded RSSI traces and stored in NVS as a single blob, which
+ * diversity.c loads into the DIVERSITY_MODE_CUSTOM_n slots next to the
+ * three built-in modes.  Layout, little endian, fixed width so the host
+ * tool and the firmware agree whatever their struct packing:
+ *
+ *     char magic[4] "DVPF"   u16 version (3)   u8 count   u8 reserved
+ *     count x entry:
+ *       u16 dwell_ms        u16 cooldown_ms     u8 hysteresis_pct
+ *       u8  predictor       u16 weight_rssi     u16 weight_stability
+ *       i16 slope_threshold u32 kf_alpha        u32 kf_beta
+ *       u16 predict_ms      char name[DIVERSITY_PROFILE_NAME_LEN]
+ *       u16 rate_min_hz     u16 rate_max_hz                      (version 2)
+ *       u16 flutter_weight_stability                             (version 3)
+ *       u8  flutter_dwell_pct   u8 reserved
+ *
+ * Version 1 entries stop after the name; they decode with the 20 / 100 Hz
+ * evaluation rates every mode ran at before the rate controller.  Version
+ * 1 and 2 entries decode with the flutter fields neutral (the entry's own
+ * stability weight, 100 % dwell), as they ran before the fading analysis.
+ *
+ * NVS checksums every blob itself, so the format carries no CRC.
+ */
+
+#ifndef __DIVERSITY_PROFILE_H
+#define __DIVERSITY_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "diversity.h"
+
+#define DIVERSITY_PROFILE_MAGIC     "DVPF"
+#define DIVERSITY_PROFILE_VERSION   3
+#define DIVERSITY_PROFILE_NAME_LEN  12      // Including the terminator
+#define DIVERSITY_PROFILE_HDR_SIZE  8
+#define DIVERSITY_PROFILE_ENTRY_SIZE_V1 (22 + DIVERSITY_PROFILE_NAME_LEN)
+#define DIVERSITY_PROFILE_ENTRY_SIZE_V2 (DIVERSITY_PROFILE_ENTRY_SIZE_V1 + 4)
+#define DIVERSITY_PROFILE_ENTRY_SIZE (DIVERSITY_PROFILE_ENTRY_SIZE_V2 + 4)
+#define DIVERSITY_PROFILE_V1_RATE_MIN_HZ 20
+#define DIVERSITY_PROFILE_V1_RATE_MAX_HZ 100
+#define DIVERSITY_PROFILE_BLOB_MAX  (DIVERSITY_PROFILE_HDR_SIZE + \
+                                     DIVERSITY_CUSTOM_PROFILES * DIVERSITY_PROFILE_ENTRY_SIZE)
+
+/** @brief One decoded profile; params.name points at name[] */
+typedef struct {
+    diversity_mode_params_t params;
+    char name[DIVERSITY_PROFILE_NAME_LEN];
+} diversity_profile_t;
+
+size_t diversity_profile_encode(const diversity_profile_t* profiles, int count, uint8_t* out, size_t cap);
+int    diversity_profile_decode(const uint8_t* blob, size_t len, diversity_profile_t* out, int max);
+bool   diversity_profile_valid(const diversity_mode_params_t* p);
+
+#endif // __DIVERSITY_PROFILE_H
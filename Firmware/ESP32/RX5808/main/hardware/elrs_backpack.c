@@ -322,8 +322,9 @@ static void handle_msp_set_vtx_config(const uint8_t *payload, uint16_t length) {
             // Look up actual frequency from band/channel table
             uint16_t frequency = Rx5808_Freq[band][channel];
             
-            // CRITICAL: Tune RX5808 hardware to new frequency (includes 50ms PLL settling)
-            RX5808_Set_Freq(frequency);
+            // Tune RX5808 hardware to new frequency. Asynchronous: PLL settling is
+            // tracked by the driver, so channel_mutex is never held across it.
+            RX5808_Tune_Async(frequency, NULL);
             
             // Update channel variables for GUI
             Rx5808_Set_Channel(channel_index);
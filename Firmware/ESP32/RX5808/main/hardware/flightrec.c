@@ -0,0 +1,360 @@
+/**
+ * @file flightrec.c
+ * @brief RSSI / diversity flight recorder
+ */
+
+#include "flightrec.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_partition.h"
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+
+static const char* TAG = "flightrec";
+
+#define FLIGHTREC_RAM_BLOCKS        CONFIG_FLIGHT_RECORDER_RAM_BLOCKS
+#define FLIGHTREC_PART_SUBTYPE      0x40
+#define FLIGHTREC_PART_LABEL        "flightrec"
+#define FLIGHTREC_CONSOLE_UART      CONFIG_ESP_CONSOLE_UART_NUM
+#define FLIGHTREC_CLOSE_TIMEOUT_MS  500     // Diversity runs at >= 5 Hz (rate_min_hz)
+#define FLIGHTREC_DRAIN_TIMEOUT_MS  2000
+#define FLIGHTREC_LANDED_NORM       15      // rssi_norm below this on both RX = no link (diversity low-signal alert)
+#define FLIGHTREC_LANDED_MS         3000    // Link lost this long = landed, flash writes allowed
+
+// RAM block states.  The diversity task moves FREE/SEALED → FILLING → FULL,
+// and recycles the oldest FULL block (FULL → FILLING) when none is free.
+// The flusher claims a FULL block (FULL → WRITING) and then releases it as
+// FREE (written to flash) or SEALED (RAM only, kept as history until the
+// producer recycles it).  FULL is the only state both sides leave, so those
+// transitions are compare-and-swaps.
+enum {
+    BLOCK_FREE = 0,
+    BLOCK_FILLING,
+    BLOCK_FULL,
+    BLOCK_WRITING,
+    BLOCK_SEALED,
+};
+
+static uint8_t s_ram[FLIGHTREC_RAM_BLOCKS][FLIGHTREC_BLOCK_SIZE];
+static volatile uint8_t s_state[FLIGHTREC_RAM_BLOCKS];
+
+// Producer (diversity task) side
+static flightrec_block_t s_enc;
+static int8_t   s_fill = -1;                // RAM block being filled, -1 = none
+static uint8_t  s_next = 0;                 // RAM block to fill next
+static uint32_t s_seq = 0;                  // Next block seq
+static uint16_t s_boot = 0;
+static volatile bool s_close_request = false;   // Dump: close the partial block
+static volatile bool s_paused = false;          // Dump in progress: drop samples
+static volatile bool s_landed = false;          // Link lost for FLIGHTREC_LANDED_MS: not recording
+static uint32_t s_weak_since_ms = 0;            // Start of the current no-link stretch
+
+// Flusher side
+static const esp_partition_t* s_part = NULL;
+static uint32_t s_flash_next = 0;           // Sector the next block goes to (= oldest)
+static volatile bool s_flush_force = false;     // Dump: write to flash regardless of the link
+static TaskHandle_t s_flush_task = NULL;
+
+static flightrec_stats_t s_stats;
+
+/**
+ * @brief Find the newest block in the partition and continue after it
+ */
+static void flightrec_scan_flash(void)
+{
+    uint8_t hdr[FLIGHTREC_HDR_SIZE];
+    uint32_t sectors = s_part->size / FLIGHTREC_BLOCK_SIZE;
+    uint32_t newest_seq = 0;
+    uint16_t newest_boot = 0;
+    bool any = false;
+
+    for (uint32_t i = 0; i < sectors; i++) {
+        uint32_t seq;
+        uint16_t boot;
+        if (esp_partition_read(s_part, i * FLIGHTREC_BLOCK_SIZE, hdr, sizeof(hdr)) != ESP_OK ||
+            !flightrec_block_valid(hdr, &seq, &boot)) {
+            continue;
+        }
+        if (!any || (int32_t)(seq - newest_seq) > 0) {
+            newest_seq   = seq;
+            newest_boot  = boot;
+            s_flash_next = (i + 1) % sectors;
+            any = true;
+        }
+    }
+    s_stats.flash_blocks = sectors;
+    s_seq  = any ? newest_seq + 1 : 1;
+    s_boot = any ? (uint16_t)(newest_boot + 1) : 1;
+}
+
+static void flightrec_write_flash(const uint8_t* buf)
+{
+    uint32_t len = flightrec_block_used(buf);
+    uint32_t offset = s_flash_next * FLIGHTREC_BLOCK_SIZE;
+
+    // Erase right before writing: a block is only ever lost to its successor
+    if (esp_partition_erase_range(s_part, offset, FLIGHTREC_BLOCK_SIZE) != ESP_OK ||
+        esp_partition_write(s_part, offset, buf, len) != ESP_OK) {
+        s_stats.flash_errors++;
+    } else {
+        s_stats.blocks_flushed++;
+    }
+    s_flash_next = (s_flash_next + 1) % s_stats.flash_blocks;
+}
+
+// Flusher: the full RAM block with the lowest seq, -1 if none
+static int flightrec_oldest_full(void)
+{
+    int oldest = -1;
+    uint32_t oldest_seq = 0;
+    for (int b = 0; b < FLIGHTREC_RAM_BLOCKS; b++) {
+        if (__atomic_load_n(&s_state[b], __ATOMIC_ACQUIRE) != BLOCK_FULL) {
+            continue;
+        }
+        uint32_t seq;
+        uint16_t boot;
+        if (flightrec_block_valid(s_ram[b], &seq, &boot) && (oldest < 0 || (int32_t)(seq - oldest_seq) < 0)) {
+            oldest     = b;
+            oldest_seq = seq;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * @brief Seal full RAM blocks and write them out, oldest first.
+ *
+ * A flash erase or program disables the caches of both cores for its whole
+ * duration (tens of ms per sector erase): any code or data not in IRAM/DRAM
+ * stalls, and the ADC driver, the RF service and the diversity task are not
+ * IRAM-safe end to end.  So in flight full blocks stay in RAM, and the
+ * oldest one is recycled when the diversity task needs room; the flash is
+ * only written once the link has been lost for FLIGHTREC_LANDED_MS (crash
+ * or landing, when a stalled decision costs nothing) or on "frdump".  A
+ * block already being written when the link comes back still completes.
+ * Recording stops on landing, so only the blocks held then are written.
+ * Without the partition, blocks are only sealed in RAM, which never stalls.
+ */
+static void flightrec_flush_task(void* param)
+{
+    (void)param;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int b;
+        while ((s_part == NULL || s_landed || s_flush_force) && (b = flightrec_oldest_full()) >= 0) {
+            uint8_t expect = BLOCK_FULL;
+            if (!__atomic_compare_exchange_n(&s_state[b], &expect, BLOCK_WRITING, false,
+                                             __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                continue;       // Recycled by the producer meanwhile
+            }
+            flightrec_block_seal(s_ram[b]);
+            if (s_part != NULL) {
+                flightrec_write_flash(s_ram[b]);
+            }
+            __atomic_store_n(&s_state[b], (s_part != NULL) ? BLOCK_FREE : BLOCK_SEALED, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+// Producer: close the block being filled and hand it to the flusher
+static IRAM_ATTR void flightrec_close_block(void)
+{
+    flightrec_block_finish(&s_enc);
+    __atomic_store_n(&s_state[s_fill], BLOCK_FULL, __ATOMIC_RELEASE);
+    s_fill = -1;
+    if (s_flush_task != NULL && (s_part == NULL || s_landed)) {
+        xTaskNotifyGive(s_flush_task);
+    }
+}
+
+// Producer: start the next RAM block, false if none is free
+static IRAM_ATTR bool flightrec_open_block(void)
+{
+    // Blocks are filled in turn, so s_next is the oldest: a sealed one (RAM
+    // only) is overwritten, a full one not yet in flash is given up
+    uint8_t state = __atomic_load_n(&s_state[s_next], __ATOMIC_ACQUIRE);
+    if (state == BLOCK_FULL) {
+        if (!__atomic_compare_exchange_n(&s_state[s_next], &state, BLOCK_FILLING, false,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            return false;       // The flusher claimed it first
+        }
+        s_stats.overwritten++;
+    } else if (state == BLOCK_FREE || state == BLOCK_SEALED) {
+        s_state[s_next] = BLOCK_FILLING;
+    } else {
+        return false;
+    }
+    s_fill = (int8_t)s_next;
+    s_next = (s_next + 1) % FLIGHTREC_RAM_BLOCKS;
+    flightrec_block_begin(&s_enc, s_ram[s_fill], s_seq++, s_boot);
+    return true;
+}
+
+// Producer: track whether the link is lost.  On landing the partial block
+// is closed, so the last seconds before it reach flash, and the flusher woken
+static IRAM_ATTR void flightrec_link_update(const flightrec_sample_t* s)
+{
+    if (s->norm[0] >= FLIGHTREC_LANDED_NORM || s->norm[1] >= FLIGHTREC_LANDED_NORM) {
+        s_weak_since_ms = s->t_ms;
+        s_landed = false;
+    } else if (!s_landed && s->t_ms - s_weak_since_ms >= FLIGHTREC_LANDED_MS) {
+        s_landed = true;
+        if (s_fill >= 0 && s_enc.count != 0) {
+            flightrec_close_block();
+        }
+        if (s_flush_task != NULL) {
+            xTaskNotifyGive(s_flush_task);
+        }
+    }
+}
+
+/**
+ * @brief Record one diversity sample.  Diversity task only (single producer);
+ *        RAM only, no locks — a few microseconds at most.
+ */
+IRAM_ATTR void flightrec_log(const flightrec_sample_t* s)
+{
+    uint32_t c0 = esp_cpu_get_cycle_count();
+
+    flightrec_link_update(s);
+
+    if (s_close_request) {
+        if (s_fill >= 0 && s_enc.count != 0) {
+            flightrec_close_block();
+        }
+        s_close_request = false;
+    }
+    if (s_paused) {
+        s_stats.dropped++;
+        return;
+    }
+    // Landed: nothing is recorded until the link returns.  A powered unit
+    // left on the ground would otherwise fill the partition with noise
+    // and overwrite the flight
+    if (s_landed) {
+        s_stats.parked++;
+        return;
+    }
+    if (s_fill < 0 && !flightrec_open_block()) {
+        s_stats.dropped++;
+        return;
+    }
+    if (!flightrec_block_append(&s_enc, s)) {
+        flightrec_close_block();
+        if (!flightrec_open_block() || !flightrec_block_append(&s_enc, s)) {
+            s_stats.dropped++;
+            return;
+        }
+    }
+    s_stats.records++;
+
+    uint32_t cycles = esp_cpu_get_cycle_count() - c0;
+    if (cycles > s_stats.log_max_cycles) {
+        s_stats.log_max_cycles = cycles;
+    }
+}
+
+void flightrec_get_stats(flightrec_stats_t* out)
+{
+    *out = s_stats;
+}
+
+static void flightrec_write_console(const void* data, size_t len)
+{
+    uart_write_bytes(FLIGHTREC_CONSOLE_UART, data, len);
+}
+
+static void flightrec_dump_block(const uint8_t* buf)
+{
+    uint32_t seq;
+    uint16_t boot;
+    if (flightrec_block_valid(buf, &seq, &boot)) {
+        flightrec_write_console(buf, flightrec_block_used(buf));
+    }
+}
+
+/**
+ * @brief "frdump": close the partial block, let the flusher drain, then
+ *        send every stored block oldest first.  Recording pauses meanwhile.
+ */
+void flightrec_dump(void)
+{
+    // Pause first, so no block is opened (or recycled) after the close
+    s_paused = true;
+    s_close_request = true;
+    for (int i = 0; i < FLIGHTREC_CLOSE_TIMEOUT_MS / 10 && s_close_request; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    // Everything still in RAM goes to flash now, link or not
+    s_flush_force = true;
+    if (s_flush_task != NULL) {
+        xTaskNotifyGive(s_flush_task);
+    }
+    for (int i = 0; i < FLIGHTREC_DRAIN_TIMEOUT_MS / 10; i++) {
+        bool pending = false;
+        for (int b = 0; b < FLIGHTREC_RAM_BLOCKS; b++) {
+            pending |= (s_state[b] == BLOCK_FULL || s_state[b] == BLOCK_WRITING);
+        }
+        if (!pending) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    static const char begin[] = "\nFRDUMP BEGIN\n";
+    static const char end[]   = "\nFRDUMP END\n";
+    flightrec_write_console(begin, sizeof(begin) - 1);
+    if (s_part != NULL) {
+        uint8_t* buf = malloc(FLIGHTREC_BLOCK_SIZE);
+        for (uint32_t i = 0; buf != NULL && i < s_stats.flash_blocks; i++) {
+            uint32_t sector = (s_flash_next + i) % s_stats.flash_blocks;
+            if (esp_partition_read(s_part, sector * FLIGHTREC_BLOCK_SIZE, buf, FLIGHTREC_BLOCK_SIZE) == ESP_OK) {
+                flightrec_dump_block(buf);
+            }
+        }
+        free(buf);
+    } else {
+        // RAM only: sealed blocks in seq order
+        for (int i = 0; i < FLIGHTREC_RAM_BLOCKS; i++) {
+            uint8_t b = (s_next + i) % FLIGHTREC_RAM_BLOCKS;
+            if (s_state[b] == BLOCK_SEALED) {
+                flightrec_dump_block(s_ram[b]);
+            }
+        }
+    }
+    flightrec_write_console(end, sizeof(end) - 1);
+    uart_wait_tx_done(FLIGHTREC_CONSOLE_UART, portMAX_DELAY);
+    s_flush_force = false;
+    s_paused = false;
+}
+
+void flightrec_print_stats(void)
+{
+    ESP_LOGI(TAG, "records %lu dropped %lu parked %lu overwritten %lu flushed %lu errors %lu flash %lu blocks, "
+             "boot %u seq %lu, log max %lu cycles, %s",
+             (unsigned long)s_stats.records, (unsigned long)s_stats.dropped, (unsigned long)s_stats.parked,
+             (unsigned long)s_stats.overwritten,
+             (unsigned long)s_stats.blocks_flushed, (unsigned long)s_stats.flash_errors,
+             (unsigned long)s_stats.flash_blocks, s_boot, (unsigned long)s_seq,
+             (unsigned long)s_stats.log_max_cycles, s_landed ? "landed" : "in flight");
+}
+
+void flightrec_init(void)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, FLIGHTREC_PART_SUBTYPE, FLIGHTREC_PART_LABEL);
+    if (s_part != NULL) {
+        flightrec_scan_flash();
+        ESP_LOGI(TAG, "Partition %lu KB, boot %u, resuming at sector %lu",
+                 (unsigned long)(s_part->size / 1024), s_boot, (unsigned long)s_flash_next);
+    } else {
+        s_seq  = 1;
+        s_boot = 1;
+        ESP_LOGW(TAG, "No '%s' partition - keeping the last %d blocks in RAM only",
+                 FLIGHTREC_PART_LABEL, FLIGHTREC_RAM_BLOCKS);
+    }
+
+    xTaskCreatePinnedToCore(flightrec_flush_task, "flightrec", 3072, NULL, 1, &s_flush_task, 1);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file flightrec.h
+ * @brief RSSI / diversity flight recorder
+ *
+ * The diversity task appends one sample per decision (raw and normalised
+ * RSSI A/B, active RX, combined scores, frequency-shift state) to a RAM
+ * block, bit-packed by flightrec_codec.c.  Full blocks are handed to a
+ * low-priority flusher that writes them to the "flightrec" data partition
+ * as a circular log: one block per sector, erased just before it is
+ * written and resumed after the newest sector on the next boot, so every
+ * sector wears at the same rate.  Without the partition the last few
+ * blocks are kept in RAM only.
+ *
+ * Flash erases stall both cores' caches, so nothing is written in flight:
+ * the RAM blocks hold the most recent history (the oldest is recycled when
+ * all are full) until the link has been lost for a few seconds — a crash
+ * or a landing — or "frdump" is typed.  Recording then stops until the
+ * link returns, so a unit left powered on the ground keeps the flight.
+ *
+ * Export: type "frdump" on the USB serial console (console.c).  The
+ * blocks are sent oldest first, raw, between "FRDUMP BEGIN" and "FRDUMP
+ * END" lines; log text in between is skipped by tools/flightrec_decode.py,
+ * which checks every block's CRC.  "frstat" prints the counters below.
+ */
+
+#ifndef __FLIGHTREC_H
+#define __FLIGHTREC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flightrec_codec.h"
+
+/** @brief Recorder counters (flightrec_get_stats()) */
+typedef struct {
+    uint32_t records;           // Samples appended since boot
+    uint32_t dropped;           // Samples lost: no free RAM block, or a dump in progress
+    uint32_t parked;            // Samples not recorded while landed (no link)
+    uint32_t overwritten;       // Full blocks recycled in flight before reaching flash
+    uint32_t blocks_flushed;    // Blocks written to flash since boot
+    uint32_t flash_errors;      // Failed erases / writes
+    uint32_t flash_blocks;      // Partition size in blocks (0 = RAM only)
+    uint32_t log_max_cycles;    // Worst flightrec_log() cost, CPU cycles
+} flightrec_stats_t;
+
+void flightrec_init(void);
+void flightrec_log(const flightrec_sample_t* s);
+void flightrec_get_stats(flightrec_stats_t* out);
+void flightrec_dump(void);          // "frdump" (console.c): blocks the caller until sent
+void flightrec_print_stats(void);   // "frstat"
+
+#endif // __FLIGHTREC_H
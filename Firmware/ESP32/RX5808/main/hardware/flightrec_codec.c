@@ -0,0 +1,186 @@
+/**
+ * @file flightrec_codec.c
+ * @brief Bit-packed delta encoding of flight recorder blocks
+ */
+
+#include "flightrec_codec.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define FLIGHTREC_HOT IRAM_ATTR
+#else
+#define FLIGHTREC_HOT
+#endif
+
+// Header field offsets
+#define HDR_MAGIC    0
+#define HDR_SEQ      4
+#define HDR_BOOT     8
+#define HDR_COUNT   10
+#define HDR_T0      12
+#define HDR_LEN     16
+#define HDR_VERSION 18
+#define HDR_CRC     20
+
+#define FLIGHTREC_MAX_DT_MS 32767       // Larger gaps start a new block (new t0)
+
+static void put_le(uint8_t* p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_le(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static FLIGHTREC_HOT void flightrec_put_bits(flightrec_block_t* b, uint32_t value, uint8_t n)
+{
+    b->bits  |= value << b->nbits;
+    b->nbits += n;
+    while (b->nbits >= 8) {
+        b->buf[b->pos++] = (uint8_t)b->bits;
+        b->bits >>= 8;
+        b->nbits -= 8;
+    }
+}
+
+static FLIGHTREC_HOT void flightrec_put_delta(flightrec_block_t* b, int32_t delta)
+{
+    uint32_t z = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);     // Zigzag
+    if (z == 0) {
+        flightrec_put_bits(b, 0, 2);
+    } else if (z < 16) {
+        flightrec_put_bits(b, 1 | (z << 2), 6);
+    } else if (z < 256) {
+        flightrec_put_bits(b, 2 | (z << 2), 10);
+    } else {
+        flightrec_put_bits(b, 3, 2);
+        flightrec_put_bits(b, z & 0xFFFF, 16);
+    }
+}
+
+/**
+ * @brief Start a new block in @p buf (FLIGHTREC_BLOCK_SIZE bytes)
+ */
+void flightrec_block_begin(flightrec_block_t* b, uint8_t* buf, uint32_t seq, uint16_t boot)
+{
+    memset(b, 0, sizeof(*b));
+    memset(buf, 0xFF, FLIGHTREC_HDR_SIZE);
+    b->buf = buf;
+    b->pos = FLIGHTREC_HDR_SIZE;
+    put_le(buf + HDR_MAGIC, FLIGHTREC_MAGIC, 4);
+    put_le(buf + HDR_SEQ, seq, 4);
+    put_le(buf + HDR_BOOT, boot, 2);
+    put_le(buf + HDR_VERSION, FLIGHTREC_VERSION, 2);
+}
+
+/**
+ * @brief Append one sample
+ * @return false if the block is full, or the sample is too far from the
+ *         previous one to encode (nothing written — finish the block and
+ *         append to the next one)
+ */
+FLIGHTREC_HOT bool flightrec_block_append(flightrec_block_t* b, const flightrec_sample_t* s)
+{
+    if (b->pos + FLIGHTREC_MAX_RECORD + 1 > FLIGHTREC_BLOCK_SIZE) {
+        return false;
+    }
+    if (b->count == 0) {
+        put_le(b->buf + HDR_T0, s->t_ms, 4);
+        b->prev_t_ms = s->t_ms;
+    }
+    uint32_t dt = s->t_ms - b->prev_t_ms;
+    if (dt > FLIGHTREC_MAX_DT_MS) {
+        return false;
+    }
+    b->prev_t_ms = s->t_ms;
+
+    int32_t v[FLIGHTREC_FIELDS] = {
+        (int32_t)dt,
+        s->raw[0],
+        s->raw[1],
+        s->norm[0],
+        s->norm[1],
+        s->score[0],
+        s->score[1],
+        (s->active_rx & 1) | ((s->freq_shift_state & 3) << 1) | (((s->freq_shift_offset + 1) & 3) << 3),
+    };
+    for (int i = 0; i < FLIGHTREC_FIELDS; i++) {
+        flightrec_put_delta(b, v[i] - b->prev[i]);
+        b->prev[i] = v[i];
+    }
+    b->count++;
+    return true;
+}
+
+/**
+ * @brief Flush the last partial byte and fill in count and length
+ * @return Bytes used, header included
+ */
+uint16_t flightrec_block_finish(flightrec_block_t* b)
+{
+    if (b->nbits != 0) {
+        b->buf[b->pos++] = (uint8_t)b->bits;
+        b->bits  = 0;
+        b->nbits = 0;
+    }
+    put_le(b->buf + HDR_COUNT, b->count, 2);
+    put_le(b->buf + HDR_LEN, (uint32_t)(b->pos - FLIGHTREC_HDR_SIZE), 2);
+    return b->pos;
+}
+
+/**
+ * @brief CRC-32 (IEEE 802.3, reflected), bitwise — only run by the flusher
+ */
+uint32_t flightrec_crc32(const uint8_t* data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Write the payload CRC of a finished block into its header
+ */
+void flightrec_block_seal(uint8_t* buf)
+{
+    uint32_t len = get_le(buf + HDR_LEN, 2);
+    put_le(buf + HDR_CRC, flightrec_crc32(buf + FLIGHTREC_HDR_SIZE, len), 4);
+}
+
+/**
+ * @brief Check a block header (magic, version, length) and return its ids.
+ *        The payload CRC is left to the decoder.
+ */
+bool flightrec_block_valid(const uint8_t* buf, uint32_t* seq, uint16_t* boot)
+{
+    if (get_le(buf + HDR_MAGIC, 4) != FLIGHTREC_MAGIC ||
+        get_le(buf + HDR_VERSION, 2) != FLIGHTREC_VERSION ||
+        get_le(buf + HDR_LEN, 2) > FLIGHTREC_BLOCK_SIZE - FLIGHTREC_HDR_SIZE) {
+        return false;
+    }
+    *seq  = get_le(buf + HDR_SEQ, 4);
+    *boot = (uint16_t)get_le(buf + HDR_BOOT, 2);
+    return true;
+}
+
+/**
+ * @brief Bytes used by a finished block, header included
+ */
+uint16_t flightrec_block_used(const uint8_t* buf)
+{
+    return (uint16_t)(FLIGHTREC_HDR_SIZE + get_le(buf + HDR_LEN, 2));
+}
@@ -0,0 +1,74 @@
+/**
+ * @file flightrec_codec.h
+ * @brief Bit-packed delta encoding of flight recorder blocks
+ *
+ * The recorder stores diversity samples in self-contained blocks of
+ * FLIGHTREC_BLOCK_SIZE bytes (one flash sector).  Every block is a fixed
+ * header followed by a bitstream of records:
+ *
+ *   header (little endian, FLIGHTREC_HDR_SIZE bytes)
+ *     u32 magic  'FRB1'      u32 seq     (block number, never reused)
+ *     u16 boot   (boot id)   u16 count   (records in the block)
+ *     u32 t0_ms  (time of the first record)
+ *     u16 len    (payload bytes)         u16 version
+ *     u32 crc32  (of the payload; filled in by the flusher, not the encoder)
+ *
+ *   record: FLIGHTREC_FIELDS fields, each the difference from the same field
+ *   of the previous record (zero at the start of a block), zigzag mapped and
+ *   written LSB first as a 2-bit class + payload:
+ *     0 → 0    1 → 4-bit value    2 → 8-bit value    3 → 16-bit value
+ *
+ * Field 0 is the change in the time step (ms), so a steady evaluation rate
+ * costs two bits and the rate controller's gradual changes six; a gap of
+ * more than 32 s starts a new block.  A typical sample packs into about 6
+ * bytes against 16 unpacked.  Switch and frequency-shift events are changes
+ * of the state field (active RX, shift FSM state and offset).
+ *
+ * Appending costs a few dozen integer operations and never touches the
+ * CRC, so it runs on the diversity decision path.
+ */
+
+#ifndef __FLIGHTREC_CODEC_H
+#define __FLIGHTREC_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLIGHTREC_BLOCK_SIZE    4096
+#define FLIGHTREC_HDR_SIZE      24
+#define FLIGHTREC_MAGIC         0x31425246u     // "FRB1"
+#define FLIGHTREC_VERSION       1
+#define FLIGHTREC_FIELDS        8
+#define FLIGHTREC_MAX_RECORD    ((FLIGHTREC_FIELDS * 18 + 7) / 8)   // Bytes, worst case
+
+/** @brief One recorded diversity sample */
+typedef struct {
+    uint32_t t_ms;              // Frame time (ms since boot)
+    uint16_t raw[2];            // Raw RSSI A/B (12-bit)
+    uint8_t  norm[2];           // Normalised RSSI A/B (0-100)
+    uint8_t  score[2];          // Combined score A/B (0-100, with bonuses)
+    uint8_t  active_rx;         // 0 = A, 1 = B
+    uint8_t  freq_shift_state;  // freq_shift_state_t
+    int8_t   freq_shift_offset; // -1, 0 or +1 MHz
+} flightrec_sample_t;
+
+/** @brief Block being filled */
+typedef struct {
+    uint8_t* buf;               // FLIGHTREC_BLOCK_SIZE bytes, owned by the caller
+    uint32_t bits;              // Bit accumulator
+    uint8_t  nbits;             // Valid bits in the accumulator
+    uint16_t pos;               // Next payload byte (from FLIGHTREC_HDR_SIZE)
+    uint16_t count;
+    uint32_t prev_t_ms;
+    int32_t  prev[FLIGHTREC_FIELDS];
+} flightrec_block_t;
+
+void     flightrec_block_begin(flightrec_block_t* b, uint8_t* buf, uint32_t seq, uint16_t boot);
+bool     flightrec_block_append(flightrec_block_t* b, const flightrec_sample_t* s);
+uint16_t flightrec_block_finish(flightrec_block_t* b);
+uint32_t flightrec_crc32(const uint8_t* data, uint32_t len);
+void     flightrec_block_seal(uint8_t* buf);
+bool     flightrec_block_valid(const uint8_t* buf, uint32_t* seq, uint16_t* boot);
+uint16_t flightrec_block_used(const uint8_t* buf);
+
+#endif // __FLIGHTREC_CODEC_H
@@ -0,0 +1,98 @@
+/**
+ * @file rf_mailbox.c
+ * @brief Lock-free latest-wins command mailbox for the RF service task
+ */
+
+#include "rf_mailbox.h"
+#include <string.h>
+
+// rf_mailbox_idle() is polled by RX5808_Is_Settled(), which the diversity
+// frame callback runs from IRAM
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RF_MAILBOX_HOT IRAM_ATTR
+#else
+#define RF_MAILBOX_HOT
+#endif
+
+#define RF_MAILBOX_TAKE_RETRIES 4   // Newer posts published while reading
+
+/**
+ * @brief Reset the mailbox (before any producer or the consumer runs)
+ */
+void rf_mailbox_init(rf_mailbox_t* mb)
+{
+    memset(mb, 0, sizeof(*mb));
+}
+
+/**
+ * @brief Post a command (any task, either core; never blocks)
+ * @return Ticket of the command (non-zero, increasing)
+ */
+uint32_t rf_mailbox_post(rf_mailbox_t* mb, const rf_cmd_t* cmd)
+{
+    uint32_t t = __atomic_add_fetch(&mb->next, 1, __ATOMIC_RELAXED);
+    if (t == 0) {
+        t = __atomic_add_fetch(&mb->next, 1, __ATOMIC_RELAXED);    // 0 means "empty slot"
+    }
+    uint32_t i = t % RF_MAILBOX_SLOTS;
+
+    __atomic_store_n(&mb->ticket[i], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    mb->cmd[i] = *cmd;
+    __atomic_store_n(&mb->ticket[i], t, __ATOMIC_RELEASE);
+
+    // Publish unless a newer post already has (latest only moves forward)
+    uint32_t cur = __atomic_load_n(&mb->latest, __ATOMIC_ACQUIRE);
+    while ((int32_t)(t - cur) > 0 &&
+           !__atomic_compare_exchange_n(&mb->latest, &cur, t, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+    }
+    return t;
+}
+
+/**
+ * @brief Take the newest command not yet taken (consumer only).
+ *        Older commands posted in between are skipped.
+ * @return false if there is nothing new, or the newest slot is being
+ *         rewritten (retry after the producer's wake-up)
+ */
+bool rf_mailbox_take(rf_mailbox_t* mb, rf_cmd_t* out, uint32_t* ticket)
+{
+    for (int n = 0; n < RF_MAILBOX_TAKE_RETRIES; n++) {
+        uint32_t t = __atomic_load_n(&mb->latest, __ATOMIC_ACQUIRE);
+        if (t == mb->done) {
+            return false;
+        }
+        uint32_t i = t % RF_MAILBOX_SLOTS;
+        if (__atomic_load_n(&mb->ticket[i], __ATOMIC_ACQUIRE) != t) {
+            continue;
+        }
+        rf_cmd_t c = mb->cmd[i];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&mb->ticket[i], __ATOMIC_RELAXED) != t) {
+            continue;
+        }
+        *out    = c;
+        *ticket = t;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Mark @p ticket (from rf_mailbox_take()) as in effect (consumer only)
+ */
+void rf_mailbox_done(rf_mailbox_t* mb, uint32_t ticket)
+{
+    __atomic_store_n(&mb->done, ticket, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief true when the newest posted command has been acted on
+ */
+RF_MAILBOX_HOT bool rf_mailbox_idle(const rf_mailbox_t* mb)
+{
+    return __atomic_load_n(&mb->latest, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&mb->done, __ATOMIC_ACQUIRE);
+}
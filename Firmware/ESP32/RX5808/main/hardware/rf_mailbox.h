@@ -0,0 +1,50 @@
+/**
+ * @file rf_mailbox.h
+ * @brief Lock-free latest-wins command mailbox for the RF service task
+ *
+ * Any number of producers on either core post commands; the single
+ * consumer (the RF service) only ever sees the most recent one — commands
+ * posted while an older one was still waiting replace it.  Producers never
+ * wait: a post claims a ticket with one atomic add, fills the slot the
+ * ticket maps to and publishes the ticket.
+ *
+ * Each slot carries the ticket it holds (0 while being written), so a
+ * consumer racing a producer that reuses the slot detects the torn copy.
+ * The consumer never spins on a half-written slot — it returns "nothing
+ * new" and picks the command up on the producer's wake-up instead.
+ *
+ * The consumer marks a ticket done only after it has acted on it, so
+ * rf_mailbox_idle() is true exactly when the last posted command is in
+ * effect.
+ */
+
+#ifndef __RF_MAILBOX_H
+#define __RF_MAILBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RF_MAILBOX_SLOTS    8       // Concurrent posters tolerated before a slot is reused mid-read
+
+/** @brief Command payload */
+typedef struct {
+    uint32_t arg;                   // Command argument (e.g. frequency)
+    void*    ptr;                   // Optional pointer (e.g. completion callback)
+} rf_cmd_t;
+
+/** @brief Mailbox storage */
+typedef struct {
+    rf_cmd_t          cmd[RF_MAILBOX_SLOTS];
+    volatile uint32_t ticket[RF_MAILBOX_SLOTS];     // Ticket held by the slot, 0 while being written
+    volatile uint32_t next;                         // Last claimed ticket
+    volatile uint32_t latest;                       // Newest published ticket
+    volatile uint32_t done;                         // Newest ticket the consumer has acted on
+} rf_mailbox_t;
+
+void     rf_mailbox_init(rf_mailbox_t* mb);
+uint32_t rf_mailbox_post(rf_mailbox_t* mb, const rf_cmd_t* cmd);
+bool     rf_mailbox_take(rf_mailbox_t* mb, rf_cmd_t* out, uint32_t* ticket);
+void     rf_mailbox_done(rf_mailbox_t* mb, uint32_t ticket);
+bool     rf_mailbox_idle(const rf_mailbox_t* mb);
+
+#endif // __RF_MAILBOX_H
@@ -0,0 +1,266 @@
+/**
+ * @file rssi_calmap.c
+ * @brief Per-frequency RSSI calibration map (floor/peak every 10 MHz)
+ */
+
+#include "rssi_calmap.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RSSI_CALMAP_HOT IRAM_ATTR
+#else
+#define RSSI_CALMAP_HOT
+#endif
+
+static void put_le16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t get_le16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+void rssi_calmap_clear(rssi_calmap_t* map)
+{
+    memset(map, 0, sizeof(*map));
+}
+
+static int rssi_calmap_cmp_u16(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+/**
+ * @brief Fold one sweep (bin means of both receivers) into the measured
+ *        points.  Bins more than RSSI_CALMAP_CARRIER_MARGIN above the
+ *        sweep's median on both receivers are carriers: the strongest one
+ *        becomes a peak point, and no floor is taken within
+ *        RSSI_CALMAP_GUARD_MHZ of any of them.  Every other measured bin is
+ *        a floor point.  Earlier points are kept where this sweep has none.
+ *
+ * @return Floor points taken, or -1 if too few bins were measured
+ */
+int rssi_calmap_merge_sweep(rssi_calmap_t* map, const uint16_t mean[RSSI_CALMAP_RX][RSSI_CALMAP_BINS],
+                            const bool measured[RSSI_CALMAP_BINS])
+{
+    uint16_t median[RSSI_CALMAP_RX];
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        uint16_t sorted[RSSI_CALMAP_BINS];
+        int n = 0;
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+            if (measured[b]) {
+                sorted[n++] = mean[rx][b];
+            }
+        }
+        if (n < RSSI_CALMAP_BINS / 2) {
+            return -1;
+        }
+        qsort(sorted, n, sizeof(sorted[0]), rssi_calmap_cmp_u16);
+        median[rx] = sorted[n / 2];
+    }
+
+    bool carrier[RSSI_CALMAP_BINS];
+    int strongest = -1;
+    uint32_t strongest_sum = 0;
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        carrier[b] = measured[b];
+        for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+            carrier[b] = carrier[b] && mean[rx][b] > median[rx] + RSSI_CALMAP_CARRIER_MARGIN;
+        }
+        uint32_t sum = (uint32_t)mean[0][b] + mean[1][b];
+        if (carrier[b] && sum > strongest_sum) {
+            strongest     = b;
+            strongest_sum = sum;
+        }
+    }
+
+    const int guard = RSSI_CALMAP_GUARD_MHZ / RSSI_CALMAP_STEP_MHZ;
+    int floors = 0;
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        if (!measured[b]) {
+            continue;
+        }
+        bool near_carrier = false;
+        for (int c = b - guard; c <= b + guard && !near_carrier; c++) {
+            near_carrier = c >= 0 && c < RSSI_CALMAP_BINS && carrier[c];
+        }
+        if (near_carrier) {
+            continue;
+        }
+        for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+            uint32_t f = mean[rx][b] + (uint32_t)mean[rx][b] * RSSI_CALMAP_FLOOR_MARGIN_PCT / 100;
+            map->meas_floor[rx][b] = (f == 0) ? 1 : (f > 4095 ? 4095 : (uint16_t)f);
+        }
+        floors++;
+    }
+    if (strongest >= 0) {
+        for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+            map->meas_peak[rx][strongest] = mean[rx][strongest];
+        }
+    }
+    return floors;
+}
+
+/**
+ * @brief Fill @p out[] from the non-zero points of @p pts[]: linear between
+ *        points, flat beyond the first and last
+ * @return false if there is no point
+ */
+static bool rssi_calmap_fill(const int32_t pts[RSSI_CALMAP_BINS], int32_t out[RSSI_CALMAP_BINS])
+{
+    int prev = -1;
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        if (pts[b] == 0) {
+            continue;
+        }
+        if (prev < 0) {
+            for (int i = 0; i < b; i++) {
+                out[i] = pts[b];
+            }
+        } else {
+            for (int i = prev + 1; i < b; i++) {
+                out[i] = pts[prev] + (pts[b] - pts[prev]) * (i - prev) / (b - prev);
+            }
+        }
+        out[b] = pts[b];
+        prev = b;
+    }
+    if (prev < 0) {
+        return false;
+    }
+    for (int i = prev + 1; i < RSSI_CALMAP_BINS; i++) {
+        out[i] = pts[prev];
+    }
+    return true;
+}
+
+/**
+ * @brief Rebuild the dense table from the measured points
+ *
+ * @param fallback_span Floor-to-peak span per receiver used when the map
+ *                      has no peak point (0 = none)
+ * @return map->valid: both receivers have floors and a usable span
+ */
+bool rssi_calmap_build(rssi_calmap_t* map, const uint16_t fallback_span[RSSI_CALMAP_RX])
+{
+    map->valid = false;
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        int32_t pts[RSSI_CALMAP_BINS], floor[RSSI_CALMAP_BINS], span[RSSI_CALMAP_BINS];
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+            pts[b] = map->meas_floor[rx][b];
+        }
+        if (!rssi_calmap_fill(pts, floor)) {
+            return false;
+        }
+
+        // Spans at the peak points, against the interpolated floor there
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+            int32_t s = map->meas_peak[rx][b] ? (int32_t)map->meas_peak[rx][b] - floor[b] : 0;
+            pts[b] = (s >= RSSI_CALMAP_MIN_SPAN) ? s : 0;
+        }
+        if (!rssi_calmap_fill(pts, span)) {
+            if (fallback_span[rx] < RSSI_CALMAP_MIN_SPAN) {
+                return false;
+            }
+            for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+                span[b] = fallback_span[rx];
+            }
+        }
+
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+            int32_t p = floor[b] + span[b];
+            map->floor[rx][b] = (uint16_t)floor[b];
+            map->peak[rx][b]  = (uint16_t)(p > 4095 ? 4095 : p);
+        }
+    }
+    map->valid = true;
+    return true;
+}
+
+/**
+ * @brief Floor and peak of receiver @p rx at @p freq, linear between the
+ *        two nearest bins (clamped to the map's range)
+ * @return false if the map is not valid
+ */
+RSSI_CALMAP_HOT bool rssi_calmap_lookup(const rssi_calmap_t* map, int rx, uint16_t freq,
+                                        uint16_t* floor, uint16_t* peak)
+{
+    if (!map->valid) {
+        return false;
+    }
+    int32_t off = (int32_t)freq - RSSI_CALMAP_MIN_MHZ;
+    if (off < 0) {
+        off = 0;
+    }
+    int32_t b    = off / RSSI_CALMAP_STEP_MHZ;
+    int32_t frac = off % RSSI_CALMAP_STEP_MHZ;
+    if (b >= RSSI_CALMAP_BINS - 1) {
+        *floor = map->floor[rx][RSSI_CALMAP_BINS - 1];
+        *peak  = map->peak[rx][RSSI_CALMAP_BINS - 1];
+        return true;
+    }
+    const uint16_t* f = &map->floor[rx][b];
+    const uint16_t* p = &map->peak[rx][b];
+    *floor = (uint16_t)(f[0] + ((int32_t)f[1] - f[0]) * frac / RSSI_CALMAP_STEP_MHZ);
+    *peak  = (uint16_t)(p[0] + ((int32_t)p[1] - p[0]) * frac / RSSI_CALMAP_STEP_MHZ);
+    return true;
+}
+
+/**
+ * @brief Serialise the measured points (the dense table is rebuilt on load)
+ * @return Blob size, or 0 if @p cap is too small
+ */
+size_t rssi_calmap_encode(const rssi_calmap_t* map, uint8_t* out, size_t cap)
+{
+    if (cap < RSSI_CALMAP_BLOB_SIZE) {
+        return 0;
+    }
+    memcpy(out, RSSI_CALMAP_MAGIC, 4);
+    put_le16(out + 4, RSSI_CALMAP_VERSION);
+    put_le16(out + 6, RSSI_CALMAP_BINS);
+    put_le16(out + 8, RSSI_CALMAP_MIN_MHZ);
+    put_le16(out + 10, RSSI_CALMAP_STEP_MHZ);
+    uint8_t* p = out + 12;
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++, p += 2) {
+            put_le16(p, map->meas_floor[rx][b]);
+        }
+    }
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++, p += 2) {
+            put_le16(p, map->meas_peak[rx][b]);
+        }
+    }
+    return RSSI_CALMAP_BLOB_SIZE;
+}
+
+/**
+ * @brief Load the measured points from a blob; the caller rebuilds
+ * @return false (map untouched) if the blob is not a map of this layout
+ */
+bool rssi_calmap_decode(rssi_calmap_t* map, const uint8_t* blob, size_t len)
+{
+    if (len != RSSI_CALMAP_BLOB_SIZE || memcmp(blob, RSSI_CALMAP_MAGIC, 4) != 0 ||
+        get_le16(blob + 4) != RSSI_CALMAP_VERSION || get_le16(blob + 6) != RSSI_CALMAP_BINS ||
+        get_le16(blob + 8) != RSSI_CALMAP_MIN_MHZ || get_le16(blob + 10) != RSSI_CALMAP_STEP_MHZ) {
+        return false;
+    }
+    rssi_calmap_clear(map);
+    const uint8_t* p = blob + 12;
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++, p += 2) {
+            map->meas_floor[rx][b] = get_le16(p);
+        }
+    }
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++, p += 2) {
+            map->meas_peak[rx][b] = get_le16(p);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file rssi_calmap.h
+ * @brief Per-frequency RSSI calibration map (floor/peak every 10 MHz)
+ *
+ * The RX5808 detector's floor and slope drift across 5.3-5.95 GHz, and not
+ * the same way on both modules, so a single floor/peak per receiver biases
+ * the A/B comparison on some bands.  The map holds a measured floor and
+ * peak per receiver at every RSSI_CALMAP_STEP_MHZ:
+ *
+ *   - floors come from a sweep (rssi_calmap_merge_sweep()): every bin away
+ *     from a carrier is one floor point;
+ *   - a peak exists only where a VTX was on during a sweep (the strongest
+ *     carrier bin), since one VTX is one channel.  Elsewhere the peak is
+ *     the local floor plus the floor-to-peak span interpolated from the bins
+ *     that have one, or the single-point calibration's span without any.
+ *
+ * rssi_calmap_build() turns the measured points into a dense table and
+ * rssi_calmap_lookup() interpolates it linearly between bins, integer only.
+ * rssi_calmap_encode()/decode() give the single NVS blob:
+ *
+ *     char magic[4] "DVCM"   u16 version (1)   u16 bins   u16 min_mhz   u16 step_mhz
+ *     u16 floor[2][bins]     u16 peak[2][bins]          (0 = not measured)
+ */
+
+#ifndef __RSSI_CALMAP_H
+#define __RSSI_CALMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define RSSI_CALMAP_MIN_MHZ     5300
+#define RSSI_CALMAP_STEP_MHZ    10
+#define RSSI_CALMAP_BINS        66      // 5300 .. 5950 MHz
+#define RSSI_CALMAP_RX          2
+#define RSSI_CALMAP_MIN_SPAN    50      // Floor-to-peak span below this is not a calibration
+
+#define RSSI_CALMAP_MAGIC       "DVCM"
+#define RSSI_CALMAP_VERSION     1
+#define RSSI_CALMAP_BLOB_SIZE   (12 + 2 * 2 * RSSI_CALMAP_RX * RSSI_CALMAP_BINS)
+
+// Sweep classification
+#define RSSI_CALMAP_CARRIER_MARGIN  400     // Bin mean this far above the sweep median = carrier
+#define RSSI_CALMAP_GUARD_MHZ       30      // No floor points this close to a carrier
+#define RSSI_CALMAP_FLOOR_MARGIN_PCT 8      // Floor = mean + 8 %, as diversity_calibrate_floor_finish()
+
+typedef struct {
+    // Measured points, raw 12-bit ADC counts (0 = not measured)
+    uint16_t meas_floor[RSSI_CALMAP_RX][RSSI_CALMAP_BINS];
+    uint16_t meas_peak[RSSI_CALMAP_RX][RSSI_CALMAP_BINS];
+    // Dense table (rssi_calmap_build())
+    uint16_t floor[RSSI_CALMAP_RX][RSSI_CALMAP_BINS];
+    uint16_t peak[RSSI_CALMAP_RX][RSSI_CALMAP_BINS];
+    bool     valid;
+} rssi_calmap_t;
+
+/** @brief Centre frequency of bin @p b */
+static inline uint16_t rssi_calmap_bin_freq(int b)
+{
+    return (uint16_t)(RSSI_CALMAP_MIN_MHZ + b * RSSI_CALMAP_STEP_MHZ);
+}
+
+void   rssi_calmap_clear(rssi_calmap_t* map);
+int    rssi_calmap_merge_sweep(rssi_calmap_t* map, const uint16_t mean[RSSI_CALMAP_RX][RSSI_CALMAP_BINS],
+                               const bool measured[RSSI_CALMAP_BINS]);
+bool   rssi_calmap_build(rssi_calmap_t* map, const uint16_t fallback_span[RSSI_CALMAP_RX]);
+bool   rssi_calmap_lookup(const rssi_calmap_t* map, int rx, uint16_t freq, uint16_t* floor, uint16_t* peak);
+size_t rssi_calmap_encode(const rssi_calmap_t* map, uint8_t* out, size_t cap);
+bool   rssi_calmap_decode(rssi_calmap_t* map, const uint8_t* blob, size_t len);
+
+#endif // __RSSI_CALMAP_H
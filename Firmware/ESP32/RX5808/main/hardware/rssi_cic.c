@@ -0,0 +1,96 @@
+/**
+ * @file rssi_cic.c
+ * @brief Integer CIC decimator + compensating FIR for oversampled RSSI
+ */
+
+#include "rssi_cic.h"
+#include <string.h>
+
+// Compensating FIR taps (sum = 16 → unity DC gain)
+#define CIC_FIR_EDGE   (-3)
+#define CIC_FIR_CENTER   22
+#define CIC_FIR_SHIFT     4
+
+/**
+ * @brief Reset a channel for decimation ratio @p decim
+ * @return false if @p decim is outside 1..RSSI_CIC_MAX_DECIM (channel left at R=1)
+ */
+bool rssi_cic_init(rssi_cic_t* c, uint16_t decim)
+{
+    bool ok = decim >= 1 && decim <= RSSI_CIC_MAX_DECIM;
+    memset(c, 0, sizeof(*c));
+    c->decim = ok ? decim : 1;
+    c->gain  = (uint32_t)c->decim * c->decim * c->decim;
+    return ok;
+}
+
+/**
+ * @brief Integrator stage — call once per input sample
+ */
+void rssi_cic_integrate(rssi_cic_t* c, uint16_t raw)
+{
+    // Modular arithmetic: integrator overflow cancels in the combs
+    c->integ[0] += raw;
+    c->integ[1] += c->integ[0];
+    c->integ[2] += c->integ[1];
+    c->last_raw = raw;
+}
+
+/**
+ * @brief Comb + FIR stage — call once every @c decim inputs
+ * @return 12-bit filtered output
+ */
+uint16_t rssi_cic_decimate(rssi_cic_t* c)
+{
+    uint32_t x = c->integ[RSSI_CIC_ORDER - 1];
+    for (int i = 0; i < RSSI_CIC_ORDER; i++) {
+        uint32_t y = x - c->comb[i];
+        c->comb[i] = x;
+        x = y;
+    }
+
+    // Normalise by R^3, keeping RSSI_CIC_FRAC_BITS of fraction for the FIR
+    int32_t cic = (int32_t)((((uint64_t)x << RSSI_CIC_FRAC_BITS) + c->gain / 2) / c->gain);
+
+    int32_t acc = CIC_FIR_EDGE * cic + CIC_FIR_CENTER * c->fir[0] + CIC_FIR_EDGE * c->fir[1];
+    c->fir[1] = c->fir[0];
+    c->fir[0] = cic;
+
+    // Combs need ORDER decimations to flush the start-up step, the FIR two more
+    if (c->primed < RSSI_CIC_ORDER + 2) {
+        c->primed++;
+        return c->last_raw;
+    }
+
+    // Undo FIR gain (>>4) and the CIC fraction (>>4), rounding to nearest
+    int32_t out = (acc + (1 << (CIC_FIR_SHIFT + RSSI_CIC_FRAC_BITS - 1))) >> (CIC_FIR_SHIFT + RSSI_CIC_FRAC_BITS);
+    if (out < 0)    out = 0;
+    if (out > 4095) out = 4095;
+    return (uint16_t)out;
+}
+
+/**
+ * @brief Standalone use: integrate one input, decimate every @c decim inputs
+ * @return true when @p out holds a new output sample
+ */
+bool rssi_cic_push(rssi_cic_t* c, uint16_t raw, uint16_t* out)
+{
+    rssi_cic_integrate(c, raw);
+    if (++c->phase < c->decim) {
+        return false;
+    }
+    c->phase = 0;
+    *out = rssi_cic_decimate(c);
+    return true;
+}
+
+/**
+ * @brief Group delay of CIC + FIR in microseconds
+ * @param input_period_us Input sample period of one channel
+ */
+uint32_t rssi_cic_group_delay_us(uint16_t decim, uint32_t input_period_us)
+{
+    // 3*(R-1)/2 + R input samples, computed in half-samples to keep the .5
+    uint32_t half_samples = (uint32_t)RSSI_CIC_ORDER * (decim - 1) + 2u * decim;
+    return (half_samples * input_period_us + 1) / 2;
+}
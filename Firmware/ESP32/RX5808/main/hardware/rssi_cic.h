@@ -0,0 +1,51 @@
+/**
+ * @file rssi_cic.h
+ * @brief Integer CIC decimator + compensating FIR for oversampled RSSI
+ *
+ * Third-order CIC (differential delay 1) decimating by R, followed by a
+ * 3-tap symmetric FIR that flattens the CIC passband droop:
+ *
+ *     y[n] = (-3 x[n] + 22 x[n-1] - 3 x[n-2]) / 16      (unity DC gain)
+ *
+ * Integrators and combs run in modular uint32 arithmetic — the output is
+ * exact as long as 12 + 3*log2(R) <= 32, i.e. R <= RSSI_CIC_MAX_DECIM.
+ * The normalised CIC output keeps 4 fractional bits into the FIR, so there
+ * is no float anywhere in the path.
+ *
+ * Group delay (input samples) = 3*(R-1)/2 for the CIC plus one output
+ * sample (R inputs) for the FIR centre tap.
+ *
+ * Channels that must decimate on a common boundary (RSSI0/RSSI1 in one
+ * frame) call rssi_cic_integrate() per input and rssi_cic_decimate() at
+ * the boundary; standalone use goes through rssi_cic_push().
+ */
+
+#ifndef __RSSI_CIC_H
+#define __RSSI_CIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_CIC_ORDER          3
+#define RSSI_CIC_MAX_DECIM    100       // 4095 * R^3 must fit in uint32 (R <= 101)
+#define RSSI_CIC_FRAC_BITS      4       // Fractional bits carried from the CIC into the FIR
+
+/** @brief One CIC + FIR channel */
+typedef struct {
+    uint32_t integ[RSSI_CIC_ORDER];
+    uint32_t comb[RSSI_CIC_ORDER];      // Previous comb inputs
+    int32_t  fir[2];                    // Previous two normalised CIC outputs (Q.4)
+    uint32_t gain;                      // R^3
+    uint16_t decim;                     // R
+    uint16_t phase;                     // Inputs since the last output (rssi_cic_push)
+    uint16_t last_raw;                  // Most recent input (output while priming)
+    uint8_t  primed;                    // Decimations run; output valid after RSSI_CIC_ORDER + 2
+} rssi_cic_t;
+
+bool     rssi_cic_init(rssi_cic_t* c, uint16_t decim);
+void     rssi_cic_integrate(rssi_cic_t* c, uint16_t raw);
+uint16_t rssi_cic_decimate(rssi_cic_t* c);
+bool     rssi_cic_push(rssi_cic_t* c, uint16_t raw, uint16_t* out);
+uint32_t rssi_cic_group_delay_us(uint16_t decim, uint32_t input_period_us);
+
+#endif // __RSSI_CIC_H
@@ -0,0 +1,71 @@
+/**
+ * @file rssi_decim.c
+ * @brief Decimator turning the interleaved continuous-ADC stream into frames
+ */
+
+#include "rssi_decim.h"
+#include <string.h>
+
+/**
+ * @brief Reset the decimator
+ * @param factor RSSI0 conversions per output frame (1..RSSI_CIC_MAX_DECIM)
+ * @return false if @p factor was out of range (decimator left at 1)
+ */
+bool rssi_decim_init(rssi_decim_t* d, uint16_t factor)
+{
+    memset(d, 0, sizeof(*d));
+    bool ok = rssi_cic_init(&d->cic[0], factor);
+    rssi_cic_init(&d->cic[1], d->cic[0].decim);
+    d->factor = d->cic[0].decim;
+    return ok;
+}
+
+/**
+ * @brief Accumulate one conversion.
+ *
+ * @param slot rssi_slot_t of the converted channel (others are ignored)
+ * @param raw  12-bit conversion result
+ * @param out  Receives the frame's value[] when one completes (t_us/seq
+ *             untouched — the caller timestamps it, the ring numbers it)
+ * @return true when @p out holds a completed frame
+ */
+bool rssi_decim_push(rssi_decim_t* d, uint8_t slot, uint16_t raw, rssi_frame_t* out)
+{
+    if (slot >= RSSI_SLOT_COUNT) {
+        return false;
+    }
+    if (slot == RSSI_SLOT_RSSI0 || slot == RSSI_SLOT_RSSI1) {
+        rssi_cic_integrate(&d->cic[slot - RSSI_SLOT_RSSI0], raw);
+    } else {
+        d->sum[slot] += raw;
+    }
+    d->count[slot]++;
+
+    if (slot != RSSI_SLOT_RSSI0 || d->count[RSSI_SLOT_RSSI0] < d->factor) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < RSSI_SLOT_COUNT; i++) {
+        if (i == RSSI_SLOT_RSSI0 || i == RSSI_SLOT_RSSI1) {
+            // RSSI1 is decimated on RSSI0's boundary, so both share one frame
+            // time.  The combs always advance so the next window stays
+            // aligned; conversions missing from the window are filled with
+            // the last one so the following outputs do not dip, and a window
+            // with no conversions just holds its value.
+            rssi_cic_t* c = &d->cic[i - RSSI_SLOT_RSSI0];
+            for (uint16_t n = d->count[i]; n < d->factor; n++) {
+                rssi_cic_integrate(c, c->last_raw);
+            }
+            uint16_t y = rssi_cic_decimate(c);
+            if (d->count[i] != 0) {
+                d->last[i] = y;
+            }
+        } else if (d->count[i] != 0) {
+            d->last[i] = (uint16_t)((d->sum[i] + d->count[i] / 2) / d->count[i]);
+        }
+        out->value[i] = d->last[i];
+        d->sum[i]   = 0;
+        d->count[i] = 0;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file rssi_decim.h
+ * @brief Decimator turning the interleaved continuous-ADC stream into frames
+ *
+ * The ADC scans RSSI0, RSSI1, VBAT and KEY round-robin at a fixed rate.
+ * Conversions are pushed one at a time (slot + raw value); every @c factor
+ * RSSI0 conversions a frame is emitted.  RSSI0/RSSI1 go through the integer
+ * CIC + compensating FIR in rssi_cic.c (both decimated on the same RSSI0
+ * boundary); VBAT and KEY are plain window means.  A slot that received
+ * no conversion (dropped DMA data) repeats its previous value; an RSSI
+ * window short of conversions is padded with the last one, so the CIC
+ * does not see the gap as a dip.
+ */
+
+#ifndef __RSSI_DECIM_H
+#define __RSSI_DECIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rssi_ring.h"
+#include "rssi_cic.h"
+
+/** @brief Decimator state */
+typedef struct {
+    rssi_cic_t cic[2];                  // RSSI0 / RSSI1
+    uint32_t sum[RSSI_SLOT_COUNT];      // VBAT / KEY window sums
+    uint16_t count[RSSI_SLOT_COUNT];
+    uint16_t last[RSSI_SLOT_COUNT];     // Previous output (fallback for empty slots)
+    uint16_t factor;                    // RSSI0 conversions per output frame
+} rssi_decim_t;
+
+bool rssi_decim_init(rssi_decim_t* d, uint16_t factor);
+bool rssi_decim_push(rssi_decim_t* d, uint8_t slot, uint16_t raw, rssi_frame_t* out);
+
+#endif // __RSSI_DECIM_H
@@ -0,0 +1,124 @@
+/**
+ * @file rssi_fading.c
+ * @brief RSSI fading-spectrum analysis (fixed-point Goertzel bank)
+ */
+
+#include "rssi_fading.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RSSI_FADING_HOT IRAM_ATTR
+#else
+#define RSSI_FADING_HOT
+#endif
+
+// DFT bin (cycles per block) of each filter
+static const uint8_t rssi_fading_bin_k[RSSI_FADING_BINS] = { 1, 2, 3, 4, 8, 16 };
+
+// 2·cos(2πk / RSSI_FADING_BLOCK), Q29
+static const int32_t rssi_fading_coeff[RSSI_FADING_BINS] = {
+    1073418433, 1072448455, 1070832474, 1068571464, 1053110176, 992008094
+};
+
+static const char* const rssi_fading_names[RSSI_FADING_COUNT] = {
+    "unknown", "steady", "slow", "flutter"
+};
+
+/**
+ * @brief Forget everything: the regime is unknown until a full block
+ */
+RSSI_FADING_HOT void rssi_fading_reset(rssi_fading_t* f)
+{
+    memset(f, 0, sizeof(*f));
+    f->regime = RSSI_FADING_UNKNOWN;
+}
+
+/**
+ * @brief Drop the current block (e.g. a retune transient in it) but keep
+ *        the smoothed powers and the regime
+ */
+RSSI_FADING_HOT void rssi_fading_restart(rssi_fading_t* f)
+{
+    for (int b = 0; b < RSSI_FADING_BINS; b++) {
+        f->s1[b] = 0;
+        f->s2[b] = 0;
+    }
+    f->n = 0;
+}
+
+/**
+ * @brief Bin powers of the finished block, smoothing and regime.
+ *        |X|² = s1² + s2² - c·s1·s2; a sinusoid of amplitude A on the bin
+ *        gives |X| = A·N/2, so A² = |X|² / 2^(2·log2(N) - 2).
+ */
+static RSSI_FADING_HOT void rssi_fading_finish(rssi_fading_t* f)
+{
+    uint32_t sum = 0, fast = 0;
+    for (int b = 0; b < RSSI_FADING_BINS; b++) {
+        int64_t s1 = f->s1[b], s2 = f->s2[b];
+        int64_t cross = ((rssi_fading_coeff[b] * s1) >> 29) * s2;
+        int64_t x2 = s1 * s1 + s2 * s2 - cross;
+        uint64_t p = (x2 > 0) ? (uint64_t)x2 >> (2 * RSSI_FADING_BLOCK_LOG2 - 2) : 0;
+        f->power[b] = (p > UINT32_MAX / RSSI_FADING_BINS) ? UINT32_MAX / RSSI_FADING_BINS : (uint32_t)p;
+        sum += f->power[b];
+        if (b >= RSSI_FADING_SLOW_BINS) {
+            fast += f->power[b];
+        }
+    }
+    uint32_t share = sum ? (uint32_t)(((uint64_t)fast << 8) / sum) : 0;
+
+    if (f->blocks == 0) {
+        f->total   = sum;
+        f->fast_q8 = (uint16_t)share;
+    } else {
+        f->total   = (uint32_t)((int64_t)f->total + (((int64_t)sum - f->total) >> RSSI_FADING_SMOOTH_LOG2));
+        f->fast_q8 = (uint16_t)(f->fast_q8 + (((int32_t)share - f->fast_q8) >> RSSI_FADING_SMOOTH_LOG2));
+    }
+    f->blocks++;
+
+    if (f->total < RSSI_FADING_STEADY_POWER) {
+        f->regime = RSSI_FADING_STEADY;
+    } else if (f->fast_q8 > RSSI_FADING_FLUTTER_ENTER ||
+               (f->regime == RSSI_FADING_FLUTTER && f->fast_q8 >= RSSI_FADING_FLUTTER_EXIT)) {
+        f->regime = RSSI_FADING_FLUTTER;
+    } else {
+        f->regime = RSSI_FADING_SLOW;
+    }
+    rssi_fading_restart(f);
+}
+
+/**
+ * @brief Feed one raw sample
+ * @return true if it completed a block (regime re-evaluated)
+ */
+RSSI_FADING_HOT bool rssi_fading_push(rssi_fading_t* f, uint16_t raw)
+{
+    if (f->n == 0) {
+        f->ref = raw;       // Bins k > 0 ignore the offset; removing it keeps the state small
+    }
+    int32_t x = (int32_t)raw - f->ref;
+    for (int b = 0; b < RSSI_FADING_BINS; b++) {
+        int32_t s = x + (int32_t)(((int64_t)rssi_fading_coeff[b] * f->s1[b]) >> 29) - f->s2[b];
+        f->s2[b] = f->s1[b];
+        f->s1[b] = s;
+    }
+    if (++f->n < RSSI_FADING_BLOCK) {
+        return false;
+    }
+    rssi_fading_finish(f);
+    return true;
+}
+
+/**
+ * @brief Centre frequency of bin @p bin at RSSI_FADING_RATE_HZ, in 0.1 Hz
+ */
+uint16_t rssi_fading_bin_hz_x10(int bin)
+{
+    return (uint16_t)((uint32_t)rssi_fading_bin_k[bin] * RSSI_FADING_RATE_HZ * 10 / RSSI_FADING_BLOCK);
+}
+
+const char* rssi_fading_name(rssi_fading_regime_t regime)
+{
+    return (regime < RSSI_FADING_COUNT) ? rssi_fading_names[regime] : "?";
+}
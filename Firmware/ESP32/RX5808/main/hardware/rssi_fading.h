@@ -0,0 +1,82 @@
+/**
+ * @file rssi_fading.h
+ * @brief RSSI fading-spectrum analysis (fixed-point Goertzel bank)
+ *
+ * The 200 ms window variance says how much a receiver's RSSI moves, not
+ * how fast: multipath flutter (notches every few tens of milliseconds,
+ * independent on each antenna) and a range fade or blockage (one slow
+ * trend) can have the same variance, but diversity should treat them
+ * differently.  This splits the movement by rate.
+ *
+ * Every raw sample of the 1 kHz frame stream goes through
+ * RSSI_FADING_BINS Goertzel filters; every RSSI_FADING_BLOCK samples
+ * (256 ms) each gives the power of its DFT bin as the squared amplitude
+ * of a sinusoid at that frequency:
+ *
+ *     bin k      1     2     3     4     8     16
+ *     Hz       3.9   7.8  11.7  15.6  31.3  62.5
+ *
+ * A fade or blockage is slower than one cycle per block: it shows as a
+ * trend, whose spectrum falls with 1/k², so its power is in bin 1.
+ * Flutter spreads it over the higher bins.  The fast share (bins 2..,
+ * over all bins) and the total power are smoothed over blocks and give
+ * the regime:
+ *
+ *   STEADY   total power below RSSI_FADING_STEADY_POWER (amplitude ~45 counts)
+ *   FLUTTER  fast share above RSSI_FADING_FLUTTER_ENTER, until it falls
+ *            below RSSI_FADING_FLUTTER_EXIT
+ *   SLOW     anything else
+ *
+ * The bins are placed for a 1 kHz stream; at another frame rate they scale
+ * with it, so the caller restarts the analysis (rssi_fading_reset()) on a
+ * gap instead of feeding it.  Per sample and bin: one 32x32->64 multiply.
+ * Coefficients are Q29, state is int32 ADC counts.
+ */
+
+#ifndef __RSSI_FADING_H
+#define __RSSI_FADING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_FADING_RATE_HZ         1000    // Sample rate the bins are placed for
+#define RSSI_FADING_BLOCK_LOG2      8
+#define RSSI_FADING_BLOCK           (1 << RSSI_FADING_BLOCK_LOG2)  // Samples per analysis block
+#define RSSI_FADING_BINS            6
+#define RSSI_FADING_SLOW_BINS       1       // Bins 0 .. SLOW_BINS-1 are the slow band
+
+// Classification (powers in ADC counts², shares Q8)
+#define RSSI_FADING_STEADY_POWER    2000
+#define RSSI_FADING_FLUTTER_ENTER   115     // 45 %
+#define RSSI_FADING_FLUTTER_EXIT    90      // 35 %
+#define RSSI_FADING_SMOOTH_LOG2     2       // Block-to-block EMA weight 1/4 (~1 s)
+
+/** @brief Fading regime of one receiver */
+typedef enum {
+    RSSI_FADING_UNKNOWN = 0,    // No full block since the last reset
+    RSSI_FADING_STEADY,         // Level holds
+    RSSI_FADING_SLOW,           // Range fade, blockage: slower than ~4 Hz
+    RSSI_FADING_FLUTTER,        // Multipath: most of the movement faster
+    RSSI_FADING_COUNT
+} rssi_fading_regime_t;
+
+/** @brief Analysis state of one receiver */
+typedef struct {
+    int32_t  s1[RSSI_FADING_BINS];      // Goertzel state, ADC counts
+    int32_t  s2[RSSI_FADING_BINS];
+    int32_t  ref;                       // First sample of the block (offset removed from the input)
+    uint16_t n;                         // Samples in the current block
+    uint32_t power[RSSI_FADING_BINS];   // Last block: squared amplitude per bin, ADC counts²
+    uint32_t total;                     // Smoothed power over all bins, ADC counts²
+    uint16_t fast_q8;                   // Smoothed fast share, Q8 (256 = all)
+    uint32_t blocks;                    // Blocks analysed since the last reset
+    volatile uint8_t regime;            // rssi_fading_regime_t
+} rssi_fading_t;
+
+void        rssi_fading_reset(rssi_fading_t* f);
+void        rssi_fading_restart(rssi_fading_t* f);
+bool        rssi_fading_push(rssi_fading_t* f, uint16_t raw);
+uint16_t    rssi_fading_bin_hz_x10(int bin);
+const char* rssi_fading_name(rssi_fading_regime_t regime);
+
+#endif // __RSSI_FADING_H
@@ -0,0 +1,71 @@
+/**
+ * @file rssi_filter.c
+ * @brief Moving-average RSSI smoothing run once per sample in the RSSI task
+ */
+
+#include "rssi_filter.h"
+
+static void rssi_filter_fill(rssi_filter_t* f, uint16_t value)
+{
+    uint16_t len = (uint16_t)(1u << f->len_log2);
+    for (uint16_t i = 0; i < len; i++) {
+        f->buf[i] = value;
+    }
+    f->sum   = (uint32_t)value << f->len_log2;
+    f->index = 0;
+}
+
+/**
+ * @brief Reset a channel
+ * @param len_log2 Window length as a power of two (clamped to RSSI_FILTER_MAX_LOG2)
+ */
+void rssi_filter_init(rssi_filter_t* f, uint8_t len_log2)
+{
+    f->len_log2 = (len_log2 > RSSI_FILTER_MAX_LOG2) ? RSSI_FILTER_MAX_LOG2 : len_log2;
+    f->primed   = false;
+    rssi_filter_fill(f, 0);
+}
+
+/**
+ * @brief Change the window length without a step in the output: the new
+ *        window is seeded with the current output.
+ */
+void rssi_filter_set_length(rssi_filter_t* f, uint8_t len_log2)
+{
+    if (len_log2 > RSSI_FILTER_MAX_LOG2) {
+        len_log2 = RSSI_FILTER_MAX_LOG2;
+    }
+    if (len_log2 == f->len_log2) {
+        return;
+    }
+    uint16_t out = rssi_filter_output(f);
+    f->len_log2 = len_log2;
+    rssi_filter_fill(f, out);
+}
+
+/**
+ * @brief Add one raw sample and return the smoothed value
+ */
+uint16_t rssi_filter_push(rssi_filter_t* f, uint16_t raw)
+{
+    if (!f->primed) {
+        rssi_filter_fill(f, raw);
+        f->primed = true;
+        return raw;
+    }
+    uint8_t mask = (uint8_t)((1u << f->len_log2) - 1);
+    f->sum -= f->buf[f->index];
+    f->sum += raw;
+    f->buf[f->index] = raw;
+    f->index = (uint8_t)((f->index + 1) & mask);
+    return rssi_filter_output(f);
+}
+
+/**
+ * @brief Current smoothed value (rounded window mean)
+ */
+uint16_t rssi_filter_output(const rssi_filter_t* f)
+{
+    uint32_t half = (f->len_log2 != 0) ? (1u << (f->len_log2 - 1)) : 0;
+    return (uint16_t)((f->sum + half) >> f->len_log2);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file rssi_filter.h
+ * @brief Moving-average RSSI smoothing run once per sample in the RSSI task
+ *
+ * Replaces the per-caller filter buffers that used to advance every time a
+ * page asked for a percentage.  The window is a power of two with a running
+ * sum, so each push is O(1) whatever its length.
+ */
+
+#ifndef __RSSI_FILTER_H
+#define __RSSI_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_FILTER_MAX_LOG2    6       // Longest window: 64 samples
+
+/** @brief One smoothing channel */
+typedef struct {
+    uint16_t buf[1 << RSSI_FILTER_MAX_LOG2];
+    uint32_t sum;
+    uint8_t  index;
+    uint8_t  len_log2;
+    bool     primed;        // First sample seeds the whole window
+} rssi_filter_t;
+
+void     rssi_filter_init(rssi_filter_t* f, uint8_t len_log2);
+void     rssi_filter_set_length(rssi_filter_t* f, uint8_t len_log2);
+uint16_t rssi_filter_push(rssi_filter_t* f, uint16_t raw);
+uint16_t rssi_filter_output(const rssi_filter_t* f);
+
+#endif // __RSSI_FILTER_H
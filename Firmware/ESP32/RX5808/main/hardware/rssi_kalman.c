@@ -0,0 +1,71 @@
+/**
+ * @file rssi_kalman.c
+ * @brief Constant-velocity RSSI fade estimator (steady-state Kalman, fixed point)
+ */
+
+#include "rssi_kalman.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RSSI_KALMAN_HOT IRAM_ATTR
+#else
+#define RSSI_KALMAN_HOT
+#endif
+
+// Level and velocity bound (Q16): far outside anything real, but keeps a
+// diverging filter inside int32
+#define RSSI_KALMAN_LIMIT   ((int64_t)8192 << 16)
+
+static RSSI_KALMAN_HOT int64_t rssi_kalman_clamp(int64_t v, int64_t limit)
+{
+    return (v > limit) ? limit : (v < -limit) ? -limit : v;
+}
+
+void rssi_kalman_reset(rssi_kalman_t* k)
+{
+    k->x = 0;
+    k->v = 0;
+    k->primed = false;
+}
+
+/**
+ * @brief Fold in one measurement taken @p dt_ms after the previous one
+ */
+RSSI_KALMAN_HOT void rssi_kalman_update(rssi_kalman_t* k, uint16_t z, uint32_t dt_ms,
+                                        uint32_t alpha_q16, uint32_t beta_q16)
+{
+    int32_t z_q16 = (int32_t)z << 16;
+    if (!k->primed || dt_ms == 0 || dt_ms > RSSI_KALMAN_MAX_DT_MS) {
+        // No usable history: restart at the measurement, velocity unknown
+        k->x = z_q16;
+        k->v = 0;
+        k->primed = true;
+        return;
+    }
+    int64_t x_pred = (int64_t)k->x + (int64_t)k->v * dt_ms;
+    int64_t r = (int64_t)z_q16 - x_pred;
+    int64_t x = x_pred + ((r * alpha_q16) >> 16);
+    int64_t v = (int64_t)k->v + ((r * beta_q16) >> 16) / (int64_t)dt_ms;
+    k->x = (int32_t)rssi_kalman_clamp(x, RSSI_KALMAN_LIMIT);
+    k->v = (int32_t)rssi_kalman_clamp(v, RSSI_KALMAN_LIMIT);
+}
+
+/**
+ * @brief Level expected @p ahead_ms after the last measurement (ADC counts)
+ */
+RSSI_KALMAN_HOT uint16_t rssi_kalman_predict(const rssi_kalman_t* k, uint32_t ahead_ms)
+{
+    int64_t x = (int64_t)k->x + (int64_t)k->v * ahead_ms;
+    x = (x + (1 << 15)) >> 16;
+    if (x < 0)    x = 0;
+    if (x > 4095) x = 4095;
+    return (uint16_t)x;
+}
+
+/**
+ * @brief Rate of change in ADC counts per second (negative = fading)
+ */
+RSSI_KALMAN_HOT int32_t rssi_kalman_velocity(const rssi_kalman_t* k)
+{
+    return (int32_t)(((int64_t)k->v * 1000) >> 16);
+}
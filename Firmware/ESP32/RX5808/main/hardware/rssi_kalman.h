@@ -0,0 +1,45 @@
+/**
+ * @file rssi_kalman.h
+ * @brief Constant-velocity RSSI fade estimator (steady-state Kalman, fixed point)
+ *
+ * Tracks level and rate of change of one receiver's raw RSSI and predicts
+ * it a few tens of milliseconds ahead, so diversity can leave an antenna
+ * before it falls below the other one instead of after.
+ *
+ * The model is the two-state constant-velocity Kalman filter.  Its gains
+ * converge to fixed values for a given process/measurement noise ratio,
+ * so only those are kept (the alpha-beta form):
+ *
+ *     predict   x' = x + v·dt
+ *     update    r  = z - x'
+ *               x  = x' + α·r
+ *               v  = v  + (β / dt)·r
+ *
+ * α and β are Q16 and should be a matched pair, β = 2(2-α) - 4·sqrt(1-α)
+ * (e.g. 0.5/0.172, 0.4/0.102, 0.25/0.036).  Level is Q16 ADC counts and
+ * velocity Q16 counts per millisecond, so a 200-count/ms null still fits
+ * in int32; products go through int64.  No division except by dt.
+ */
+
+#ifndef __RSSI_KALMAN_H
+#define __RSSI_KALMAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_KALMAN_Q16(x)      ((uint32_t)((x) * 65536.0f + 0.5f))
+#define RSSI_KALMAN_MAX_DT_MS   500     // Longer gaps restart the filter
+
+/** @brief Estimator state */
+typedef struct {
+    int32_t x;              // Level, Q16 ADC counts
+    int32_t v;              // Velocity, Q16 ADC counts per ms
+    bool    primed;         // At least one measurement seen
+} rssi_kalman_t;
+
+void     rssi_kalman_reset(rssi_kalman_t* k);
+void     rssi_kalman_update(rssi_kalman_t* k, uint16_t z, uint32_t dt_ms, uint32_t alpha_q16, uint32_t beta_q16);
+uint16_t rssi_kalman_predict(const rssi_kalman_t* k, uint32_t ahead_ms);
+int32_t  rssi_kalman_velocity(const rssi_kalman_t* k);
+
+#endif // __RSSI_KALMAN_H
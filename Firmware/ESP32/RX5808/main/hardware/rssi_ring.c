@@ -0,0 +1,126 @@
+/**
+ * @file rssi_ring.c
+ * @brief Lock-free single-producer ring of timestamped ADC frames
+ */
+
+#include "rssi_ring.h"
+#include <string.h>
+
+#define RSSI_RING_MASK  (RSSI_RING_LEN - 1)
+
+#if (RSSI_RING_LEN & RSSI_RING_MASK) != 0
+#error "RSSI_RING_LEN must be a power of two"
+#endif
+
+// Slots a reader may still trust behind head.  The producer's next write
+// lands on the slot of (head + 1 - RSSI_RING_LEN), so keep one slot clear.
+#define RSSI_RING_SAFE  (RSSI_RING_LEN - 1)
+
+/**
+ * @brief Copy one slot out; false if the producer touched it mid-copy or it
+ *        no longer holds frame @p seq.
+ */
+static bool rssi_ring_copy_slot(const rssi_ring_t* ring, uint32_t seq, rssi_frame_t* out)
+{
+    uint32_t idx = seq & RSSI_RING_MASK;
+
+    uint32_t v1 = __atomic_load_n(&ring->version[idx], __ATOMIC_ACQUIRE);
+    if (v1 & 1u) {
+        return false;
+    }
+    memcpy(out, &ring->frame[idx], sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t v2 = __atomic_load_n(&ring->version[idx], __ATOMIC_RELAXED);
+
+    return v1 == v2 && out->seq == seq;
+}
+
+/**
+ * @brief Reset the ring (no readers may be active)
+ */
+void rssi_ring_init(rssi_ring_t* ring)
+{
+    memset(ring, 0, sizeof(*ring));
+}
+
+/**
+ * @brief Publish a frame (producer only).  Assigns and returns via
+ *        @p frame->seq the frame's sequence number.
+ */
+void rssi_ring_publish(rssi_ring_t* ring, rssi_frame_t* frame)
+{
+    uint32_t seq = ring->head + 1;
+    if (seq == 0) {
+        seq = 1;    // 0 is "nothing published yet"; wraps after ~49 days at 1 kHz
+    }
+    uint32_t idx = seq & RSSI_RING_MASK;
+    frame->seq = seq;
+
+    __atomic_store_n(&ring->version[idx], ring->version[idx] + 1, __ATOMIC_RELAXED);   // odd: writing
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ring->frame[idx] = *frame;
+    __atomic_store_n(&ring->version[idx], ring->version[idx] + 1, __ATOMIC_RELEASE);   // even: stable
+    __atomic_store_n(&ring->head, seq, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Sequence number of the newest frame (0 = none yet)
+ */
+uint32_t rssi_ring_head(const rssi_ring_t* ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Attach a reader; it will see frames published from now on.
+ */
+void rssi_ring_reader_init(const rssi_ring_t* ring, rssi_ring_reader_t* rd)
+{
+    rd->next    = rssi_ring_head(ring) + 1;
+    rd->dropped = 0;
+}
+
+/**
+ * @brief Return the next unread frame for this reader.
+ *        A reader that fell more than a ring behind resumes at the oldest
+ *        frame still available and adds the skipped ones to rd->dropped.
+ * @return false if no new frame is available
+ */
+bool rssi_ring_read(const rssi_ring_t* ring, rssi_ring_reader_t* rd, rssi_frame_t* out)
+{
+    for (;;) {
+        uint32_t head = rssi_ring_head(ring);
+        int32_t  behind = (int32_t)(head - rd->next);   // frames after 'next' (wrap-safe)
+
+        if (head == 0 || behind < 0) {
+            return false;
+        }
+        if (behind >= RSSI_RING_SAFE) {
+            uint32_t oldest = head - (RSSI_RING_SAFE - 1);
+            rd->dropped += oldest - rd->next;
+            rd->next = oldest;
+        }
+        if (rssi_ring_copy_slot(ring, rd->next, out)) {
+            rd->next++;
+            return true;
+        }
+        // Overwritten while copying — re-evaluate against the new head
+    }
+}
+
+/**
+ * @brief Copy the newest frame regardless of any reader cursor
+ * @return false if nothing has been published yet
+ */
+bool rssi_ring_latest(const rssi_ring_t* ring, rssi_frame_t* out)
+{
+    for (;;) {
+        uint32_t head = rssi_ring_head(ring);
+        if (head == 0) {
+            return false;
+        }
+        if (rssi_ring_copy_slot(ring, head, out)) {
+            return true;
+        }
+    }
+}
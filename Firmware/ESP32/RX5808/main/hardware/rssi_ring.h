@@ -0,0 +1,71 @@
+/**
+ * @file rssi_ring.h
+ * @brief Lock-free single-producer ring of timestamped ADC frames
+ *
+ * The RSSI sampling task is the only writer.  Any number of readers on
+ * either core consume frames through their own cursor (rssi_ring_reader_t),
+ * so a slow reader never holds up the producer or another reader — it just
+ * skips the frames that were overwritten and counts them as dropped.
+ *
+ * Each slot is protected by its own version counter (odd while being
+ * written), so a reader that races the producer detects the torn copy and
+ * retries instead of returning mixed data.
+ */
+
+#ifndef __RSSI_RING_H
+#define __RSSI_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_RING_LEN   128     // Frames kept (power of two) — 128 ms at 1 kHz
+
+#ifndef RSSI_RX_COUNT
+#define RSSI_RX_COUNT   2       // Receiver RSSI slots per frame (the RX5808 board has two)
+#endif
+
+// Receivers smoothed and calibrated by the RF service's filter stage
+// (rx5808.c): the board's two modules.  Host builds with more receivers
+// carry the extra ones in value[] only; rx5808.c builds for two alone.
+#define RSSI_FILTER_RX  2
+
+/** @brief Per-frame channel slots (order of the ADC scan pattern) */
+typedef enum {
+    RSSI_SLOT_RSSI0 = 0,        // Receiver A RSSI; receiver n is RSSI_SLOT_RSSI0 + n
+    RSSI_SLOT_RSSI1,            // Receiver B RSSI
+    RSSI_SLOT_VBAT = RSSI_SLOT_RSSI0 + RSSI_RX_COUNT,  // Battery divider
+    RSSI_SLOT_KEY,              // 5-way key resistor ladder
+    RSSI_SLOT_COUNT
+} rssi_slot_t;
+
+/** @brief One decimated ADC frame */
+typedef struct {
+    int64_t  t_us;                      // Time of the last conversion in the frame
+    uint32_t seq;                       // Producer sequence number (1, 2, 3, ...)
+    uint16_t value[RSSI_SLOT_COUNT];    // Raw 12-bit values
+    uint16_t filtered[RSSI_FILTER_RX];  // Smoothed RSSI0/RSSI1 (filter stage in rx5808.c)
+    float    percent[RSSI_FILTER_RX];   // Calibrated 0-99 % of filtered[] (RSSI Ad min/max)
+} rssi_frame_t;
+
+/** @brief Ring storage (one producer) */
+typedef struct {
+    rssi_frame_t      frame[RSSI_RING_LEN];
+    volatile uint32_t version[RSSI_RING_LEN];   // Odd while the slot is being written
+    volatile uint32_t head;                     // Sequence number of the newest published frame
+} rssi_ring_t;
+
+/** @brief Per-consumer read cursor */
+typedef struct {
+    uint32_t next;              // Sequence number of the next frame to return
+    uint32_t dropped;           // Frames overwritten before this reader got to them
+} rssi_ring_reader_t;
+
+void     rssi_ring_init(rssi_ring_t* ring);
+void     rssi_ring_publish(rssi_ring_t* ring, rssi_frame_t* frame);
+uint32_t rssi_ring_head(const rssi_ring_t* ring);
+
+void     rssi_ring_reader_init(const rssi_ring_t* ring, rssi_ring_reader_t* rd);
+bool     rssi_ring_read(const rssi_ring_t* ring, rssi_ring_reader_t* rd, rssi_frame_t* out);
+bool     rssi_ring_latest(const rssi_ring_t* ring, rssi_frame_t* out);
+
+#endif // __RSSI_RING_H
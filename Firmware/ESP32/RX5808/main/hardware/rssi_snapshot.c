@@ -0,0 +1,58 @@
+/**
+ * @file rssi_snapshot.c
+ * @brief Seqlock-protected "latest sample" published by the RSSI task
+ */
+
+#include "rssi_snapshot.h"
+#include <string.h>
+
+// Readers include the diversity decide-and-switch path, which runs from IRAM
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RSSI_SNAPSHOT_HOT IRAM_ATTR
+#else
+#define RSSI_SNAPSHOT_HOT
+#endif
+
+/**
+ * @brief Reset the snapshot (before the writer starts)
+ */
+void rssi_snapshot_init(rssi_snapshot_t* snap)
+{
+    memset(snap, 0, sizeof(*snap));
+}
+
+/**
+ * @brief Publish a frame (single writer)
+ */
+void rssi_snapshot_write(rssi_snapshot_t* snap, const rssi_frame_t* frame)
+{
+    uint32_t s = snap->seqcount;
+
+    // Odd: readers use copy[1] while copy[0] is rewritten
+    __atomic_store_n(&snap->seqcount, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    snap->copy[0] = *frame;
+
+    // Even: readers use copy[0] while copy[1] is rewritten
+    __atomic_store_n(&snap->seqcount, s + 2, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    snap->copy[1] = *frame;
+}
+
+/**
+ * @brief Copy out the latest frame
+ * @return false if nothing has been published yet (out->seq == 0)
+ */
+bool RSSI_SNAPSHOT_HOT rssi_snapshot_read(const rssi_snapshot_t* snap, rssi_frame_t* out)
+{
+    uint32_t s1, s2;
+    do {
+        s1 = __atomic_load_n(&snap->seqcount, __ATOMIC_ACQUIRE);
+        memcpy(out, &snap->copy[s1 & 1u], sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&snap->seqcount, __ATOMIC_RELAXED);
+    } while (s1 != s2);
+
+    return out->seq != 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file rssi_snapshot.h
+ * @brief Seqlock-protected "latest sample" published by the RSSI task
+ *
+ * Single writer, any number of readers on either core.  Readers always get
+ * a torn-free copy of one frame, and the frame's seq / t_us let them tell a
+ * new sample from one they have already processed.
+ *
+ * Two copies are kept (seqcount latch): the writer only ever modifies the
+ * copy readers are told not to use.  A reader that preempts the writer on
+ * the same core therefore never spins waiting for a half-written frame.
+ */
+
+#ifndef __RSSI_SNAPSHOT_H
+#define __RSSI_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rssi_ring.h"
+
+/** @brief Latest-sample snapshot */
+typedef struct {
+    volatile uint32_t seqcount;     // Bumped twice per write; low bit selects the readable copy
+    rssi_frame_t      copy[2];
+} rssi_snapshot_t;
+
+void rssi_snapshot_init(rssi_snapshot_t* snap);
+void rssi_snapshot_write(rssi_snapshot_t* snap, const rssi_frame_t* frame);
+bool rssi_snapshot_read(const rssi_snapshot_t* snap, rssi_frame_t* out);
+
+#endif // __RSSI_SNAPSHOT_H
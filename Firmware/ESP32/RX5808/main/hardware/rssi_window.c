@@ -0,0 +1,140 @@
+/**
+ * @file rssi_window.c
+ * @brief Rolling RSSI window with O(1) mean, variance and slope
+ */
+
+#include "rssi_window.h"
+
+// Hot-path placement: the diversity decide-and-switch path runs from IRAM
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define RSSI_WINDOW_HOT IRAM_ATTR
+#else
+#define RSSI_WINDOW_HOT
+#endif
+
+/**
+ * @brief Attach buffers of @p capacity samples and times and empty the window
+ * @return false if @p capacity is 0 or above RSSI_WINDOW_MAX_LEN (clamped)
+ */
+bool rssi_window_init(rssi_window_t* w, uint16_t* buf, uint32_t* t_buf, uint16_t capacity)
+{
+    bool ok = capacity >= 1 && capacity <= RSSI_WINDOW_MAX_LEN;
+    w->buf      = buf;
+    w->t_buf    = t_buf;
+    w->capacity = (capacity < 1) ? 1 : (capacity > RSSI_WINDOW_MAX_LEN ? RSSI_WINDOW_MAX_LEN : capacity);
+    rssi_window_reset(w);
+    return ok;
+}
+
+/**
+ * @brief Drop every sample (the buffer contents are simply forgotten)
+ */
+void rssi_window_reset(rssi_window_t* w)
+{
+    w->head    = 0;
+    w->count   = 0;
+    w->sum     = 0;
+    w->sum_sq  = 0;
+    w->sum_old = 0;
+    w->sum_new = 0;
+    w->t_old   = 0;
+    w->t_new   = 0;
+}
+
+// Ring index of the sample @p age positions before the newest (0 = newest);
+// requires age < count
+static RSSI_WINDOW_HOT uint16_t rssi_window_at(const rssi_window_t* w, uint16_t age)
+{
+    return (uint16_t)((w->head + w->capacity - 1 - age) % w->capacity);
+}
+
+/**
+ * @brief Add one sample taken at @p t_ms, evicting the oldest once the
+ *        window is full
+ */
+void RSSI_WINDOW_HOT rssi_window_push(rssi_window_t* w, uint16_t value, uint32_t t_ms)
+{
+    uint16_t half = w->count / 2;
+
+    if (w->count == w->capacity) {
+        // Full: half stays put.  The oldest sample leaves the old half and
+        // the one behind it moves in; the newest half slides by one.
+        uint16_t oldest = rssi_window_at(w, w->count - 1);
+        w->sum    -= w->buf[oldest];
+        w->sum_sq -= (uint32_t)w->buf[oldest] * w->buf[oldest];
+        if (half != 0) {
+            uint16_t in_old  = rssi_window_at(w, w->count - 1 - half);
+            uint16_t out_new = rssi_window_at(w, half - 1);
+            w->sum_old += w->buf[in_old] - w->buf[oldest];
+            w->t_old   += w->t_buf[in_old] - w->t_buf[oldest];
+            w->sum_new += value - w->buf[out_new];
+            w->t_new   += t_ms - w->t_buf[out_new];
+        }
+    } else if ((w->count + 1) / 2 == half) {
+        // Filling, half unchanged (count even → odd): the newest half slides
+        if (half != 0) {
+            uint16_t out_new = rssi_window_at(w, half - 1);
+            w->sum_new += value - w->buf[out_new];
+            w->t_new   += t_ms - w->t_buf[out_new];
+        }
+    } else {
+        // Filling, half grows by one (count odd → even): the old half takes
+        // the next-oldest sample, the newest half only gains the new one
+        uint16_t in_old = rssi_window_at(w, w->count - 1 - half);
+        w->sum_old += w->buf[in_old];
+        w->t_old   += w->t_buf[in_old];
+        w->sum_new += value;
+        w->t_new   += t_ms;
+    }
+
+    w->buf[w->head]   = value;
+    w->t_buf[w->head] = t_ms;
+    w->head = (uint16_t)((w->head + 1) % w->capacity);
+    if (w->count < w->capacity) {
+        w->count++;
+    }
+    w->sum    += value;
+    w->sum_sq += (uint32_t)value * value;
+}
+
+/**
+ * @brief Window mean (truncated), 0 when empty
+ */
+uint16_t RSSI_WINDOW_HOT rssi_window_mean(const rssi_window_t* w)
+{
+    return (w->count == 0) ? 0 : (uint16_t)(w->sum / w->count);
+}
+
+/**
+ * @brief Population variance (counts^2): (n*sum_sq - sum^2) / n^2, exact
+ */
+uint32_t RSSI_WINDOW_HOT rssi_window_variance(const rssi_window_t* w)
+{
+    if (w->count == 0) {
+        return 0;
+    }
+    uint64_t n = w->count;
+    return (uint32_t)((w->sum_sq * n - (uint64_t)w->sum * w->sum) / (n * n));
+}
+
+/**
+ * @brief Slope (ADC units per second) between the means of the oldest and
+ *        the newest half of the window, over the time between their mean
+ *        timestamps; positive when the signal is rising.
+ * @return 0 until the window holds 10 samples
+ */
+int32_t RSSI_WINDOW_HOT rssi_window_slope(const rssi_window_t* w)
+{
+    if (w->count < 10) {
+        return 0;
+    }
+    // Both halves hold count/2 samples, so the count cancels:
+    // Δmean / Δt = (sum_new - sum_old) / (t_new - t_old)
+    int64_t span = (int64_t)(uint32_t)(w->t_new - w->t_old);     // half x Δt (ms)
+    if (span == 0) {
+        span = 1;
+    }
+    int64_t delta = (int64_t)w->sum_new - (int64_t)w->sum_old;    // half x Δmean
+    return (int32_t)(delta * 1000 / span);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file rssi_window.h
+ * @brief Rolling RSSI window with O(1) mean, variance and slope
+ *
+ * Keeps the last @c capacity samples in a caller-provided ring together with
+ * running sums, so every statistic costs the same whatever the window length:
+ *
+ *   - sum / sum_sq over the whole window        → mean, population variance
+ *   - sum of the oldest and of the newest half,
+ *     of their values and of their timestamps   → slope between the halves
+ *
+ * The slope divides by the time between the two halves' mean timestamps, so
+ * it holds whatever the spacing of the samples: a rate change or an early
+ * wake-up inside the window does not scale it.
+ *
+ * Each push adds the new sample and subtracts the ones leaving a sum, so a
+ * 1 s window at 1 kHz costs no more per sample than the default 50.
+ * Integer sums are exact — no drift to resynchronise.
+ */
+
+#ifndef __RSSI_WINDOW_H
+#define __RSSI_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_WINDOW_MAX_LEN   1000      // 4095^2 * len must fit sum_sq; 1 s @ 1 kHz
+
+/** @brief Window state (buffers owned by the caller) */
+typedef struct {
+    uint16_t* buf;
+    uint32_t* t_buf;                    // Sample times (ms), parallel to buf
+    uint16_t  capacity;
+    uint16_t  head;                     // Next write position
+    uint16_t  count;                    // Samples held (<= capacity)
+    uint32_t  sum;
+    uint64_t  sum_sq;
+    uint32_t  sum_old;                  // Oldest count/2 samples
+    uint32_t  sum_new;                  // Newest count/2 samples
+    uint32_t  t_old;                    // Sums of the same halves' times, modulo 2^32:
+    uint32_t  t_new;                    // only t_new - t_old is used, which is exact
+} rssi_window_t;
+
+bool     rssi_window_init(rssi_window_t* w, uint16_t* buf, uint32_t* t_buf, uint16_t capacity);
+void     rssi_window_reset(rssi_window_t* w);
+void     rssi_window_push(rssi_window_t* w, uint16_t value, uint32_t t_ms);
+uint16_t rssi_window_mean(const rssi_window_t* w);
+uint32_t rssi_window_variance(const rssi_window_t* w);
+int32_t  rssi_window_slope(const rssi_window_t* w);
+
+#endif // __RSSI_WINDOW_H
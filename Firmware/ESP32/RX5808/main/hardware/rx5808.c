@@ -2,30 +2,68 @@
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
 #include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_continuous.h"
 #include "esp_log.h"
 #include "sys/unistd.h"
+#include <string.h>
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
 #include "hwvers.h"
+#include "rx5808_settle.h"
+#include "rssi_decim.h"
+#include "rssi_snapshot.h"
+#include "rssi_filter.h"
+#include "rf_mailbox.h"
 #include "led.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "sdkconfig.h"
+#include <math.h>
 
 static const char *TAG = "RX5808";
 
-// SPI Bus Mutex - protects soft SPI from concurrent access
-static SemaphoreHandle_t spi_mutex = NULL;
-// Serialises all adc_oneshot_read() calls so that the Core-1 RSSI burst and
-// the Core-0 LVGL keypad reader never race on the same adc1_handle.
-// adc_oneshot_read() is not thread-safe per IDF documentation.
-static SemaphoreHandle_t adc_mutex = NULL;
+// The ADC scan, the decimator, the filter stage (RSSI_FILTER_RX), the RSSI
+// Ad calibration and the two switch lines serve the board's two receivers;
+// RSSI_RX_COUNT > 2 is for host builds of diversity.c
+#if RSSI_RX_COUNT != 2
+#error "rx5808.c drives exactly two receivers (RSSI_RX_COUNT == 2)"
+#endif
 
-// Hardware SPI device handle for RX5808 (DMA-accelerated)
+// RF service: the RSSI task (DMA2_Stream0_IRQHandler) is the only task that
+// touches the SPI bus, the antenna switch GPIOs and the ADC unit once
+// RX5808_Init() has started it.  Everyone else posts a command and wakes it
+// — nobody blocks on an RF mutex.  Tunes go through a latest-wins mailbox
+// (only the newest frequency matters); the rest are request bits.
+static rf_mailbox_t tune_mbox;
+static volatile uint32_t rf_requests = 0;          // RX5808_RF_REQ_* bits
+static volatile uint8_t antenna_request = RX5808_ANTENNA_B;    // Auto mode selection (diversity.c)
+static uint8_t antenna_applied = 0xFF;              // Switch state on the pins (RF service only)
+static int64_t antenna_applied_us = 0;              // esp_timer time of the last pin change (tune_lock)
+static volatile rx5808_frame_cb_t frame_cb = NULL;  // RX5808_Set_Frame_Callback()
+#define RX5808_RF_REQ_PAUSE        (1 << 0)
+#define RX5808_RF_REQ_RESUME       (1 << 1)
+#define RX5808_RF_REQ_INVALIDATE   (1 << 2)
+#define RX5808_RF_PAUSE_TIMEOUT_MS  100     // RX5808_Pause() wait for the service to release I2S0
+
+// Hardware SPI device handle for RX5808 (polling writes)
 static spi_device_handle_t rx5808_spi = NULL;
 static bool rx5808_spi_initialized = false;
 
+// Shadow register file: last value written to each of the 16 RX5808
+// registers (both chips share the bus, so one copy covers both).  A write
+// equal to the shadow is skipped.  The chip is write-only, so anything that
+// may have written it behind our back (ELRS backpack) must invalidate.
+// RF service only; spi_stats is read unlocked (diagnostics).
+#define RX5808_REG_COUNT          16
+#define RX5808_SPI_QUEUE_LEN       1    // Device queue_size (only the benchmark queues)
+static uint32_t reg_shadow[RX5808_REG_COUNT];
+static uint16_t reg_shadow_valid = 0;   // Bit n set: reg_shadow[n] matches the chip
+static rx5808_spi_stats_t spi_stats;
+
 
 #define Synthesizer_Register_A 				              0x00  
 #define Synthesizer_Register_B 				              0x01  
@@ -41,8 +79,32 @@ static bool rx5808_spi_initialized = false;
 #define State_Register                              0x0F
 
 // Performance optimization settings
-#define RSSI_FILTER_SIZE 4              // Moving average filter size (reduces jitter)
-#define RX5808_FREQ_SETTLING_TIME_MS 50 // Reduced from 150ms for faster channel switching
+#define RSSI_FILTER_WINDOW_MS   64       // Display smoothing window while streaming (any frame rate)
+#define RSSI_FILTER_LOG2_ONESHOT 2       // Smoothing window in oneshot fallback: 4 samples = 100 ms @ 40 Hz
+#define RX5808_FREQ_SETTLING_TIME_MS 50 // Upper bound; rx5808_settle.c predicts per jump size
+#define RSSI_TASK_PERIOD_MS          25 // Oneshot fallback polling period (and DMA stall timeout)
+#define RSSI_TASK_SETTLE_TICKS        1 // Oneshot fallback polling period (ticks) while a tune settles
+
+// Continuous (DMA) RSSI sampling.  ESP32 ADC1 scans RSSI0/RSSI1/VBAT/KEY
+// round-robin through I2S0; RSSI is decimated by a CIC + FIR (rssi_cic.c)
+// into 1000, 250 or 100 Hz frames (RX5808_Set_RSSI_Rate()).
+#define RSSI_ADC_SAMPLE_HZ       20000  // Total conversion rate (ESP32 minimum) — 5 kHz per channel
+#define RSSI_ADC_CONV_PERIOD_US  (1000000 / RSSI_ADC_SAMPLE_HZ)
+#define RSSI_ADC_CHAN_HZ         (RSSI_ADC_SAMPLE_HZ / RSSI_SLOT_COUNT)
+#define RSSI_ADC_CHAN_PERIOD_US  (1000000 / RSSI_ADC_CHAN_HZ)
+#define RSSI_ADC_DEFAULT_RATE_HZ  1000  // Frame rate at boot (fast enough for the settle model)
+#define RSSI_ONESHOT_RATE_HZ        40  // Frame rate of the oneshot fallback (25 ms)
+#define RSSI_ADC_FRAME_BYTES       256  // One DMA conversion frame: 128 results = 6.4 ms
+#define RSSI_ADC_POOL_BYTES       2048  // Driver-side pool: ~50 ms of backlog
+#define RSSI_ADC_FIRST_FRAME_MS     20  // RX5808_ADC_Read_Raw() wait for the first frame after (re)start
+
+// Asynchronous tuning: event bit set once the PLL of the last tune has settled
+#define RX5808_EVT_SETTLED         (1 << 0)
+#define RX5808_EVT_PAUSED          (1 << 1)    // RF service has released I2S0 (RX5808_Pause)
+
+// Tune-and-measure task (RX5808_Measure)
+#define RX5808_MEASURE_QUEUE_LEN     64 // A full 48-channel scan plus room for the calibration sweep and spectrum
+#define RX5808_MEASURE_TIMEOUT_MS   100 // Slack on top of dwell + expected frame time
 
 // ExpressLRS Backpack Detection
 #define BACKPACK_DETECTION_ENABLED 1     // Set to 0 to disable backpack detection
@@ -54,18 +116,13 @@ static bool rx5808_spi_initialized = false;
 
 // 彻底关断接收机
 bool RX5808_Shutdown = false;
-//uint16_t adc_convert_temp0[32][3];
-//uint16_t adc_convert_temp1[32][3];
-uint16_t adc_converted_value[3]={1024,1024,1024};
-
-// RSSI filtering buffers for smoother readings
-static uint16_t rssi0_filter_buffer[RSSI_FILTER_SIZE] = {0};
-static uint16_t rssi1_filter_buffer[RSSI_FILTER_SIZE] = {0};
-// Each buffer has its own independent write-index so that calling
-// Rx5808_Get_Precentage0() and Rx5808_Get_Precentage1() in any order
-// never advances the other buffer's cursor out of phase.
-static uint8_t rssi0_filter_index = 0;
-static uint8_t rssi1_filter_index = 0;
+// Latest sample (RSSI0/RSSI1/VBAT/KEY + seq + timestamp), written only by
+// the RSSI task.  Read through RX5808_Get_Sample() from any task or core.
+static rssi_snapshot_t rssi_latest;
+
+// RSSI smoothing — run once per sample by the RSSI task (rx5808_publish_frame),
+// never by readers, so every page sees the same filtered value.
+static rssi_filter_t rssi_filter[RSSI_FILTER_RX];
 
 // Band X (User Favorites) custom frequency storage
 // These are modifiable copies of Band X frequencies
@@ -92,6 +149,43 @@ static uint16_t expected_frequency = 5800;  // Track what frequency we last set
 static uint32_t last_freq_set_time_ms = 0;
 static uint32_t backpack_detected_time_ms = 0;
 
+// Asynchronous tune state (RX5808_Tune_Async).  The synthesizer write takes
+// ~30 us; the PLL settle that follows is tracked with a one-shot esp_timer
+// instead of a vTaskDelay(), so no caller sleeps through it.
+static EventGroupHandle_t tune_events = NULL;
+static esp_timer_handle_t settle_timer = NULL;
+static portMUX_TYPE tune_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile int64_t settled_at_us = 0;   // esp_timer time at which the last tune is settled
+static volatile uint32_t tune_seq = 0;       // incremented on every synthesizer retune
+static uint16_t seq_freq = 5800;             // frequency written by retune tune_seq (guarded by tune_lock)
+static uint16_t tune_freq = 0;               // frequency of the pending tune
+static uint16_t synth_freq = 5800;           // frequency the synthesizer holds (RF service)
+static rx5808_tune_cb_t tune_cb = NULL;      // completion callback of the pending tune
+static rx5808_settle_model_t settle_model;   // learned settle time per jump size (guarded by tune_lock)
+static void rx5808_settle_timer_cb(void *arg);
+static void rx5808_write_batch_locked(const rx5808_reg_write_t* writes, uint8_t count);
+static uint32_t rx5808_synth_register_b(uint16_t freq);
+static void rx5808_tune_begin_locked(uint16_t freq, rx5808_tune_cb_t cb);
+static void rx5808_antenna_apply(void);
+#ifdef CONFIG_RX5808_SPI_BENCHMARK
+static void rx5808_spi_benchmark(void);
+#endif
+
+// Queued tune-and-measure requests, served in order by rx5808_measure_task
+typedef struct {
+    uint16_t freq;
+    uint16_t dwell_ms;
+    uint16_t n_samples;
+    uint32_t gen;                       // measure_gen when queued
+    rx5808_measure_cb_t cb;
+    void* arg;
+} rx5808_measure_req_t;
+
+static QueueHandle_t measure_queue = NULL;
+static SemaphoreHandle_t measure_lock = NULL;      // Held around the tune and the callback so Cancel can fence them
+static volatile uint32_t measure_gen = 0;           // Bumped by RX5808_Measure_Cancel()
+static void rx5808_measure_task(void *arg);
+
 volatile int8_t channel_count = 0;
 volatile int8_t Chx_count = 0;
 volatile uint8_t Rx5808_channel;
@@ -121,6 +215,21 @@ const uint16_t Rx5808_Freq[7][8]=
 
 static adc_oneshot_unit_handle_t adc1_handle = NULL;
 
+// Continuous sampling state.  adc_cont_handle is created/destroyed only by
+// RX5808_Init() and then by the RF service (pause/resume commands), which is
+// also the only reader.  While adc_dma_active is false (composite video owns
+// I2S0, or DMA failed to start) the service falls back to oneshot polling.
+static adc_continuous_handle_t adc_cont_handle = NULL;
+static volatile bool adc_dma_active = false;
+static TaskHandle_t rssi_task_handle = NULL;
+static rssi_ring_t rssi_ring;           // Written only by the RSSI task
+static rssi_decim_t rssi_decim;         // RSSI task only
+static volatile uint16_t rssi_decim_factor = RSSI_ADC_CHAN_HZ / RSSI_ADC_DEFAULT_RATE_HZ;
+static volatile uint16_t rssi_decim_pending = 0;   // New factor for the RSSI task to apply (0 = none)
+static bool rx5808_adc_dma_start(void);
+static void rx5808_adc_dma_stop(void);
+static uint8_t rx5808_adc_slot(int channel);
+
 
 
 void RX5808_RSSI_ADC_Init(void)
@@ -140,25 +249,221 @@ void RX5808_RSSI_ADC_Init(void)
     ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, RX5808_RSSI1_CHAN, &ch_cfg));
     ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, VBAT_ADC_CHAN,     &ch_cfg));
     ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, KEY_ADC_CHAN,      &ch_cfg));
+
+    rssi_ring_init(&rssi_ring);
+    rssi_snapshot_init(&rssi_latest);
+    rssi_filter_init(&rssi_filter[0], RSSI_FILTER_LOG2_ONESHOT);
+    rssi_filter_init(&rssi_filter[1], RSSI_FILTER_LOG2_ONESHOT);
+    adc_dma_active = rx5808_adc_dma_start();
+}
+
+/**
+ * @brief Map an ADC1 channel number to its frame slot
+ * @return rssi_slot_t, or RSSI_SLOT_COUNT for a channel not in the scan
+ */
+static uint8_t rx5808_adc_slot(int channel)
+{
+    if (channel == RX5808_RSSI0_CHAN) return RSSI_SLOT_RSSI0;
+    if (channel == RX5808_RSSI1_CHAN) return RSSI_SLOT_RSSI1;
+    if (channel == VBAT_ADC_CHAN)     return RSSI_SLOT_VBAT;
+    if (channel == KEY_ADC_CHAN)      return RSSI_SLOT_KEY;
+    return RSSI_SLOT_COUNT;
 }
 
 /**
- * @brief Read a raw ADC sample from any configured ADC1 channel.
- *        Used by other drivers (e.g. lvgl keypad) that share the oneshot unit.
+ * @brief DMA conversion-frame-done ISR: wake the RSSI task
+ */
+static bool IRAM_ATTR rx5808_adc_conv_done_cb(adc_continuous_handle_t handle,
+                                              const adc_continuous_evt_data_t *edata,
+                                              void *user_data)
+{
+    BaseType_t woken = pdFALSE;
+    if (rssi_task_handle != NULL) {
+        vTaskNotifyGiveFromISR(rssi_task_handle, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief Create and start continuous sampling (init or RF service).
+ * @return true if streaming
+ */
+static bool rx5808_adc_dma_start(void)
+{
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = RSSI_ADC_POOL_BYTES,
+        .conv_frame_size    = RSSI_ADC_FRAME_BYTES,
+    };
+    esp_err_t ret = adc_continuous_new_handle(&handle_cfg, &adc_cont_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Continuous ADC unavailable (%s) - oneshot polling", esp_err_to_name(ret));
+        adc_cont_handle = NULL;
+        return false;
+    }
+
+    // Pattern order matches rssi_slot_t so the scan stays RSSI0-first
+    static const int scan_chan[RSSI_SLOT_COUNT] = {
+        RX5808_RSSI0_CHAN, RX5808_RSSI1_CHAN, VBAT_ADC_CHAN, KEY_ADC_CHAN
+    };
+    adc_digi_pattern_config_t pattern[RSSI_SLOT_COUNT];
+    for (int i = 0; i < RSSI_SLOT_COUNT; i++) {
+        pattern[i].atten     = ADC_ATTEN_DB_12;
+        pattern[i].channel   = scan_chan[i] & 0x7;
+        pattern[i].unit      = ADC_UNIT_1;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    adc_continuous_config_t dig_cfg = {
+        .pattern_num    = RSSI_SLOT_COUNT,
+        .adc_pattern    = pattern,
+        .sample_freq_hz = RSSI_ADC_SAMPLE_HZ,
+        .conv_mode      = ADC_CONV_SINGLE_UNIT_1,
+        .format         = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = rx5808_adc_conv_done_cb,
+    };
+
+    ret = adc_continuous_config(adc_cont_handle, &dig_cfg);
+    if (ret == ESP_OK) ret = adc_continuous_register_event_callbacks(adc_cont_handle, &cbs, NULL);
+    if (ret == ESP_OK) ret = adc_continuous_start(adc_cont_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Continuous ADC start failed (%s) - oneshot polling", esp_err_to_name(ret));
+        adc_continuous_deinit(adc_cont_handle);
+        adc_cont_handle = NULL;
+        return false;
+    }
+
+    rssi_decim_init(&rssi_decim, rssi_decim_factor);
+    ESP_LOGI(TAG, "Continuous RSSI sampling: %d Hz scan, %d Hz frames",
+             RSSI_ADC_SAMPLE_HZ, RSSI_ADC_CHAN_HZ / rssi_decim_factor);
+    return true;
+}
+
+/**
+ * @brief Stop continuous sampling and release I2S0 (RF service).
+ */
+static void rx5808_adc_dma_stop(void)
+{
+    if (adc_cont_handle == NULL) {
+        return;
+    }
+    adc_continuous_stop(adc_cont_handle);
+    adc_continuous_deinit(adc_cont_handle);
+    adc_cont_handle = NULL;
+}
+
+/**
+ * @brief Ring of timestamped 1 kHz ADC frames (RSSI0/RSSI1/VBAT/KEY).
+ *        Attach an rssi_ring_reader_t to consume every frame; consumers
+ *        that only want the newest sample use RX5808_Get_Sample().
+ */
+const rssi_ring_t* RX5808_Get_Sample_Ring(void)
+{
+    return &rssi_ring;
+}
+
+/**
+ * @brief Select the RSSI frame rate produced by the CIC + FIR decimator.
+ *        Applied by the RSSI task at its next DMA batch.
+ * @param rate_hz 1000, 250 or 100
+ * @return false for an unsupported rate
+ */
+bool RX5808_Set_RSSI_Rate(uint16_t rate_hz)
+{
+    if (rate_hz != 1000 && rate_hz != 250 && rate_hz != 100) {
+        return false;
+    }
+    rssi_decim_pending = RSSI_ADC_CHAN_HZ / rate_hz;
+    if (rssi_task_handle != NULL) {
+        xTaskNotifyGive(rssi_task_handle);
+    }
+    return true;
+}
+
+/**
+ * @brief Current RSSI frame rate (Hz) — the oneshot rate while video owns the ADC
+ */
+uint16_t RX5808_Get_RSSI_Rate(void)
+{
+    return adc_dma_active ? RSSI_ADC_CHAN_HZ / rssi_decim_factor : RSSI_ONESHOT_RATE_HZ;
+}
+
+/**
+ * @brief Group delay (us) of the RSSI decimation filter: how far the signal
+ *        in a frame lags the frame's t_us.  0 in the oneshot fallback.
+ */
+uint32_t RX5808_Get_RSSI_Group_Delay_Us(void)
+{
+    return adc_dma_active ? rssi_cic_group_delay_us(rssi_decim_factor, RSSI_ADC_CHAN_PERIOD_US) : 0;
+}
+
+/**
+ * @brief Torn-free copy of the latest published sample.
+ *        out->seq increases by one per sample, so a consumer that remembers
+ *        the last seq it processed can skip duplicates; out->t_us is the
+ *        esp_timer time of the sample.
+ *        In IRAM: the diversity decide-and-switch path reads it.
+ * @return false before the first sample (out is zeroed)
+ */
+IRAM_ATTR bool RX5808_Get_Sample(rssi_frame_t* out)
+{
+    return rssi_snapshot_read(&rssi_latest, out);
+}
+
+/**
+ * @brief Register a hook run by the RF service right after each frame is
+ *        published (NULL to remove).  Lets a consumer react to a new sample
+ *        within microseconds instead of polling on the tick.  The hook must
+ *        be short and must not block — typically it notifies a task.
+ */
+void RX5808_Set_Frame_Callback(rx5808_frame_cb_t cb)
+{
+    frame_cb = cb;
+}
+
+/**
+ * @brief Latest raw RSSI of one receiver (0 before the first sample)
+ */
+uint16_t RX5808_Get_RSSI_Raw(rx5808_receive rx)
+{
+    rssi_frame_t frame;
+    rssi_snapshot_read(&rssi_latest, &frame);
+    return frame.value[(rx == rx5808_receiver0) ? RSSI_SLOT_RSSI0 : RSSI_SLOT_RSSI1];
+}
+
+/**
+ * @brief true while RSSI is sampled by continuous DMA (false: oneshot fallback)
+ */
+bool RX5808_Is_ADC_Streaming(void)
+{
+    return adc_dma_active;
+}
+
+/**
+ * @brief Read a raw ADC sample from any scanned ADC1 channel.
+ *        Used by other drivers (e.g. lvgl keypad).  ADC1 belongs to the RF
+ *        service, so the value comes from its newest frame (DMA or oneshot).
  * @param channel  ADC1 channel number (adc_channel_t cast to int)
- * @return raw 12-bit ADC reading, or 0 on error
+ * @return raw 12-bit ADC reading, or 0 for a channel outside the scan
  */
 int RX5808_ADC_Read_Raw(int channel)
 {
-    int raw = 0;
-    if (adc_mutex != NULL) xSemaphoreTake(adc_mutex, portMAX_DELAY);
-    adc_oneshot_read(adc1_handle, (adc_channel_t)channel, &raw);
-    if (adc_mutex != NULL) xSemaphoreGive(adc_mutex);
-    return raw;
+    uint8_t slot = rx5808_adc_slot(channel);
+    if (slot >= RSSI_SLOT_COUNT) {
+        return 0;
+    }
+    rssi_frame_t frame;
+    for (int i = 0; i < RSSI_ADC_FIRST_FRAME_MS; i++) {
+        if (rssi_snapshot_read(&rssi_latest, &frame)) {
+            return frame.value[slot];
+        }
+        vTaskDelay(1);
+    }
+    return 0;
 }
 
 /**
- * @brief Initialize hardware SPI for RX5808 (DMA-accelerated)
+ * @brief Initialize hardware SPI for RX5808 (polling writes, DMA optional)
  */
 static void RX5808_Init_Hardware_SPI(void) {
     esp_err_t ret;
@@ -172,13 +477,20 @@ static void RX5808_Init_Hardware_SPI(void) {
         .quadhd_io_num = -1,
         .max_transfer_sz = 4,                   // Only need 4 bytes (32 bits)
     };
+    // A 25-bit write fits in the transaction's own tx_data, so DMA only adds
+    // descriptor setup.  Optional so the benchmark can measure both.
+#ifdef CONFIG_RX5808_SPI_USE_DMA
+    const int dma_chan = SPI_DMA_CH_AUTO;
+#else
+    const int dma_chan = SPI_DMA_DISABLED;
+#endif
     
     // RX5808 device configuration
     spi_device_interface_config_t devcfg = {
         .clock_speed_hz = 1*1000*1000,          // 1MHz (RX5808 max is ~2MHz, be conservative)
         .mode = 0,                              // SPI mode 0 (CPOL=0, CPHA=0)
         .spics_io_num = RX5808_CS,              // GPIO 5
-        .queue_size = 4,                        // Queue up to 4 transactions
+        .queue_size = RX5808_SPI_QUEUE_LEN,     // Writes poll; queued path is benchmark-only
         .pre_cb = NULL,
         .post_cb = NULL,
         .flags = SPI_DEVICE_BIT_LSBFIRST,       // RX5808 expects LSB first
@@ -188,7 +500,7 @@ static void RX5808_Init_Hardware_SPI(void) {
     };
     
     // Initialize VSPI bus (SPI3)
-    ret = spi_bus_initialize(VSPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
+    ret = spi_bus_initialize(VSPI_HOST, &buscfg, dma_chan);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize VSPI bus: %s", esp_err_to_name(ret));
         return;
@@ -202,25 +514,29 @@ static void RX5808_Init_Hardware_SPI(void) {
     }
     
     rx5808_spi_initialized = true;
-    ESP_LOGI(TAG, "RX5808 hardware SPI initialized (DMA-accelerated, 1MHz)");
+    ESP_LOGI(TAG, "RX5808 hardware SPI initialized (%s, polling writes, 1MHz)",
+             dma_chan == SPI_DMA_DISABLED ? "no DMA" : "DMA");
 }
 
 
 void RX5808_Init()
 {
-    // Create SPI mutex for bus protection
-    spi_mutex = xSemaphoreCreateMutex();
-    if (spi_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create SPI mutex!");
-    }
-    // Create ADC mutex — must exist before RX5808_RSSI_ADC_Init() and before
-    // the RSSI task starts, so any early RX5808_ADC_Read_Raw() call is safe.
-    adc_mutex = xSemaphoreCreateMutex();
-    if (adc_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create ADC mutex!");
+    rf_mailbox_init(&tune_mbox);
+    // Settle tracking for RX5808_Tune_Async() — must exist before the first tune below.
+    tune_events = xEventGroupCreate();
+    if (tune_events == NULL) {
+        ESP_LOGE(TAG, "Failed to create tune event group!");
     }
+    esp_timer_create_args_t settle_timer_args = {
+        .callback = &rx5808_settle_timer_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "rx5808_settle",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&settle_timer_args, &settle_timer));
+    rx5808_settle_init(&settle_model);
     
-    // Initialize hardware SPI for RX5808 (DMA-accelerated)
+    // Initialize hardware SPI for RX5808 (polling writes)
     RX5808_Init_Hardware_SPI();
 
     // GPIO setup (CS and switches still need GPIO control)
@@ -231,14 +547,25 @@ void RX5808_Init()
 	gpio_set_level(RX5808_SWITCH0, 1);
 	gpio_set_level(RX5808_SWITCH1, 0);
 	
-	Send_Register_Data(Synthesizer_Register_A,0x00008);
-
-	Send_Register_Data(Power_Down_Control_Register,0x10DF3);
-
-	// Initialize Band X from NVS
+	// Initialize Band X from NVS (needed for the boot frequency)
 	RX5808_Init_Band_X();
 
-	RX5808_Set_Freq(RX5808_Get_Current_Freq());
+	// Whole init sequence in one SPI batch; the synthesizer write is
+	// tracked like any other tune.  The RF service does not run yet, so
+	// the bus is ours.
+	uint16_t boot_freq = RX5808_Get_Current_Freq();
+	const rx5808_reg_write_t init_seq[] = {
+		{ Synthesizer_Register_A,      0x00008 },
+		{ Power_Down_Control_Register, 0x10DF3 },
+		{ Synthesizer_Register_B,      rx5808_synth_register_b(boot_freq) },
+	};
+	rx5808_write_batch_locked(init_seq, sizeof(init_seq) / sizeof(init_seq[0]));
+	rx5808_tune_begin_locked(boot_freq, NULL);
+	expected_frequency = boot_freq;
+
+#ifdef CONFIG_RX5808_SPI_BENCHMARK
+	rx5808_spi_benchmark();
+#endif
 
 	RX5808_RSSI_ADC_Init();	
 
@@ -250,25 +577,59 @@ void RX5808_Init()
 	// 		NULL//任务句柄
 	// 		);
 
-	// Move RSSI ADC sampling to Core 1 for better load distribution (v1.7.1)
+	// RF service on Core 1 (v1.7.1), above the diversity task so a tune or
+	// antenna command posted from it is applied before it runs on
 	xTaskCreatePinnedToCore( (TaskFunction_t)DMA2_Stream0_IRQHandler,
-	                          "rx5808_rssi", 
-							  1536,  // Increased stack for Core 1
+	                          "rx5808_rf", 
+							  2560,  // SPI writes + ADC drain
 							  NULL,
-							   5,
-							    NULL, 
+							   7,
+							    &rssi_task_handle, 
 								1 );  // Core 1
+
+	// Scanner measurements run below the RF service that feeds them
+	measure_queue = xQueueCreate(RX5808_MEASURE_QUEUE_LEN, sizeof(rx5808_measure_req_t));
+	measure_lock = xSemaphoreCreateMutex();
+	if (measure_queue == NULL || measure_lock == NULL) {
+		ESP_LOGE(TAG, "Failed to create measure queue!");
+	} else {
+		xTaskCreatePinnedToCore(rx5808_measure_task, "rx5808_meas", 2048, NULL, 4, NULL, 1);
+	}
+}
+
+/**
+ * @brief Post a request bit to the RF service, replacing @p cancel
+ */
+static void rx5808_rf_request(uint32_t set, uint32_t cancel)
+{
+	__atomic_fetch_and(&rf_requests, ~cancel, __ATOMIC_RELAXED);
+	__atomic_fetch_or(&rf_requests, set, __ATOMIC_RELEASE);
+	if (rssi_task_handle != NULL) {
+		xTaskNotifyGive(rssi_task_handle);
+	}
 }
 
+// Composite video output (esp32-video) drives the DAC through I2S0, which on
+// ESP32 is also the continuous-ADC DMA engine: release it before the video
+// starts and take it back once the video has stopped.  Both are RF service
+// commands; Pause waits for the service to confirm I2S0 is free.
 void RX5808_Pause() {
-	RX5808_Shutdown = true;
-	gpio_set_level(RX5808_SWITCH0, 0);
-	gpio_set_level(RX5808_SWITCH1, 0);
+	if (rssi_task_handle == NULL) {
+		adc_dma_active = false;
+		rx5808_adc_dma_stop();
+		RX5808_Shutdown = true;
+		return;
+	}
+	xEventGroupClearBits(tune_events, RX5808_EVT_PAUSED);
+	rx5808_rf_request(RX5808_RF_REQ_PAUSE, RX5808_RF_REQ_RESUME);
+	EventBits_t bits = xEventGroupWaitBits(tune_events, RX5808_EVT_PAUSED, pdFALSE, pdTRUE,
+	                                       pdMS_TO_TICKS(RX5808_RF_PAUSE_TIMEOUT_MS));
+	if ((bits & RX5808_EVT_PAUSED) == 0) {
+		ESP_LOGE(TAG, "RF service did not release the ADC");
+	}
 }
 void RX5808_Resume() {
-	RX5808_Shutdown = false;
-	gpio_set_level(RX5808_SWITCH0, 1);
-	gpio_set_level(RX5808_SWITCH1, 0);
+	rx5808_rf_request(RX5808_RF_REQ_RESUME, RX5808_RF_REQ_PAUSE);
 }
 void Soft_SPI_Send_One_Bit(uint8_t bit)
 {
@@ -280,59 +641,11 @@ void Soft_SPI_Send_One_Bit(uint8_t bit)
 	usleep(20);
 }
 
-void Send_Register_Data(uint8_t addr,uint32_t data)   
+/**
+ * @brief Bit-bang one 25-bit register write (hardware SPI unavailable)
+ */
+static void rx5808_soft_spi_write(uint8_t addr, uint32_t data)
 {
-    // Serialise all SPI accesses with a single mutex (fix M).
-    //
-    // The hardware SPI path uses spi_device_queue_trans() followed by
-    // spi_device_get_trans_result().  Although spi_device_queue_trans() is
-    // internally queue-safe, the queue/get pair is NOT atomic: a second task
-    // calling queue_trans while the first task is inside get_trans_result
-    // could steal the transaction result.  Since v1.8.x introduced a
-    // dedicated diversity_task that calls RX5808_Set_Freq() concurrently with
-    // the ELRS backpack task, the mutex must wrap both the hardware and soft-
-    // SPI branches.
-    //
-    // Note: spi_mutex is created at the very start of RX5808_Init(), before
-    // any tasks that call Send_Register_Data() are spawned, so it is always
-    // valid here.
-    if (spi_mutex != NULL) {
-        xSemaphoreTake(spi_mutex, portMAX_DELAY);
-    }
-
-  if (rx5808_spi_initialized && rx5808_spi != NULL) {
-      // Hardware SPI with DMA (v1.7.1)
-      // RX5808 protocol: 4-bit addr + 1-bit R/W + 20-bit data = 25 bits (LSB first)
-      // Pack into 32 bits (4 bytes) with LSB first
-      
-      uint32_t spi_data = 0;
-      spi_data |= (addr & 0x0F);              // 4-bit address at bits 3-0
-      spi_data |= (1 << 4);                   // 1-bit write flag at bit 4
-      spi_data |= (data & 0xFFFFF) << 5;      // 20-bit data at bits 24-5
-      // Bits 31-25 are padding (ignored by RX5808 when CS goes high)
-      
-      // Prepare SPI transaction
-      spi_transaction_t trans = {
-          .flags = 0,
-          .length = 25,                       // 25 bits (actual data length)
-          .tx_buffer = &spi_data,
-          .rx_buffer = NULL,
-      };
-      
-      // Queue transaction (non-blocking with DMA)
-      esp_err_t ret = spi_device_queue_trans(rx5808_spi, &trans, portMAX_DELAY);
-      if (ret != ESP_OK) {
-          ESP_LOGE(TAG, "SPI queue transaction failed: %s", esp_err_to_name(ret));
-      }
-      
-      // Wait for transaction to complete (DMA handles the transfer)
-      spi_transaction_t *rtrans;
-      ret = spi_device_get_trans_result(rx5808_spi, &rtrans, portMAX_DELAY);
-      if (ret != ESP_OK) {
-          ESP_LOGE(TAG, "SPI get result failed: %s", esp_err_to_name(ret));
-      }
-  } else {
-      // Fallback to bit-banged SPI if hardware SPI fails
       gpio_set_level(RX5808_CS, 0);
       uint8_t read_write=1;   //1 write     0 read
      
@@ -345,38 +658,638 @@ void Send_Register_Data(uint8_t addr,uint32_t data)
 	  gpio_set_level(RX5808_CS, 1);
 	  gpio_set_level(RX5808_SCLK, 0);
 	  gpio_set_level(RX5808_MOSI, 0);
-  }
+}
 
-    if (spi_mutex != NULL) {
-        xSemaphoreGive(spi_mutex);
+/**
+ * @brief Build the 25-bit write transaction for one register.
+ *        RX5808 protocol: 4-bit addr + 1-bit R/W + 20-bit data = 25 bits
+ *        (LSB first); the payload travels in the transaction's tx_data.
+ */
+static void rx5808_spi_prepare(spi_transaction_t* t, uint8_t addr, uint32_t data)
+{
+    // Bits 31-25 are padding (ignored by RX5808 when CS goes high)
+    uint32_t spi_data = (addr & 0x0F) | (1u << 4) | ((data & 0xFFFFF) << 5);
+    memset(t, 0, sizeof(*t));
+    t->flags  = SPI_TRANS_USE_TXDATA;
+    t->length = 25;
+    memcpy(t->tx_data, &spi_data, sizeof(spi_data));
+}
+
+/**
+ * @brief Write a sequence of registers, skipping values the chip already
+ *        holds.  The bus is acquired once for the whole batch and every
+ *        write is a polling transmit: for a 25-bit payload the interrupt
+ *        and queue round trip of spi_device_queue_trans() cost more than
+ *        the 25 us on the wire.  Order is preserved.
+ *        RF service (or RX5808_Init() before it starts) only.
+ */
+static void rx5808_write_batch_locked(const rx5808_reg_write_t* writes, uint8_t count)
+{
+    bool hw = rx5808_spi_initialized && rx5808_spi != NULL;
+    bool acquired = false;
+    bool sent = false;
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t addr  = writes[i].addr & 0x0F;
+        uint32_t data = writes[i].data & 0xFFFFF;
+
+        if ((reg_shadow_valid & (1u << addr)) && reg_shadow[addr] == data) {
+            spi_stats.hits++;
+            continue;
+        }
+        spi_stats.misses++;
+        sent = true;
+        reg_shadow[addr] = data;
+        reg_shadow_valid |= (uint16_t)(1u << addr);
+
+        if (!hw) {
+            // Fallback to bit-banged SPI if hardware SPI fails
+            rx5808_soft_spi_write(addr, data);
+            continue;
+        }
+        if (!acquired) {
+            acquired = spi_device_acquire_bus(rx5808_spi, portMAX_DELAY) == ESP_OK;
+        }
+        spi_transaction_t t;
+        rx5808_spi_prepare(&t, addr, data);
+        esp_err_t ret = spi_device_polling_transmit(rx5808_spi, &t);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
+            reg_shadow_valid &= (uint16_t)~(1u << addr);
+        }
+    }
+    if (acquired) {
+        spi_device_release_bus(rx5808_spi);
+    }
+    if (sent) {
+        spi_stats.batches++;
     }
 }
 
-void RX5808_Set_Freq(uint16_t Fre)   
+/**
+ * @brief Clock one 25-bit register write out to the RX5808 (shadowed).
+ *        RF service only.
+ */
+static void rx5808_write_register_locked(uint8_t addr, uint32_t data)
 {
-#if BACKPACK_DETECTION_ENABLED
-	// Check if backpack is active - if so, skip SPI control
-	if (backpack_detected) {
-		ESP_LOGW(TAG, "Backpack active - skipping frequency change to %d MHz", Fre);
-		return;
-	}
+    rx5808_reg_write_t w = { .addr = addr, .data = data };
+    rx5808_write_batch_locked(&w, 1);
+}
+
+void Send_Register_Data(uint8_t addr,uint32_t data)   
+{
+    rx5808_reg_write_t w = { .addr = addr, .data = data };
+    Send_Register_Batch(&w, 1);
+}
+
+/**
+ * @brief Write several registers as one batch under a single bus
+ *        acquisition (see rx5808_write_batch_locked()); redundant writes
+ *        are skipped.
+ *
+ * The RF service owns the bus, so raw register access is only allowed from
+ * its context (or before RX5808_Init() starts it).  Other tasks retune with
+ * RX5808_Tune_Async().
+ */
+void Send_Register_Batch(const rx5808_reg_write_t* writes, uint8_t count)
+{
+    if (rssi_task_handle != NULL && xTaskGetCurrentTaskHandle() != rssi_task_handle) {
+        ESP_LOGE(TAG, "Register write outside the RF service ignored");
+        return;
+    }
+    rx5808_write_batch_locked(writes, count);
+}
+
+/**
+ * @brief Forget the shadow register file: the next write of every register
+ *        goes out even if it matches the last value we wrote.  Call when
+ *        another bus master may have reprogrammed the chip.  Applied by the
+ *        RF service before any tune posted after this call.
+ */
+void RX5808_Invalidate_Shadow_Registers(void)
+{
+    if (rssi_task_handle == NULL) {
+        reg_shadow_valid = 0;
+        return;
+    }
+    rx5808_rf_request(RX5808_RF_REQ_INVALIDATE, 0);
+}
+
+/**
+ * @brief Copy of the shadow register counters (diagnostics; fields are read
+ *        individually, not as one consistent snapshot)
+ */
+void RX5808_Get_SPI_Stats(rx5808_spi_stats_t* out)
+{
+    *out = spi_stats;
+}
+
+#ifdef CONFIG_RX5808_SPI_BENCHMARK
+typedef void (*rx5808_spi_bench_fn_t)(uint8_t addr, uint32_t data);
+
+// Interrupt-driven queue + wait: the write path used before the polling one
+static void rx5808_spi_bench_queued(uint8_t addr, uint32_t data)
+{
+    spi_transaction_t t, *rtrans;
+    rx5808_spi_prepare(&t, addr, data);
+    if (spi_device_queue_trans(rx5808_spi, &t, portMAX_DELAY) == ESP_OK) {
+        spi_device_get_trans_result(rx5808_spi, &rtrans, portMAX_DELAY);
+    }
+}
+
+// Polling transmit including the bus acquisition a single-write batch pays
+static void rx5808_spi_bench_polling(uint8_t addr, uint32_t data)
+{
+    spi_transaction_t t;
+    rx5808_spi_prepare(&t, addr, data);
+    spi_device_acquire_bus(rx5808_spi, portMAX_DELAY);
+    spi_device_polling_transmit(rx5808_spi, &t);
+    spi_device_release_bus(rx5808_spi);
+}
+
+static void rx5808_spi_bench_run(const char* name, rx5808_spi_bench_fn_t fn, uint8_t addr, uint32_t data)
+{
+    const uint32_t n = CONFIG_RX5808_SPI_BENCHMARK_ITERATIONS;
+    uint32_t min_us = UINT32_MAX, max_us = 0;
+    uint64_t sum = 0, sum_sq = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        int64_t t0 = esp_timer_get_time();
+        fn(addr, data);
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        if (dt < min_us) min_us = dt;
+        if (dt > max_us) max_us = dt;
+        sum    += dt;
+        sum_sq += (uint64_t)dt * dt;
+    }
+    float mean = (float)sum / n;
+    float var  = (float)sum_sq / n - mean * mean;
+    ESP_LOGI(TAG, "SPI bench %-8s min %4lu  mean %7.1f  max %4lu  sd %6.1f us (n=%lu)",
+             name, (unsigned long)min_us, mean, (unsigned long)max_us,
+             var > 0.0f ? sqrtf(var) : 0.0f, (unsigned long)n);
+}
+
+/**
+ * @brief Boot-time latency/jitter comparison of the three write paths.
+ *        Rewrites register A with its init value, so the chip state is
+ *        unchanged.  Runs from RX5808_Init() before the RF service starts.  Build once with and once without
+ *        CONFIG_RX5808_SPI_USE_DMA to cover both bus modes.
+ */
+static void rx5808_spi_benchmark(void)
+{
+    if (!rx5808_spi_initialized || rx5808_spi == NULL) {
+        ESP_LOGW(TAG, "SPI bench skipped: hardware SPI not available");
+        return;
+    }
+    rx5808_spi_bench_run("queued", rx5808_spi_bench_queued, Synthesizer_Register_A, 0x00008);
+    rx5808_spi_bench_run("polling", rx5808_spi_bench_polling, Synthesizer_Register_A, 0x00008);
+    // The pins belong to the SPI peripheral, so this measures the bit-bang
+    // timing only — nothing reaches the chip
+    rx5808_spi_bench_run("bitbang", rx5808_soft_spi_write, Synthesizer_Register_A, 0x00008);
+}
 #endif
 
-	uint16_t F_LO=(Fre-479)>>1;
+/**
+ * @brief esp_timer callback fired when the PLL of the last tune has settled.
+ *
+ * A retune issued while this callback is already queued re-arms the timer and
+ * moves settled_at_us forward, so a stale firing is recognised by comparing the
+ * current time against settled_at_us and ignored.
+ */
+static void rx5808_settle_timer_cb(void *arg)
+{
+    (void)arg;
+    rx5808_tune_cb_t cb = NULL;
+    uint16_t freq = 0;
+
+    portENTER_CRITICAL(&tune_lock);
+    bool settled = esp_timer_get_time() >= settled_at_us;
+    if (settled) {
+        cb      = tune_cb;
+        freq    = tune_freq;
+        tune_cb = NULL;
+    }
+    portEXIT_CRITICAL(&tune_lock);
+
+    if (!settled) {
+        return;
+    }
+    xEventGroupSetBits(tune_events, RX5808_EVT_SETTLED);
+    if (cb != NULL) {
+        cb(freq);
+    }
+}
+
+/**
+ * @brief Feed one RSSI sample into the settle model (RSSI task).
+ *
+ * When both receivers have converged before the predicted deadline the tune
+ * is completed early: settled_at_us is pulled in, the timer is cancelled and
+ * the event bit / callback fire from here instead.  tune_cb is taken under
+ * tune_lock, so the timer and the early exit can never both invoke it.
+ */
+static void rx5808_settle_feed(uint16_t rssi0, uint16_t rssi1, int64_t sample_us)
+{
+    rx5808_tune_cb_t cb = NULL;
+    uint16_t freq = 0;
+
+    portENTER_CRITICAL(&tune_lock);
+    bool early = rx5808_settle_observe(&settle_model, rssi0, rssi1, sample_us) &&
+                 esp_timer_get_time() < settled_at_us;
+    if (early) {
+        settled_at_us = esp_timer_get_time();
+        cb      = tune_cb;
+        freq    = tune_freq;
+        tune_cb = NULL;
+    }
+    portEXIT_CRITICAL(&tune_lock);
+
+    if (!early) {
+        return;
+    }
+    if (settle_timer != NULL) {
+        esp_timer_stop(settle_timer);
+    }
+    if (tune_events != NULL) {
+        xEventGroupSetBits(tune_events, RX5808_EVT_SETTLED);
+    }
+    if (cb != NULL) {
+        cb(freq);
+    }
+}
+
+/**
+ * @brief Synthesizer register B value (N<<7|A) for @p freq MHz
+ */
+static uint32_t rx5808_synth_register_b(uint16_t freq)
+{
+	uint16_t F_LO=(freq-479)>>1;
 	uint16_t N;
 	uint16_t A;
 	
 	N=F_LO/32;    
 	A=F_LO%32;    
+	return (uint32_t)N<<7|A;
+}
+
+/**
+ * @brief Start settle tracking for a synthesizer write just issued.
+ *        RF service (or RX5808_Init() before it starts) only.
+ */
+static void rx5808_tune_begin_locked(uint16_t freq, rx5808_tune_cb_t cb)
+{
+	if (tune_events != NULL) {
+		xEventGroupClearBits(tune_events, RX5808_EVT_SETTLED);
+	}
+	// Deadline comes from the learned model for this jump distance; the RSSI
+	// task may still complete the tune earlier once both receivers converge.
+	portENTER_CRITICAL(&tune_lock);
+	int64_t now_us = esp_timer_get_time();
+	uint32_t settle_us = rx5808_settle_predict_us(&settle_model, synth_freq, freq);
+	rx5808_settle_begin(&settle_model, synth_freq, freq, now_us);
+	settled_at_us = now_us + settle_us;
+	tune_freq     = freq;
+	tune_cb       = cb;
+	seq_freq      = freq;
+	tune_seq++;
+	portEXIT_CRITICAL(&tune_lock);
+
+	if (settle_timer != NULL) {
+		esp_timer_stop(settle_timer);   // ESP_ERR_INVALID_STATE if idle — harmless
+		esp_timer_start_once(settle_timer, settle_us);
+	}
+	synth_freq = freq;
+}
+
+/**
+ * @brief Apply a tune taken from the mailbox (RF service)
+ */
+static void rx5808_tune_apply(uint16_t freq, rx5808_tune_cb_t cb)
+{
+	uint32_t reg_b = rx5808_synth_register_b(freq);
+
+	if ((reg_shadow_valid & (1u << Synthesizer_Register_B)) && reg_shadow[Synthesizer_Register_B] == reg_b) {
+		// Already tuned there: the PLL is not disturbed, so the current
+		// settle deadline stands.  This tune's callback supersedes the
+		// pending one and fires from the timer as usual.
+		spi_stats.hits++;
+		portENTER_CRITICAL(&tune_lock);
+		bool settled = esp_timer_get_time() >= settled_at_us;
+		tune_freq = freq;
+		tune_cb   = cb;
+		portEXIT_CRITICAL(&tune_lock);
+		if (settled && settle_timer != NULL) {
+			esp_timer_stop(settle_timer);
+			esp_timer_start_once(settle_timer, 0);
+		}
+		return;
+	}
+	rx5808_write_register_locked(Synthesizer_Register_B, reg_b);
+	rx5808_tune_begin_locked(freq, cb);
+}
+
+/**
+ * @brief Retune both RX5808 chips without waiting for the PLL to settle.
+ *
+ * The tune is posted to the RF service, which writes the synthesizer register
+ * as soon as it runs (it preempts every other Core 1 task); settling is
+ * tracked in the background.  When it completes, the RX5808_EVT_SETTLED event
+ * bit is set, RX5808_Is_Settled() turns true and @p cb (if not NULL) is
+ * invoked from the esp_timer task (predicted deadline) or the RF service
+ * (early convergence).  A newer tune supersedes a pending one — one posted
+ * before the service got to the older is the only one written — and only the
+ * callback of the most recent tune fires.  The callback must be short and
+ * must not touch LVGL objects.
+ *
+ * @param freq Frequency in MHz
+ * @param cb   Optional "tuned and settled" callback
+ * @return false if the tune was not issued (ELRS backpack owns the bus)
+ */
+bool RX5808_Tune_Async(uint16_t freq, rx5808_tune_cb_t cb)
+{
+#if BACKPACK_DETECTION_ENABLED
+	// Check if backpack is active - if so, skip SPI control
+	if (backpack_detected) {
+		ESP_LOGW(TAG, "Backpack active - skipping frequency change to %d MHz", freq);
+		return false;
+	}
+#endif
 
-	Send_Register_Data(Synthesizer_Register_B,N<<7|A);
-	
 	// Track expected frequency and timestamp
-	expected_frequency = Fre;
+	expected_frequency = freq;
 	last_freq_set_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-	
-	// Wait for RX5808 to settle on new frequency (optimized for faster switching)
-	vTaskDelay(RX5808_FREQ_SETTLING_TIME_MS / portTICK_PERIOD_MS);
+
+	rf_cmd_t cmd = { .arg = freq, .ptr = (void*)cb };
+	rf_mailbox_post(&tune_mbox, &cmd);
+	if (rssi_task_handle != NULL) {
+		xTaskNotifyGive(rssi_task_handle);
+	}
+	return true;
+}
+
+/**
+ * @brief true once the most recent tune has been written and its PLL has settled.
+ *        In IRAM with its callees (rf_mailbox_idle(), esp_timer_get_time()):
+ *        diversity_frame_cb() calls it on the RF service.
+ */
+IRAM_ATTR bool RX5808_Is_Settled(void)
+{
+	return rf_mailbox_idle(&tune_mbox) && esp_timer_get_time() >= settled_at_us;
+}
+
+/**
+ * @brief esp_timer timestamp (us) at which the most recent tune is (or will be) settled.
+ *        In IRAM, like RX5808_Is_Settled().
+ */
+IRAM_ATTR int64_t RX5808_Get_Settled_Time_Us(void)
+{
+	portENTER_CRITICAL(&tune_lock);
+	int64_t t = settled_at_us;
+	portEXIT_CRITICAL(&tune_lock);
+	return t;
+}
+
+/**
+ * @brief Settle time (us) the learned model currently predicts for a retune
+ *        from @p from_mhz to @p to_mhz
+ */
+uint32_t RX5808_Get_Predicted_Settle_Us(uint16_t from_mhz, uint16_t to_mhz)
+{
+	portENTER_CRITICAL(&tune_lock);
+	uint32_t us = rx5808_settle_predict_us(&settle_model, from_mhz, to_mhz);
+	portEXIT_CRITICAL(&tune_lock);
+	return us;
+}
+
+/**
+ * @brief Sequence number of the most recent synthesizer retune.
+ *        Lets consumers detect that a retune happened since they last looked.
+ */
+uint32_t RX5808_Get_Tune_Seq(void)
+{
+	return tune_seq;
+}
+
+/**
+ * @brief Block until the most recent tune has settled.
+ *        Only for callers that must measure right after tuning.
+ * @return true if settled within @p timeout_ms
+ */
+bool RX5808_Wait_Settled(uint32_t timeout_ms)
+{
+	if (tune_events == NULL) {
+		vTaskDelay(RX5808_FREQ_SETTLING_TIME_MS / portTICK_PERIOD_MS);
+		return true;
+	}
+	// The bit may still be set from the previous tune while the newest one
+	// sits in the mailbox, so it only wakes us to re-check the condition.
+	TickType_t start = xTaskGetTickCount();
+	TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+	for (;;) {
+		if (RX5808_Is_Settled()) {
+			return true;
+		}
+		TickType_t waited = xTaskGetTickCount() - start;
+		if (waited >= timeout) {
+			return false;
+		}
+		xEventGroupWaitBits(tune_events, RX5808_EVT_SETTLED, pdTRUE, pdTRUE, timeout - waited);
+	}
+}
+
+/**
+ * @brief Blocking tune: RX5808_Tune_Async() followed by RX5808_Wait_Settled().
+ *        Scanners use RX5808_Measure() and every other caller should use
+ *        RX5808_Tune_Async().
+ */
+void RX5808_Set_Freq(uint16_t Fre)   
+{
+	if (RX5808_Tune_Async(Fre, NULL)) {
+		RX5808_Wait_Settled(RX5808_FREQ_SETTLING_TIME_MS * 2);
+	}
+}
+
+/**
+ * @brief Number of RSSI frames produced in @p ms at the current frame rate
+ *        (at least 1).  Lets scanners size RX5808_Measure() by time, so a
+ *        scan stays the same length in the oneshot fallback.
+ */
+uint16_t RX5808_Get_RSSI_Frames_In(uint16_t ms)
+{
+	uint32_t n = (uint32_t)ms * RX5808_Get_RSSI_Rate() / 1000;
+	return (n == 0) ? 1 : (n > UINT16_MAX ? UINT16_MAX : (uint16_t)n);
+}
+
+/**
+ * @brief Sequence number of the most recent retune and, in @p freq, the
+ *        frequency it wrote (consistent with each other)
+ */
+static uint32_t rx5808_tune_seq_freq(uint16_t* freq)
+{
+	portENTER_CRITICAL(&tune_lock);
+	uint32_t seq = tune_seq;
+	*freq = seq_freq;
+	portEXIT_CRITICAL(&tune_lock);
+	return seq;
+}
+
+/**
+ * @brief Wait for the request's tune to settle, then collect its frames.
+ *        The tune mailbox keeps only the newest tune, so another one posted
+ *        before the RF service applied ours replaces it: the result is then
+ *        reported with ok = false rather than measured on that frequency.
+ * @param tuned false if RX5808_Tune_Async() refused (backpack owns the bus)
+ * @return false if the request was cancelled meanwhile (no callback)
+ */
+static bool rx5808_measure_run(const rx5808_measure_req_t* req, bool tuned, rx5808_measure_t* res)
+{
+	memset(res, 0, sizeof(*res));
+	res->freq = req->freq;
+	if (!tuned) {
+		return true;    // Reported with ok = false
+	}
+	// Attach before waiting so dwell time already sits in the ring
+	const rssi_ring_t* ring = RX5808_Get_Sample_Ring();
+	rssi_ring_reader_t rd;
+	rssi_ring_reader_init(ring, &rd);
+
+	if (!RX5808_Wait_Settled(RX5808_FREQ_SETTLING_TIME_MS * 2)) {
+		return true;
+	}
+	// Only now is the tune written (the RF service applies it), so this is
+	// the seq a later retune would move away from.  A tune of someone else's
+	// that superseded ours in the mailbox settled instead of it.
+	uint16_t freq;
+	uint32_t seq = rx5808_tune_seq_freq(&freq);
+	if (freq != req->freq) {
+		return true;
+	}
+	// First frame whose whole filter window lies after settle + dwell
+	int64_t start_us = RX5808_Get_Settled_Time_Us() + (int64_t)req->dwell_ms * 1000 +
+	                   RX5808_Get_RSSI_Group_Delay_Us();
+	int64_t deadline_us = start_us +
+	                      (int64_t)req->n_samples * 1000000 / RX5808_Get_RSSI_Rate() +
+	                      RX5808_MEASURE_TIMEOUT_MS * 1000;
+
+	uint32_t sum[2] = {0, 0};
+	uint64_t sum_sq[2] = {0, 0};
+	res->min[0] = res->min[1] = UINT16_MAX;
+
+	while (res->samples < req->n_samples) {
+		rssi_frame_t frame;
+		if (req->gen != measure_gen) {
+			return false;
+		}
+		if (RX5808_Get_Tune_Seq() != seq || esp_timer_get_time() > deadline_us) {
+			break;      // Retuned underneath us, or no frames (ADC stalled)
+		}
+		if (!rssi_ring_read(ring, &rd, &frame)) {
+			vTaskDelay(1);
+			continue;
+		}
+		if (frame.t_us < start_us) {
+			continue;
+		}
+		for (int rx = 0; rx < 2; rx++) {
+			uint16_t v = frame.value[rx == 0 ? RSSI_SLOT_RSSI0 : RSSI_SLOT_RSSI1];
+			if (v < res->min[rx]) res->min[rx] = v;
+			if (v > res->max[rx]) res->max[rx] = v;
+			sum[rx]    += v;
+			sum_sq[rx] += (uint32_t)v * v;
+		}
+		res->t_us = frame.t_us;
+		res->samples++;
+	}
+
+	if (res->samples == 0) {
+		res->min[0] = res->min[1] = 0;
+		return true;
+	}
+	for (int rx = 0; rx < 2; rx++) {
+		uint32_t n = res->samples;
+		res->mean[rx] = (uint16_t)((sum[rx] + n / 2) / n);
+		// Population variance: E[x^2] - E[x]^2, exact in integers
+		res->variance[rx] = (uint32_t)((sum_sq[rx] * n - (uint64_t)sum[rx] * sum[rx]) / ((uint64_t)n * n));
+	}
+	res->percent[0] = Rx5808_Calculate_RSSI_Precentage(res->mean[0], Rx5808_RSSI_Ad_Min0, Rx5808_RSSI_Ad_Max0);
+	res->percent[1] = Rx5808_Calculate_RSSI_Precentage(res->mean[1], Rx5808_RSSI_Ad_Min1, Rx5808_RSSI_Ad_Max1);
+	res->ok = res->samples == req->n_samples;
+	return true;
+}
+
+static void rx5808_measure_task(void *arg)
+{
+	(void)arg;
+	rx5808_measure_req_t req;
+	rx5808_measure_t res;
+
+	for (;;) {
+		if (xQueueReceive(measure_queue, &req, portMAX_DELAY) != pdTRUE) {
+			continue;
+		}
+		// Tune under the lock: after RX5808_Measure_Cancel() returns, a
+		// cancelled request can no longer move the synthesizer
+		xSemaphoreTake(measure_lock, portMAX_DELAY);
+		bool live  = req.gen == measure_gen;
+		bool tuned = live && RX5808_Tune_Async(req.freq, NULL);
+		xSemaphoreGive(measure_lock);
+		if (!live || !rx5808_measure_run(&req, tuned, &res)) {
+			continue;
+		}
+		xSemaphoreTake(measure_lock, portMAX_DELAY);
+		if (req.gen == measure_gen && req.cb != NULL) {
+			req.cb(&res, req.arg);
+		}
+		xSemaphoreGive(measure_lock);
+	}
+}
+
+/**
+ * @brief Queue a tune-and-measure: retune to @p freq, wait until the PLL has
+ *        settled, skip @p dwell_ms, then collect @p n_samples RSSI frames of
+ *        both receivers and report min/mean/max/variance through @p cb.
+ *
+ * Requests are served in order by a background task, so a scanner can queue
+ * a whole band and never blocks.  @p cb runs in that task: it must be short
+ * and must not touch LVGL objects — copy the result and let an LVGL timer
+ * pick it up.
+ *
+ * @param n_samples Frames to collect (see RX5808_Get_RSSI_Frames_In())
+ * @return false if the queue is full or the driver is not initialised.  The
+ *         queue is shared by every scanner: check it and post again later.
+ */
+bool RX5808_Measure(uint16_t freq, uint16_t dwell_ms, uint16_t n_samples,
+                    rx5808_measure_cb_t cb, void* arg)
+{
+	if (measure_queue == NULL || n_samples == 0) {
+		return false;
+	}
+	rx5808_measure_req_t req = {
+		.freq      = freq,
+		.dwell_ms  = dwell_ms,
+		.n_samples = n_samples,
+		.gen       = measure_gen,
+		.cb        = cb,
+		.arg       = arg,
+	};
+	return xQueueSend(measure_queue, &req, 0) == pdTRUE;
+}
+
+/**
+ * @brief Drop every queued measurement and abort the one in progress.
+ *        Once this returns no earlier request retunes the receivers or runs
+ *        its callback, so a page can restore its channel on exit and free
+ *        whatever its callback touches.
+ */
+void RX5808_Measure_Cancel(void)
+{
+	if (measure_queue == NULL) {
+		return;
+	}
+	xSemaphoreTake(measure_lock, portMAX_DELAY);
+	measure_gen++;
+	xQueueReset(measure_queue);
+	xSemaphoreGive(measure_lock);
 }
 
 void Rx5808_Set_Channel(uint8_t ch)
@@ -523,90 +1436,296 @@ float Rx5808_Calculate_RSSI_Precentage(uint16_t value, uint16_t min, uint16_t ma
    return precent;   
 }
 
-// Apply moving average filter to RSSI value for smoother readings.
-// index must be a pointer to the per-buffer write cursor (rssi0/1_filter_index).
-static uint16_t filter_rssi(uint16_t new_value, uint16_t *buffer, uint8_t *index) {
-    buffer[*index] = new_value;
-    *index = (*index + 1) % RSSI_FILTER_SIZE;
-    
-    uint32_t sum = 0;
-    for(int i = 0; i < RSSI_FILTER_SIZE; i++) {
-        sum += buffer[i];
-    }
-    return sum / RSSI_FILTER_SIZE;
-}
-
+/**
+ * @brief Smoothed 0-99 % RSSI of receiver 0 (precomputed by the RSSI task,
+ *        no side effects — any number of callers see the same value)
+ */
 float Rx5808_Get_Precentage0()
 {
-    // Apply smoothing filter before calculating percentage
-    uint16_t filtered_value = filter_rssi(adc_converted_value[0], rssi0_filter_buffer, &rssi0_filter_index);
-    return Rx5808_Calculate_RSSI_Precentage(filtered_value, Rx5808_RSSI_Ad_Min0, Rx5808_RSSI_Ad_Max0);
+    rssi_frame_t frame;
+    RX5808_Get_Sample(&frame);
+    return frame.percent[0];
 }
 
+/**
+ * @brief Smoothed 0-99 % RSSI of receiver 1 (see Rx5808_Get_Precentage0())
+ */
 float Rx5808_Get_Precentage1()
 {
-    // Apply smoothing filter before calculating percentage
-    uint16_t filtered_value = filter_rssi(adc_converted_value[1], rssi1_filter_buffer, &rssi1_filter_index);
-    return Rx5808_Calculate_RSSI_Precentage(filtered_value, Rx5808_RSSI_Ad_Min1, Rx5808_RSSI_Ad_Max1);
+    rssi_frame_t frame;
+    RX5808_Get_Sample(&frame);
+    return frame.percent[1];
+}
+
+/**
+ * @brief Smoothed raw RSSI of one receiver (0 before the first sample)
+ */
+uint16_t RX5808_Get_RSSI_Filtered(rx5808_receive rx)
+{
+    rssi_frame_t frame;
+    RX5808_Get_Sample(&frame);
+    return frame.filtered[(rx == rx5808_receiver0) ? 0 : 1];
 }
 
 float Get_Battery_Voltage()
 {
-	//return (float)adc_converted_value[2]/4095*53.3375;
-    return (float)adc_converted_value[2]/4095*6.8;
+	rssi_frame_t frame;
+	RX5808_Get_Sample(&frame);
+	//return (float)frame.value[RSSI_SLOT_VBAT]/4095*53.3375;
+    return (float)frame.value[RSSI_SLOT_VBAT]/4095*6.8;
 }
 
 
 
-void DMA2_Stream0_IRQHandler(void)     
+/**
+ * @brief Filter stage + publish: smooth RSSI, derive the calibrated
+ *        percentages, then hand the frame to the ring, the latest-sample
+ *        snapshot and the settle model.  RF service only.
+ */
+static void rx5808_publish_frame(rssi_frame_t* frame)
 {
-	//static uint16_t count=0;
+    static uint32_t filter_tune_seq = 0;
+
+    // Restart smoothing with the first settled sample of a new channel, so a
+    // scanner reading right after RX5808_Wait_Settled() never gets a window
+    // still averaging the previous channel.
+    bool retuned = filter_tune_seq != tune_seq && frame->t_us >= RX5808_Get_Settled_Time_Us();
+    if (retuned) {
+        filter_tune_seq = tune_seq;
+    }
 
-	while(1)
-	{
-    uint32_t sum0=0,sum1=0;
+    // Same ~64-100 ms smoothing whatever the frame rate: largest power-of-two
+    // window not longer than RSSI_FILTER_WINDOW_MS (64 @ 1 kHz, 16 @ 250 Hz, 4 @ 100 Hz)
+    uint8_t len_log2 = RSSI_FILTER_LOG2_ONESHOT;
+    if (adc_dma_active) {
+        uint32_t frames = RSSI_FILTER_WINDOW_MS * (RSSI_ADC_CHAN_HZ / rssi_decim_factor) / 1000;
+        len_log2 = 0;
+        while (len_log2 < RSSI_FILTER_MAX_LOG2 && (2u << len_log2) <= frames) {
+            len_log2++;
+        }
+    }
+    for (int rx = 0; rx < RSSI_FILTER_RX; rx++) {
+        if (retuned) {
+            rssi_filter_init(&rssi_filter[rx], len_log2);
+        }
+        rssi_filter_set_length(&rssi_filter[rx], len_log2);
+        frame->filtered[rx] = rssi_filter_push(&rssi_filter[rx],
+                                               frame->value[rx == 0 ? RSSI_SLOT_RSSI0 : RSSI_SLOT_RSSI1]);
+    }
+    frame->percent[0] = Rx5808_Calculate_RSSI_Precentage(frame->filtered[0], Rx5808_RSSI_Ad_Min0, Rx5808_RSSI_Ad_Max0);
+    frame->percent[1] = Rx5808_Calculate_RSSI_Precentage(frame->filtered[1], Rx5808_RSSI_Ad_Min1, Rx5808_RSSI_Ad_Max1);
+
+    rssi_ring_publish(&rssi_ring, frame);
+    rssi_snapshot_write(&rssi_latest, frame);
+    rx5808_settle_feed(frame->value[RSSI_SLOT_RSSI0], frame->value[RSSI_SLOT_RSSI1], frame->t_us);
 
+    rx5808_frame_cb_t cb = frame_cb;
+    if (cb != NULL) {
+        cb(frame);
+    }
+}
+
+/**
+ * @brief Drain every conversion frame the DMA has completed.
+ *
+ * Results are timestamped backwards from the read time at the fixed
+ * conversion period, so each decimated frame carries the time of its last
+ * conversion.  That only holds for the newest result, so a backlog of
+ * several conversion frames (the service was held off) is read in full
+ * before any of it is timestamped.
+ */
+static void rx5808_adc_dma_drain(void)
+{
+    static uint8_t buf[RSSI_ADC_POOL_BYTES + RSSI_ADC_FRAME_BYTES];    // Driver pool + the frame in flight
+
+    uint16_t pending = rssi_decim_pending;
+    if (pending != 0) {
+        rssi_decim_pending = 0;
+        rssi_decim_factor  = pending;
+        rssi_decim_init(&rssi_decim, pending);
+        ESP_LOGI(TAG, "RSSI frame rate %d Hz (filter delay %lu us)",
+                 RSSI_ADC_CHAN_HZ / pending, (unsigned long)RX5808_Get_RSSI_Group_Delay_Us());
+    }
+
+    bool more = true;
+    while (more) {
+        uint32_t total = 0;
+        more = false;
+        while (adc_dma_active && adc_cont_handle != NULL && total + RSSI_ADC_FRAME_BYTES <= sizeof(buf)) {
+            uint32_t len = 0;
+            if (adc_continuous_read(adc_cont_handle, buf + total, RSSI_ADC_FRAME_BYTES, &len, 0) != ESP_OK) {
+                break;      // ESP_ERR_TIMEOUT: pool empty
+            }
+            total += len;
+            more = total + RSSI_ADC_FRAME_BYTES > sizeof(buf);    // Full: there may be more
+        }
+
+        int64_t end_us = esp_timer_get_time();
+        uint32_t n = total / SOC_ADC_DIGI_RESULT_BYTES;
+        for (uint32_t i = 0; i < n; i++) {
+            adc_digi_output_data_t *p = (adc_digi_output_data_t *)&buf[i * SOC_ADC_DIGI_RESULT_BYTES];
+            rssi_frame_t frame;
+            if (rssi_decim_push(&rssi_decim, rx5808_adc_slot(p->type1.channel), p->type1.data, &frame)) {
+                frame.t_us = end_us - (int64_t)(n - 1 - i) * RSSI_ADC_CONV_PERIOD_US;
+                rx5808_publish_frame(&frame);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Oneshot fallback (composite video active or DMA unavailable):
+ *        16-sample RSSI burst plus VBAT/KEY, published as a single frame.
+ */
+static void rx5808_adc_oneshot_sample(void)
+{
+    uint32_t sum0=0,sum1=0;
     int _adc_raw;
-    // Hold adc_mutex for the entire burst so RX5808_ADC_Read_Raw() (Core 0,
-    // LVGL keypad) cannot interleave and get a 0 back from a busy unit.
-    if (adc_mutex != NULL) xSemaphoreTake(adc_mutex, portMAX_DELAY);
+    rssi_frame_t frame;
+
+    frame.t_us = esp_timer_get_time();  // burst start — never credited to a tune issued mid-burst
     for(int i=0;i<16;i++)
     {
         adc_oneshot_read(adc1_handle, RX5808_RSSI0_CHAN, &_adc_raw); sum0 += _adc_raw;
         adc_oneshot_read(adc1_handle, RX5808_RSSI1_CHAN, &_adc_raw); sum1 += _adc_raw;
     }
-    // Note: static cur/pre receiver_best locals removed — only used in old simple-diversity
-    // else-branch which has been deleted (see below).
-    adc_converted_value[0] = sum0 >> 4;
-    adc_converted_value[1] = sum1 >> 4;
+    frame.value[RSSI_SLOT_RSSI0] = sum0 >> 4;
+    frame.value[RSSI_SLOT_RSSI1] = sum1 >> 4;
     adc_oneshot_read(adc1_handle, VBAT_ADC_CHAN, &_adc_raw);
-    adc_converted_value[2] = (uint16_t)_adc_raw;
-    if (adc_mutex != NULL) xSemaphoreGive(adc_mutex);
-		
+    frame.value[RSSI_SLOT_VBAT] = (uint16_t)_adc_raw;
+    adc_oneshot_read(adc1_handle, KEY_ADC_CHAN, &_adc_raw);
+    frame.value[RSSI_SLOT_KEY] = (uint16_t)_adc_raw;
+
+    rx5808_publish_frame(&frame);
+}
+
+/**
+ * @brief Select the antenna used in Auto signal-source mode.
+ *        Called by diversity.c; the RF service switches the GPIOs.
+ */
+IRAM_ATTR void RX5808_Set_Antenna(rx5808_antenna_t ant)
+{
+	if (ant == antenna_request) {
+		return;
+	}
+	antenna_request = (uint8_t)ant;
+	if (rssi_task_handle != NULL) {
+		xTaskNotifyGive(rssi_task_handle);
+	}
+}
+
+/**
+ * @brief Drive the switch GPIOs for the current signal source (RF service).
+ *        Break before make: both lines drop before the new side is asserted,
+ *        so the two receivers are never selected together.
+ */
+static IRAM_ATTR void rx5808_antenna_apply(void)
+{
+	uint8_t ant;
 	int sig_src = Rx5808_Signal_Source;
 	// 关断则都为0
-	if(RX5808_Shutdown) {
-		sig_src = 3;
+	if (RX5808_Shutdown || sig_src == 3) {
+		ant = RX5808_ANTENNA_OFF;
+	} else if (sig_src == 1) {
+		ant = RX5808_ANTENNA_A;
+	} else if (sig_src == 2) {
+		ant = RX5808_ANTENNA_B;
+	} else {
+		ant = antenna_request;     // Auto: diversity.c decides
 	}
-	if(sig_src==1) {
+	if (ant == antenna_applied) {
+		return;
+	}
+	antenna_applied = ant;
+	gpio_set_level(RX5808_SWITCH0, 0);
+	gpio_set_level(RX5808_SWITCH1, 0);
+	if (ant == RX5808_ANTENNA_A) {
 		gpio_set_level(RX5808_SWITCH1, 1);
-		gpio_set_level(RX5808_SWITCH0, 0);
+	} else if (ant == RX5808_ANTENNA_B) {
+		gpio_set_level(RX5808_SWITCH0, 1);
+	}
+	int64_t now_us = esp_timer_get_time();
+	portENTER_CRITICAL(&tune_lock);
+	antenna_applied_us = now_us;
+	portEXIT_CRITICAL(&tune_lock);
+}
 
+/**
+ * @brief esp_timer time (us) at which the RF service last changed the
+ *        antenna switch GPIOs (0 before the first change)
+ */
+int64_t RX5808_Get_Antenna_Switch_Time_Us(void)
+{
+	portENTER_CRITICAL(&tune_lock);
+	int64_t t = antenna_applied_us;
+	portEXIT_CRITICAL(&tune_lock);
+	return t;
+}
+
+/**
+ * @brief Execute posted commands (RF service): request bits first, so a
+ *        shadow invalidation reaches the tune posted after it, then the
+ *        newest tune from the mailbox.
+ */
+static void rx5808_rf_commands(void)
+{
+	uint32_t req = __atomic_exchange_n(&rf_requests, 0, __ATOMIC_ACQUIRE);
+
+	if (req & RX5808_RF_REQ_INVALIDATE) {
+		reg_shadow_valid = 0;
 	}
-	else if(sig_src==2) {
-		gpio_set_level(RX5808_SWITCH0, 1);
-		gpio_set_level(RX5808_SWITCH1, 0);
+	if (req & RX5808_RF_REQ_PAUSE) {
+		adc_dma_active = false;
+		rx5808_adc_dma_stop();
+		RX5808_Shutdown = true;
+		rx5808_antenna_apply();
+		xEventGroupSetBits(tune_events, RX5808_EVT_PAUSED);
+	}
+	if (req & RX5808_RF_REQ_RESUME) {
+		if (adc_cont_handle == NULL && adc1_handle != NULL) {
+			adc_dma_active = rx5808_adc_dma_start();
+		}
+		RX5808_Shutdown = false;
 	}
-	else if(sig_src==3) {
-		gpio_set_level(RX5808_SWITCH0, 0);
-		gpio_set_level(RX5808_SWITCH1, 0);
+
+	rf_cmd_t cmd;
+	uint32_t ticket;
+	if (rf_mailbox_take(&tune_mbox, &cmd, &ticket)) {
+		rx5808_tune_apply((uint16_t)cmd.arg, (rx5808_tune_cb_t)cmd.ptr);
+		// Settle state describes the new tune before it counts as applied
+		rf_mailbox_done(&tune_mbox, ticket);
+	}
+}
+
+// RF service task (name kept from the STM32 port, where this was the ADC DMA
+// ISR): sole owner of the SPI bus, the antenna switch and ADC1
+void DMA2_Stream0_IRQHandler(void)     
+{
+	while(1)
+	{
+	// Commands and the antenna first: a switch posted by the diversity
+	// task reaches the pins before this wake-up's frames are processed
+	rx5808_rf_commands();
+	rx5808_antenna_apply();
+	if (adc_dma_active) {
+		rx5808_adc_dma_drain();
+	} else {
+		rx5808_adc_oneshot_sample();
+	}
+
+	// Woken per DMA conversion frame (~6.4 ms) and by every posted command;
+	// the timeout only covers a DMA stall.  Oneshot fallback: 25 ms idle rate
+	// (thermal optimization), every tick while a tune is being observed so
+	// convergence can actually be seen.
+	TickType_t wait;
+	if (adc_dma_active) {
+		wait = pdMS_TO_TICKS(RSSI_TASK_PERIOD_MS) + 1;
+	} else if (settle_model.tracking) {
+		wait = RSSI_TASK_SETTLE_TICKS;
+	} else {
+		wait = RSSI_TASK_PERIOD_MS / portTICK_PERIOD_MS;
 	}
-	// sig_src == 0 (Auto): diversity.c task owns GPIO switching via
-	// diversity_perform_switch(). Do NOT write SWITCH0/SWITCH1 here —
-	// the old simple algorithm ran with inverted polarity vs diversity.c
-	// and caused them to fight each other on every 25 ms cycle.
-	//	(count==100)?(count=0):(++count);
-	vTaskDelay(25 / portTICK_PERIOD_MS);  // Changed from 10ms to 25ms to reduce ADC polling rate (thermal optimization)
+	ulTaskNotifyTake(pdTRUE, wait);
 	}
 		
 }
@@ -635,12 +1754,17 @@ void RX5808_Check_Backpack_Activity(void)
 	if ((current_time_ms - last_freq_set_time_ms) > 2000) {
 		
 		// Check RSSI stability - if both receivers show signal, backpack might be controlling
-		uint16_t rssi0 = adc_converted_value[0];
-		uint16_t rssi1 = adc_converted_value[1];
+		rssi_frame_t frame;
+		RX5808_Get_Sample(&frame);
+		uint16_t rssi0 = frame.value[RSSI_SLOT_RSSI0];
+		uint16_t rssi1 = frame.value[RSSI_SLOT_RSSI1];
 		
 		// If RSSI values are significantly above noise floor, assume external control
 		if ((rssi0 > 200 || rssi1 > 200) && !backpack_detected) {
 			backpack_detected = true;
+			// The backpack may retune the chip: stop trusting the shadow so
+			// the reclaim below really rewrites our frequency
+			RX5808_Invalidate_Shadow_Registers();
 			backpack_detected_time_ms = current_time_ms;
 			ESP_LOGW(TAG, "ExpressLRS Backpack detected - ESP32 control suspended");
 		}
@@ -652,7 +1776,7 @@ void RX5808_Check_Backpack_Activity(void)
 			backpack_detected = false;
 			ESP_LOGI(TAG, "Attempting to reclaim SPI bus from backpack");
 			// Re-apply our expected frequency
-			RX5808_Set_Freq(expected_frequency);
+			RX5808_Tune_Async(expected_frequency, NULL);
 		}
 	}
 #endif
@@ -667,11 +1791,12 @@ void RX5808_Set_Backpack_Detected(bool detected)
 	if (detected != backpack_detected) {
 		backpack_detected = detected;
 		if (detected) {
+			RX5808_Invalidate_Shadow_Registers();
 			ESP_LOGI(TAG, "Backpack control enabled");
 		} else {
 			ESP_LOGI(TAG, "Backpack control disabled - ESP32 resume");
 			// Restore our frequency setting
-			RX5808_Set_Freq(expected_frequency);
+			RX5808_Tune_Async(expected_frequency, NULL);
 		}
 	}
 }
@@ -686,10 +1811,11 @@ bool RX5808_Is_Backpack_Detected(void)
 }
 
 /**
- * @brief Get expected frequency (what ESP32 last tried to set)
+ * @brief Get expected frequency (what ESP32 last tried to set).
+ *        In IRAM, like RX5808_Get_Sample().
  * @return Frequency in MHz
  */
-uint16_t RX5808_Get_Expected_Frequency(void)
+IRAM_ATTR uint16_t RX5808_Get_Expected_Frequency(void)
 {
 	return expected_frequency;
 }
@@ -704,7 +1830,7 @@ void RX5808_Clear_Backpack_Detection(void)
 		backpack_detected = false;
 		last_freq_set_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
 		// Re-apply frequency
-		RX5808_Set_Freq(expected_frequency);
+		RX5808_Tune_Async(expected_frequency, NULL);
 	}
 }
 
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "hardware/hwvers.h"
+#include "hardware/rssi_ring.h"
 
 
 typedef enum
@@ -13,18 +14,79 @@ typedef enum
 	 rx5808_receiver_count,
 }rx5808_receive;
 
+/** @brief Antenna switch selection (RX5808_Set_Antenna()); receiver n of a
+ *         diversity build is RX5808_ANTENNA_A + n */
+typedef enum
+{
+    RX5808_ANTENNA_OFF = 0,     // Both switch lines low
+    RX5808_ANTENNA_A,           // SWITCH1 = 1
+    RX5808_ANTENNA_B,           // SWITCH0 = 1
+} rx5808_antenna_t;
+
+/** @brief "Tuned and settled" callback for RX5808_Tune_Async() (esp_timer task or RF service context) */
+typedef void (*rx5808_tune_cb_t)(uint16_t freq);
+
+/** @brief One register write of a Send_Register_Batch() */
+typedef struct {
+    uint8_t  addr;              // Register address (0x00-0x0F)
+    uint32_t data;              // 20-bit value
+} rx5808_reg_write_t;
+
+/** @brief Shadow register counters (RX5808_Get_SPI_Stats()) */
+typedef struct {
+    uint32_t hits;              // Writes skipped: the chip already held the value
+    uint32_t misses;            // Writes sent over SPI
+    uint32_t batches;           // SPI batches that sent at least one write
+} rx5808_spi_stats_t;
+
+/** @brief New-frame hook (RX5808_Set_Frame_Callback()); RF service context, once per frame */
+typedef void (*rx5808_frame_cb_t)(const rssi_frame_t* frame);
+
+/** @brief Result of one RX5808_Measure() (raw 12-bit RSSI statistics per receiver) */
+typedef struct {
+    uint16_t freq;              // Frequency measured (MHz)
+    uint16_t samples;           // Frames collected
+    uint16_t min[2];
+    uint16_t max[2];
+    uint16_t mean[2];
+    uint32_t variance[2];       // Population variance (counts^2)
+    float    percent[2];        // mean[] as calibrated 0-99 %
+    int64_t  t_us;              // Time of the last frame
+    bool     ok;                // false: tune refused, superseded by another tune or timed out
+} rx5808_measure_t;
+
+/** @brief RX5808_Measure() completion callback (measure task context) */
+typedef void (*rx5808_measure_cb_t)(const rx5808_measure_t* result, void* arg);
+
 extern const char Rx5808_ChxMap[7];
 extern const uint16_t Rx5808_Freq[7][8];
 extern volatile int8_t channel_count;
 extern volatile int8_t Chx_count;
-extern uint16_t adc_converted_value[3];
 void RX5808_RSSI_ADC_Init(void);
 void RX5808_Init(void);
 void RX5808_Pause(void);  
 void RX5808_Resume(void);
 void Soft_SPI_Send_One_Bit(uint8_t bit);
 void Send_Register_Data(uint8_t addr, uint32_t data);
+void Send_Register_Batch(const rx5808_reg_write_t* writes, uint8_t count);
+void RX5808_Invalidate_Shadow_Registers(void);
+void RX5808_Get_SPI_Stats(rx5808_spi_stats_t* out);
 void RX5808_Set_Freq(uint16_t Fre);
+// Asynchronous tuning — never sleeps through PLL settling
+bool RX5808_Tune_Async(uint16_t freq, rx5808_tune_cb_t cb);
+bool RX5808_Is_Settled(void);
+int64_t RX5808_Get_Settled_Time_Us(void);
+uint32_t RX5808_Get_Tune_Seq(void);
+bool RX5808_Wait_Settled(uint32_t timeout_ms);
+uint32_t RX5808_Get_Predicted_Settle_Us(uint16_t from_mhz, uint16_t to_mhz);
+// Antenna selection in Auto mode — applied by the RF service
+void RX5808_Set_Antenna(rx5808_antenna_t ant);
+int64_t RX5808_Get_Antenna_Switch_Time_Us(void);
+// Tune-and-measure for scanners — queued, never blocks the caller
+bool RX5808_Measure(uint16_t freq, uint16_t dwell_ms, uint16_t n_samples,
+                    rx5808_measure_cb_t cb, void* arg);
+void RX5808_Measure_Cancel(void);
+uint16_t RX5808_Get_RSSI_Frames_In(uint16_t ms);
 void Rx5808_Set_Channel(uint8_t ch);
 void RX5808_Set_RSSI_Ad_Min0(uint16_t value);
 void RX5808_Set_RSSI_Ad_Max0(uint16_t value);
@@ -72,8 +134,18 @@ void RX5808_Load_Band_X_From_NVS(void);
 bool RX5808_Is_Band_X(void);
 uint16_t RX5808_Get_Current_Freq(void);
 
-// ADC shared access (oneshot unit, also used by lvgl keypad driver)
+// ADC shared access (newest RF service frame, also used by lvgl keypad driver)
 int RX5808_ADC_Read_Raw(int channel);
+// Continuous RSSI sampling (1 kHz timestamped frames)
+const rssi_ring_t* RX5808_Get_Sample_Ring(void);
+bool RX5808_Is_ADC_Streaming(void);
+bool RX5808_Set_RSSI_Rate(uint16_t rate_hz);
+uint16_t RX5808_Get_RSSI_Rate(void);
+uint32_t RX5808_Get_RSSI_Group_Delay_Us(void);
+bool RX5808_Get_Sample(rssi_frame_t* out);
+void RX5808_Set_Frame_Callback(rx5808_frame_cb_t cb);
+uint16_t RX5808_Get_RSSI_Raw(rx5808_receive rx);
+uint16_t RX5808_Get_RSSI_Filtered(rx5808_receive rx);
 
 #endif
 
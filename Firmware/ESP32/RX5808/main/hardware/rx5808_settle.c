@@ -0,0 +1,173 @@
+/**
+ * @file rx5808_settle.c
+ * @brief Learned, jump-size-aware PLL settle-time model for the RX5808
+ */
+
+#include "rx5808_settle.h"
+
+// Upper edge (inclusive, MHz) of each jump-distance bucket:
+//   ≤2 MHz  : point-8 ±1 MHz micro-shifts
+//   ≤10     : spectrum zoom steps
+//   ≤40     : neighbouring channels within a band
+//   ≤100    : band-to-band within the 5.8 GHz block
+//   ≤250    : wide sweeps
+//   >250    : L-band <-> E/F/R jumps (up to ~600 MHz)
+static const uint16_t settle_bucket_limit[RX5808_SETTLE_BUCKETS] = {
+    2, 10, 40, 100, 250, UINT16_MAX
+};
+
+#define SETTLE_STABLE_TOL      32   // Max sample-to-sample change (ADC counts) still considered "stable"
+#define SETTLE_STABLE_SAMPLES   4   // Consecutive stable samples required to declare convergence
+#define SETTLE_MOVE_MIN       150   // RSSI must move at least this much for the tune to be learned
+#define SETTLE_MARGIN_DIV       4   // Learned value = observed + observed/4 (25% safety margin)
+
+static uint16_t settle_abs_diff(uint16_t a, uint16_t b)
+{
+    return (a > b) ? (uint16_t)(a - b) : (uint16_t)(b - a);
+}
+
+static uint8_t settle_bucket_for(uint16_t from_mhz, uint16_t to_mhz)
+{
+    uint16_t jump = settle_abs_diff(from_mhz, to_mhz);
+    uint8_t b = 0;
+    while (b < RX5808_SETTLE_BUCKETS - 1 && jump > settle_bucket_limit[b]) {
+        b++;
+    }
+    return b;
+}
+
+static uint32_t settle_clamp_us(uint32_t us)
+{
+    if (us < RX5808_SETTLE_MIN_US) return RX5808_SETTLE_MIN_US;
+    if (us > RX5808_SETTLE_MAX_US) return RX5808_SETTLE_MAX_US;
+    return us;
+}
+
+/**
+ * @brief Fold one observed convergence time into a bucket.
+ *        Rises fast (half-way) so a slow outlier is honoured on the next
+ *        tune, decays slowly (1/8) so one lucky fast tune cannot shrink it.
+ */
+static void settle_learn(rx5808_settle_model_t* m, uint8_t bucket, uint32_t observed_us)
+{
+    uint32_t target  = settle_clamp_us(observed_us + observed_us / SETTLE_MARGIN_DIV);
+    uint32_t learned = m->learned_us[bucket];
+
+    if (target > learned) {
+        learned = (learned + target + 1) / 2;
+    } else {
+        learned -= (learned - target) / 8;
+    }
+    m->learned_us[bucket] = settle_clamp_us(learned);
+    if (m->learn_count[bucket] < UINT16_MAX) m->learn_count[bucket]++;
+}
+
+/**
+ * @brief Reset the model: every bucket starts at the conservative ceiling.
+ */
+void rx5808_settle_init(rx5808_settle_model_t* m)
+{
+    for (uint8_t i = 0; i < RX5808_SETTLE_BUCKETS; i++) {
+        m->learned_us[i]  = RX5808_SETTLE_MAX_US;
+        m->learn_count[i] = 0;
+    }
+    m->tracking  = false;
+    m->converged = false;
+}
+
+/**
+ * @brief Upper edge (MHz) of a jump bucket — for diagnostics output
+ */
+uint16_t rx5808_settle_bucket_limit_mhz(uint8_t bucket)
+{
+    return (bucket < RX5808_SETTLE_BUCKETS) ? settle_bucket_limit[bucket] : UINT16_MAX;
+}
+
+/**
+ * @brief Predicted settle time for a retune from @p from_mhz to @p to_mhz
+ */
+uint32_t rx5808_settle_predict_us(const rx5808_settle_model_t* m, uint16_t from_mhz, uint16_t to_mhz)
+{
+    return settle_clamp_us(m->learned_us[settle_bucket_for(from_mhz, to_mhz)]);
+}
+
+/**
+ * @brief Start observing a new tune (call right after the synthesizer write)
+ */
+void rx5808_settle_begin(rx5808_settle_model_t* m, uint16_t from_mhz, uint16_t to_mhz, int64_t now_us)
+{
+    m->tracking        = true;
+    m->converged       = false;
+    m->bucket          = settle_bucket_for(from_mhz, to_mhz);
+    m->tune_us         = now_us;
+    m->stable_since_us = now_us;
+    m->stable_count    = 0;
+    m->have_sample     = false;
+}
+
+/**
+ * @brief Feed one RSSI sample taken after the tune.
+ *
+ * Convergence = SETTLE_STABLE_SAMPLES consecutive samples whose change on
+ * both receivers stays within SETTLE_STABLE_TOL.  The convergence time is
+ * the start of that stable run.  Only tunes where the RSSI actually moved
+ * are learned — on an empty band the noise floor is "stable" immediately
+ * and says nothing about the PLL.  Such tunes may still exit early, but not
+ * before half of the learned prediction for their bucket.
+ *
+ * @return true exactly once per tune, when it may be treated as settled
+ */
+bool rx5808_settle_observe(rx5808_settle_model_t* m, uint16_t rssi0, uint16_t rssi1, int64_t sample_us)
+{
+    if (!m->tracking || sample_us <= m->tune_us) {
+        return false; // Idle, or sample captured before the synthesizer write
+    }
+
+    int64_t elapsed_us = sample_us - m->tune_us;
+    if (elapsed_us > (int64_t)RX5808_SETTLE_TRACK_US) {
+        m->tracking = false; // Never converged — leave the table alone
+        return false;
+    }
+
+    if (!m->have_sample) {
+        m->first_rssi[0] = m->last_rssi[0] = rssi0;
+        m->first_rssi[1] = m->last_rssi[1] = rssi1;
+        m->stable_since_us = sample_us;
+        m->stable_count    = 0;
+        m->have_sample     = true;
+        return false;
+    }
+
+    uint16_t d0 = settle_abs_diff(rssi0, m->last_rssi[0]);
+    uint16_t d1 = settle_abs_diff(rssi1, m->last_rssi[1]);
+    if (d0 <= SETTLE_STABLE_TOL && d1 <= SETTLE_STABLE_TOL) {
+        if (m->stable_count < UINT8_MAX) m->stable_count++;
+    } else {
+        m->stable_count    = 0;
+        m->stable_since_us = sample_us;
+    }
+    m->last_rssi[0] = rssi0;
+    m->last_rssi[1] = rssi1;
+
+    if (m->stable_count < SETTLE_STABLE_SAMPLES) {
+        return false;
+    }
+
+    bool moved = settle_abs_diff(rssi0, m->first_rssi[0]) >= SETTLE_MOVE_MIN ||
+                 settle_abs_diff(rssi1, m->first_rssi[1]) >= SETTLE_MOVE_MIN;
+    uint32_t floor_us = moved ? RX5808_SETTLE_MIN_US
+                              : settle_clamp_us(m->learned_us[m->bucket] / 2);
+    if (elapsed_us < (int64_t)floor_us) {
+        return false; // Stable, but too early to trust
+    }
+
+    if (moved) {
+        settle_learn(m, m->bucket, (uint32_t)(m->stable_since_us - m->tune_us));
+    }
+    m->tracking = false;
+    if (m->converged) {
+        return false;
+    }
+    m->converged = true;
+    return true;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file rx5808_settle.h
+ * @brief Learned, jump-size-aware PLL settle-time model for the RX5808
+ *
+ * Replaces the single fixed settle constant with a small table indexed by
+ * retune distance.  After every tune the driver feeds RSSI samples into the
+ * model; once both receivers stop moving the tune is declared settled (early
+ * exit) and, if the RSSI actually went through a transition, the observed
+ * convergence time is folded into the table entry for that jump size.
+ */
+
+#ifndef __RX5808_SETTLE_H
+#define __RX5808_SETTLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RX5808_SETTLE_BUCKETS        6       // Jump-distance buckets (see rx5808_settle.c)
+#define RX5808_SETTLE_MAX_US     50000u      // Ceiling / initial seed (the old fixed 50 ms)
+#define RX5808_SETTLE_MIN_US      3000u      // Never predict or exit earlier than this
+#define RX5808_SETTLE_TRACK_US  100000u      // Give up observing a tune after this long
+
+/** @brief Settle model state (one instance per RX5808 pair) */
+typedef struct {
+    // Learned table
+    uint32_t learned_us[RX5808_SETTLE_BUCKETS];   // Predicted settle time per jump bucket
+    uint16_t learn_count[RX5808_SETTLE_BUCKETS];  // Transitions learned per bucket
+
+    // Convergence tracking of the tune in progress
+    bool     tracking;          // A tune is being observed
+    bool     converged;         // Convergence already reported for this tune
+    uint8_t  bucket;            // Bucket of the tune being observed
+    int64_t  tune_us;           // Timestamp of the synthesizer write
+    int64_t  stable_since_us;   // Timestamp of the first sample in the current stable run
+    uint16_t first_rssi[2];     // First post-tune sample (transition detection)
+    uint16_t last_rssi[2];      // Previous sample
+    uint8_t  stable_count;      // Consecutive samples within tolerance
+    bool     have_sample;       // last_rssi is valid
+} rx5808_settle_model_t;
+
+void     rx5808_settle_init(rx5808_settle_model_t* m);
+uint32_t rx5808_settle_predict_us(const rx5808_settle_model_t* m, uint16_t from_mhz, uint16_t to_mhz);
+void     rx5808_settle_begin(rx5808_settle_model_t* m, uint16_t from_mhz, uint16_t to_mhz, int64_t now_us);
+bool     rx5808_settle_observe(rx5808_settle_model_t* m, uint16_t rssi0, uint16_t rssi1, int64_t sample_us);
+uint16_t rx5808_settle_bucket_limit_mhz(uint8_t bucket);
+
+#endif // __RX5808_SETTLE_H
@@ -15,6 +15,10 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "diversity.h"
+#include "console.h"
+#ifdef CONFIG_FLIGHT_RECORDER
+#include "flightrec.h"
+#endif
 #include "led.h"
 #include "esp_log.h"
 #include "esp_pm.h"
@@ -149,6 +153,14 @@ void system_init(void)
 	// Initialize diversity algorithm
 	diversity_init();
 	printf("Diversity algorithm initialized!\n");
+
+	#ifdef CONFIG_FLIGHT_RECORDER
+	flightrec_init();
+	printf("Flight recorder initialized!\n");
+	#endif
+
+	console_init();
+	printf("Console initialized!\n");
 	
 	//ws2812_init();
 	//printf("ws2812 init success!\n");
@@ -0,0 +1,515 @@
+/**
+ * @file diversity_opt.c
+ * @brief Offline diversity parameter optimizer: grid or random search of
+ *        diversity_mode_params_t over a corpus of RSSI traces
+ *
+ * Every candidate runs in DIVERSITY_MODE_CUSTOM_1 of the unmodified
+ * diversity.c against every trace (sim_run()), and is scored as
+ *
+ *     cost = (time on the worse antenna + switches x penalty
+ *             + updates x update cost) / trace minutes
+ *
+ * in seconds per minute of flight, so a lower cost is better.  Candidates
+ * are split over forked worker processes (diversity.c keeps global state,
+ * so each worker has its own copy) and reported back over pipes.  The best
+ * one is written as a profile blob (diversity_profile.h) that the firmware
+ * loads from NVS next to the built-in modes.
+ */
+
+#include "diversity.h"
+#include "diversity_profile.h"
+#include "sim_hal.h"
+#include "sim_run.h"
+#include "trace.h"
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define OPT_MAX_TRACES      16
+#define OPT_MAX_JOBS        64
+#define OPT_TOP             10
+#define OPT_DEFAULT_RANDOM  400
+#define OPT_DEFAULT_PENALTY 20      // ms of "bad video" charged per switch
+#define OPT_DEFAULT_UPDATE  10      // us charged per diversity_update() call (CPU)
+
+// Search space.  Cooldown is a multiple of dwell, weight_stability is
+// 1 - weight_rssi, the fade-estimator beta is matched to alpha, the
+// evaluation rate range is one of a few min / max pairs, and the response
+// to multipath flutter one of a few dwell % / stability-weight kept pairs.
+static const uint16_t opt_dwell[]        = { 40, 80, 150, 250, 400 };
+static const uint8_t  opt_cooldown_x[]   = { 1, 2, 3 };
+static const uint8_t  opt_hysteresis[]   = { 1, 2, 4, 6, 8 };
+static const float    opt_weight_rssi[]  = { 0.6f, 0.7f, 0.8f, 0.9f };
+static const int16_t  opt_slope[]        = { -50, -100, -200, -400 };
+static const float    opt_kf_alpha[]     = { 0.25f, 0.4f, 0.5f };
+static const uint16_t opt_predict_ms[]   = { 20, 40, 60, 100 };
+static const uint16_t opt_rate[][2]      = { { 10, 100 }, { 20, 100 }, { 25, 200 } };
+static const uint8_t  opt_flutter[][2]   = { { 100, 1 }, { 50, 1 }, { 25, 0 } };
+
+#define OPT_LEN(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+/** @brief Worker → parent record */
+typedef struct {
+    uint32_t index;
+    double   cost;
+    double   worse_pct;
+    double   switches_per_min;
+    double   updates_per_s;
+} opt_score_t;
+
+typedef struct {
+    diversity_mode_params_t params;
+    opt_score_t             score;
+} opt_candidate_t;
+
+static opt_candidate_t* opt_cand;
+static uint32_t         opt_ncand;
+static uint32_t         opt_cap;
+
+static void opt_add(const diversity_mode_params_t* p)
+{
+    if (opt_ncand == opt_cap) {
+        opt_cap  = opt_cap ? opt_cap * 2 : 1024;
+        opt_cand = realloc(opt_cand, opt_cap * sizeof(*opt_cand));
+        if (opt_cand == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    memset(&opt_cand[opt_ncand], 0, sizeof(opt_cand[0]));
+    opt_cand[opt_ncand].params = *p;
+    opt_cand[opt_ncand].score.index = opt_ncand;
+    opt_ncand++;
+}
+
+// Matched steady-state beta for alpha (rssi_kalman.h)
+static uint32_t opt_kf_beta(float alpha)
+{
+    return RSSI_KALMAN_Q16(2.0f * (2.0f - alpha) - 4.0f * sqrtf(1.0f - alpha));
+}
+
+static void opt_set(diversity_mode_params_t* p, int dwell, int cool, int hyst, int w,
+                    int slope, diversity_predictor_t pred, int alpha, int predict, int rate, int flutter)
+{
+    p->dwell_ms         = opt_dwell[dwell];
+    p->cooldown_ms      = opt_dwell[dwell] * opt_cooldown_x[cool];
+    p->hysteresis_pct   = opt_hysteresis[hyst];
+    p->weight_rssi      = DIVERSITY_Q15(opt_weight_rssi[w]);
+    p->weight_stability = DIVERSITY_Q15(1.0f - opt_weight_rssi[w]);
+    p->slope_threshold  = opt_slope[slope];
+    p->predictor        = pred;
+    p->kf_alpha         = RSSI_KALMAN_Q16(opt_kf_alpha[alpha]);
+    p->kf_beta          = opt_kf_beta(opt_kf_alpha[alpha]);
+    p->predict_ms       = opt_predict_ms[predict];
+    p->rate_min_hz      = opt_rate[rate][0];
+    p->rate_max_hz      = opt_rate[rate][1];
+    p->flutter_dwell_pct        = opt_flutter[flutter][0];
+    p->flutter_weight_stability = opt_flutter[flutter][1] ? p->weight_stability : 0;
+}
+
+/**
+ * @brief Full grid.  Slope threshold only matters to the slope predictor and
+ *        alpha / look-ahead only to the fade estimator, so each predictor
+ *        varies only its own parameters (the others stay at the base mode's).
+ */
+static void opt_grid(const diversity_mode_params_t* base)
+{
+    for (int d = 0; d < OPT_LEN(opt_dwell); d++)
+    for (int c = 0; c < OPT_LEN(opt_cooldown_x); c++)
+    for (int h = 0; h < OPT_LEN(opt_hysteresis); h++)
+    for (int w = 0; w < OPT_LEN(opt_weight_rssi); w++)
+    for (int r = 0; r < OPT_LEN(opt_rate); r++)
+    for (int f = 0; f < OPT_LEN(opt_flutter); f++) {
+        diversity_mode_params_t p = {0};
+        for (int s = 0; s < OPT_LEN(opt_slope); s++) {
+            opt_set(&p, d, c, h, w, s, DIVERSITY_PREDICT_SLOPE, 0, 0, r, f);
+            p.kf_alpha = base->kf_alpha;
+            p.kf_beta = base->kf_beta;
+            p.predict_ms = base->predict_ms;
+            opt_add(&p);
+        }
+        for (int a = 0; a < OPT_LEN(opt_kf_alpha); a++)
+        for (int t = 0; t < OPT_LEN(opt_predict_ms); t++) {
+            opt_set(&p, d, c, h, w, 0, DIVERSITY_PREDICT_KALMAN, a, t, r, f);
+            p.slope_threshold = base->slope_threshold;
+            opt_add(&p);
+        }
+    }
+}
+
+static uint32_t opt_rand(uint32_t* s)
+{
+    // xorshift32
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static void opt_random(uint32_t n, uint32_t seed)
+{
+    uint32_t s = seed ? seed : 1;
+    for (uint32_t i = 0; i < n; i++) {
+        diversity_mode_params_t p = {0};
+        opt_set(&p,
+                opt_rand(&s) % OPT_LEN(opt_dwell), opt_rand(&s) % OPT_LEN(opt_cooldown_x),
+                opt_rand(&s) % OPT_LEN(opt_hysteresis), opt_rand(&s) % OPT_LEN(opt_weight_rssi),
+                opt_rand(&s) % OPT_LEN(opt_slope), (diversity_predictor_t)(opt_rand(&s) % DIVERSITY_PREDICT_COUNT),
+                opt_rand(&s) % OPT_LEN(opt_kf_alpha), opt_rand(&s) % OPT_LEN(opt_predict_ms),
+                opt_rand(&s) % OPT_LEN(opt_rate), opt_rand(&s) % OPT_LEN(opt_flutter));
+        opt_add(&p);
+    }
+}
+
+static double opt_penalty_s = OPT_DEFAULT_PENALTY / 1000.0;
+static double opt_update_s  = OPT_DEFAULT_UPDATE / 1e6;
+
+static void opt_evaluate(opt_candidate_t* c, const trace_t* traces, int ntraces)
+{
+    double bad_s = 0.0, minutes = 0.0, worse_s = 0.0;
+    uint32_t switches = 0, updates = 0;
+    for (int t = 0; t < ntraces; t++) {
+        sim_config_t cfg = { .mode = DIVERSITY_MODE_CUSTOM_1, .predictor = -1, .custom = &c->params };
+        sim_result_t r;
+        sim_run(&traces[t], &cfg, &r);
+        double w = r.worse_pct / 100.0 * r.minutes * 60.0;
+        worse_s  += w;
+        bad_s    += w + r.switches * opt_penalty_s + r.updates * opt_update_s;
+        minutes  += r.minutes;
+        switches += r.switches;
+        updates  += r.updates;
+    }
+    c->score.cost             = minutes > 0 ? bad_s / minutes : 0.0;
+    c->score.worse_pct        = minutes > 0 ? 100.0 * worse_s / (minutes * 60.0) : 0.0;
+    c->score.switches_per_min = minutes > 0 ? switches / minutes : 0.0;
+    c->score.updates_per_s    = minutes > 0 ? updates / (minutes * 60.0) : 0.0;
+}
+
+static bool opt_write_all(int fd, const void* buf, size_t len)
+{
+    const uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief Score every candidate on @p jobs worker processes, worker w taking
+ *        candidates w, w + jobs, ...  Results come back over one pipe each.
+ */
+static bool opt_run_parallel(const trace_t* traces, int ntraces, int jobs)
+{
+    int   fd[OPT_MAX_JOBS];
+    pid_t pid[OPT_MAX_JOBS];
+
+    fflush(stdout);
+    for (int w = 0; w < jobs; w++) {
+        int p[2];
+        if (pipe(p) != 0) {
+            perror("pipe");
+            return false;
+        }
+        pid[w] = fork();
+        if (pid[w] < 0) {
+            perror("fork");
+            return false;
+        }
+        if (pid[w] == 0) {
+            close(p[0]);
+            for (uint32_t i = (uint32_t)w; i < opt_ncand; i += (uint32_t)jobs) {
+                opt_evaluate(&opt_cand[i], traces, ntraces);
+                if (!opt_write_all(p[1], &opt_cand[i].score, sizeof(opt_score_t))) {
+                    _exit(1);
+                }
+            }
+            _exit(0);
+        }
+        close(p[1]);
+        fd[w] = p[0];
+    }
+
+    bool ok = true;
+    uint32_t received = 0;
+    for (int w = 0; w < jobs; w++) {
+        opt_score_t s;
+        ssize_t n;
+        while ((n = read(fd[w], &s, sizeof(s))) == (ssize_t)sizeof(s)) {
+            if (s.index < opt_ncand) {
+                opt_cand[s.index].score = s;
+                received++;
+            }
+        }
+        close(fd[w]);
+        int status;
+        if (waitpid(pid[w], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+    if (!ok || received != opt_ncand) {
+        fprintf(stderr, "worker failed (%u of %u candidates scored)\n", received, opt_ncand);
+        return false;
+    }
+    return true;
+}
+
+static int opt_cmp(const void* a, const void* b)
+{
+    double ca = ((const opt_candidate_t*)a)->score.cost;
+    double cb = ((const opt_candidate_t*)b)->score.cost;
+    return (ca > cb) - (ca < cb);
+}
+
+static void opt_print(const char* tag, const opt_candidate_t* c)
+{
+    const diversity_mode_params_t* p = &c->params;
+    char rate[16], flutter[16];
+    snprintf(rate, sizeof(rate), "%u-%u", p->rate_min_hz, p->rate_max_hz);
+    snprintf(flutter, sizeof(flutter), "%u%%/%.2f", p->flutter_dwell_pct, p->flutter_weight_stability / 32768.0);
+    printf("%-8s %7.3f %7.2f %7.1f %6.1f  %5u %5u %4u %5.2f %5d %-6s %5.2f %4u %7s %9s\n", tag,
+           c->score.cost, c->score.worse_pct, c->score.switches_per_min, c->score.updates_per_s,
+           p->dwell_ms, p->cooldown_ms, p->hysteresis_pct, p->weight_rssi / 32768.0,
+           p->slope_threshold, p->predictor == DIVERSITY_PREDICT_KALMAN ? "kalman" : "slope",
+           p->kf_alpha / 65536.0, p->predict_ms, rate, flutter);
+}
+
+/**
+ * @brief Write @p best into the blob at @p path: replaces the entry with the
+ *        same name, else is appended to an existing valid blob
+ */
+static bool opt_save_blob(const char* path, const diversity_mode_params_t* best, const char* name)
+{
+    diversity_profile_t profiles[DIVERSITY_CUSTOM_PROFILES];
+    int count = 0;
+
+    FILE* f = fopen(path, "rb");
+    if (f != NULL) {
+        uint8_t old[DIVERSITY_PROFILE_BLOB_MAX + 1];
+        size_t len = fread(old, 1, sizeof(old), f);
+        fclose(f);
+        count = diversity_profile_decode(old, len, profiles, DIVERSITY_CUSTOM_PROFILES);
+        if (count < 0) {
+            fprintf(stderr, "%s exists but is not a profile blob; not overwriting\n", path);
+            return false;
+        }
+    }
+
+    int slot = 0;
+    while (slot < count && strcmp(profiles[slot].name, name) != 0) {
+        slot++;
+    }
+    if (slot == DIVERSITY_CUSTOM_PROFILES) {
+        fprintf(stderr, "%s already holds %d profiles\n", path, DIVERSITY_CUSTOM_PROFILES);
+        return false;
+    }
+    profiles[slot].params = *best;
+    snprintf(profiles[slot].name, sizeof(profiles[slot].name), "%s", name);
+    if (slot == count) {
+        count++;
+    }
+
+    uint8_t blob[DIVERSITY_PROFILE_BLOB_MAX];
+    size_t len = diversity_profile_encode(profiles, count, blob, sizeof(blob));
+    f = fopen(path, "wb");
+    if (f == NULL || fwrite(blob, 1, len, f) != len) {
+        perror(path);
+        if (f != NULL) {
+            fclose(f);
+        }
+        return false;
+    }
+    fclose(f);
+    printf("wrote %s: \"%s\" in slot CUSTOM_%d (%d profile%s)\n",
+           path, profiles[slot].name, slot + 1, count, count == 1 ? "" : "s");
+    return true;
+}
+
+/**
+ * @brief CSV for ESP-IDF's nvs_partition_gen.py holding just the blob
+ */
+static bool opt_save_nvs_csv(const char* path, const char* blob_path)
+{
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "key,type,encoding,value\n"
+               "diversity,namespace,,\n"
+               "profiles,file,binary,%s\n", blob_path);
+    fclose(f);
+    printf("wrote %s\n", path);
+    return true;
+}
+
+static void opt_usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-t trace.csv|trace.bin]... [-s scenario|all] [-S seed]\n"
+            "          [-m mode] [-g | -r N] [-j jobs] [-w penalty_ms] [-u update_us]\n"
+            "          [-N name] [-o profiles.bin] [-n nvs.csv]\n"
+            "  -t FILE  trace to optimise over (t_us,rssi_a,rssi_b,...); repeatable\n"
+            "  -s NAME  synthetic scenario: multipath, obstacle, long-range or all\n"
+            "           (default: all, when no -t is given)\n"
+            "  -S SEED  seed for the synthetic scenarios and the random search (default 1)\n"
+            "  -m MODE  built-in mode to compare against (default freestyle)\n"
+            "  -g       full grid search\n"
+            "  -r N     N random candidates from the grid (default %d)\n"
+            "  -j JOBS  worker processes (default: online CPUs)\n"
+            "  -w MS    cost charged per switch, in ms on the worse antenna (default %d)\n"
+            "  -u US    cost charged per diversity_update() call, in us (default %d)\n"
+            "  -N NAME  profile name (default \"Opt\")\n"
+            "  -o FILE  add the best profile to the blob FILE (same name is replaced)\n"
+            "  -n FILE  also write an nvs_partition_gen.py CSV for the blob\n",
+            argv0, OPT_DEFAULT_RANDOM, OPT_DEFAULT_PENALTY, OPT_DEFAULT_UPDATE);
+}
+
+int main(int argc, char** argv)
+{
+    const char* files[OPT_MAX_TRACES];
+    int nfiles = 0;
+    const char* scenario = NULL;
+    const char* blob_path = NULL;
+    const char* csv_path = NULL;
+    const char* name = "Opt";
+    uint32_t seed = 1;
+    uint32_t nrandom = OPT_DEFAULT_RANDOM;
+    bool grid = false;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    diversity_mode_t base_mode = DIVERSITY_MODE_FREESTYLE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:S:m:gr:j:w:u:N:o:n:h")) != -1) {
+        switch (opt) {
+        case 't':
+            if (nfiles == OPT_MAX_TRACES) {
+                fprintf(stderr, "at most %d traces\n", OPT_MAX_TRACES);
+                return 2;
+            }
+            files[nfiles++] = optarg;
+            break;
+        case 's': scenario = optarg; break;
+        case 'S': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'g': grid = true; break;
+        case 'r': nrandom = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'j': jobs = atoi(optarg); break;
+        case 'w': opt_penalty_s = atof(optarg) / 1000.0; break;
+        case 'u': opt_update_s = atof(optarg) / 1e6; break;
+        case 'N': name = optarg; break;
+        case 'o': blob_path = optarg; break;
+        case 'n': csv_path = optarg; break;
+        case 'm': {
+            static const char* const keys[] = { "race", "freestyle", "long-range" };
+            int m = 0;
+            while (m < DIVERSITY_MODE_BUILTIN_COUNT && strcasecmp(optarg, keys[m]) != 0) {
+                m++;
+            }
+            if (m == DIVERSITY_MODE_BUILTIN_COUNT) {
+                fprintf(stderr, "unknown mode '%s'\n", optarg);
+                return 2;
+            }
+            base_mode = (diversity_mode_t)m;
+            break;
+        }
+        default:
+            opt_usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (jobs < 1) {
+        jobs = 1;
+    }
+    if (jobs > OPT_MAX_JOBS) {
+        jobs = OPT_MAX_JOBS;
+    }
+    if (strlen(name) >= DIVERSITY_PROFILE_NAME_LEN) {
+        fprintf(stderr, "name longer than %d characters\n", DIVERSITY_PROFILE_NAME_LEN - 1);
+        return 2;
+    }
+    if (csv_path != NULL && blob_path == NULL) {
+        fprintf(stderr, "-n needs -o\n");
+        return 2;
+    }
+    if (scenario == NULL && nfiles == 0) {
+        scenario = "all";
+    }
+
+    trace_t traces[OPT_MAX_TRACES + TRACE_SCENARIO_COUNT];
+    int ntraces = 0;
+    for (int i = 0; i < nfiles; i++) {
+        if (!trace_load(&traces[ntraces], files[i])) {
+            return 1;
+        }
+        if (traces[ntraces].rx_count != DIVERSITY_NUM_RX) {
+            fprintf(stderr, "%s: %d receivers, this build has %d (make RX=%d)\n", files[i],
+                    traces[ntraces].rx_count, DIVERSITY_NUM_RX, traces[ntraces].rx_count);
+            return 2;
+        }
+        ntraces++;
+    }
+    if (scenario != NULL) {
+        trace_scenario_t sc;
+        bool all = strcmp(scenario, "all") == 0;
+        if (!all && !trace_scenario_from_name(scenario, &sc)) {
+            fprintf(stderr, "unknown scenario '%s'\n", scenario);
+            return 2;
+        }
+        for (int s = 0; s < TRACE_SCENARIO_COUNT; s++) {
+            if ((all || s == (int)sc) && trace_generate(&traces[ntraces], (trace_scenario_t)s, seed, DIVERSITY_NUM_RX)) {
+                ntraces++;
+            }
+        }
+    }
+
+    // Candidate 0 is the built-in mode, as the reference
+    const diversity_mode_params_t* base = &diversity_mode_params[base_mode];
+    opt_add(base);
+    if (grid) {
+        opt_grid(base);
+    } else {
+        opt_random(nrandom, seed);
+    }
+    printf("%u candidates x %d traces on %d worker%s, %.0f ms per switch, %.0f us per update\n",
+           opt_ncand, ntraces, jobs, jobs == 1 ? "" : "s", opt_penalty_s * 1000.0, opt_update_s * 1e6);
+    if (!opt_run_parallel(traces, ntraces, jobs)) {
+        return 1;
+    }
+
+    opt_candidate_t reference = opt_cand[0];
+    qsort(opt_cand, opt_ncand, sizeof(opt_cand[0]), opt_cmp);
+
+    printf("%-8s %7s %7s %7s %6s  %5s %5s %4s %5s %5s %-6s %5s %4s %7s %9s\n", "", "cost", "worse%", "sw/min",
+           "upd/s", "dwell", "cool", "hyst", "w_rs", "slope", "pred", "alpha", "look", "rate", "flutter");
+    opt_print(base->name, &reference);
+    for (uint32_t i = 0; i < opt_ncand && i < OPT_TOP; i++) {
+        char tag[16];
+        snprintf(tag, sizeof(tag), "#%u", i + 1);
+        opt_print(tag, &opt_cand[i]);
+    }
+
+    for (int t = 0; t < ntraces; t++) {
+        trace_free(&traces[t]);
+    }
+    if (blob_path != NULL) {
+        if (!opt_save_blob(blob_path, &opt_cand[0].params, name)) {
+            return 1;
+        }
+        if (csv_path != NULL && !opt_save_nvs_csv(csv_path, blob_path)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,406 @@
+/**
+ * @file diversity_sim.c
+ * @brief Host-side diversity simulator: replays RSSI traces through the
+ *        unmodified diversity.c and scores the switching (metrics: sim_run.h)
+ */
+
+#include "diversity.h"
+#include "rssi_fading.h"
+#include "sim_hal.h"
+#include "sim_run.h"
+#include "trace.h"
+#include <ctype.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SIM_HAVE_TSC 1
+#endif
+
+#define SIM_MAX_TRACES      16
+
+/** Fixed evaluation rates (Hz) swept by -R, next to each mode's own range */
+static const uint16_t sim_rates[] = { 10, 20, 50, 100, 200, 500 };
+#define SIM_NRATES ((int)(sizeof(sim_rates) / sizeof(sim_rates[0])))
+
+#define SIM_BENCH_PASSES    20      // -B: times each trace is fed through the bank
+
+/** Predictor forced by -p, or -1 for each mode's default */
+static int sim_predictor = -1;
+
+static const char* sim_mode_key(diversity_mode_t mode)
+{
+    static const char* const keys[DIVERSITY_MODE_BUILTIN_COUNT] = { "race", "freestyle", "long-range" };
+    return keys[mode];
+}
+
+static bool sim_parse_mode(const char* s, int* first, int* last)
+{
+    if (strcmp(s, "all") == 0) {
+        *first = 0;
+        *last  = DIVERSITY_MODE_BUILTIN_COUNT - 1;
+        return true;
+    }
+    for (int m = 0; m < DIVERSITY_MODE_BUILTIN_COUNT; m++) {
+        if (strcasecmp(s, sim_mode_key((diversity_mode_t)m)) == 0) {
+            *first = *last = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+static double sim_right_pct(const diversity_shadow_stats_t* st)
+{
+    return st->judged ? 100.0 * st->right / st->judged : 0.0;
+}
+
+/**
+ * @brief -R: the CPU versus switch-latency curve of one trace x mode.  The
+ *        mode runs at each fixed rate of sim_rates[] (rate_min_hz =
+ *        rate_max_hz) and at its own adaptive range.
+ */
+static void sim_rate_curve(const trace_t* trace, diversity_mode_t mode, bool csv)
+{
+    for (int i = 0; i <= SIM_NRATES; i++) {
+        diversity_mode_params_t p = *diversity_get_mode_params(mode);
+        if (i < SIM_NRATES) {
+            p.rate_min_hz = p.rate_max_hz = sim_rates[i];
+        }
+        char rate[16];
+        snprintf(rate, sizeof(rate), "%u-%u", p.rate_min_hz, p.rate_max_hz);
+        if (p.rate_min_hz == p.rate_max_hz) {
+            snprintf(rate, sizeof(rate), "%u", p.rate_min_hz);
+        }
+        sim_config_t cfg = { .mode = mode, .predictor = sim_predictor, .custom = &p };
+        sim_result_t r;
+        sim_run(trace, &cfg, &r);
+        double seconds = r.minutes * 60.0;
+        double per_s   = seconds > 0 ? r.updates / seconds : 0.0;
+        double cpu_us  = per_s * r.ns_per_update / 1000.0;
+        if (csv) {
+            printf("%s,%s,%s,%.1f,%.0f,%.2f,%u,%u,%.1f,%.1f\n", trace->name, sim_mode_key(mode), rate,
+                   per_s, cpu_us, r.worse_pct, r.fades, r.fades_switched,
+                   r.fade_latency_mean_ms, r.fade_latency_max_ms);
+        } else {
+            printf("%-16s %-10s %8s %9.1f %9.0f %7.2f %6u %8u %7.1fms %7.1fms\n", trace->name,
+                   sim_mode_key(mode), rate, per_s, cpu_us, r.worse_pct, r.fades, r.fades_switched,
+                   r.fade_latency_mean_ms, r.fade_latency_max_ms);
+        }
+    }
+}
+
+/**
+ * @brief -F: one trace x mode with and without the fading-regime input.
+ *        "off" runs the mode with its flutter parameters neutral (the
+ *        stability weight it has in any other regime, 100 % dwell), so the
+ *        difference is what the regime changes.  The regime shares are
+ *        sampled at each run's decisions, so they differ slightly.
+ */
+static void sim_fading_eval(const trace_t* trace, diversity_mode_t mode, bool csv)
+{
+    for (int off = 0; off <= 1; off++) {
+        diversity_mode_params_t p = *diversity_get_mode_params(mode);
+        if (off) {
+            p.flutter_weight_stability = p.weight_stability;
+            p.flutter_dwell_pct        = 100;
+        }
+        sim_config_t cfg = { .mode = mode, .predictor = sim_predictor, .custom = &p };
+        sim_result_t r;
+        sim_run(trace, &cfg, &r);
+        double per_min = r.minutes > 0 ? r.switches / r.minutes : 0.0;
+        if (csv) {
+            printf("%s,%s,%s,%.1f,%.1f,%.1f,%.1f,%u,%.1f,%.2f,%u,%u\n", trace->name, sim_mode_key(mode),
+                   off ? "off" : "on", r.fading_pct[RSSI_FADING_STEADY], r.fading_pct[RSSI_FADING_SLOW],
+                   r.fading_pct[RSSI_FADING_FLUTTER], r.fading_pct[RSSI_FADING_UNKNOWN], r.switches,
+                   per_min, r.worse_pct, r.fades, r.fades_switched);
+        } else {
+            printf("%-16s %-10s %-4s %7.1f %7.1f %7.1f %7.1f %8u %7.1f %7.2f %6u %8u\n", trace->name,
+                   sim_mode_key(mode), off ? "off" : "on", r.fading_pct[RSSI_FADING_STEADY],
+                   r.fading_pct[RSSI_FADING_SLOW], r.fading_pct[RSSI_FADING_FLUTTER],
+                   r.fading_pct[RSSI_FADING_UNKNOWN], r.switches, per_min, r.worse_pct, r.fades,
+                   r.fades_switched);
+        }
+    }
+}
+
+static int64_t sim_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief -B: cost of the Goertzel bank alone, as diversity_frame_cb() runs
+ *        it: every frame of the trace through one rssi_fading_t per
+ *        receiver, SIM_BENCH_PASSES times.  Cycles are the host's TSC (x86
+ *        only); the firmware's own count is the CONFIG_DIVERSITY_SCORE_BENCHMARK
+ *        boot log.
+ */
+static void sim_fading_bench(const trace_t* trace, bool csv)
+{
+    rssi_fading_t bank[TRACE_MAX_RX];
+    uint32_t blocks = 0;
+    int64_t t0 = sim_now_ns();
+#ifdef SIM_HAVE_TSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (int pass = 0; pass < SIM_BENCH_PASSES; pass++) {
+        for (int rx = 0; rx < trace->rx_count; rx++) {
+            rssi_fading_reset(&bank[rx]);
+        }
+        for (size_t i = 0; i < trace->count; i++) {
+            for (int rx = 0; rx < trace->rx_count; rx++) {
+                blocks += rssi_fading_push(&bank[rx], trace->frame[i].rssi[rx]);
+            }
+        }
+    }
+    double frames = (double)trace->count * SIM_BENCH_PASSES;
+    double ns     = (sim_now_ns() - t0) / frames;
+#ifdef SIM_HAVE_TSC
+    double cycles = (double)(__rdtsc() - c0) / frames;
+#else
+    double cycles = 0.0;
+#endif
+    if (csv) {
+        printf("%s,%d,%d,%.1f,%.0f,%u\n", trace->name, trace->rx_count, RSSI_FADING_BINS, ns, cycles,
+               blocks / SIM_BENCH_PASSES);
+    } else {
+        printf("%-16s %3d %5d %9.1f %10.0f %7u\n", trace->name, trace->rx_count, RSSI_FADING_BINS, ns,
+               cycles, blocks / SIM_BENCH_PASSES);
+    }
+}
+
+static void sim_usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-t trace.csv|trace.bin]... [-s scenario|all] [-m mode|all]\n"
+            "          [-p slope|kalman] [-a mode]... [-S seed] [-o out.csv|out.bin] [-R|-F|-B] [-c] [-v]\n"
+            "  -t FILE  replay a recorded trace (t_us,rssi_a,rssi_b,...); repeatable\n"
+            "  -s NAME  synthetic scenario: multipath, obstacle, long-range or all\n"
+            "           (default: all, when no -t is given)\n"
+            "  -m MODE  race, freestyle, long-range or all (default all)\n"
+            "  -p PRED  preemptive-switch predictor: slope or kalman\n"
+            "           (default: each mode's own)\n"
+            "  -a MODE  also run MODE in shadow and report how often each mode\n"
+            "           selected the antenna stronger 50 ms later; repeatable\n"
+            "  -S SEED  seed for the synthetic scenarios (default 1)\n"
+            "  -o FILE  write the selected trace to FILE instead of simulating\n"
+            "  -R       CPU versus switch latency: each mode at fixed evaluation\n"
+            "           rates and at its own adaptive range\n"
+            "  -F       fading regimes (share of receiver time) and each mode with\n"
+            "           and without its flutter parameters\n"
+            "  -B       host cost of the fading-spectrum bank per frame\n"
+            "  -c       print results as CSV\n"
+            "  -v       show the firmware's log output\n",
+            argv0);
+}
+
+int main(int argc, char** argv)
+{
+    const char* files[SIM_MAX_TRACES];
+    int nfiles = 0;
+    const char* scenario = NULL;
+    const char* out_path = NULL;
+    uint32_t seed = 1;
+    int mode_first = 0, mode_last = DIVERSITY_MODE_BUILTIN_COUNT - 1;
+    bool csv = false;
+    bool rate_curve = false;
+    bool fading_eval = false;
+    bool fading_bench = false;
+    diversity_mode_t shadow[DIVERSITY_SHADOW_MAX];
+    int shadows = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:m:p:a:S:o:RFBcvh")) != -1) {
+        switch (opt) {
+        case 't':
+            if (nfiles == SIM_MAX_TRACES) {
+                fprintf(stderr, "at most %d traces\n", SIM_MAX_TRACES);
+                return 2;
+            }
+            files[nfiles++] = optarg;
+            break;
+        case 's': scenario = optarg; break;
+        case 'S': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'o': out_path = optarg; break;
+        case 'c': csv = true; break;
+        case 'R': rate_curve = true; break;
+        case 'F': fading_eval = true; break;
+        case 'B': fading_bench = true; break;
+        case 'v': sim_log_verbose = true; break;
+        case 'p':
+            if (strcmp(optarg, "slope") == 0) {
+                sim_predictor = DIVERSITY_PREDICT_SLOPE;
+            } else if (strcmp(optarg, "kalman") == 0) {
+                sim_predictor = DIVERSITY_PREDICT_KALMAN;
+            } else {
+                fprintf(stderr, "unknown predictor '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 'a': {
+            int first, last;
+            if (!sim_parse_mode(optarg, &first, &last) || first != last) {
+                fprintf(stderr, "unknown shadow mode '%s'\n", optarg);
+                return 2;
+            }
+            if (shadows == DIVERSITY_SHADOW_MAX) {
+                fprintf(stderr, "at most %d shadow modes\n", DIVERSITY_SHADOW_MAX);
+                return 2;
+            }
+            shadow[shadows++] = (diversity_mode_t)first;
+            break;
+        }
+        case 'm':
+            if (!sim_parse_mode(optarg, &mode_first, &mode_last)) {
+                fprintf(stderr, "unknown mode '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        default:
+            sim_usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (scenario == NULL && nfiles == 0) {
+        scenario = "all";
+    }
+
+    trace_t traces[SIM_MAX_TRACES + TRACE_SCENARIO_COUNT];
+    int ntraces = 0;
+    for (int i = 0; i < nfiles; i++) {
+        if (!trace_load(&traces[ntraces], files[i])) {
+            return 1;
+        }
+        ntraces++;
+    }
+    if (scenario != NULL) {
+        trace_scenario_t sc;
+        bool all = strcmp(scenario, "all") == 0;
+        if (!all && !trace_scenario_from_name(scenario, &sc)) {
+            fprintf(stderr, "unknown scenario '%s'\n", scenario);
+            return 2;
+        }
+        for (int s = 0; s < TRACE_SCENARIO_COUNT; s++) {
+            if ((all || s == (int)sc) && trace_generate(&traces[ntraces], (trace_scenario_t)s, seed, DIVERSITY_NUM_RX)) {
+                ntraces++;
+            }
+        }
+    }
+
+    if (out_path != NULL) {
+        if (ntraces != 1) {
+            fprintf(stderr, "-o needs exactly one trace (got %d)\n", ntraces);
+            return 2;
+        }
+        return trace_save(&traces[0], out_path) ? 0 : 1;
+    }
+    for (int t = 0; t < ntraces; t++) {
+        if (traces[t].rx_count != DIVERSITY_NUM_RX) {
+            fprintf(stderr, "%s: %d receivers, this build has %d (make RX=%d)\n",
+                    traces[t].name, traces[t].rx_count, DIVERSITY_NUM_RX, traces[t].rx_count);
+            return 2;
+        }
+    }
+
+    if (fading_bench) {
+        if (csv) {
+            printf("trace,receivers,bins,ns_per_frame,cycles_per_frame,blocks\n");
+        } else {
+            printf("%-16s %3s %5s %9s %10s %7s\n", "trace", "rx", "bins", "ns/frame", "cycles/frm", "blocks");
+        }
+        for (int t = 0; t < ntraces; t++) {
+            sim_fading_bench(&traces[t], csv);
+            trace_free(&traces[t]);
+        }
+        return 0;
+    }
+
+    if (fading_eval) {
+        if (csv) {
+            printf("trace,mode,flutter_params,steady_pct,slow_pct,flutter_pct,unknown_pct,switches,"
+                   "switches_per_min,worse_pct,fades,fades_switched\n");
+        } else {
+            printf("%-16s %-10s %-4s %7s %7s %7s %7s %8s %7s %7s %6s %8s\n", "trace", "mode", "flut",
+                   "steady%", "slow%", "flutt%", "unkn%", "switches", "sw/min", "worse%", "fades", "switched");
+        }
+        for (int t = 0; t < ntraces; t++) {
+            for (int m = mode_first; m <= mode_last; m++) {
+                sim_fading_eval(&traces[t], (diversity_mode_t)m, csv);
+            }
+            trace_free(&traces[t]);
+        }
+        return 0;
+    }
+
+    if (rate_curve) {
+        if (csv) {
+            printf("trace,mode,rate_hz,updates_per_s,cpu_us_per_s,worse_pct,fades,fades_switched,"
+                   "fade_latency_mean_ms,fade_latency_max_ms\n");
+        } else {
+            printf("%-16s %-10s %8s %9s %9s %7s %6s %8s %9s %9s\n", "trace", "mode", "rate_hz",
+                   "updates/s", "cpu_us/s", "worse%", "fades", "switched", "lat_mean", "lat_max");
+        }
+        for (int t = 0; t < ntraces; t++) {
+            for (int m = mode_first; m <= mode_last; m++) {
+                sim_rate_curve(&traces[t], (diversity_mode_t)m, csv);
+            }
+            trace_free(&traces[t]);
+        }
+        return 0;
+    }
+
+    if (csv) {
+        printf("trace,mode,switches,switches_per_min,worse_pct,fades,fades_switched,"
+               "fade_latency_mean_ms,fade_latency_max_ms,updates,ns_per_update,freq_sets%s",
+               shadows ? ",live_right_pct" : "");
+        for (int i = 0; i < shadows; i++) {
+            printf(",shadow%d_mode,shadow%d_switches,shadow%d_right_pct", i + 1, i + 1, i + 1);
+        }
+        printf("\n");
+    } else {
+        printf("%-16s %-10s %8s %7s %7s %6s %8s %9s %9s %8s %9s\n",
+               "trace", "mode", "switches", "sw/min", "worse%", "fades", "switched",
+               "lat_mean", "lat_max", "updates", "ns/update");
+    }
+    for (int t = 0; t < ntraces; t++) {
+        for (int m = mode_first; m <= mode_last; m++) {
+            sim_config_t cfg = { .mode = (diversity_mode_t)m, .predictor = sim_predictor, .shadows = shadows };
+            memcpy(cfg.shadow, shadow, sizeof(shadow));
+            sim_result_t r;
+            sim_run(&traces[t], &cfg, &r);
+            double per_min = r.minutes > 0 ? r.switches / r.minutes : 0.0;
+            if (csv) {
+                printf("%s,%s,%u,%.1f,%.2f,%u,%u,%.1f,%.1f,%u,%.0f,%u",
+                       traces[t].name, sim_mode_key((diversity_mode_t)m), r.switches, per_min,
+                       r.worse_pct, r.fades, r.fades_switched, r.fade_latency_mean_ms,
+                       r.fade_latency_max_ms, r.updates, r.ns_per_update, r.freq_sets);
+                for (int i = 0; shadows && i <= shadows; i++) {
+                    if (i > 0) {
+                        printf(",%s,%u", sim_mode_key(r.shadow[i].mode), r.shadow[i].switches);
+                    }
+                    printf(",%.2f", sim_right_pct(&r.shadow[i]));
+                }
+                printf("\n");
+            } else {
+                printf("%-16s %-10s %8u %7.1f %7.2f %6u %8u %7.1fms %7.1fms %8u %9.0f\n",
+                       traces[t].name, sim_mode_key((diversity_mode_t)m), r.switches, per_min,
+                       r.worse_pct, r.fades, r.fades_switched, r.fade_latency_mean_ms,
+                       r.fade_latency_max_ms, r.updates, r.ns_per_update);
+                for (int i = 0; shadows && i <= shadows; i++) {
+                    printf("  %-14s %-10s %8u %7.2f%% right @%d ms (%u judged)\n",
+                           i == 0 ? "live" : "shadow", sim_mode_key(r.shadow[i].mode),
+                           r.shadow[i].switches, sim_right_pct(&r.shadow[i]),
+                           DIVERSITY_SHADOW_JUDGE_MS, r.shadow[i].judged);
+                }
+            }
+        }
+        trace_free(&traces[t]);
+    }
+    return 0;
+}
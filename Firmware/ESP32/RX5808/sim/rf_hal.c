@@ -0,0 +1,471 @@
+/**
+ * @file rf_hal.c
+ * @brief Host stand-ins for the platform rx5808.c drives (RF driver test)
+ */
+
+#include "rf_hal.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_adc/adc_continuous.h"
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "nvs_flash.h"
+#include "hwvers.h"
+#include "rx5808.h"
+#include "led.h"
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RF_HAL_MAX_WAIT_US  1000000     // portMAX_DELAY waits give up after this (nothing else runs)
+#define RF_HAL_CONV_US      50          // 20 kHz scan, as rx5808.c configures it
+
+struct esp_timer {
+    esp_timer_cb_t cb;
+    void*          arg;
+    bool           armed;
+    int64_t        deadline_us;
+};
+
+struct sim_event_group {
+    EventBits_t bits;
+};
+
+struct sim_queue {
+    uint8_t* items;
+    size_t   item_size;
+    uint32_t len, head, count;
+};
+
+static int64_t            rf_time_us;
+static struct esp_timer   rf_timer;         // rx5808.c creates exactly one (settle)
+static bool               rf_timer_created;
+static uint16_t           rf_rssi[2];
+static bool               rf_adc_stream;
+static uint16_t           rf_adc_fifo[RF_HAL_ADC_FIFO];    // adc_digi_output_data_t
+static uint32_t           rf_adc_count;
+static uint32_t           rf_adc_scan;      // Position in the scan pattern
+static rf_hal_spi_write_t rf_spi_log[RF_HAL_SPI_LOG];
+static uint32_t           rf_spi_writes;
+static uint32_t           rf_notifies;
+static int                rf_service_handle;    // Addresses used as non-NULL handles
+static int                rf_test_handle;
+static int                rf_dummy;
+static bool               rf_in_service;
+static jmp_buf            rf_service_exit;
+
+/**
+ * @brief Advance the clock, firing the settle timer at its deadline on the way
+ */
+void rf_hal_advance_us(int64_t us)
+{
+    int64_t target = rf_time_us + us;
+    while (rf_timer.armed && rf_timer.deadline_us <= target) {
+        if (rf_timer.deadline_us > rf_time_us) {
+            rf_time_us = rf_timer.deadline_us;
+        }
+        rf_timer.armed = false;
+        rf_timer.cb(rf_timer.arg);
+    }
+    rf_time_us = target;
+}
+
+/**
+ * @brief Run one wake-up of the RF service
+ */
+void rf_hal_service_step(void)
+{
+    if (setjmp(rf_service_exit) == 0) {
+        rf_in_service = true;
+        DMA2_Stream0_IRQHandler();
+    }
+    rf_in_service = false;
+}
+
+void rf_hal_set_rssi(uint16_t rssi0, uint16_t rssi1)
+{
+    rf_rssi[0] = rssi0;
+    rf_rssi[1] = rssi1;
+}
+
+/**
+ * @brief Let the continuous ADC driver start (call before RX5808_Init())
+ */
+void rf_hal_adc_stream(bool on)
+{
+    rf_adc_stream = on;
+}
+
+/**
+ * @brief Run @p n conversions of the scan, one every RF_HAL_CONV_US; the
+ *        clock ends at the last one
+ */
+void rf_hal_adc_convert(uint32_t n)
+{
+    static const adc_channel_t scan[4] = {
+        RX5808_RSSI0_CHAN, RX5808_RSSI1_CHAN, VBAT_ADC_CHAN, KEY_ADC_CHAN
+    };
+    static const uint16_t fixed[4] = { 0, 0, 2100, 4000 };     // VBAT, KEY
+
+    for (uint32_t i = 0; i < n; i++) {
+        rf_hal_advance_us(RF_HAL_CONV_US);
+        uint32_t s = rf_adc_scan++ % 4;
+        adc_digi_output_data_t d = { 0 };
+        d.type1.channel = scan[s];
+        d.type1.data    = (s < 2) ? rf_rssi[s] : fixed[s];
+        if (rf_adc_count < RF_HAL_ADC_FIFO) {
+            rf_adc_fifo[rf_adc_count++] = d.val;
+        }
+    }
+}
+
+uint32_t rf_hal_spi_count(void)
+{
+    return rf_spi_writes;
+}
+
+/**
+ * @brief Most recent register write (NULL before the first)
+ */
+const rf_hal_spi_write_t* rf_hal_spi_last(void)
+{
+    return rf_spi_writes ? &rf_spi_log[(rf_spi_writes - 1) % RF_HAL_SPI_LOG] : NULL;
+}
+
+/**
+ * @brief Deadline of the settle timer (-1 while it is not armed)
+ */
+int64_t rf_hal_timer_deadline_us(void)
+{
+    return rf_timer.armed ? rf_timer.deadline_us : -1;
+}
+
+/**
+ * @brief Run the settle timer callback now, as an expiry already queued in
+ *        the esp_timer task when the timer was re-armed would
+ */
+void rf_hal_timer_fire_stale(void)
+{
+    rf_timer.cb(rf_timer.arg);
+}
+
+/**
+ * @brief Wake-ups posted to the RF service
+ */
+uint32_t rf_hal_notify_count(void)
+{
+    return rf_notifies;
+}
+
+void sim_log(char level, const char* tag, const char* fmt, ...)
+{
+    (void)level; (void)tag; (void)fmt;
+}
+
+void led_set_brightness(uint8_t brightness_percent)
+{
+    (void)brightness_percent;
+}
+
+// ---------------------------------------------------------------------------
+// esp_timer
+// ---------------------------------------------------------------------------
+
+int64_t esp_timer_get_time(void)
+{
+    return rf_time_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out)
+{
+    if (rf_timer_created) {
+        return ESP_FAIL;
+    }
+    rf_timer_created = true;
+    rf_timer.cb  = args->callback;
+    rf_timer.arg = args->arg;
+    *out = &rf_timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    if (t->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    t->armed       = true;
+    t->deadline_us = rf_time_us + (int64_t)timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    if (!t->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    t->armed = false;
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// SPI: record every register write (25-bit frame, LSB first)
+// ---------------------------------------------------------------------------
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* cfg, int dma_chan)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* cfg,
+                             spi_device_handle_t* handle)
+{
+    *handle = (spi_device_handle_t)&rf_dummy;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t dev, TickType_t wait) { return ESP_OK; }
+void spi_device_release_bus(spi_device_handle_t dev) {}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t dev, spi_transaction_t* t)
+{
+    uint32_t frame;
+    memcpy(&frame, t->tx_data, sizeof(frame));
+    rf_hal_spi_write_t* w = &rf_spi_log[rf_spi_writes % RF_HAL_SPI_LOG];
+    w->addr = frame & 0x0F;
+    w->data = (frame >> 5) & 0xFFFFF;
+    w->t_us = rf_time_us;
+    rf_spi_writes++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t* t, TickType_t wait)
+{
+    return spi_device_polling_transmit(dev, t);
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t** t, TickType_t wait)
+{
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// ADC: no continuous driver (oneshot fallback), oneshot reads the test RSSI
+// ---------------------------------------------------------------------------
+
+esp_err_t adc_oneshot_new_unit(const adc_oneshot_unit_init_cfg_t* cfg, adc_oneshot_unit_handle_t* out)
+{
+    *out = (adc_oneshot_unit_handle_t)&rf_dummy;
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_config_channel(adc_oneshot_unit_handle_t h, adc_channel_t chan,
+                                     const adc_oneshot_chan_cfg_t* cfg)
+{
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_read(adc_oneshot_unit_handle_t h, adc_channel_t chan, int* out)
+{
+    *out = (chan == RX5808_RSSI0_CHAN) ? rf_rssi[0] : (chan == RX5808_RSSI1_CHAN) ? rf_rssi[1] : 0;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t* cfg, adc_continuous_handle_t* out)
+{
+    if (!rf_adc_stream) {
+        return ESP_FAIL;
+    }
+    *out = (adc_continuous_handle_t)&rf_dummy;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t h, const adc_continuous_config_t* cfg) { return ESP_OK; }
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t h, const adc_continuous_evt_cbs_t* cbs,
+                                                  void* user_data) { return ESP_OK; }
+esp_err_t adc_continuous_start(adc_continuous_handle_t h) { return ESP_OK; }
+esp_err_t adc_continuous_stop(adc_continuous_handle_t h) { return ESP_OK; }
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t h) { return ESP_OK; }
+
+/**
+ * @brief Hand out queued conversions, oldest first (ESP_ERR_TIMEOUT: none)
+ */
+esp_err_t adc_continuous_read(adc_continuous_handle_t h, uint8_t* buf, uint32_t len, uint32_t* out_len,
+                              uint32_t timeout_ms)
+{
+    uint32_t n = len / SOC_ADC_DIGI_RESULT_BYTES;
+    if (rf_adc_count == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (n > rf_adc_count) {
+        n = rf_adc_count;
+    }
+    memcpy(buf, rf_adc_fifo, n * SOC_ADC_DIGI_RESULT_BYTES);
+    memmove(rf_adc_fifo, rf_adc_fifo + n, (rf_adc_count - n) * sizeof(rf_adc_fifo[0]));
+    rf_adc_count -= n;
+    *out_len = n * SOC_ADC_DIGI_RESULT_BYTES;
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// GPIO, NVS (always empty)
+// ---------------------------------------------------------------------------
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) { return ESP_OK; }
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) { return ESP_OK; }
+esp_err_t gpio_reset_pin(gpio_num_t gpio) { return ESP_OK; }
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+esp_err_t nvs_flash_erase(void) { return ESP_OK; }
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* out) { return ESP_ERR_NVS_NOT_FOUND; }
+void nvs_close(nvs_handle_t h) {}
+esp_err_t nvs_commit(nvs_handle_t h) { return ESP_OK; }
+esp_err_t nvs_get_u16(nvs_handle_t h, const char* key, uint16_t* out) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_get_blob(nvs_handle_t h, const char* key, void* out, size_t* len) { return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_set_blob(nvs_handle_t h, const char* key, const void* value, size_t len) { return ESP_OK; }
+
+// ---------------------------------------------------------------------------
+// FreeRTOS (one thread: blocking calls advance the clock)
+// ---------------------------------------------------------------------------
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t prio, TaskHandle_t* handle, BaseType_t core)
+{
+    if (handle != NULL) {
+        *handle = &rf_service_handle;   // Only the RF service asks for its handle
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                       UBaseType_t prio, TaskHandle_t* handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, 0);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    rf_notifies++;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken)
+{
+    rf_notifies++;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    if (rf_in_service) {
+        longjmp(rf_service_exit, 1);    // End of one service iteration
+    }
+    return 0;
+}
+
+void vTaskDelete(TaskHandle_t task) {}
+
+void vTaskDelay(TickType_t ticks)
+{
+    rf_hal_advance_us((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(rf_time_us / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return rf_in_service ? (TaskHandle_t)&rf_service_handle : (TaskHandle_t)&rf_test_handle;
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return calloc(1, sizeof(struct sim_event_group));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    return g->bits |= bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    EventBits_t old = g->bits;
+    g->bits &= ~bits;
+    return old;
+}
+
+/**
+ * @brief Nothing else runs while we wait, so only the settle timer can set
+ *        a bit: advance to its deadline if that comes first, else time out
+ */
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t wait)
+{
+    int64_t wait_us = (wait == portMAX_DELAY) ? RF_HAL_MAX_WAIT_US
+                                              : (int64_t)wait * portTICK_PERIOD_MS * 1000;
+    int64_t end_us  = rf_time_us + wait_us;
+    for (;;) {
+        EventBits_t got = g->bits & bits;
+        if (all ? got == bits : got != 0) {
+            EventBits_t ret = g->bits;
+            if (clear) {
+                g->bits &= ~bits;
+            }
+            return ret;
+        }
+        if (!rf_timer.armed || rf_timer.deadline_us > end_us) {
+            rf_hal_advance_us(end_us - rf_time_us);
+            return g->bits;
+        }
+        rf_hal_advance_us(rf_timer.deadline_us - rf_time_us);
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size)
+{
+    struct sim_queue* q = calloc(1, sizeof(*q));
+    q->items     = calloc(len, item_size);
+    q->item_size = item_size;
+    q->len       = len;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t wait)
+{
+    if (q->count == q->len) {
+        return pdFALSE;
+    }
+    memcpy(q->items + ((q->head + q->count) % q->len) * q->item_size, item, q->item_size);
+    q->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t wait)
+{
+    if (q->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item, q->items + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->len;
+    q->count--;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q)
+{
+    q->head = q->count = 0;
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xQueueCreate(1, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { return pdTRUE; }
@@ -0,0 +1,48 @@
+/**
+ * @file rf_hal.h
+ * @brief Host stand-ins for the platform rx5808.c drives (RF driver test)
+ *
+ * A simulated clock with one-shot esp_timers, an SPI bus that records
+ * every register write, the ADC and the FreeRTOS calls of a single thread.
+ * Blocking waits advance the clock instead of sleeping.
+ *
+ * The continuous ADC driver refuses to start unless rf_hal_adc_stream()
+ * enabled it before RX5808_Init(), so by default the driver runs its
+ * oneshot fallback with the RSSI set by the test.  When streaming,
+ * rf_hal_adc_convert() runs the 20 kHz scan (RSSI0, RSSI1, VBAT, KEY) on
+ * the clock and queues the results for the next service step.
+ *
+ * The RF service loop (DMA2_Stream0_IRQHandler) never returns, so
+ * rf_hal_service_step() enters it and its ulTaskNotifyTake() jumps back
+ * out: one step runs the posted commands, the antenna and one frame,
+ * exactly as one wake-up of the real service does.
+ */
+
+#ifndef __RF_HAL_H
+#define __RF_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RF_HAL_SPI_LOG  64      // Register writes remembered
+#define RF_HAL_ADC_FIFO 4096    // Conversions queued between service steps
+
+/** @brief One recorded SPI register write */
+typedef struct {
+    uint8_t  addr;
+    uint32_t data;
+    int64_t  t_us;
+} rf_hal_spi_write_t;
+
+void     rf_hal_advance_us(int64_t us);
+void     rf_hal_service_step(void);
+void     rf_hal_set_rssi(uint16_t rssi0, uint16_t rssi1);
+void     rf_hal_adc_stream(bool on);
+void     rf_hal_adc_convert(uint32_t n);
+uint32_t rf_hal_spi_count(void);
+const rf_hal_spi_write_t* rf_hal_spi_last(void);
+int64_t  rf_hal_timer_deadline_us(void);
+void     rf_hal_timer_fire_stale(void);
+uint32_t rf_hal_notify_count(void);
+
+#endif // __RF_HAL_H
@@ -0,0 +1,254 @@
+/**
+ * @file sim_hal.c
+ * @brief Host stand-ins for the parts of the firmware diversity.c calls
+ */
+
+#include "sim_hal.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "led.h"
+#include "beep.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_NOMINAL_FREQ_MHZ    5800
+#define SIM_SETTLE_US           15000   // PLL settle after a retune (a ±1 MHz hop settles early)
+
+bool sim_log_verbose = false;
+
+static int64_t           sim_time_us;
+static rssi_frame_t      sim_frame;
+static rx5808_frame_cb_t sim_frame_cb;
+static bool              sim_notified;
+static rx5808_antenna_t  sim_antenna;
+static int64_t           sim_antenna_us;
+static uint32_t          sim_freq_sets;
+static int64_t           sim_settled_us;
+static int               sim_task_handle;   // Address used as a non-NULL TaskHandle_t
+
+/**
+ * @brief Start a new run: clock at 0, no frames, antenna A (diversity's
+ *        initial active_rx), nominal channel 5800 MHz
+ */
+void sim_hal_reset(void)
+{
+    sim_time_us = 0;
+    memset(&sim_frame, 0, sizeof(sim_frame));
+    sim_notified   = false;
+    sim_antenna    = RX5808_ANTENNA_A;
+    sim_antenna_us = 0;
+    sim_freq_sets  = 0;
+    sim_settled_us = 0;
+}
+
+void sim_hal_set_time_us(int64_t t_us)
+{
+    sim_time_us = t_us;
+}
+
+/**
+ * @brief Publish one frame (@p rssi: RSSI_RX_COUNT receivers) stamped with
+ *        the current clock, as the RF service does after each decimated
+ *        ADC frame
+ */
+void sim_hal_publish(const uint16_t* rssi)
+{
+    sim_frame.t_us = sim_time_us;
+    sim_frame.seq++;
+    for (int rx = 0; rx < RSSI_RX_COUNT; rx++) {
+        sim_frame.value[RSSI_SLOT_RSSI0 + rx] = rssi[rx];
+    }
+    sim_frame.filtered[0]               = rssi[0];
+    sim_frame.filtered[1]               = rssi[1];
+    if (sim_frame_cb != NULL) {
+        sim_frame_cb(&sim_frame);
+    }
+}
+
+/**
+ * @brief true (once) if the diversity task was notified since the last call
+ */
+bool sim_hal_take_notify(void)
+{
+    bool n = sim_notified;
+    sim_notified = false;
+    return n;
+}
+
+rx5808_antenna_t sim_hal_get_antenna(void)
+{
+    return sim_antenna;
+}
+
+uint32_t sim_hal_get_freq_sets(void)
+{
+    return sim_freq_sets;
+}
+
+void sim_log(char level, const char* tag, const char* fmt, ...)
+{
+    if (!sim_log_verbose) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%c (%lld) %s: ", level, (long long)(sim_time_us / 1000), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+// ---------------------------------------------------------------------------
+// ESP-IDF / FreeRTOS
+// ---------------------------------------------------------------------------
+
+int64_t esp_timer_get_time(void)
+{
+    return sim_time_us;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* out)
+{
+    (void)name; (void)mode; (void)out;
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+void nvs_close(nvs_handle_t h) { (void)h; }
+esp_err_t nvs_commit(nvs_handle_t h) { (void)h; return ESP_OK; }
+esp_err_t nvs_get_u8(nvs_handle_t h, const char* key, uint8_t* out) { (void)h; (void)key; (void)out; return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_set_u8(nvs_handle_t h, const char* key, uint8_t value) { (void)h; (void)key; (void)value; return ESP_OK; }
+esp_err_t nvs_get_u16(nvs_handle_t h, const char* key, uint16_t* out) { (void)h; (void)key; (void)out; return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_set_u16(nvs_handle_t h, const char* key, uint16_t value) { (void)h; (void)key; (void)value; return ESP_OK; }
+esp_err_t nvs_get_blob(nvs_handle_t h, const char* key, void* out, size_t* len) { (void)h; (void)key; (void)out; (void)len; return ESP_ERR_NVS_NOT_FOUND; }
+esp_err_t nvs_set_blob(nvs_handle_t h, const char* key, const void* value, size_t len) { (void)h; (void)key; (void)value; (void)len; return ESP_OK; }
+esp_err_t nvs_erase_key(nvs_handle_t h, const char* key) { (void)h; (void)key; return ESP_OK; }
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level)
+{
+    (void)gpio; (void)level;
+    return ESP_OK;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t prio, TaskHandle_t* handle, BaseType_t core)
+{
+    (void)fn; (void)name; (void)stack; (void)arg; (void)prio; (void)core;
+    if (handle != NULL) {
+        *handle = &sim_task_handle;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    sim_notified = true;
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    (void)clear; (void)wait;
+    return sim_hal_take_notify() ? 1 : 0;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+}
+
+// ---------------------------------------------------------------------------
+// rx5808.h / led.h / beep.h
+// ---------------------------------------------------------------------------
+
+void RX5808_Set_Frame_Callback(rx5808_frame_cb_t cb)
+{
+    sim_frame_cb = cb;
+}
+
+bool RX5808_Get_Sample(rssi_frame_t* out)
+{
+    if (sim_frame.seq == 0) {
+        return false;
+    }
+    *out = sim_frame;
+    return true;
+}
+
+// The RF service runs above the diversity task, so the switch is immediate
+void RX5808_Set_Antenna(rx5808_antenna_t ant)
+{
+    if (ant != sim_antenna) {
+        sim_antenna    = ant;
+        sim_antenna_us = sim_time_us;
+    }
+}
+
+int64_t RX5808_Get_Antenna_Switch_Time_Us(void)
+{
+    return sim_antenna_us;
+}
+
+uint16_t RX5808_Get_Current_Freq(void)
+{
+    return SIM_NOMINAL_FREQ_MHZ;
+}
+
+uint16_t RX5808_Get_Expected_Frequency(void)
+{
+    return SIM_NOMINAL_FREQ_MHZ;
+}
+
+void RX5808_Set_Freq(uint16_t Fre)
+{
+    (void)Fre;
+    sim_freq_sets++;
+}
+
+/**
+ * @brief Count the retune; it settles SIM_SETTLE_US later.  The traces do
+ *        not depend on frequency, so the transient is only in the timing.
+ */
+bool RX5808_Tune_Async(uint16_t freq, rx5808_tune_cb_t cb)
+{
+    (void)freq; (void)cb;
+    sim_freq_sets++;
+    sim_settled_us = sim_time_us + SIM_SETTLE_US;
+    return true;
+}
+
+bool RX5808_Is_Settled(void)
+{
+    return sim_time_us >= sim_settled_us;
+}
+
+int64_t RX5808_Get_Settled_Time_Us(void)
+{
+    return sim_settled_us;
+}
+
+// No sweeps on the host: the calibration map is never filled
+bool RX5808_Measure(uint16_t freq, uint16_t dwell_ms, uint16_t n_samples,
+                    rx5808_measure_cb_t cb, void* arg)
+{
+    (void)freq; (void)dwell_ms; (void)n_samples; (void)cb; (void)arg;
+    return false;
+}
+
+uint16_t RX5808_Get_RSSI_Frames_In(uint16_t ms)
+{
+    return ms;
+}
+
+uint16_t RX5808_Get_RSSI_Raw(rx5808_receive rx)
+{
+    return sim_frame.value[RSSI_SLOT_RSSI0 + rx];
+}
+
+void led_set_signal_strength(uint8_t rssi_percent) { (void)rssi_percent; }
+void led_trigger_double_blink(void) {}
+void beep_play_triple(void) {}
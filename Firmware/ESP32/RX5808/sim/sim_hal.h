@@ -0,0 +1,29 @@
+/**
+ * @file sim_hal.h
+ * @brief Host stand-ins for the parts of the firmware diversity.c calls
+ *
+ * Implements esp_timer, NVS (always empty), the FreeRTOS notification
+ * calls, led/beep (no-ops) and the rx5808.h sample/antenna interface on a
+ * simulated clock.  The replayer sets the clock and publishes one frame at
+ * a time; the frame callback registered by diversity_init() runs exactly
+ * as the RF service would call it, and a pending notification tells the
+ * replayer to run diversity_update().
+ */
+
+#ifndef __SIM_HAL_H
+#define __SIM_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rx5808.h"
+
+extern bool sim_log_verbose;
+
+void             sim_hal_reset(void);
+void             sim_hal_set_time_us(int64_t t_us);
+void             sim_hal_publish(const uint16_t* rssi);
+bool             sim_hal_take_notify(void);
+rx5808_antenna_t sim_hal_get_antenna(void);
+uint32_t         sim_hal_get_freq_sets(void);
+
+#endif // __SIM_HAL_H
@@ -0,0 +1,124 @@
+/**
+ * @file sim_run.c
+ * @brief One trace x mode replay through diversity.c, and its metrics
+ */
+
+#include "sim_run.h"
+#include "sim_hal.h"
+#include <string.h>
+#include <time.h>
+
+static int64_t sim_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Replay @p trace from a fresh diversity_init()
+ *
+ * Every frame is published through sim_hal exactly as the RF service would
+ * publish it; diversity_update() runs when the frame callback notifies the
+ * task (or after SIM_WAKE_TIMEOUT_US without one).
+ */
+void sim_run(const trace_t* trace, const sim_config_t* cfg, sim_result_t* r)
+{
+    diversity_mode_t mode = cfg->mode;
+
+    memset(r, 0, sizeof(*r));
+    sim_hal_reset();
+    diversity_init();
+    diversity_reset_stats();
+    if (cfg->custom != NULL) {
+        diversity_set_custom_profiles(cfg->custom, 1);
+        mode = DIVERSITY_MODE_CUSTOM_1;
+    }
+    diversity_set_mode(mode);
+    if (cfg->predictor >= 0) {
+        diversity_set_predictor(mode, (diversity_predictor_t)cfg->predictor);
+    }
+    for (int i = 0; i < cfg->shadows; i++) {
+        diversity_shadow_set(i, cfg->shadow[i]);
+    }
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        diversity_get_state()->rx[i].health.disabled = (cfg->disabled_mask >> i) & 1;
+    }
+
+    int64_t last_wake_us = 0;
+    int64_t worse_us = 0;
+    int64_t fade_start_us = -1;
+    int fade_rx = 0;
+    double latency_sum_ms = 0.0;
+    int64_t cpu_ns = 0;
+    int64_t fading_us[RSSI_FADING_COUNT] = {0};
+
+    for (size_t i = 0; i < trace->count; i++) {
+        const trace_frame_t* f = &trace->frame[i];
+        sim_hal_set_time_us(f->t_us);
+        sim_hal_publish(f->rssi);
+
+        if (sim_hal_take_notify() || f->t_us - last_wake_us >= SIM_WAKE_TIMEOUT_US) {
+            last_wake_us = f->t_us;
+            int64_t t0 = sim_now_ns();
+            diversity_update();
+            cpu_ns += sim_now_ns() - t0;
+            r->updates++;
+            if (cfg->on_update != NULL) {
+                cfg->on_update(diversity_get_state(), cfg->on_update_arg);
+            }
+        }
+
+        // Score the antenna in use until the next frame, against the best
+        // other; read as the UI reads it
+        diversity_snapshot_t snap;
+        diversity_get_snapshot(&snap);
+        int active = (int)snap.active_rx;
+        int32_t best_other = -1;
+        for (int rx = 0; rx < trace->rx_count; rx++) {
+            if (rx != active && (int32_t)f->rssi[rx] > best_other) {
+                best_other = f->rssi[rx];
+            }
+        }
+        int32_t gap = best_other - (int32_t)f->rssi[active];
+        int64_t dt = (i + 1 < trace->count) ? trace->frame[i + 1].t_us - f->t_us : 0;
+        if (gap > SIM_WORSE_MARGIN) {
+            worse_us += dt;
+        }
+        for (int rx = 0; rx < trace->rx_count; rx++) {
+            fading_us[snap.fading[rx] < RSSI_FADING_COUNT ? snap.fading[rx] : RSSI_FADING_UNKNOWN] += dt;
+        }
+
+        if (fade_start_us < 0) {
+            if (gap >= SIM_FADE_MARGIN) {
+                fade_start_us = f->t_us;
+                fade_rx = active;
+                r->fades++;
+            }
+        } else if (gap < SIM_FADE_CLEAR) {
+            // A handled fade ends on another antenna, clearly above the one
+            // that faded (with two receivers: gap's sign flipped)
+            if ((int32_t)f->rssi[active] - f->rssi[fade_rx] >= SIM_FADE_CLEAR) {
+                double ms = (f->t_us - fade_start_us) / 1000.0;
+                r->fades_switched++;
+                latency_sum_ms += ms;
+                if (ms > r->fade_latency_max_ms) {
+                    r->fade_latency_max_ms = ms;
+                }
+            }
+            fade_start_us = -1;
+        }
+    }
+
+    int64_t span_us = trace->frame[trace->count - 1].t_us - trace->frame[0].t_us;
+    r->switches  = diversity_get_switch_count();
+    r->minutes   = span_us / 60e6;
+    r->worse_pct = span_us > 0 ? 100.0 * worse_us / span_us : 0.0;
+    r->fade_latency_mean_ms = r->fades_switched ? latency_sum_ms / r->fades_switched : 0.0;
+    r->ns_per_update = r->updates ? (double)cpu_ns / r->updates : 0.0;
+    r->freq_sets = sim_hal_get_freq_sets();
+    for (int g = 0; g < RSSI_FADING_COUNT; g++) {
+        r->fading_pct[g] = span_us > 0 ? 100.0 * fading_us[g] / ((double)span_us * trace->rx_count) : 0.0;
+    }
+    diversity_shadow_get_stats(r->shadow);
+}
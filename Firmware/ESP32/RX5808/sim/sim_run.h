@@ -0,0 +1,64 @@
+/**
+ * @file sim_run.h
+ * @brief One trace x mode replay through diversity.c, and its metrics
+ *
+ * Shared by diversity_sim (report) and diversity_opt (parameter search).
+ * Per run:
+ *   switches    antenna switches, and per minute
+ *   worse%      share of trace time spent on an antenna whose raw RSSI is
+ *               below the best other one's by more than SIM_WORSE_MARGIN
+ *   fades       times the active antenna fell SIM_FADE_MARGIN counts below
+ *               the best other; "switched" of them ended with a switch,
+ *               after the mean / max latency shown
+ *   ns/update   host CPU time per diversity_update() call
+ *   fading      share of receiver time in each rssi_fading.h regime, as
+ *               the snapshot reports it
+ *   shadow      the firmware's shadow counters (diversity_shadow_get_stats())
+ *               when sim_config_t.shadows > 0
+ */
+
+#ifndef __SIM_RUN_H
+#define __SIM_RUN_H
+
+#include <stdint.h>
+#include "diversity.h"
+#include "trace.h"
+
+#define SIM_WORSE_MARGIN    123     // ~3 % of full scale (3x the A-B noise): below this the antennas tie
+#define SIM_FADE_MARGIN     400     // ~10 % of full scale opens a fade...
+#define SIM_FADE_CLEAR      200     // ...which closes once the gap is back under this
+#define SIM_WAKE_TIMEOUT_US 100000  // Diversity task notification timeout
+
+/** @brief Result of one trace x mode run */
+typedef struct {
+    uint32_t switches;
+    double   minutes;
+    double   worse_pct;
+    uint32_t fades;
+    uint32_t fades_switched;
+    double   fade_latency_mean_ms;
+    double   fade_latency_max_ms;
+    uint32_t updates;
+    double   ns_per_update;
+    uint32_t freq_sets;
+    double   fading_pct[RSSI_FADING_COUNT];
+    diversity_shadow_stats_t shadow[1 + DIVERSITY_SHADOW_MAX];
+} sim_result_t;
+
+/** @brief What to run: a mode, optionally with its predictor forced */
+typedef struct {
+    diversity_mode_t mode;
+    int              predictor;     // diversity_predictor_t, or -1 for the mode's own
+    const diversity_mode_params_t* custom;  // If set, run these in DIVERSITY_MODE_CUSTOM_1
+    diversity_mode_t shadow[DIVERSITY_SHADOW_MAX];  // Modes evaluated in shadow
+    int              shadows;
+    uint32_t         disabled_mask; // Receivers (bit n = receiver n) marked disabled
+    // If set, called after every diversity_update() with the live state
+    void (*on_update)(const diversity_state_t* state, void* arg);
+    void*            on_update_arg;
+} sim_config_t;
+
+/** @brief Replay one trace (DIVERSITY_NUM_RX receivers) with one config */
+void sim_run(const trace_t* trace, const sim_config_t* cfg, sim_result_t* r);
+
+#endif // __SIM_RUN_H
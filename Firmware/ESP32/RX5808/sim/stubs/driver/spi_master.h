@@ -0,0 +1,55 @@
+/**
+ * @file spi_master.h
+ * @brief Host stub: the types and calls rx5808.c uses; the host test
+ *        provides the functions and records the transactions
+ */
+#ifndef __SIM_SPI_MASTER_H
+#define __SIM_SPI_MASTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+#define VSPI_HOST   SPI3_HOST
+
+#define SPI_DMA_DISABLED        0
+#define SPI_DMA_CH_AUTO         3
+#define SPI_DEVICE_BIT_LSBFIRST (1 << 0)
+#define SPI_TRANS_USE_TXDATA    (1 << 3)
+
+typedef struct spi_device_t* spi_device_handle_t;
+
+typedef struct {
+    int mosi_io_num, miso_io_num, sclk_io_num, quadwp_io_num, quadhd_io_num;
+    int max_transfer_sz;
+} spi_bus_config_t;
+
+typedef struct {
+    uint8_t  command_bits, address_bits, dummy_bits, mode;
+    int      clock_speed_hz, spics_io_num, queue_size;
+    uint32_t flags;
+    void   (*pre_cb)(void*);
+    void   (*post_cb)(void*);
+} spi_device_interface_config_t;
+
+typedef struct {
+    uint32_t flags;
+    size_t   length;                    // Bits
+    union {
+        const void* tx_buffer;
+        uint8_t     tx_data[4];
+    };
+} spi_transaction_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* cfg, int dma_chan);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* cfg,
+                             spi_device_handle_t* handle);
+esp_err_t spi_device_acquire_bus(spi_device_handle_t dev, TickType_t wait);
+void      spi_device_release_bus(spi_device_handle_t dev);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t dev, spi_transaction_t* t);
+esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t* t, TickType_t wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t** t, TickType_t wait);
+
+#endif // __SIM_SPI_MASTER_H
@@ -0,0 +1,69 @@
+/**
+ * @file adc_continuous.h
+ * @brief Host stub: the continuous (DMA) ADC driver rx5808.c starts
+ */
+#ifndef __SIM_ADC_CONTINUOUS_H
+#define __SIM_ADC_CONTINUOUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_adc/adc_oneshot.h"
+
+#define SOC_ADC_DIGI_MAX_BITWIDTH   12
+#define SOC_ADC_DIGI_RESULT_BYTES   2
+
+typedef enum { ADC_CONV_SINGLE_UNIT_1 = 1 } adc_digi_convert_mode_t;
+typedef enum { ADC_DIGI_OUTPUT_FORMAT_TYPE1 } adc_digi_output_format_t;
+
+typedef struct adc_continuous_ctx_t* adc_continuous_handle_t;
+
+typedef struct {
+    uint8_t atten, channel, unit, bit_width;
+} adc_digi_pattern_config_t;
+
+typedef struct {
+    uint32_t max_store_buf_size;
+    uint32_t conv_frame_size;
+} adc_continuous_handle_cfg_t;
+
+typedef struct {
+    uint32_t                   pattern_num;
+    adc_digi_pattern_config_t* adc_pattern;
+    uint32_t                   sample_freq_hz;
+    adc_digi_convert_mode_t    conv_mode;
+    adc_digi_output_format_t   format;
+} adc_continuous_config_t;
+
+typedef struct {
+    uint8_t* conv_frame_buffer;
+    uint32_t size;
+} adc_continuous_evt_data_t;
+
+typedef bool (*adc_continuous_callback_t)(adc_continuous_handle_t h, const adc_continuous_evt_data_t* edata,
+                                          void* user_data);
+typedef struct {
+    adc_continuous_callback_t on_conv_done;
+    adc_continuous_callback_t on_pool_ovf;
+} adc_continuous_evt_cbs_t;
+
+typedef struct {
+    union {
+        struct {
+            uint16_t data    : 12;
+            uint16_t channel : 4;
+        } type1;
+        uint16_t val;
+    };
+} adc_digi_output_data_t;
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t* cfg, adc_continuous_handle_t* out);
+esp_err_t adc_continuous_config(adc_continuous_handle_t h, const adc_continuous_config_t* cfg);
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t h, const adc_continuous_evt_cbs_t* cbs,
+                                                  void* user_data);
+esp_err_t adc_continuous_start(adc_continuous_handle_t h);
+esp_err_t adc_continuous_stop(adc_continuous_handle_t h);
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t h);
+esp_err_t adc_continuous_read(adc_continuous_handle_t h, uint8_t* buf, uint32_t len, uint32_t* out_len,
+                              uint32_t timeout_ms);
+
+#endif // __SIM_ADC_CONTINUOUS_H
@@ -0,0 +1,11 @@
+/**
+ * @file esp_attr.h
+ * @brief Host stub: placement attributes are no-ops
+ */
+#ifndef __SIM_ESP_ATTR_H
+#define __SIM_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif // __SIM_ESP_ATTR_H
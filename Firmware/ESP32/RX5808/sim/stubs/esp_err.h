@@ -0,0 +1,30 @@
+/**
+ * @file esp_err.h
+ * @brief Host stub
+ */
+#ifndef __SIM_ESP_ERR_H
+#define __SIM_ESP_ERR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK          0
+#define ESP_FAIL       -1
+#define ESP_ERR_INVALID_STATE       0x103
+#define ESP_ERR_TIMEOUT             0x107
+#define ESP_ERR_NVS_NOT_FOUND       0x1102
+#define ESP_ERR_NVS_NO_FREE_PAGES   0x110d
+#define ESP_ERR_NVS_NEW_VERSION_FOUND 0x1110
+
+#define esp_err_to_name(err)    "esp_err"
+#define ESP_ERROR_CHECK(x) do {                                             \
+        esp_err_t err_ = (x);                                               \
+        if (err_ != ESP_OK) {                                               \
+            fprintf(stderr, "%s:%d: %s failed (%d)\n", __FILE__, __LINE__, #x, err_); \
+            abort();                                                        \
+        }                                                                   \
+    } while (0)
+
+#endif // __SIM_ESP_ERR_H
@@ -0,0 +1,16 @@
+/**
+ * @file esp_log.h
+ * @brief Host stub: ESP_LOGx go to sim_log(), silent unless -v was given
+ */
+#ifndef __SIM_ESP_LOG_H
+#define __SIM_ESP_LOG_H
+
+void sim_log(char level, const char* tag, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, fmt, ...) sim_log('E', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) sim_log('W', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) sim_log('I', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) sim_log('D', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) sim_log('V', tag, fmt, ##__VA_ARGS__)
+
+#endif // __SIM_ESP_LOG_H
@@ -0,0 +1,29 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stub: esp_timer_get_time() returns the simulation clock
+ *        (sim_hal.c, rf_hal.c); one-shot timers fire when rf_hal.c
+ *        advances that clock past their deadline
+ */
+#ifndef __SIM_ESP_TIMER_H
+#define __SIM_ESP_TIMER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t       callback;
+    void*                arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char*          name;
+} esp_timer_create_args_t;
+
+int64_t   esp_timer_get_time(void);
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t t);
+
+#endif // __SIM_ESP_TIMER_H
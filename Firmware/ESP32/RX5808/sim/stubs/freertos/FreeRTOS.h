@@ -0,0 +1,29 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stub: the simulator is single threaded, so only the types
+ *        and macros diversity.c and rx5808.c touch exist.  Critical
+ *        sections are no-ops.
+ */
+#ifndef __SIM_FREERTOS_H
+#define __SIM_FREERTOS_H
+
+#include <stdint.h>
+#include "esp_attr.h"
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE      1
+#define pdFALSE     0
+#define pdPASS      1
+#define portTICK_PERIOD_MS  10
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define portMAX_DELAY       ((TickType_t)0xffffffffu)
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+
+#endif // __SIM_FREERTOS_H
@@ -0,0 +1,19 @@
+/**
+ * @file event_groups.h
+ * @brief Host stub
+ */
+#ifndef __SIM_EVENT_GROUPS_H
+#define __SIM_EVENT_GROUPS_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_event_group* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t        xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits);
+EventBits_t        xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits);
+EventBits_t        xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear,
+                                       BaseType_t all, TickType_t wait);
+
+#endif // __SIM_EVENT_GROUPS_H
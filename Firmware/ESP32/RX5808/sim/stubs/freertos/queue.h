@@ -0,0 +1,17 @@
+/**
+ * @file queue.h
+ * @brief Host stub
+ */
+#ifndef __SIM_QUEUE_H
+#define __SIM_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_queue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size);
+BaseType_t    xQueueSend(QueueHandle_t q, const void* item, TickType_t wait);
+BaseType_t    xQueueReceive(QueueHandle_t q, void* item, TickType_t wait);
+BaseType_t    xQueueReset(QueueHandle_t q);
+
+#endif // __SIM_QUEUE_H
@@ -0,0 +1,16 @@
+/**
+ * @file semphr.h
+ * @brief Host stub: single threaded, so a mutex is always free
+ */
+#ifndef __SIM_SEMPHR_H
+#define __SIM_SEMPHR_H
+
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t s);
+
+#endif // __SIM_SEMPHR_H
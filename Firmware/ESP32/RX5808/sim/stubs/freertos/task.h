@@ -0,0 +1,27 @@
+/**
+ * @file task.h
+ * @brief Host stub: no task is created — the simulator calls
+ *        diversity_update() itself, once per trace frame, and the RF
+ *        driver test steps the RF service loop by hand
+ */
+#ifndef __SIM_TASK_H
+#define __SIM_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                     UBaseType_t prio, TaskHandle_t* handle, BaseType_t core);
+BaseType_t   xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                         UBaseType_t prio, TaskHandle_t* handle);
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+void         vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+uint32_t     ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+void         vTaskDelete(TaskHandle_t task);
+void         vTaskDelay(TickType_t ticks);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+#endif // __SIM_TASK_H
@@ -0,0 +1,26 @@
+/**
+ * @file nvs.h
+ * @brief Host stub: there is no flash, every nvs_open() fails
+ */
+#ifndef __SIM_NVS_H
+#define __SIM_NVS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* out);
+void      nvs_close(nvs_handle_t h);
+esp_err_t nvs_commit(nvs_handle_t h);
+esp_err_t nvs_get_u8(nvs_handle_t h, const char* key, uint8_t* out);
+esp_err_t nvs_set_u8(nvs_handle_t h, const char* key, uint8_t value);
+esp_err_t nvs_get_u16(nvs_handle_t h, const char* key, uint16_t* out);
+esp_err_t nvs_set_u16(nvs_handle_t h, const char* key, uint16_t value);
+esp_err_t nvs_get_blob(nvs_handle_t h, const char* key, void* out, size_t* len);
+esp_err_t nvs_set_blob(nvs_handle_t h, const char* key, const void* value, size_t len);
+esp_err_t nvs_erase_key(nvs_handle_t h, const char* key);
+
+#endif // __SIM_NVS_H
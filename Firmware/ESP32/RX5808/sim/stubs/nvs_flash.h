@@ -0,0 +1,13 @@
+/**
+ * @file nvs_flash.h
+ * @brief Host stub
+ */
+#ifndef __SIM_NVS_FLASH_H
+#define __SIM_NVS_FLASH_H
+
+#include "nvs.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#endif // __SIM_NVS_FLASH_H
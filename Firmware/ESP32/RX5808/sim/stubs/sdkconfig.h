@@ -0,0 +1,4 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host stub: every optional firmware feature is off
+ */
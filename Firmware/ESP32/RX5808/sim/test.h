@@ -0,0 +1,45 @@
+/**
+ * @file test.h
+ * @brief Assertions for the host unit tests (make test)
+ *
+ * Each test_*.c is one program: CHECK() counts and reports a failure
+ * without stopping, so one run lists every broken property, and
+ * test_report() turns the tally into the exit status.
+ */
+
+#ifndef __SIM_TEST_H
+#define __SIM_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int test_checks;
+static int test_failures;
+
+#define CHECK(cond) CHECK_MSG(cond, "%s", "")
+
+#define CHECK_MSG(cond, fmt, ...) do {                                      \
+        test_checks++;                                                      \
+        if (!(cond)) {                                                      \
+            test_failures++;                                                \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: " fmt "\n",           \
+                    __FILE__, __LINE__, #cond, ##__VA_ARGS__);              \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ(a, b) do {                                                 \
+        long long a_ = (long long)(a), b_ = (long long)(b);                 \
+        CHECK_MSG(a_ == b_, "%lld != %lld", a_, b_);                        \
+    } while (0)
+
+/**
+ * @brief Print the tally of test @p name
+ * @return Process exit status (0 if every check passed)
+ */
+static inline int test_report(const char* name)
+{
+    printf("%-16s %4d checks, %d failed\n", name, test_checks, test_failures);
+    return test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif // __SIM_TEST_H
@@ -0,0 +1,258 @@
+/**
+ * @file test_calmap.c
+ * @brief Host test of the per-frequency calibration map (rssi_calmap.c):
+ *        carrier classification and guard band of a sweep, interpolation of
+ *        floors and spans, the fallback span, lookup between bins and the
+ *        NVS blob round trip
+ */
+
+#include "rssi_calmap.h"
+#include "test.h"
+#include <string.h>
+
+#define FLOOR_A     500
+#define FLOOR_B     620
+#define CARRIER_BIN 30      // 5600 MHz
+#define GUARD_BINS  (RSSI_CALMAP_GUARD_MHZ / RSSI_CALMAP_STEP_MHZ)
+
+static uint16_t mean[RSSI_CALMAP_RX][RSSI_CALMAP_BINS];
+static bool measured[RSSI_CALMAP_BINS];
+
+static uint16_t with_margin(uint16_t v)
+{
+    return (uint16_t)(v + v * RSSI_CALMAP_FLOOR_MARGIN_PCT / 100);
+}
+
+/**
+ * @brief Sweep with a sloped floor on both receivers and, if @p carrier_bin
+ *        >= 0, a VTX there that leaks into the bins next to it
+ */
+static void make_sweep(int carrier_bin)
+{
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        mean[0][b]  = (uint16_t)(FLOOR_A + b * 2);
+        mean[1][b]  = (uint16_t)(FLOOR_B - b);
+        measured[b] = true;
+    }
+    if (carrier_bin >= 0) {
+        mean[0][carrier_bin] = 2500;
+        mean[1][carrier_bin] = 2300;
+        for (int d = -1; d <= 1; d += 2) {
+            mean[0][carrier_bin + d] = 1500;
+            mean[1][carrier_bin + d] = 1400;
+        }
+    }
+}
+
+/**
+ * @brief Carriers (well above the median on both receivers) give one peak
+ *        point, the strongest; no floor within the guard band of any of
+ *        them; every other measured bin is a floor point with the margin
+ */
+static void test_merge(void)
+{
+    rssi_calmap_t map;
+    rssi_calmap_clear(&map);
+    make_sweep(CARRIER_BIN);
+
+    int floors = rssi_calmap_merge_sweep(&map, mean, measured);
+    // Carriers at 29..31, guard 3 bins either side: 26..34 have no floor
+    CHECK_EQ(floors, RSSI_CALMAP_BINS - (3 + 2 * GUARD_BINS));
+    int bad_floor = 0, bad_peak = 0;
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        bool guarded = b >= CARRIER_BIN - 1 - GUARD_BINS && b <= CARRIER_BIN + 1 + GUARD_BINS;
+        for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+            uint16_t want = guarded ? 0 : with_margin(mean[rx][b]);
+            if (map.meas_floor[rx][b] != want) bad_floor++;
+            if (map.meas_peak[rx][b] != (b == CARRIER_BIN ? mean[rx][b] : 0)) bad_peak++;
+        }
+    }
+    CHECK_EQ(bad_floor, 0);
+    CHECK_EQ(bad_peak, 0);
+
+    // A carrier on one receiver only is not a carrier: its bin is a floor
+    rssi_calmap_clear(&map);
+    make_sweep(-1);
+    mean[0][10] = 3000;
+    CHECK_EQ(rssi_calmap_merge_sweep(&map, mean, measured), RSSI_CALMAP_BINS);
+    CHECK_EQ(map.meas_floor[0][10], with_margin(3000));
+    CHECK_EQ(map.meas_peak[0][10], 0);
+
+    // Bins this sweep missed keep their earlier points
+    uint16_t kept = map.meas_floor[1][40];
+    make_sweep(-1);
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        mean[1][b] += 50;
+    }
+    measured[40] = false;
+    CHECK_EQ(rssi_calmap_merge_sweep(&map, mean, measured), RSSI_CALMAP_BINS - 1);
+    CHECK_EQ(map.meas_floor[1][40], kept);
+    CHECK_EQ(map.meas_floor[1][41], with_margin(mean[1][41]));
+
+    // Under half the band measured: refused, map untouched
+    rssi_calmap_t before = map;
+    for (int b = 0; b <= RSSI_CALMAP_BINS / 2; b++) {
+        measured[b] = false;
+    }
+    CHECK_EQ(rssi_calmap_merge_sweep(&map, mean, measured), -1);
+    CHECK(memcmp(&map, &before, sizeof(map)) == 0);
+}
+
+/**
+ * @brief Floors interpolate linearly across the guard band and stay flat
+ *        beyond the outermost points; the span is the peak point's over the
+ *        interpolated floor there, interpolated between peak points
+ */
+static void test_build(void)
+{
+    static const uint16_t no_span[RSSI_CALMAP_RX] = { 0, 0 };
+    rssi_calmap_t map;
+    rssi_calmap_clear(&map);
+    make_sweep(CARRIER_BIN);
+    rssi_calmap_merge_sweep(&map, mean, measured);
+
+    CHECK(rssi_calmap_build(&map, no_span));
+    CHECK(map.valid);
+    int lo = CARRIER_BIN - 2 - GUARD_BINS, hi = CARRIER_BIN + 2 + GUARD_BINS;
+    int bad = 0;
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        int32_t f_lo = map.meas_floor[rx][lo], f_hi = map.meas_floor[rx][hi];
+        int32_t span = map.meas_peak[rx][CARRIER_BIN] -
+                       (f_lo + (f_hi - f_lo) * (CARRIER_BIN - lo) / (hi - lo));
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+            int32_t floor = (b > lo && b < hi) ? f_lo + (f_hi - f_lo) * (b - lo) / (hi - lo)
+                                               : map.meas_floor[rx][b];
+            if (map.floor[rx][b] != floor) bad++;
+            if (map.peak[rx][b] != floor + span) bad++;     // One peak point: same span everywhere
+        }
+    }
+    CHECK_MSG(bad == 0, "%d bins off", bad);
+
+    // Two peak points: span linear between them, flat outside
+    rssi_calmap_clear(&map);
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        map.meas_floor[0][b] = map.meas_floor[1][b] = 400;
+    }
+    map.meas_peak[0][10] = map.meas_peak[1][10] = 1400;     // Span 1000
+    map.meas_peak[0][50] = map.meas_peak[1][50] = 2400;     // Span 2000
+    CHECK(rssi_calmap_build(&map, no_span));
+    CHECK_EQ(map.peak[0][0], 1400);
+    CHECK_EQ(map.peak[0][30], 1900);
+    CHECK_EQ(map.peak[1][20], 1650);
+    CHECK_EQ(map.peak[1][RSSI_CALMAP_BINS - 1], 2400);
+
+    // A peak point too close to its floor is no span; clamped at 4095
+    map.meas_peak[0][50] = 400 + RSSI_CALMAP_MIN_SPAN - 1;
+    map.meas_floor[1][50] = 3900;
+    CHECK(rssi_calmap_build(&map, no_span));
+    CHECK_EQ(map.peak[0][60], 1400);
+    CHECK_EQ(map.peak[1][50], 4095);
+}
+
+/**
+ * @brief Without a peak point the single-point calibration's span is used
+ *        everywhere; without that too (or without floors) there is no map
+ */
+static void test_fallback(void)
+{
+    static const uint16_t span[RSSI_CALMAP_RX] = { 1200, 1100 };
+    static const uint16_t short_span[RSSI_CALMAP_RX] = { 1200, RSSI_CALMAP_MIN_SPAN - 1 };
+    static const uint16_t no_span[RSSI_CALMAP_RX] = { 0, 0 };
+    rssi_calmap_t map;
+    rssi_calmap_clear(&map);
+    CHECK(!rssi_calmap_build(&map, span));      // No floors
+    CHECK(!map.valid);
+
+    make_sweep(-1);
+    rssi_calmap_merge_sweep(&map, mean, measured);
+    CHECK(!rssi_calmap_build(&map, no_span));
+    CHECK(!map.valid);
+    CHECK(!rssi_calmap_build(&map, short_span));
+    CHECK(rssi_calmap_build(&map, span));
+    int bad = 0;
+    for (int rx = 0; rx < RSSI_CALMAP_RX; rx++) {
+        for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+            if (map.floor[rx][b] != with_margin(mean[rx][b])) bad++;
+            if (map.peak[rx][b] != map.floor[rx][b] + span[rx]) bad++;
+        }
+    }
+    CHECK_EQ(bad, 0);
+}
+
+/**
+ * @brief Lookup: the bin's values at its centre, linear in between,
+ *        clamped outside the band; refused on an invalid map
+ */
+static void test_lookup(void)
+{
+    static const uint16_t span[RSSI_CALMAP_RX] = { 1000, 1000 };
+    rssi_calmap_t map;
+    rssi_calmap_clear(&map);
+    uint16_t floor, peak;
+    CHECK(!rssi_calmap_lookup(&map, 0, 5800, &floor, &peak));
+
+    for (int b = 0; b < RSSI_CALMAP_BINS; b++) {
+        map.meas_floor[0][b] = (uint16_t)(300 + b * 10);
+        map.meas_floor[1][b] = (uint16_t)(900 - b * 5);
+    }
+    CHECK(rssi_calmap_build(&map, span));
+
+    CHECK(rssi_calmap_lookup(&map, 0, 5600, &floor, &peak));
+    CHECK_EQ(floor, 600);
+    CHECK_EQ(peak, 1600);
+    CHECK(rssi_calmap_lookup(&map, 0, 5607, &floor, &peak));
+    CHECK_EQ(floor, 607);
+    CHECK(rssi_calmap_lookup(&map, 1, 5604, &floor, &peak));
+    CHECK_EQ(floor, 748);       // 750 - 2
+    CHECK_EQ(peak, 1748);
+    CHECK(rssi_calmap_lookup(&map, 0, 5100, &floor, &peak));
+    CHECK_EQ(floor, 300);
+    CHECK(rssi_calmap_lookup(&map, 0, 6100, &floor, &peak));
+    CHECK_EQ(floor, 300 + (RSSI_CALMAP_BINS - 1) * 10);
+    CHECK(rssi_calmap_lookup(&map, 1, rssi_calmap_bin_freq(RSSI_CALMAP_BINS - 1), &floor, &peak));
+    CHECK_EQ(floor, 900 - (RSSI_CALMAP_BINS - 1) * 5);
+}
+
+/**
+ * @brief The blob carries the measured points; other layouts are refused
+ *        and leave the map alone
+ */
+static void test_blob(void)
+{
+    static uint8_t blob[RSSI_CALMAP_BLOB_SIZE + 4];
+    rssi_calmap_t map, back;
+    rssi_calmap_clear(&map);
+    make_sweep(CARRIER_BIN);
+    rssi_calmap_merge_sweep(&map, mean, measured);
+
+    CHECK_EQ(rssi_calmap_encode(&map, blob, RSSI_CALMAP_BLOB_SIZE - 1), 0);
+    CHECK_EQ(rssi_calmap_encode(&map, blob, sizeof(blob)), RSSI_CALMAP_BLOB_SIZE);
+    memset(&back, 0xAA, sizeof(back));
+    CHECK(rssi_calmap_decode(&back, blob, RSSI_CALMAP_BLOB_SIZE));
+    CHECK(memcmp(back.meas_floor, map.meas_floor, sizeof(map.meas_floor)) == 0);
+    CHECK(memcmp(back.meas_peak, map.meas_peak, sizeof(map.meas_peak)) == 0);
+    CHECK(!back.valid);         // Rebuilt by the caller
+
+    static const int offsets[] = { 0, 4, 6, 8, 10 };   // Magic, version, bins, min, step
+    for (unsigned i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        rssi_calmap_encode(&map, blob, sizeof(blob));
+        blob[offsets[i]] ^= 1;
+        memset(&back, 0xAA, sizeof(back));
+        rssi_calmap_t untouched = back;
+        CHECK_MSG(!rssi_calmap_decode(&back, blob, RSSI_CALMAP_BLOB_SIZE), "offset %d", offsets[i]);
+        CHECK(memcmp(&back, &untouched, sizeof(back)) == 0);
+    }
+    rssi_calmap_encode(&map, blob, sizeof(blob));
+    CHECK(!rssi_calmap_decode(&back, blob, RSSI_CALMAP_BLOB_SIZE - 2));
+    CHECK(!rssi_calmap_decode(&back, blob, RSSI_CALMAP_BLOB_SIZE + 2));
+}
+
+int main(void)
+{
+    test_merge();
+    test_build();
+    test_fallback();
+    test_lookup();
+    test_blob();
+    return test_report("test_calmap");
+}
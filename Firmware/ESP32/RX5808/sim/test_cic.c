@@ -0,0 +1,187 @@
+/**
+ * @file test_cic.c
+ * @brief Host test of the CIC decimator + compensating FIR (rssi_cic.c) at
+ *        the decimation ratios of the 1000/250/100 Hz frame rates: DC gain,
+ *        passband droop and alias attenuation against the analytic
+ *        response, and the cost per input sample
+ */
+
+#include "rssi_cic.h"
+#include "test.h"
+#include <math.h>
+#include <time.h>
+
+#define FS_HZ       5000.0  // Per-channel input rate (20 kHz scan of four channels)
+#define MID         2048.0
+#define AMPL        1000.0
+#define OUTPUTS     4000    // Output samples measured per tone
+
+static const uint16_t ratios[] = { 5, 20, 50 };
+
+/**
+ * @brief Analytic magnitude at input frequency @p f_hz: third-order CIC
+ *        |sin(πfR/fs) / (R·sin(πf/fs))|³ times the FIR at the output rate
+ */
+static double response(uint16_t r, double f_hz)
+{
+    double x = M_PI * f_hz / FS_HZ;
+    double cic = (fabs(sin(x)) < 1e-12) ? 1.0 : fabs(sin(x * r) / (r * sin(x)));
+    double fir = fabs(22.0 - 6.0 * cos(2.0 * x * r)) / 16.0;
+    return cic * cic * cic * fir;
+}
+
+/**
+ * @brief Amplitude of the tone @p f_hz in the decimated output of a sine of
+ *        AMPL at @p f_hz (folded to wherever it aliases, since the
+ *        projection uses the input-rate time of each output)
+ */
+static double measure(uint16_t r, double f_hz)
+{
+    static double y[OUTPUTS];
+    static double w[OUTPUTS];
+    rssi_cic_t c;
+    rssi_cic_init(&c, r);
+
+    int m = -20;            // Priming and start-up transient skipped
+    for (long n = 0; m < OUTPUTS; n++) {
+        double phase = 2.0 * M_PI * f_hz * n / FS_HZ;
+        uint16_t out;
+        if (rssi_cic_push(&c, (uint16_t)lround(MID + AMPL * sin(phase)), &out) && m++ >= 0) {
+            y[m - 1] = out;
+            w[m - 1] = phase;
+        }
+    }
+
+    double mean = 0, re = 0, im = 0;
+    for (m = 0; m < OUTPUTS; m++) {
+        mean += y[m] / OUTPUTS;
+    }
+    for (m = 0; m < OUTPUTS; m++) {
+        re += (y[m] - mean) * cos(w[m]);
+        im += (y[m] - mean) * sin(w[m]);
+    }
+    return 2.0 / OUTPUTS * hypot(re, im);
+}
+
+/**
+ * @brief A constant input comes out unchanged once primed, at every level
+ *        including the rails; before that the raw input is passed through
+ */
+static void test_dc_gain(void)
+{
+    static const uint16_t levels[] = { 0, 1, 777, 2048, 4094, 4095 };
+
+    for (unsigned i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+        for (unsigned l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+            rssi_cic_t c;
+            CHECK(rssi_cic_init(&c, ratios[i]));
+            int outputs = 0, bad = 0;
+            for (int n = 0; n < ratios[i] * 40; n++) {
+                uint16_t y;
+                if (rssi_cic_push(&c, levels[l], &y)) {
+                    outputs++;
+                    if (y != levels[l]) bad++;
+                }
+            }
+            CHECK_EQ(outputs, 40);
+            CHECK_MSG(bad == 0, "R=%u level %u: %d off", ratios[i], levels[l], bad);
+        }
+    }
+}
+
+/**
+ * @brief Passband: flat within 5 % up to a quarter of the output rate, and
+ *        on the analytic response (CIC droop lifted by the FIR)
+ */
+static void test_passband(void)
+{
+    static const double fractions[] = { 0.02, 0.05, 0.1, 0.15, 0.2, 0.25 };
+
+    for (unsigned i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+        uint16_t r = ratios[i];
+        for (unsigned k = 0; k < sizeof(fractions) / sizeof(fractions[0]); k++) {
+            double f = fractions[k] * FS_HZ / r;
+            double gain = measure(r, f) / AMPL;
+            CHECK_MSG(fabs(gain - 1.0) <= 0.05, "R=%u %.1f Hz: gain %.4f", r, f, gain);
+            CHECK_MSG(fabs(gain - response(r, f)) <= 0.005, "R=%u %.1f Hz: gain %.4f, expected %.4f",
+                      r, f, gain, response(r, f));
+        }
+    }
+}
+
+/**
+ * @brief Stopband: tones that alias onto the lower passband (around
+ *        multiples of the output rate) are attenuated by at least 45 dB
+ */
+static void test_stopband(void)
+{
+    for (unsigned i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+        uint16_t r = ratios[i];
+        double fo = FS_HZ / r;
+        for (int k = 1; k <= 2 && k * fo < FS_HZ / 2; k++) {
+            for (int sign = -1; sign <= 1; sign += 2) {
+                double f = k * fo + sign * 0.1 * fo;
+                double atten_db = -20.0 * log10(measure(r, f) / AMPL);
+                double expect_db = -20.0 * log10(response(r, f));
+                CHECK_MSG(atten_db >= 45.0, "R=%u %.1f Hz: %.1f dB", r, f, atten_db);
+                // Output rounding (±0.5 count) sets a floor well above the
+                // analytic response deep in the stopband
+                CHECK_MSG(atten_db >= fmin(expect_db, 60.0) - 3.0, "R=%u %.1f Hz: %.1f dB, expected %.1f",
+                          r, f, atten_db, expect_db);
+            }
+        }
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Cost per input sample of rssi_cic_push() (informational: the
+ *        host is not the ESP32, but a regression shows up as a ratio)
+ */
+static void bench(void)
+{
+    enum { SAMPLES = 10000000 };
+    static uint16_t input[4096];
+    for (int n = 0; n < 4096; n++) {
+        input[n] = (uint16_t)(MID + AMPL * sin(n * 0.01));
+    }
+
+    for (unsigned i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+        rssi_cic_t c;
+        rssi_cic_init(&c, ratios[i]);
+        volatile uint32_t sink = 0;
+
+        double t0 = now_ns();
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t c0 = __builtin_ia32_rdtsc();
+#endif
+        for (int n = 0; n < SAMPLES; n++) {
+            uint16_t y;
+            if (rssi_cic_push(&c, input[n & 4095], &y)) {
+                sink += y;
+            }
+        }
+        double ns = (now_ns() - t0) / SAMPLES;
+#if defined(__x86_64__) || defined(__i386__)
+        double cycles = (double)(__builtin_ia32_rdtsc() - c0) / SAMPLES;
+        printf("  rssi_cic R=%-3u %6.2f ns/sample, %6.2f TSC cycles/sample\n", ratios[i], ns, cycles);
+#else
+        printf("  rssi_cic R=%-3u %6.2f ns/sample\n", ratios[i], ns);
+#endif
+    }
+}
+
+int main(void)
+{
+    test_dc_gain();
+    test_passband();
+    test_stopband();
+    bench();
+    return test_report("test_cic");
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_decim.c
+ * @brief Host test of the RSSI decimator (rssi_decim.c) and of the frames
+ *        the RF service builds from the continuous ADC stream (rx5808.c on
+ *        the stand-ins of rf_hal.c)
+ */
+
+#include "rf_hal.h"
+#include "rx5808.h"
+#include "rssi_decim.h"
+#include "esp_timer.h"
+#include "test.h"
+
+#define CHAN_HZ     5000    // Per-channel conversion rate of the 20 kHz scan
+
+static const uint16_t level[RSSI_SLOT_COUNT] = { 1000, 2000, 3000, 4000 };
+
+/**
+ * @brief Push one scan (RSSI0, RSSI1, VBAT, KEY), leaving out the slots
+ *        in @p drop_mask
+ * @return Frames completed (0 or 1)
+ */
+static int push_scan(rssi_decim_t* d, const uint16_t* v, uint32_t drop_mask, rssi_frame_t* out)
+{
+    int frames = 0;
+    for (uint8_t s = 0; s < RSSI_SLOT_COUNT; s++) {
+        if (!(drop_mask & (1u << s))) {
+            frames += rssi_decim_push(d, s, v[s], out);
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Slots stay apart: one frame per factor scans, each value from its
+ *        own slot only; VBAT/KEY are rounded window means
+ */
+static void test_interleave(void)
+{
+    static const uint16_t factors[] = { 5, 20, 50 };
+
+    for (unsigned f = 0; f < sizeof(factors) / sizeof(factors[0]); f++) {
+        rssi_decim_t d;
+        rssi_frame_t out;
+        CHECK(rssi_decim_init(&d, factors[f]));
+
+        int frames = 0, last = -1, bad_gap = 0, bad_value = 0;
+        for (int scan = 0; scan < factors[f] * 40; scan++) {
+            if (push_scan(&d, level, 0, &out)) {
+                if (last >= 0 && scan - last != factors[f]) bad_gap++;
+                for (uint8_t s = 0; s < RSSI_SLOT_COUNT; s++) {
+                    if (out.value[s] != level[s]) bad_value++;
+                }
+                last = scan;
+                frames++;
+            }
+        }
+        CHECK_EQ(frames, 40);
+        CHECK_EQ(bad_gap, 0);
+        CHECK_EQ(bad_value, 0);
+    }
+
+    // Unknown slot: ignored
+    rssi_decim_t d;
+    rssi_frame_t out;
+    rssi_decim_init(&d, 5);
+    CHECK(!rssi_decim_push(&d, RSSI_SLOT_COUNT, 1234, &out));
+    CHECK_EQ(d.count[RSSI_SLOT_RSSI0], 0);
+
+    // Window mean of VBAT, rounded: 3000/3011 alternating, five per window
+    uint16_t v[RSSI_SLOT_COUNT] = { 1000, 2000, 3000, 4000 };
+    for (int scan = 0; scan < 100; scan++) {
+        v[RSSI_SLOT_VBAT] = (scan & 1) ? 3011 : 3000;
+        if (push_scan(&d, v, 0, &out) && scan > 10) {
+            CHECK(out.value[RSSI_SLOT_VBAT] == 3004 || out.value[RSSI_SLOT_VBAT] == 3007);
+        }
+    }
+
+    // Out-of-range factor: clamped to 1, reported
+    CHECK(!rssi_decim_init(&d, RSSI_CIC_MAX_DECIM + 1));
+    CHECK_EQ(d.factor, 1);
+}
+
+/**
+ * @brief Dropped conversions: a slot with none in a window holds its
+ *        previous value, and the CIC output does not dip afterwards
+ */
+static void test_dropped(void)
+{
+    rssi_decim_t d;
+    rssi_frame_t out;
+    rssi_decim_init(&d, 5);
+
+    for (int scan = 0; scan < 100; scan++) {
+        push_scan(&d, level, 0, &out);
+    }
+    // A whole window without RSSI1 and VBAT
+    int frames = 0;
+    for (int scan = 0; scan < 5; scan++) {
+        frames += push_scan(&d, level, (1u << RSSI_SLOT_RSSI1) | (1u << RSSI_SLOT_VBAT), &out);
+    }
+    CHECK_EQ(frames, 1);
+    CHECK_EQ(out.value[RSSI_SLOT_RSSI0], level[RSSI_SLOT_RSSI0]);
+    CHECK_EQ(out.value[RSSI_SLOT_RSSI1], level[RSSI_SLOT_RSSI1]);
+    CHECK_EQ(out.value[RSSI_SLOT_VBAT], level[RSSI_SLOT_VBAT]);
+
+    // Single conversions lost here and there
+    for (int scan = 0; scan < 200; scan++) {
+        uint32_t drop = (scan % 7 == 3) ? (1u << RSSI_SLOT_RSSI1) : 0;
+        if (push_scan(&d, level, drop, &out)) {
+            CHECK_EQ(out.value[RSSI_SLOT_RSSI1], level[RSSI_SLOT_RSSI1]);
+        }
+    }
+}
+
+/**
+ * @brief Frames from the RF service: spaced exactly one frame period at
+ *        1000, 250 and 100 Hz, consecutive seq, values from the right
+ *        slots — also when the service was held off and drains a backlog
+ */
+static void test_frame_times(void)
+{
+    static const uint16_t rates[] = { 1000, 250, 100 };
+
+    rf_hal_set_rssi(1234, 2345);
+    rf_hal_adc_stream(true);
+    RX5808_Init();
+    CHECK(RX5808_Is_ADC_Streaming());
+    CHECK_EQ(RX5808_Get_RSSI_Rate(), 1000);
+
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        CHECK(RX5808_Set_RSSI_Rate(rates[r]));
+        rf_hal_service_step();      // Applies the rate
+        CHECK_EQ(RX5808_Get_RSSI_Rate(), rates[r]);
+        CHECK_EQ(RX5808_Get_RSSI_Group_Delay_Us(),
+                 rssi_cic_group_delay_us(CHAN_HZ / rates[r], 1000000 / CHAN_HZ));
+
+        rssi_ring_reader_t rd;
+        rssi_ring_reader_init(RX5808_Get_Sample_Ring(), &rd);
+        int frames = 0, bad_dt = 0, bad_seq = 0, bad_value = 0, late = 0;
+        int64_t prev_t = -1;
+        uint32_t prev_seq = 0;
+
+        for (int wake = 0; wake < 160; wake++) {
+            // One DMA conversion frame (128 results) per wake-up; every 40th
+            // wake-up the service was held off for five
+            rf_hal_adc_convert(wake % 40 == 39 ? 5 * 128 : 128);
+            rf_hal_service_step();
+
+            rssi_frame_t fr;
+            while (rssi_ring_read(RX5808_Get_Sample_Ring(), &rd, &fr)) {
+                if (prev_t >= 0 && fr.t_us - prev_t != 1000000 / rates[r]) bad_dt++;
+                if (prev_t >= 0 && fr.seq != prev_seq + 1) bad_seq++;
+                if (fr.t_us > esp_timer_get_time()) late++;
+                if (fr.value[RSSI_SLOT_RSSI0] != 1234 || fr.value[RSSI_SLOT_RSSI1] != 2345 ||
+                    fr.value[RSSI_SLOT_VBAT] != 2100 || fr.value[RSSI_SLOT_KEY] != 4000) bad_value++;
+                prev_t   = fr.t_us;
+                prev_seq = fr.seq;
+                frames++;
+            }
+        }
+        // 160 wake-ups x 128 + 4 x 512 extra conversions, 4 per scan
+        int expect = (160 * 128 + 4 * 512) / 4 / (CHAN_HZ / rates[r]);
+        CHECK_MSG(frames >= expect - 1 && frames <= expect, "%d Hz: %d frames", rates[r], frames);
+        CHECK_MSG(bad_dt == 0, "%d Hz: %d gaps off", rates[r], bad_dt);
+        CHECK_EQ(bad_seq, 0);
+        CHECK_EQ(late, 0);
+        CHECK_EQ(bad_value, 0);
+        CHECK_EQ(rd.dropped, 0);
+    }
+}
+
+int main(void)
+{
+    test_interleave();
+    test_dropped();
+    test_frame_times();
+    return test_report("test_decim");
+}
@@ -0,0 +1,308 @@
+/**
+ * @file test_flightrec.c
+ * @brief Host test of the flight recorder block codec (flightrec_codec.c):
+ *        encode / decode round trip against a reference decoder written
+ *        from the format in flightrec_codec.h (as tools/flightrec_decode.py
+ *        reads it), block boundaries, and detection of corrupt blocks
+ */
+
+#include "flightrec_codec.h"
+#include "test.h"
+#include <string.h>
+
+#define MAX_RECORDS     (FLIGHTREC_BLOCK_SIZE * 4)   // More than a block can hold (2 bits per field minimum)
+
+static uint32_t rng = 12345;
+
+static uint32_t rand_next(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static uint32_t get_le(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/** @brief LSB-first bit reader over the payload */
+typedef struct {
+    const uint8_t* data;
+    uint32_t len;
+    uint32_t pos;               // Bit position
+    bool     overrun;
+} bit_reader_t;
+
+static uint32_t get_bits(bit_reader_t* r, int n)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++, r->pos++) {
+        if (r->pos / 8 >= r->len) {
+            r->overrun = true;
+            return 0;
+        }
+        v |= (uint32_t)((r->data[r->pos / 8] >> (r->pos % 8)) & 1) << i;
+    }
+    return v;
+}
+
+static int32_t get_delta(bit_reader_t* r)
+{
+    static const int class_bits[4] = { 0, 4, 8, 16 };
+    uint32_t z = get_bits(r, class_bits[get_bits(r, 2)]);
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+/**
+ * @brief Decode a sealed block as the dump decoder does: header checks,
+ *        payload CRC, then count records
+ * @return Records decoded, -1 if the block would be rejected
+ */
+static int decode_block(const uint8_t* buf, flightrec_sample_t* out, uint32_t* seq, uint16_t* boot)
+{
+    if (!flightrec_block_valid(buf, seq, boot)) {
+        return -1;
+    }
+    uint32_t len = get_le(buf + 16, 2);
+    if (flightrec_crc32(buf + FLIGHTREC_HDR_SIZE, len) != get_le(buf + 20, 4)) {
+        return -1;
+    }
+    bit_reader_t r = { buf + FLIGHTREC_HDR_SIZE, len, 0, false };
+    int32_t prev[FLIGHTREC_FIELDS] = { 0 };
+    uint32_t t_ms = get_le(buf + 12, 4);
+    int count = (int)get_le(buf + 10, 2);
+
+    for (int n = 0; n < count; n++) {
+        for (int i = 0; i < FLIGHTREC_FIELDS; i++) {
+            prev[i] += get_delta(&r);
+        }
+        t_ms += (uint32_t)prev[0];
+        out[n].t_ms              = t_ms;
+        out[n].raw[0]            = (uint16_t)prev[1];
+        out[n].raw[1]            = (uint16_t)prev[2];
+        out[n].norm[0]           = (uint8_t)prev[3];
+        out[n].norm[1]           = (uint8_t)prev[4];
+        out[n].score[0]          = (uint8_t)prev[5];
+        out[n].score[1]          = (uint8_t)prev[6];
+        out[n].active_rx         = (uint8_t)(prev[7] & 1);
+        out[n].freq_shift_state  = (uint8_t)((prev[7] >> 1) & 3);
+        out[n].freq_shift_offset = (int8_t)(((prev[7] >> 3) & 3) - 1);
+    }
+    return r.overrun ? -1 : count;
+}
+
+static bool sample_equal(const flightrec_sample_t* a, const flightrec_sample_t* b)
+{
+    return a->t_ms == b->t_ms && a->raw[0] == b->raw[0] && a->raw[1] == b->raw[1] &&
+           a->norm[0] == b->norm[0] && a->norm[1] == b->norm[1] &&
+           a->score[0] == b->score[0] && a->score[1] == b->score[1] &&
+           a->active_rx == b->active_rx && a->freq_shift_state == b->freq_shift_state &&
+           a->freq_shift_offset == b->freq_shift_offset;
+}
+
+/**
+ * @brief Next sample after @p prev: RSSI random walk at a slowly changing
+ *        evaluation rate, or (@p wild) every field anywhere in its range
+ */
+static void make_sample(flightrec_sample_t* s, const flightrec_sample_t* prev, bool wild)
+{
+    if (wild) {
+        s->t_ms     = prev->t_ms + rand_next() % 32768;
+        s->raw[0]   = (uint16_t)(rand_next() & 0xFFF);
+        s->raw[1]   = (uint16_t)(rand_next() & 0xFFF);
+        s->norm[0]  = (uint8_t)(rand_next() % 101);
+        s->norm[1]  = (uint8_t)(rand_next() % 101);
+        s->score[0] = (uint8_t)(rand_next() % 101);
+        s->score[1] = (uint8_t)(rand_next() % 101);
+    } else {
+        *s = *prev;
+        s->t_ms += 10 + (rand_next() % 64 == 0);
+        for (int i = 0; i < 2; i++) {
+            int raw = s->raw[i] + (int)(rand_next() % 41) - 20;
+            s->raw[i]   = (uint16_t)(raw < 0 ? 0 : raw > 4095 ? 4095 : raw);
+            s->norm[i]  = (uint8_t)(s->raw[i] * 100 / 4095);
+            s->score[i] = s->norm[i];
+        }
+    }
+    s->active_rx = (rand_next() % 50 == 0) ? !prev->active_rx : prev->active_rx;
+    s->freq_shift_state  = (uint8_t)(wild ? rand_next() % 4 : prev->freq_shift_state);
+    s->freq_shift_offset = (int8_t)(wild ? (int)(rand_next() % 3) - 1 : prev->freq_shift_offset);
+}
+
+/**
+ * @brief Fill one block to the end with @p wild or flight-like samples
+ *        and read it back: every record identical, header ids as written
+ */
+static int round_trip(bool wild, flightrec_sample_t* first)
+{
+    static uint8_t buf[FLIGHTREC_BLOCK_SIZE];
+    static flightrec_sample_t in[MAX_RECORDS], out[MAX_RECORDS];
+    flightrec_block_t b;
+    flightrec_block_begin(&b, buf, 0x12345678u, 77);
+
+    flightrec_sample_t prev = *first;
+    int n = 0;
+    while (n < MAX_RECORDS) {
+        make_sample(&in[n], &prev, wild);
+        if (!flightrec_block_append(&b, &in[n])) {
+            break;
+        }
+        prev = in[n++];
+    }
+    *first = prev;
+    uint16_t used = flightrec_block_finish(&b);
+    CHECK(used <= FLIGHTREC_BLOCK_SIZE);
+    CHECK_EQ(used, flightrec_block_used(buf));
+    flightrec_block_seal(buf);
+
+    uint32_t seq;
+    uint16_t boot;
+    int got = decode_block(buf, out, &seq, &boot);
+    CHECK_EQ(got, n);
+    CHECK_EQ(seq, 0x12345678u);
+    CHECK_EQ(boot, 77);
+    int bad = 0;
+    for (int i = 0; i < n && i < got; i++) {
+        if (!sample_equal(&in[i], &out[i])) bad++;
+    }
+    CHECK_MSG(bad == 0, "%d of %d records differ", bad, n);
+    return n;
+}
+
+static void test_round_trip(void)
+{
+    flightrec_sample_t s = { .t_ms = 1000, .raw = { 2000, 1800 }, .norm = { 48, 43 }, .score = { 48, 43 } };
+
+    // Flight-like: 10 ms steps, small RSSI steps: about 4 bytes a record
+    for (int k = 0; k < 4; k++) {
+        int n = round_trip(false, &s);
+        CHECK_MSG(n >= 800, "%d records per block", n);
+    }
+    // Every field jumping across its whole range, 16-bit deltas included
+    for (int k = 0; k < 4; k++) {
+        int n = round_trip(true, &s);
+        CHECK_MSG(n >= (FLIGHTREC_BLOCK_SIZE - FLIGHTREC_HDR_SIZE) / FLIGHTREC_MAX_RECORD, "%d records", n);
+    }
+}
+
+/**
+ * @brief Edges: a gap beyond 32767 ms and a full block are refused without
+ *        writing, an empty block round-trips, extreme values survive
+ */
+static void test_edges(void)
+{
+    static uint8_t buf[FLIGHTREC_BLOCK_SIZE];
+    static flightrec_sample_t out[4];
+    flightrec_block_t b;
+    uint32_t seq;
+    uint16_t boot;
+
+    flightrec_block_begin(&b, buf, 1, 1);
+    flightrec_block_finish(&b);
+    flightrec_block_seal(buf);
+    CHECK_EQ(decode_block(buf, out, &seq, &boot), 0);
+    CHECK_EQ(flightrec_block_used(buf), FLIGHTREC_HDR_SIZE);
+
+    flightrec_sample_t lo = { .t_ms = 0xFFFFFF00u, .raw = { 0, 4095 }, .norm = { 0, 100 }, .score = { 100, 0 },
+                              .active_rx = 1, .freq_shift_state = 3, .freq_shift_offset = -1 };
+    flightrec_sample_t hi = { .t_ms = lo.t_ms + 32767, .raw = { 4095, 0 }, .norm = { 100, 0 }, .score = { 0, 100 },
+                              .active_rx = 0, .freq_shift_state = 0, .freq_shift_offset = 1 };
+    flightrec_sample_t gap = hi;
+    gap.t_ms += 32768;
+
+    flightrec_block_begin(&b, buf, 2, 1);
+    CHECK(flightrec_block_append(&b, &lo));
+    CHECK(flightrec_block_append(&b, &hi));     // Wraps the 32-bit ms counter
+    uint16_t pos = b.pos;
+    CHECK(!flightrec_block_append(&b, &gap));
+    CHECK_EQ(b.pos, pos);
+    CHECK_EQ(b.count, 2);
+    flightrec_block_finish(&b);
+    flightrec_block_seal(buf);
+    CHECK_EQ(decode_block(buf, out, &seq, &boot), 2);
+    CHECK(sample_equal(&out[0], &lo));
+    CHECK(sample_equal(&out[1], &hi));
+
+    // The next block starts from the gap sample
+    flightrec_block_begin(&b, buf, 3, 1);
+    CHECK(flightrec_block_append(&b, &gap));
+    flightrec_block_finish(&b);
+    flightrec_block_seal(buf);
+    CHECK_EQ(decode_block(buf, out, &seq, &boot), 1);
+    CHECK(sample_equal(&out[0], &gap));
+}
+
+/**
+ * @brief Corrupt blocks are rejected: bad magic, version or length by the
+ *        header check, any single flipped payload or header bit by the CRC
+ */
+static void test_corrupt(void)
+{
+    static uint8_t good[FLIGHTREC_BLOCK_SIZE], buf[FLIGHTREC_BLOCK_SIZE];
+    static flightrec_sample_t out[MAX_RECORDS];
+    flightrec_sample_t s = { .t_ms = 5000, .raw = { 1500, 1500 }, .norm = { 30, 30 }, .score = { 30, 30 } };
+    flightrec_block_t b;
+    uint32_t seq;
+    uint16_t boot;
+
+    // CRC-32 check value
+    CHECK_EQ(flightrec_crc32((const uint8_t*)"123456789", 9), 0xCBF43926u);
+
+    flightrec_block_begin(&b, good, 9, 3);
+    for (int i = 0; i < 200; i++) {
+        flightrec_sample_t next;
+        make_sample(&next, &s, false);
+        flightrec_block_append(&b, &next);
+        s = next;
+    }
+    uint16_t used = flightrec_block_finish(&b);
+    flightrec_block_seal(good);
+    CHECK_EQ(decode_block(good, out, &seq, &boot), 200);
+
+    // Unsealed: the CRC field is still erased flash
+    memcpy(buf, good, used);
+    memset(buf + 20, 0xFF, 4);
+    CHECK_EQ(decode_block(buf, out, &seq, &boot), -1);
+
+    static const struct { int offset; uint8_t value; } headers[] = {
+        { 0, 'X' },                 // Magic
+        { 18, 2 },                  // Version
+        { 17, 0x10 },               // Length beyond the block
+    };
+    for (unsigned i = 0; i < sizeof(headers) / sizeof(headers[0]); i++) {
+        memcpy(buf, good, used);
+        buf[headers[i].offset] = headers[i].value;
+        CHECK_MSG(!flightrec_block_valid(buf, &seq, &boot), "header byte %d", headers[i].offset);
+    }
+
+    // Every payload bit, and the length / CRC fields
+    int missed = 0;
+    for (uint32_t bit = 0; bit < (uint32_t)(used - FLIGHTREC_HDR_SIZE) * 8; bit++) {
+        memcpy(buf, good, used);
+        buf[FLIGHTREC_HDR_SIZE + bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        if (decode_block(buf, out, &seq, &boot) >= 0) missed++;
+    }
+    for (int bit = 16 * 8; bit < FLIGHTREC_HDR_SIZE * 8; bit++) {
+        if (bit >= 18 * 8 && bit < 20 * 8) continue;    // Version: header check above
+        memcpy(buf, good, used);
+        buf[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        if (decode_block(buf, out, &seq, &boot) >= 0) missed++;
+    }
+    CHECK_MSG(missed == 0, "%d flipped bits not detected", missed);
+
+    // Erased flash is not a block
+    memset(buf, 0xFF, sizeof(buf));
+    CHECK(!flightrec_block_valid(buf, &seq, &boot));
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_edges();
+    test_corrupt();
+    return test_report("test_flightrec");
+}
@@ -0,0 +1,186 @@
+/**
+ * @file test_nrx.c
+ * @brief Receiver-count checks of diversity.c, built for every RSSI_RX_COUNT
+ *        (make test at 2; make run-rx runs test-nrx at 4 and 8):
+ *
+ *   - best of N: with one receiver clearly strongest the decision settles
+ *     on it, and follows when another takes over
+ *   - a disabled receiver is never the active one, over every synthetic
+ *     scenario and mode
+ *   - two receivers: the switch counts of the synthetic scenarios are the
+ *     two-receiver build's, also in an N-receiver build whose receivers
+ *     beyond A and B are disabled and flat
+ */
+
+#include "sim_run.h"
+#include "trace.h"
+#include "test.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STEP_US         1000        // 1 kHz frames
+#define BEST_MS         40000
+#define HANDOVER_MS     20000
+#define FLAT_RSSI       300         // Receivers beyond A and B in the 2-RX comparison
+
+static const diversity_mode_t modes[] = {
+    DIVERSITY_MODE_RACE, DIVERSITY_MODE_FREESTYLE, DIVERSITY_MODE_LONG_RANGE
+};
+#define MODE_COUNT  (int)(sizeof(modes) / sizeof(modes[0]))
+
+// Switches of the two-receiver build, seed 1 (diversity_sim -c), per
+// scenario (multipath, obstacle, long range) and mode (as modes[])
+static const uint32_t two_rx_switches[TRACE_SCENARIO_COUNT][MODE_COUNT] = {
+    { 342, 231, 89 },
+    {  28,  24, 10 },
+    {  46,  30, 20 },
+};
+
+static bool trace_alloc(trace_t* t, size_t count, int rx_count, const char* name)
+{
+    memset(t, 0, sizeof(*t));
+    t->frame = calloc(count, sizeof(t->frame[0]));
+    t->count = t->capacity = t->frame ? count : 0;
+    t->rx_count = rx_count;
+    strncpy(t->name, name, sizeof(t->name) - 1);
+    return t->frame != NULL;
+}
+
+/** @brief Active receiver at the last update before @p at_us, and at the end */
+typedef struct {
+    int64_t  at_us;
+    int      active;
+    int      last;
+} active_at_t;
+
+static void active_at_check(const diversity_state_t* s, void* arg)
+{
+    active_at_t* a = arg;
+    a->last = (int)s->active_rx;
+    if (esp_timer_get_time() < a->at_us) {
+        a->active = (int)s->active_rx;
+    }
+}
+
+/**
+ * @brief Receiver n sits at a level that grows with n, so the last one is
+ *        strongest; half-way receiver 1 jumps above all of them
+ */
+static void test_best_of_n(void)
+{
+    trace_t t;
+    if (!trace_alloc(&t, BEST_MS * 1000 / STEP_US, DIVERSITY_NUM_RX, "best-of-n")) {
+        CHECK(false);
+        return;
+    }
+    uint32_t rng = 7;
+    for (size_t i = 0; i < t.count; i++) {
+        t.frame[i].t_us = (int64_t)i * STEP_US;
+        for (int rx = 0; rx < DIVERSITY_NUM_RX; rx++) {
+            rng = rng * 1664525u + 1013904223u;
+            int level = 1200 + rx * 2400 / DIVERSITY_NUM_RX + (int)(rng >> 27) - 16;
+            if (rx == 1 && t.frame[i].t_us >= HANDOVER_MS * 1000LL) {
+                level = 3900;
+            }
+            t.frame[i].rssi[rx] = (uint16_t)level;
+        }
+    }
+
+    for (int m = 0; m < MODE_COUNT; m++) {
+        active_at_t a = { .at_us = HANDOVER_MS * 1000LL, .active = -1, .last = -1 };
+        sim_config_t cfg = { .mode = modes[m], .predictor = -1, .on_update = active_at_check, .on_update_arg = &a };
+        sim_result_t r;
+        sim_run(&t, &cfg, &r);
+        const char* name = diversity_get_mode_params(modes[m])->name;
+        CHECK_MSG(a.active == DIVERSITY_NUM_RX - 1, "%s: on %d before the handover", name, a.active);
+        CHECK_MSG(a.last == 1, "%s: on %d after it", name, a.last);
+        CHECK_MSG(r.switches <= 2 * (DIVERSITY_NUM_RX - 1), "%s: %u switches", name, r.switches);
+    }
+    trace_free(&t);
+}
+
+/** @brief Updates that found a disabled receiver active */
+typedef struct {
+    uint32_t mask;
+    uint32_t on_disabled;
+    uint32_t updates;
+} disabled_check_t;
+
+static void disabled_check(const diversity_state_t* s, void* arg)
+{
+    disabled_check_t* d = arg;
+    d->updates++;
+    if ((d->mask >> s->active_rx) & 1) {
+        d->on_disabled++;
+    }
+}
+
+/**
+ * @brief Receiver B and the last one disabled: never active, whatever the
+ *        scenario makes of them
+ */
+static void test_disabled(void)
+{
+    uint32_t mask = (1u << 1) | (1u << (DIVERSITY_NUM_RX - 1));
+    for (int sc = 0; sc < TRACE_SCENARIO_COUNT; sc++) {
+        trace_t t;
+        if (!trace_generate(&t, (trace_scenario_t)sc, 1, DIVERSITY_NUM_RX)) {
+            CHECK(false);
+            continue;
+        }
+        for (int m = 0; m < MODE_COUNT; m++) {
+            disabled_check_t d = { .mask = mask };
+            sim_config_t cfg = { .mode = modes[m], .predictor = -1, .disabled_mask = mask,
+                                 .on_update = disabled_check, .on_update_arg = &d };
+            sim_result_t r;
+            sim_run(&t, &cfg, &r);
+            CHECK_MSG(d.updates > 1000 && d.on_disabled == 0, "%s/%s: %u of %u updates on a disabled receiver",
+                      t.name, diversity_get_mode_params(modes[m])->name, d.on_disabled, d.updates);
+        }
+        trace_free(&t);
+    }
+}
+
+/**
+ * @brief A and B of the synthetic scenarios (their sequences do not depend
+ *        on the receiver count), the others disabled and flat: the switch
+ *        counts of the two-receiver build
+ */
+static void test_two_rx(void)
+{
+    uint32_t mask = 0;
+    for (int rx = 2; rx < DIVERSITY_NUM_RX; rx++) {
+        mask |= 1u << rx;
+    }
+    for (int sc = 0; sc < TRACE_SCENARIO_COUNT; sc++) {
+        trace_t t;
+        if (!trace_generate(&t, (trace_scenario_t)sc, 1, 2)) {
+            CHECK(false);
+            continue;
+        }
+        t.rx_count = DIVERSITY_NUM_RX;
+        for (size_t i = 0; i < t.count; i++) {
+            for (int rx = 2; rx < DIVERSITY_NUM_RX; rx++) {
+                t.frame[i].rssi[rx] = FLAT_RSSI;
+            }
+        }
+        for (int m = 0; m < MODE_COUNT; m++) {
+            sim_config_t cfg = { .mode = modes[m], .predictor = -1, .disabled_mask = mask };
+            sim_result_t r;
+            sim_run(&t, &cfg, &r);
+            CHECK_MSG(r.switches == two_rx_switches[sc][m], "%s/%s: %u switches, %u with two receivers",
+                      trace_scenario_name((trace_scenario_t)sc), diversity_get_mode_params(modes[m])->name,
+                      r.switches, two_rx_switches[sc][m]);
+        }
+        trace_free(&t);
+    }
+}
+
+int main(void)
+{
+    test_best_of_n();
+    test_disabled();
+    test_two_rx();
+    return test_report("test_nrx");
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test_ring.c
+ * @brief Writer/reader stress test of rssi_ring.c and rssi_snapshot.c:
+ *        one producer thread publishing as fast as it can against several
+ *        reader threads, checking that no reader ever sees a torn frame and
+ *        that sequence numbers only move forward
+ */
+
+#include "rssi_ring.h"
+#include "rssi_snapshot.h"
+#include "test.h"
+#include <pthread.h>
+#include <string.h>
+
+#define FRAMES      2000000     // Published per run
+#define READERS     3           // Of each kind
+
+static rssi_ring_t     ring;
+static rssi_snapshot_t snap;
+
+/**
+ * @brief Frame contents derived from its seq alone, so a copy mixing two
+ *        frames is recognised whichever fields it mixes
+ */
+static void frame_fill(rssi_frame_t* fr, uint32_t seq)
+{
+    memset(fr, 0, sizeof(*fr));
+    fr->seq  = seq;
+    fr->t_us = (int64_t)seq * 1000 + 7;
+    for (int s = 0; s < RSSI_SLOT_COUNT; s++) {
+        fr->value[s] = (uint16_t)((seq + s * 977u) & 0xFFF);
+    }
+    for (int i = 0; i < RSSI_FILTER_RX; i++) {
+        fr->filtered[i] = (uint16_t)(seq * 3u + i);
+        fr->percent[i]  = (float)(seq % 100u) + i;
+    }
+}
+
+static bool frame_whole(const rssi_frame_t* fr)
+{
+    rssi_frame_t want;
+    frame_fill(&want, fr->seq);
+    return fr->t_us == want.t_us &&
+           memcmp(fr->value, want.value, sizeof(want.value)) == 0 &&
+           memcmp(fr->filtered, want.filtered, sizeof(want.filtered)) == 0 &&
+           memcmp(fr->percent, want.percent, sizeof(want.percent)) == 0;
+}
+
+/** @brief What one reader thread saw */
+typedef struct {
+    uint32_t frames;            // Frames returned
+    uint32_t torn;              // Frames whose fields do not all belong to its seq
+    uint32_t backwards;         // Returned seq not after the previous one (at or before, for snapshots)
+    uint32_t gap_unaccounted;   // Ring: skipped frames not counted in dropped
+    uint32_t last_seq;
+    uint32_t dropped;
+} reader_result_t;
+
+static void* ring_writer(void* arg)
+{
+    rssi_frame_t fr;
+    for (uint32_t seq = 1; seq <= FRAMES; seq++) {
+        frame_fill(&fr, seq);
+        rssi_ring_publish(&ring, &fr);
+    }
+    return NULL;
+}
+
+static void* ring_reader(void* arg)
+{
+    reader_result_t* r = arg;
+    rssi_ring_reader_t rd;
+    rssi_ring_reader_init(&ring, &rd);
+    uint32_t prev = rd.next - 1;
+    uint32_t prev_dropped = 0;
+
+    while (prev < FRAMES) {
+        rssi_frame_t fr;
+        if (!rssi_ring_read(&ring, &rd, &fr)) {
+            continue;
+        }
+        r->frames++;
+        if (!frame_whole(&fr)) r->torn++;
+        if (fr.seq <= prev) r->backwards++;
+        if (fr.seq - prev - 1 != rd.dropped - prev_dropped) r->gap_unaccounted++;
+        prev = fr.seq;
+        prev_dropped = rd.dropped;
+    }
+    r->last_seq = prev;
+    r->dropped  = rd.dropped;
+    return NULL;
+}
+
+static void* ring_latest_reader(void* arg)
+{
+    reader_result_t* r = arg;
+    uint32_t prev = 0;
+
+    while (prev < FRAMES) {
+        rssi_frame_t fr;
+        if (!rssi_ring_latest(&ring, &fr)) {
+            continue;
+        }
+        r->frames++;
+        if (!frame_whole(&fr)) r->torn++;
+        if (fr.seq < prev) r->backwards++;
+        prev = fr.seq;
+    }
+    r->last_seq = prev;
+    return NULL;
+}
+
+static void* snap_writer(void* arg)
+{
+    rssi_frame_t fr;
+    for (uint32_t seq = 1; seq <= FRAMES; seq++) {
+        frame_fill(&fr, seq);
+        rssi_snapshot_write(&snap, &fr);
+    }
+    return NULL;
+}
+
+static void* snap_reader(void* arg)
+{
+    reader_result_t* r = arg;
+    uint32_t prev = 0;
+
+    while (prev < FRAMES) {
+        rssi_frame_t fr;
+        if (!rssi_snapshot_read(&snap, &fr)) {
+            continue;
+        }
+        r->frames++;
+        if (!frame_whole(&fr)) r->torn++;
+        if (fr.seq < prev) r->backwards++;
+        prev = fr.seq;
+    }
+    r->last_seq = prev;
+    return NULL;
+}
+
+static void check_readers(const char* what, const reader_result_t* r, int n)
+{
+    for (int i = 0; i < n; i++) {
+        CHECK_MSG(r[i].frames > 0, "%s %d", what, i);
+        CHECK_MSG(r[i].torn == 0, "%s %d: %u torn of %u", what, i, r[i].torn, r[i].frames);
+        CHECK_MSG(r[i].backwards == 0, "%s %d: %u backwards", what, i, r[i].backwards);
+        CHECK_MSG(r[i].gap_unaccounted == 0, "%s %d: %u gaps not in dropped", what, i, r[i].gap_unaccounted);
+        CHECK_EQ(r[i].last_seq, FRAMES);
+    }
+}
+
+/**
+ * @brief Ring: cursor readers get every frame exactly once or count it as
+ *        dropped; rssi_ring_latest() readers never go back
+ */
+static void test_ring(void)
+{
+    pthread_t writer, readers[2 * READERS];
+    reader_result_t res[2 * READERS];
+    memset(res, 0, sizeof(res));
+    rssi_ring_init(&ring);
+
+    // Readers attach before the first frame, so each one's cursor starts at 1
+    for (int i = 0; i < READERS; i++) {
+        pthread_create(&readers[i], NULL, ring_reader, &res[i]);
+        pthread_create(&readers[READERS + i], NULL, ring_latest_reader, &res[READERS + i]);
+    }
+    pthread_create(&writer, NULL, ring_writer, NULL);
+    pthread_join(writer, NULL);
+    for (int i = 0; i < 2 * READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    check_readers("ring reader", res, READERS);
+    check_readers("ring latest", res + READERS, READERS);
+    for (int i = 0; i < READERS; i++) {
+        CHECK_EQ(res[i].frames + res[i].dropped, FRAMES);
+    }
+    CHECK_EQ(rssi_ring_head(&ring), FRAMES);
+}
+
+/**
+ * @brief Snapshot: every read is one whole frame, seq never goes back
+ */
+static void test_snapshot(void)
+{
+    pthread_t writer, readers[READERS];
+    reader_result_t res[READERS];
+    memset(res, 0, sizeof(res));
+    rssi_snapshot_init(&snap);
+
+    rssi_frame_t fr;
+    CHECK(!rssi_snapshot_read(&snap, &fr));
+
+    for (int i = 0; i < READERS; i++) {
+        pthread_create(&readers[i], NULL, snap_reader, &res[i]);
+    }
+    pthread_create(&writer, NULL, snap_writer, NULL);
+    pthread_join(writer, NULL);
+    for (int i = 0; i < READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    check_readers("snapshot", res, READERS);
+}
+
+int main(void)
+{
+    test_ring();
+    test_snapshot();
+    return test_report("test_ring");
+}
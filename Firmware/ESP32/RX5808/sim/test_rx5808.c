@@ -0,0 +1,286 @@
+/**
+ * @file test_rx5808.c
+ * @brief Host test of the asynchronous tune path of rx5808.c:
+ *        RX5808_Tune_Async(), RX5808_Is_Settled(), RX5808_Get_Settled_Time_Us()
+ *        and RX5808_Wait_Settled(), on the stand-ins of rf_hal.c
+ */
+
+#include "rf_hal.h"
+#include "rx5808.h"
+#include "rx5808_settle.h"
+#include "esp_timer.h"
+#include "test.h"
+
+#define REG_B   0x01    // Synthesizer register B
+
+static uint32_t cb_count[2];
+static uint16_t cb_freq[2];
+
+static void cb_a(uint16_t freq) { cb_count[0]++; cb_freq[0] = freq; }
+static void cb_b(uint16_t freq) { cb_count[1]++; cb_freq[1] = freq; }
+
+static void cb_clear(void)
+{
+    cb_count[0] = cb_count[1] = 0;
+    cb_freq[0]  = cb_freq[1]  = 0;
+}
+
+// Same N/A split as rx5808_synth_register_b()
+static uint32_t reg_b_for(uint16_t freq)
+{
+    uint16_t f_lo = (freq - 479) >> 1;
+    return (uint32_t)(f_lo / 32) << 7 | (f_lo % 32);
+}
+
+static void check_last_write(uint16_t freq)
+{
+    const rf_hal_spi_write_t* w = rf_hal_spi_last();
+    CHECK(w != NULL);
+    if (w != NULL) {
+        CHECK_EQ(w->addr, REG_B);
+        CHECK_EQ(w->data, reg_b_for(freq));
+    }
+}
+
+// Post, let the service apply it, run past the settle deadline
+static void tune_and_settle(uint16_t freq)
+{
+    RX5808_Tune_Async(freq, NULL);
+    rf_hal_service_step();
+    rf_hal_advance_us(RX5808_Get_Settled_Time_Us() - esp_timer_get_time());
+}
+
+/**
+ * @brief Boot tune: written by RX5808_Init() itself and tracked like any
+ *        other, settled exactly at the predicted deadline
+ */
+static void test_boot(void)
+{
+    RX5808_Init();     // Band A CH1, 5865 MHz, from the synthesizer's 5800
+    uint32_t predict = RX5808_Get_Predicted_Settle_Us(5800, 5865);
+
+    CHECK_EQ(rf_hal_spi_count(), 3);
+    check_last_write(5865);
+    CHECK_EQ(RX5808_Get_Settled_Time_Us(), predict);
+    CHECK_EQ(rf_hal_timer_deadline_us(), predict);
+    CHECK(!RX5808_Is_Settled());
+    rf_hal_advance_us(predict - 1);
+    CHECK(!RX5808_Is_Settled());
+    rf_hal_advance_us(1);
+    CHECK(RX5808_Is_Settled());
+}
+
+/**
+ * @brief One tune: nothing is written until the service runs, not settled
+ *        until the deadline, callback exactly once at the deadline
+ */
+static void test_tune_async(void)
+{
+    cb_clear();
+    uint32_t spi = rf_hal_spi_count();
+    uint32_t notifies = rf_hal_notify_count();
+    uint32_t predict = RX5808_Get_Predicted_Settle_Us(5865, 5740);
+
+    CHECK(RX5808_Tune_Async(5740, cb_a));
+    CHECK(rf_hal_notify_count() > notifies);
+    CHECK_EQ(rf_hal_spi_count(), spi);
+    CHECK(!RX5808_Is_Settled());        // Posted but not applied: still unsettled
+
+    int64_t t0 = esp_timer_get_time();
+    rf_hal_service_step();
+    CHECK_EQ(rf_hal_spi_count(), spi + 1);
+    check_last_write(5740);
+    CHECK_EQ(RX5808_Get_Settled_Time_Us(), t0 + predict);
+    CHECK(!RX5808_Is_Settled());
+
+    rf_hal_advance_us(predict - 1);
+    CHECK_EQ(cb_count[0], 0);
+    CHECK(!RX5808_Is_Settled());
+    rf_hal_advance_us(1);
+    CHECK_EQ(cb_count[0], 1);
+    CHECK_EQ(cb_freq[0], 5740);
+    CHECK(RX5808_Is_Settled());
+
+    rf_hal_advance_us(200000);
+    CHECK_EQ(cb_count[0], 1);
+    CHECK_EQ(RX5808_Get_Settled_Time_Us(), t0 + predict);
+}
+
+/**
+ * @brief Two posts before the service runs: only the newest is written
+ *        and only its callback fires
+ */
+static void test_latest_wins(void)
+{
+    cb_clear();
+    uint32_t spi = rf_hal_spi_count();
+
+    RX5808_Tune_Async(5760, cb_a);
+    RX5808_Tune_Async(5780, cb_b);
+    rf_hal_service_step();
+    CHECK_EQ(rf_hal_spi_count(), spi + 1);
+    check_last_write(5780);
+
+    rf_hal_advance_us(RX5808_SETTLE_MAX_US);
+    CHECK_EQ(cb_count[0], 0);
+    CHECK_EQ(cb_count[1], 1);
+    CHECK_EQ(cb_freq[1], 5780);
+    CHECK(RX5808_Is_Settled());
+}
+
+/**
+ * @brief A retune while the previous one settles moves the deadline: an
+ *        expiry of the old timer that was already queued is ignored, and
+ *        only the new callback fires, at the new deadline
+ */
+static void test_supersede_settling(void)
+{
+    cb_clear();
+    RX5808_Tune_Async(5800, cb_a);
+    rf_hal_service_step();
+    int64_t old_deadline = RX5808_Get_Settled_Time_Us();
+
+    rf_hal_advance_us(10000);
+    RX5808_Tune_Async(5820, cb_b);
+    CHECK(!RX5808_Is_Settled());
+    rf_hal_service_step();
+    int64_t new_deadline = RX5808_Get_Settled_Time_Us();
+    CHECK(new_deadline > old_deadline);
+    CHECK_EQ(rf_hal_timer_deadline_us(), new_deadline);
+
+    rf_hal_advance_us(old_deadline - esp_timer_get_time());
+    rf_hal_timer_fire_stale();
+    CHECK_EQ(cb_count[0], 0);
+    CHECK_EQ(cb_count[1], 0);
+    CHECK(!RX5808_Is_Settled());
+
+    rf_hal_advance_us(new_deadline - esp_timer_get_time());
+    CHECK_EQ(cb_count[0], 0);
+    CHECK_EQ(cb_count[1], 1);
+    CHECK_EQ(cb_freq[1], 5820);
+    CHECK(RX5808_Is_Settled());
+}
+
+/**
+ * @brief Retune to the frequency already held: no SPI write, the deadline
+ *        stands, and the new callback replaces the pending one
+ */
+static void test_same_frequency(void)
+{
+    cb_clear();
+    uint32_t spi = rf_hal_spi_count();
+
+    // Already settled: the callback fires at once
+    RX5808_Tune_Async(5820, cb_a);
+    rf_hal_service_step();
+    CHECK_EQ(rf_hal_spi_count(), spi);
+    CHECK(RX5808_Is_Settled());
+    rf_hal_advance_us(0);
+    CHECK_EQ(cb_count[0], 1);
+
+    // Still settling: the deadline of the original write holds
+    cb_clear();
+    RX5808_Tune_Async(5840, cb_a);
+    rf_hal_service_step();
+    int64_t deadline = RX5808_Get_Settled_Time_Us();
+    rf_hal_advance_us(5000);
+    RX5808_Tune_Async(5840, cb_b);
+    rf_hal_service_step();
+    CHECK_EQ(rf_hal_spi_count(), spi + 1);
+    CHECK_EQ(RX5808_Get_Settled_Time_Us(), deadline);
+    rf_hal_advance_us(deadline - esp_timer_get_time());
+    CHECK_EQ(cb_count[0], 0);
+    CHECK_EQ(cb_count[1], 1);
+    CHECK(RX5808_Is_Settled());
+}
+
+/**
+ * @brief RX5808_Wait_Settled(): times out while the tune sits in the
+ *        mailbox (a stale event bit must not end the wait), returns at the
+ *        deadline once it is applied, at once when already settled
+ */
+static void test_wait_settled(void)
+{
+    RX5808_Tune_Async(5860, NULL);
+    int64_t t0 = esp_timer_get_time();
+    CHECK(!RX5808_Wait_Settled(100));
+    CHECK(esp_timer_get_time() - t0 >= 100000);
+    CHECK(!RX5808_Is_Settled());
+
+    rf_hal_service_step();
+    int64_t deadline = RX5808_Get_Settled_Time_Us();
+    CHECK(RX5808_Wait_Settled(200));
+    CHECK_EQ(esp_timer_get_time(), deadline);
+
+    t0 = esp_timer_get_time();
+    CHECK(RX5808_Wait_Settled(200));
+    CHECK_EQ(esp_timer_get_time(), t0);
+}
+
+/**
+ * @brief Early convergence seen by the RF service completes the tune before
+ *        the predicted deadline; the timer must not run the callback again
+ */
+static void test_early_exit(void)
+{
+    cb_clear();
+    rf_hal_set_rssi(500, 500);
+    RX5808_Tune_Async(5362, cb_a);
+    rf_hal_service_step();
+    int64_t t0 = esp_timer_get_time();
+    int64_t deadline = RX5808_Get_Settled_Time_Us();
+
+    // One frame per millisecond: first sample, a transition, then stable
+    int64_t exit_us = -1;
+    for (int ms = 1; ms <= 20 && exit_us < 0; ms++) {
+        rf_hal_advance_us(1000);
+        rf_hal_set_rssi(ms == 1 ? 500 : 1500, ms == 1 ? 500 : 1400);
+        rf_hal_service_step();
+        if (cb_count[0] != 0) {
+            exit_us = esp_timer_get_time();
+        }
+    }
+    CHECK(exit_us > 0 && exit_us < deadline);
+    CHECK_EQ(cb_count[0], 1);
+    CHECK_EQ(cb_freq[0], 5362);
+    CHECK_EQ(RX5808_Get_Settled_Time_Us(), exit_us);
+    CHECK(exit_us - t0 >= RX5808_SETTLE_MIN_US);
+    CHECK(RX5808_Is_Settled());
+    CHECK_EQ(rf_hal_timer_deadline_us(), -1);
+
+    rf_hal_advance_us(deadline - esp_timer_get_time() + 10000);
+    CHECK_EQ(cb_count[0], 1);
+}
+
+/**
+ * @brief While the ELRS backpack owns the bus no tune is issued; releasing
+ *        it rewrites the last frequency even though the shadow matched
+ */
+static void test_backpack(void)
+{
+    tune_and_settle(5880);
+    uint32_t spi = rf_hal_spi_count();
+
+    RX5808_Set_Backpack_Detected(true);
+    CHECK(!RX5808_Tune_Async(5900, cb_a));
+    rf_hal_service_step();
+    CHECK_EQ(rf_hal_spi_count(), spi);
+
+    RX5808_Set_Backpack_Detected(false);
+    rf_hal_service_step();
+    CHECK_EQ(rf_hal_spi_count(), spi + 1);
+    check_last_write(5880);
+}
+
+int main(void)
+{
+    test_boot();
+    test_tune_async();
+    test_latest_wins();
+    test_supersede_settling();
+    test_same_frequency();
+    test_wait_settled();
+    test_early_exit();
+    test_backpack();
+    return test_report("test_rx5808");
+}
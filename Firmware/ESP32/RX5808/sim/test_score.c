@@ -0,0 +1,149 @@
+/**
+ * @file test_score.c
+ * @brief Integer scoring and AGC of diversity.c against a float reference
+ *
+ * diversity_calculate_scores() and the AGC run in Q15/Q16 integers.  This
+ * keeps the float formulation they were converted from and replays the
+ * synthetic traces through diversity.c (sim_run()), recomputing every
+ * processed sample in float from the live state's own inputs:
+ *
+ *   stability  100 - (0.2·sqrt(variance) + 0.038·|slope|), clamped 0..100
+ *   AGC        baseline = 0.999·baseline + 0.001·rssi_norm while stable;
+ *              rssi_agc = rssi_norm + clamp(50 - baseline, ±15) after 100
+ *   combined   w_rssi·rssi_agc + w_stability·stability (flutter weights
+ *              in multipath flutter), clamped 0..100
+ *
+ * Each stage must agree to within one point; the whole chain (float AGC
+ * and stability into the float combined score) to within two.
+ */
+
+#include "sim_run.h"
+#include "trace.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define SCORE_TOL           1   // Points, one stage
+#define SCORE_CHAIN_TOL     2   // Points, AGC + stability + combination
+
+/** @brief Float reference state and the worst disagreement seen */
+typedef struct {
+    double   baseline[DIVERSITY_NUM_RX];
+    uint32_t count[DIVERSITY_NUM_RX];
+    uint32_t last_seq;
+    uint32_t transients;
+    uint32_t time_stable_ms;        // As diversity_update() reads it on the next sample
+    uint32_t samples;
+    int      err_stability, err_agc, err_combined, err_chain;
+} score_ref_t;
+
+static int ref_stability(const diversity_rx_state_t* rx)
+{
+    double penalty = 0.2 * sqrt((double)rx->rssi_variance) + 0.038 * fabs((double)rx->rssi_slope);
+    int stability = 100 - (int)penalty;
+    return stability < 0 ? 0 : stability > 100 ? 100 : stability;
+}
+
+static int ref_agc(score_ref_t* ref, int i, uint8_t rssi_norm, bool stable)
+{
+    if (stable) {
+        ref->baseline[i] = ref->baseline[i] * 0.999 + rssi_norm * 0.001;
+        if (ref->count[i] < 60000) ref->count[i]++;
+    }
+    if (ref->count[i] < 100) {
+        return rssi_norm;
+    }
+    int corr = (int)(50.0 - ref->baseline[i]);
+    corr = corr > 15 ? 15 : corr < -15 ? -15 : corr;
+    int agc = rssi_norm + corr;
+    return agc < 0 ? 0 : agc > 100 ? 100 : agc;
+}
+
+static int ref_combined(const diversity_mode_params_t* p, uint8_t fading, int agc, int stability)
+{
+    double w_rssi = p->weight_rssi / 32768.0, w_stability = p->weight_stability / 32768.0;
+    if (fading == RSSI_FADING_FLUTTER) {
+        w_rssi      += w_stability - p->flutter_weight_stability / 32768.0;
+        w_stability  = p->flutter_weight_stability / 32768.0;
+    }
+    double score = w_rssi * agc + w_stability * stability;
+    return score > 100.0 ? 100 : score < 0.0 ? 0 : (int)score;
+}
+
+static void worst(int* err, int a, int b)
+{
+    int d = abs(a - b);
+    if (d > *err) *err = d;
+}
+
+/**
+ * @brief sim_run() observer: after a diversity_update() that processed a
+ *        new, settled sample, recompute each receiver in float
+ */
+static void score_check(const diversity_state_t* s, void* arg)
+{
+    score_ref_t* ref = arg;
+    bool fresh = s->last_sample_seq != ref->last_seq && s->transient_samples == ref->transients;
+    bool stable = ref->time_stable_ms > 2000;
+    ref->last_seq       = s->last_sample_seq;
+    ref->transients     = s->transient_samples;
+    ref->time_stable_ms = s->time_stable_ms;
+    if (!fresh) {
+        return;
+    }
+    ref->samples++;
+
+    const diversity_mode_params_t* p = diversity_get_mode_params(s->mode);
+    for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+        const diversity_rx_state_t* rx = &s->rx[i];
+        int stability = ref_stability(rx);
+        int agc = ref_agc(ref, i, rx->rssi_norm, stable);
+        worst(&ref->err_stability, stability, rx->stability_score);
+        worst(&ref->err_agc, agc, rx->rssi_agc);
+
+        // The preference bonus is added after scoring; undo it unless capped
+        int combined = rx->combined_score;
+        if (s->pref_bonus[i] > 0) {
+            if (combined == 100) continue;
+            combined -= s->pref_bonus[i];
+        }
+        worst(&ref->err_combined, ref_combined(p, rx->fading, rx->rssi_agc, rx->stability_score), combined);
+        worst(&ref->err_chain, ref_combined(p, rx->fading, agc, stability), combined);
+    }
+}
+
+int main(void)
+{
+    static const diversity_mode_t modes[] = {
+        DIVERSITY_MODE_RACE, DIVERSITY_MODE_FREESTYLE, DIVERSITY_MODE_LONG_RANGE
+    };
+
+    for (int sc = 0; sc < TRACE_SCENARIO_COUNT; sc++) {
+        trace_t trace;
+        if (!trace_generate(&trace, (trace_scenario_t)sc, 1, DIVERSITY_NUM_RX)) {
+            CHECK_MSG(false, "%s", trace_scenario_name((trace_scenario_t)sc));
+            continue;
+        }
+        for (unsigned m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            score_ref_t ref;
+            memset(&ref, 0, sizeof(ref));
+            for (int i = 0; i < DIVERSITY_NUM_RX; i++) {
+                ref.baseline[i] = 50.0;     // diversity_init(): AGC target
+            }
+            sim_config_t cfg = { .mode = modes[m], .predictor = -1,
+                                 .on_update = score_check, .on_update_arg = &ref };
+            sim_result_t r;
+            sim_run(&trace, &cfg, &r);
+
+            const char* name = diversity_get_mode_params(modes[m])->name;
+            const char* scn  = trace_scenario_name((trace_scenario_t)sc);
+            CHECK_MSG(ref.samples > 1000, "%s/%s: %u samples", scn, name, ref.samples);
+            CHECK_MSG(ref.err_stability <= SCORE_TOL, "%s/%s: stability off by %d", scn, name, ref.err_stability);
+            CHECK_MSG(ref.err_agc <= SCORE_TOL, "%s/%s: AGC off by %d", scn, name, ref.err_agc);
+            CHECK_MSG(ref.err_combined <= SCORE_TOL, "%s/%s: combined off by %d", scn, name, ref.err_combined);
+            CHECK_MSG(ref.err_chain <= SCORE_CHAIN_TOL, "%s/%s: chain off by %d", scn, name, ref.err_chain);
+        }
+        trace_free(&trace);
+    }
+    return test_report("test_score");
+}
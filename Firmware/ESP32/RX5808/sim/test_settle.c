@@ -0,0 +1,240 @@
+/**
+ * @file test_settle.c
+ * @brief Host test of the learned settle model (rx5808_settle.c), driven
+ *        with synthetic post-tune RSSI curves
+ */
+
+#include "rx5808_settle.h"
+#include "test.h"
+#include <math.h>
+
+#define NOMINAL_MHZ 5800
+
+/**
+ * @brief Post-tune RSSI curve of both receivers.
+ *        STEP: the PLL hunts (the RSSI swings around the mid level) until
+ *        it locks at at_us and the new level is there at once.
+ *        EXP: exponential approach to the new level, time constant at_us.
+ *        FLAT: noise floor (empty band), NOISY: never stable.
+ */
+typedef struct {
+    enum { CURVE_STEP, CURVE_EXP, CURVE_FLAT, CURVE_NOISY } kind;
+    uint16_t from, to;          // Level before / after the transition
+    uint32_t at_us;
+} curve_t;
+
+static uint16_t curve_at(const curve_t* c, int64_t t_us, int n)
+{
+    switch (c->kind) {
+    case CURVE_STEP:
+        if (t_us >= c->at_us) {
+            return c->to;
+        }
+        return (uint16_t)((c->from + c->to) / 2 + ((n & 1) ? 150 : -150));
+    case CURVE_EXP:
+        return (uint16_t)lround(c->to + ((double)c->from - c->to) * exp(-(double)t_us / c->at_us));
+    case CURVE_FLAT:
+        return (uint16_t)(c->from + (n % 3) * 8);       // Noise floor, well within tolerance
+    case CURVE_NOISY:
+    default:
+        return (uint16_t)(c->from + (n & 1) * 200);     // Never stable
+    }
+}
+
+/**
+ * @brief Run one tune from @p from_mhz to @p to_mhz at t = 0, sampling the
+ *        curve every @p period_us for 150 ms
+ * @return Time of the (single) early exit, -1 if there was none
+ */
+static int64_t run_tune(rx5808_settle_model_t* m, uint16_t from_mhz, uint16_t to_mhz,
+                        const curve_t* c, uint32_t period_us)
+{
+    int64_t exit_us = -1;
+    int exits = 0;
+
+    rx5808_settle_begin(m, from_mhz, to_mhz, 0);
+    CHECK(!rx5808_settle_observe(m, c->from, c->from, 0));     // Captured with the write: ignored
+    int n = 0;
+    for (int64_t t = period_us; t <= 150000; t += period_us, n++) {
+        uint16_t v = curve_at(c, t, n);
+        if (rx5808_settle_observe(m, v, v, t)) {
+            exits++;
+            if (exit_us < 0) {
+                exit_us = t;
+            }
+        }
+    }
+    CHECK(exits <= 1);
+    CHECK(!m->tracking);
+    return exit_us;
+}
+
+static uint8_t bucket_of(uint16_t jump_mhz)
+{
+    uint8_t b = 0;
+    while (b < RX5808_SETTLE_BUCKETS - 1 && jump_mhz > rx5808_settle_bucket_limit_mhz(b)) {
+        b++;
+    }
+    return b;
+}
+
+/**
+ * @brief Step: exits four stable samples after the jump, well before the
+ *        seed prediction, and learns the jump time plus 25 % margin into
+ *        the tune's bucket only
+ */
+static void test_step(void)
+{
+    rx5808_settle_model_t m;
+    rx5808_settle_init(&m);
+    curve_t c = { CURVE_STEP, 500, 2000, 8000 };
+    uint8_t b = bucket_of(30);
+
+    CHECK_EQ(rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 30), RX5808_SETTLE_MAX_US);
+    int64_t exit_us = run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 30, &c, 1000);
+    CHECK_EQ(exit_us, 12000);
+    CHECK_EQ(m.learn_count[b], 1);
+    // Falls by 1/8 of the gap to the target (8 ms + 25 % = 10 ms)
+    CHECK_EQ(m.learned_us[b], RX5808_SETTLE_MAX_US - (RX5808_SETTLE_MAX_US - 10000) / 8);
+    for (uint8_t i = 0; i < RX5808_SETTLE_BUCKETS; i++) {
+        if (i != b) {
+            CHECK_EQ(m.learned_us[i], RX5808_SETTLE_MAX_US);
+            CHECK_EQ(m.learn_count[i], 0);
+        }
+    }
+
+    // Repeated tunes converge on the target, from above
+    for (int i = 0; i < 60; i++) {
+        run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ - 30, &c, 1000);
+    }
+    uint32_t p = rx5808_settle_predict_us(&m, NOMINAL_MHZ + 30, NOMINAL_MHZ);
+    CHECK_MSG(p >= 10000 && p <= 10500, "%u", p);
+
+    // One slow tune is honoured at once: half-way up towards it
+    curve_t slow = { CURVE_STEP, 500, 2000, 36000 };
+    run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 30, &slow, 1000);
+    CHECK_EQ(m.learned_us[b], (p + 45000 + 1) / 2);
+}
+
+/**
+ * @brief Exponential approach (PLL lock): converges once the per-sample
+ *        change drops under the tolerance, ~2.5 time constants here
+ */
+static void test_exponential(void)
+{
+    rx5808_settle_model_t m;
+    rx5808_settle_init(&m);
+    curve_t c = { CURVE_EXP, 400, 1900, 4000 };
+    uint8_t b = bucket_of(200);
+
+    int64_t exit_us = run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 200, &c, 1000);
+    CHECK_MSG(exit_us >= 12000 && exit_us <= 16000, "%lld", (long long)exit_us);
+    CHECK_EQ(m.learn_count[b], 1);
+    for (int i = 0; i < 60; i++) {
+        run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 200, &c, 1000);
+    }
+    // Stable run starts ~10 ms in; +25 % margin
+    uint32_t p = rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 200);
+    CHECK_MSG(p >= 11000 && p <= 14000, "%u", p);
+    CHECK_EQ(rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 20), RX5808_SETTLE_MAX_US);
+}
+
+/**
+ * @brief Each bucket learns its own jumps; the bucket edges are inclusive
+ */
+static void test_buckets(void)
+{
+    rx5808_settle_model_t m;
+    rx5808_settle_init(&m);
+    curve_t fast = { CURVE_STEP, 500, 2000, 2000 };
+    curve_t slow = { CURVE_STEP, 500, 2000, 20000 };
+
+    for (int i = 0; i < 60; i++) {
+        run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 1, &fast, 500);
+        run_tune(&m, 5362, 5945, &slow, 1000);
+    }
+    uint32_t p_micro = rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 2);
+    uint32_t p_wide  = rx5808_settle_predict_us(&m, 5945, 5362);
+    CHECK_MSG(p_micro >= RX5808_SETTLE_MIN_US && p_micro <= 3200, "%u", p_micro);
+    CHECK_MSG(p_wide >= 25000 && p_wide <= 26000, "%u", p_wide);
+    CHECK_EQ(rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 3), RX5808_SETTLE_MAX_US);
+    CHECK_EQ(rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 250), RX5808_SETTLE_MAX_US);
+    CHECK_EQ(m.learn_count[bucket_of(2)], 60);
+    CHECK_EQ(m.learn_count[bucket_of(583)], 60);
+    CHECK_EQ(m.learn_count[bucket_of(40)], 0);
+}
+
+/**
+ * @brief Learned values and exits stay within 3 .. 50 ms
+ */
+static void test_clamp(void)
+{
+    rx5808_settle_model_t m;
+    rx5808_settle_init(&m);
+    uint8_t b = bucket_of(10);
+
+    // Sub-millisecond transition sampled at 4 kHz: stable by 1.5 ms, but
+    // neither the exit nor the learned value may go below the floor
+    curve_t fast = { CURVE_STEP, 500, 2000, 500 };
+    for (int i = 0; i < 80; i++) {
+        int64_t exit_us = run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 10, &fast, 250);
+        CHECK(exit_us >= RX5808_SETTLE_MIN_US && exit_us < RX5808_SETTLE_MIN_US + 250);
+    }
+    // Decay steps are 1/8 of the gap, truncated: it stops within 8 us
+    CHECK(m.learned_us[b] >= RX5808_SETTLE_MIN_US && m.learned_us[b] < RX5808_SETTLE_MIN_US + 8);
+    CHECK(rx5808_settle_predict_us(&m, NOMINAL_MHZ, NOMINAL_MHZ + 10) < RX5808_SETTLE_MIN_US + 8);
+
+    // Transition later than the ceiling: learned, but capped
+    curve_t late = { CURVE_STEP, 500, 2000, 80000 };
+    for (int i = 0; i < 20; i++) {
+        CHECK(run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 10, &late, 1000) > 80000);
+    }
+    CHECK_EQ(m.learned_us[b], RX5808_SETTLE_MAX_US);
+
+    // Never stable: given up after RX5808_SETTLE_TRACK_US, table untouched
+    curve_t noisy = { CURVE_NOISY, 500, 500, 0 };
+    uint16_t count = m.learn_count[b];
+    CHECK_EQ(run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 10, &noisy, 1000), -1);
+    CHECK_EQ(m.learn_count[b], count);
+    CHECK_EQ(m.learned_us[b], RX5808_SETTLE_MAX_US);
+}
+
+/**
+ * @brief Empty band: the noise floor is stable at once and says nothing
+ *        about the PLL — nothing learned, no exit before half the bucket's
+ *        prediction
+ */
+static void test_flat(void)
+{
+    rx5808_settle_model_t m;
+    rx5808_settle_init(&m);
+    curve_t flat = { CURVE_FLAT, 300, 300, 0 };
+    uint8_t b = bucket_of(30);
+
+    int64_t exit_us = run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 30, &flat, 1000);
+    CHECK_EQ(exit_us, RX5808_SETTLE_MAX_US / 2);
+    CHECK_EQ(m.learn_count[b], 0);
+    CHECK_EQ(m.learned_us[b], RX5808_SETTLE_MAX_US);
+
+    // With a shorter learned prediction the floor follows it
+    curve_t step = { CURVE_STEP, 500, 2000, 8000 };
+    for (int i = 0; i < 60; i++) {
+        run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 30, &step, 1000);
+    }
+    uint32_t learned = m.learned_us[b];
+    uint16_t count = m.learn_count[b];
+    exit_us = run_tune(&m, NOMINAL_MHZ, NOMINAL_MHZ + 30, &flat, 1000);
+    CHECK(exit_us >= learned / 2 && exit_us < learned / 2 + 1000);
+    CHECK_EQ(m.learn_count[b], count);
+    CHECK_EQ(m.learned_us[b], learned);
+}
+
+int main(void)
+{
+    test_step();
+    test_exponential();
+    test_buckets();
+    test_clamp();
+    test_flat();
+    return test_report("test_settle");
+}
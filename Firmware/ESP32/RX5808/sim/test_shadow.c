@@ -0,0 +1,45 @@
+/**
+ * @file test_shadow.c
+ * @brief Shadow evaluation of diversity.c at high evaluation rates: every
+ *        decision waits DIVERSITY_SHADOW_JUDGE_MS for its judgement, so at
+ *        any rate the share of decisions judged (those with a clear winner
+ *        50 ms later) is the one of a 100 Hz profile
+ */
+
+#include "sim_run.h"
+#include "trace.h"
+#include "test.h"
+
+static const uint16_t rates[] = { 100, 200, 500, 1000 };
+
+int main(void)
+{
+    trace_t t;
+    if (!trace_generate(&t, TRACE_SCENARIO_MULTIPATH, 1, DIVERSITY_NUM_RX)) {
+        CHECK(false);
+        return test_report("test_shadow");
+    }
+
+    double base = 0;
+    for (unsigned k = 0; k < sizeof(rates) / sizeof(rates[0]); k++) {
+        diversity_mode_params_t p = *diversity_get_mode_params(DIVERSITY_MODE_RACE);
+        p.rate_min_hz = p.rate_max_hz = rates[k];
+        sim_config_t cfg = { .mode = DIVERSITY_MODE_RACE, .predictor = -1, .custom = &p,
+                             .shadow = { DIVERSITY_MODE_FREESTYLE }, .shadows = 1 };
+        sim_result_t r;
+        sim_run(&t, &cfg, &r);
+
+        double share = (double)r.shadow[0].judged / r.updates;
+        if (k == 0) {
+            base = share;
+            CHECK_MSG(share > 0.3, "%u Hz: %.3f of %u decisions judged", rates[k], share, r.updates);
+        } else {
+            CHECK_MSG(share > 0.9 * base, "%u Hz: %.3f of %u decisions judged, %.3f at %u Hz",
+                      rates[k], share, r.updates, base, rates[0]);
+        }
+        CHECK_EQ(r.shadow[0].judged, r.shadow[1].judged);
+        CHECK(r.shadow[1].right <= r.shadow[1].judged);
+    }
+    trace_free(&t);
+    return test_report("test_shadow");
+}
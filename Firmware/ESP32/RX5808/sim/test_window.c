@@ -0,0 +1,111 @@
+/**
+ * @file test_window.c
+ * @brief Host test of the rolling RSSI window (rssi_window.c): running sums
+ *        against a recomputation over the held samples, and the slope of a
+ *        ramp sampled at uneven intervals (rate changes, early wake-ups)
+ */
+
+#include "rssi_window.h"
+#include "test.h"
+#include <math.h>
+
+#define CAPACITY    50
+
+/**
+ * @brief Mean, variance and the half-to-half slope recomputed from the last
+ *        @p n of @p v / @p t (oldest first)
+ */
+static void reference(const uint16_t* v, const uint32_t* t, int n,
+                      double* mean, double* variance, double* slope)
+{
+    double sum = 0, sum_sq = 0;
+    for (int i = 0; i < n; i++) {
+        sum    += v[i];
+        sum_sq += (double)v[i] * v[i];
+    }
+    *mean     = sum / n;
+    *variance = sum_sq / n - *mean * *mean;
+
+    int half = n / 2;
+    double v_old = 0, v_new = 0, t_old = 0, t_new = 0;
+    for (int i = 0; i < half; i++) {
+        v_old += v[i];
+        t_old += t[i];
+        v_new += v[n - 1 - i];
+        t_new += t[n - 1 - i];
+    }
+    *slope = (v_new - v_old) / (t_new - t_old) * 1000.0;
+}
+
+/**
+ * @brief Random values and gaps from 1 ms to 100 ms, across the window
+ *        filling and sliding and across a wrap of the millisecond clock
+ */
+static void test_against_reference(void)
+{
+    enum { PUSHES = 3000 };
+    static uint16_t v[PUSHES];
+    static uint32_t t[PUSHES];
+    uint16_t buf[CAPACITY];
+    uint32_t t_buf[CAPACITY];
+    rssi_window_t w;
+    CHECK(rssi_window_init(&w, buf, t_buf, CAPACITY));
+
+    uint32_t rng = 1, now = UINT32_MAX - 40000;
+    int bad_mean = 0, bad_var = 0, bad_slope = 0;
+    for (int i = 0; i < PUSHES; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        v[i] = (uint16_t)(rng >> 20);
+        now += 1 + (rng >> 8) % 100;
+        t[i] = now;
+        rssi_window_push(&w, v[i], t[i]);
+
+        int n = i + 1 < CAPACITY ? i + 1 : CAPACITY;
+        // Times relative to the oldest held sample, as a wrap-free reference
+        uint32_t rel[CAPACITY];
+        for (int k = 0; k < n; k++) {
+            rel[k] = t[i + 1 - n + k] - t[i + 1 - n];
+        }
+        double mean, variance, slope;
+        reference(&v[i + 1 - n], rel, n, &mean, &variance, &slope);
+        if (rssi_window_mean(&w) != (uint16_t)mean) bad_mean++;
+        if (fabs(rssi_window_variance(&w) - variance) > 1.0) bad_var++;
+        int32_t got = rssi_window_slope(&w);
+        if (n >= 10 ? fabs(got - slope) > 1.0 : got != 0) bad_slope++;
+    }
+    CHECK_MSG(bad_mean == 0, "%d pushes with a wrong mean", bad_mean);
+    CHECK_MSG(bad_var == 0, "%d pushes with a wrong variance", bad_var);
+    CHECK_MSG(bad_slope == 0, "%d pushes with a wrong slope", bad_slope);
+}
+
+/**
+ * @brief A ramp of 200 units/s: the slope stays on it when the spacing
+ *        jumps from 100 ms to 10 ms and an early wake-up lands 1 ms after
+ *        the previous sample
+ */
+static void test_uneven_ramp(void)
+{
+    uint16_t buf[CAPACITY];
+    uint32_t t_buf[CAPACITY];
+    rssi_window_t w;
+    rssi_window_init(&w, buf, t_buf, CAPACITY);
+
+    uint32_t t = 0;
+    int worst = 0;
+    for (int i = 0; i < 200; i++) {
+        t += (i < 60) ? 100 : (i % 7 == 0) ? 1 : 10;
+        rssi_window_push(&w, (uint16_t)(1000 + t / 5), t);
+        if (i >= 10) {
+            int err = abs(rssi_window_slope(&w) - 200);
+            if (err > worst) worst = err;
+        }
+    }
+    CHECK_MSG(worst <= 2, "slope off by %d units/s", worst);
+}
+
+int main(void)
+{
+    test_against_reference();
+    test_uneven_ramp();
+    return test_report("test_window");
+}
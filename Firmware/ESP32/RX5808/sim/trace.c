@@ -0,0 +1,449 @@
+/**
+ * @file trace.c
+ * @brief Timestamped RSSI traces for the diversity simulator
+ */
+
+#include "trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_PERIOD_US         1000    // Synthetic traces: 1 kHz, the RF service frame rate
+#define TRACE_DURATION_S        60
+#define TRACE_ADC_MIN           300     // Receiver RSSI output floor / ceiling (raw)
+#define TRACE_ADC_MAX           3800
+#define TRACE_FADE_PATHS        8       // Sum-of-sinusoids paths per Rayleigh process
+#define TRACE_CSV_LINE          512
+
+static const char* const scenario_names[TRACE_SCENARIO_COUNT] = {
+    "multipath",
+    "obstacle",
+    "long-range",
+};
+
+/** @brief Deterministic PRNG so a scenario is the same on every host */
+static uint32_t trace_rand(uint32_t* s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static double trace_rand_unit(uint32_t* s)
+{
+    return (trace_rand(s) >> 8) * (1.0 / 16777216.0);
+}
+
+// Roughly Gaussian (Irwin-Hall, 4 terms), zero mean, unit variance
+static double trace_rand_gauss(uint32_t* s)
+{
+    double sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        sum += trace_rand_unit(s);
+    }
+    return (sum - 2.0) * sqrt(3.0);
+}
+
+/** @brief Clarke-model Rayleigh fader: sum of sinusoids at Doppler fd */
+typedef struct {
+    double w[2][TRACE_FADE_PATHS];      // rad/s for I and Q
+    double phi[2][TRACE_FADE_PATHS];
+} trace_fader_t;
+
+static void trace_fader_init(trace_fader_t* f, double doppler_hz, uint32_t* seed)
+{
+    for (int iq = 0; iq < 2; iq++) {
+        for (int n = 0; n < TRACE_FADE_PATHS; n++) {
+            double alpha = 2.0 * M_PI * trace_rand_unit(seed);
+            f->w[iq][n]   = 2.0 * M_PI * doppler_hz * cos(alpha);
+            f->phi[iq][n] = 2.0 * M_PI * trace_rand_unit(seed);
+        }
+    }
+}
+
+// Fade in dB relative to the mean power (deep notches are strongly negative)
+static double trace_fader_db(const trace_fader_t* f, double t)
+{
+    double iq[2] = {0.0, 0.0};
+    for (int k = 0; k < 2; k++) {
+        for (int n = 0; n < TRACE_FADE_PATHS; n++) {
+            iq[k] += cos(f->w[k][n] * t + f->phi[k][n]);
+        }
+    }
+    double p = (iq[0] * iq[0] + iq[1] * iq[1]) / TRACE_FADE_PATHS;
+    if (p < 1e-4) {
+        p = 1e-4;       // -40 dB floor
+    }
+    return 10.0 * log10(p);
+}
+
+// 0 outside [start, end], 1 inside, linear ramps of ramp_s at both edges
+static double trace_window(double t, double start, double end, double ramp_s)
+{
+    if (t <= start - ramp_s || t >= end + ramp_s) {
+        return 0.0;
+    }
+    if (t < start) {
+        return (t - (start - ramp_s)) / ramp_s;
+    }
+    if (t > end) {
+        return ((end + ramp_s) - t) / ramp_s;
+    }
+    return 1.0;
+}
+
+static uint16_t trace_clamp(double v)
+{
+    if (v < TRACE_ADC_MIN) return TRACE_ADC_MIN;
+    if (v > TRACE_ADC_MAX) return TRACE_ADC_MAX;
+    return (uint16_t)lround(v);
+}
+
+static bool trace_reserve(trace_t* t, size_t count)
+{
+    if (count <= t->capacity) {
+        return true;
+    }
+    size_t cap = t->capacity ? t->capacity : 4096;
+    while (cap < count) {
+        cap *= 2;
+    }
+    trace_frame_t* p = realloc(t->frame, cap * sizeof(*p));
+    if (p == NULL) {
+        return false;
+    }
+    t->frame    = p;
+    t->capacity = cap;
+    return true;
+}
+
+static bool trace_append(trace_t* t, int64_t t_us, const uint16_t* rssi)
+{
+    if (!trace_reserve(t, t->count + 1)) {
+        return false;
+    }
+    trace_frame_t* f = &t->frame[t->count];
+    memset(f, 0, sizeof(*f));
+    f->t_us = t_us;
+    memcpy(f->rssi, rssi, (size_t)t->rx_count * sizeof(rssi[0]));
+    t->count++;
+    return true;
+}
+
+static void trace_set_name(trace_t* t, const char* name)
+{
+    const char* base = strrchr(name, '/');
+    snprintf(t->name, sizeof(t->name), "%s", base ? base + 1 : name);
+}
+
+/**
+ * @brief Parse "t_us,rssi,rssi..." into @p t_us and @p rssi[]
+ * @return Receiver columns read, or -1 if the line is not all numbers
+ *         (or has an RSSI outside 0..4095)
+ */
+static int trace_parse_csv_line(const char* line, long long* t_us, uint16_t rssi[TRACE_MAX_RX])
+{
+    char* end;
+    *t_us = strtoll(line, &end, 10);
+    if (end == line) {
+        return -1;
+    }
+    int n = 0;
+    for (const char* p = end; ; p = end) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0' || *p == '\n' || *p == '\r') {
+            return n;
+        }
+        if (*p != ',' || n == TRACE_MAX_RX) {
+            return -1;
+        }
+        unsigned long v = strtoul(p + 1, &end, 10);
+        if (end == p + 1 || v > 4095) {
+            return -1;
+        }
+        rssi[n++] = (uint16_t)v;
+    }
+}
+
+static bool trace_load_csv(trace_t* t, FILE* fp)
+{
+    char line[TRACE_CSV_LINE];
+    unsigned long lineno = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        lineno++;
+        long long t_us;
+        uint16_t rssi[TRACE_MAX_RX];
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        int n = trace_parse_csv_line(line, &t_us, rssi);
+        if (n < 0 && t->count == 0) {
+            continue;           // Header
+        }
+        if (t->count == 0) {
+            t->rx_count = n;    // The first frame sets the receiver count
+        }
+        if (n < 2 || n != t->rx_count) {
+            fprintf(stderr, "trace: line %lu: expected t_us and %d RSSI columns (0..4095)\n",
+                    lineno, t->count ? t->rx_count : 2);
+            return false;
+        }
+        if (!trace_append(t, t_us, rssi)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t trace_get_le(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void trace_put_le(uint8_t* p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static bool trace_load_bin(trace_t* t, FILE* fp)
+{
+    uint8_t hdr[12];
+    if (fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) || memcmp(hdr, TRACE_BIN_MAGIC, 4) != 0) {
+        fprintf(stderr, "trace: bad binary header\n");
+        return false;
+    }
+    uint32_t version = trace_get_le(hdr + 4, 2);
+    if (version != 1 && version != TRACE_BIN_VERSION) {
+        fprintf(stderr, "trace: unsupported binary version %u\n", (unsigned)version);
+        return false;
+    }
+    t->rx_count = (version == 1) ? 2 : (int)trace_get_le(hdr + 6, 2);
+    if (t->rx_count < 2 || t->rx_count > TRACE_MAX_RX) {
+        fprintf(stderr, "trace: %d receivers (2..%d supported)\n", t->rx_count, TRACE_MAX_RX);
+        return false;
+    }
+    uint32_t count = trace_get_le(hdr + 8, 4);
+    if (!trace_reserve(t, count)) {
+        return false;
+    }
+    size_t rec_size = 4 + 2 * (size_t)t->rx_count;
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t rec[4 + 2 * TRACE_MAX_RX];
+        uint16_t rssi[TRACE_MAX_RX];
+        if (fread(rec, 1, rec_size, fp) != rec_size) {
+            fprintf(stderr, "trace: truncated after %u of %u frames\n", (unsigned)i, (unsigned)count);
+            return false;
+        }
+        for (int rx = 0; rx < t->rx_count; rx++) {
+            rssi[rx] = (uint16_t)trace_get_le(rec + 4 + 2 * rx, 2);
+        }
+        trace_append(t, trace_get_le(rec, 4), rssi);
+    }
+    return true;
+}
+
+/**
+ * @brief Load a CSV or binary trace; the format is picked from the header
+ */
+bool trace_load(trace_t* t, const char* path)
+{
+    memset(t, 0, sizeof(*t));
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return false;
+    }
+    char magic[4];
+    bool binary = fread(magic, 1, 4, fp) == 4 && memcmp(magic, TRACE_BIN_MAGIC, 4) == 0;
+    rewind(fp);
+    bool ok = binary ? trace_load_bin(t, fp) : trace_load_csv(t, fp);
+    fclose(fp);
+
+    for (size_t i = 1; ok && i < t->count; i++) {
+        if (t->frame[i].t_us <= t->frame[i - 1].t_us) {
+            fprintf(stderr, "trace: %s: timestamps not increasing at frame %zu\n", path, i);
+            ok = false;
+        }
+    }
+    if (ok && t->count == 0) {
+        fprintf(stderr, "trace: %s: no frames\n", path);
+        ok = false;
+    }
+    if (!ok) {
+        trace_free(t);
+        return false;
+    }
+    trace_set_name(t, path);
+    return true;
+}
+
+/**
+ * @brief Write a trace; ".bin" paths get the binary format, anything else CSV
+ */
+bool trace_save(const trace_t* t, const char* path)
+{
+    size_t len = strlen(path);
+    bool binary = len > 4 && strcmp(path + len - 4, ".bin") == 0;
+    FILE* fp = fopen(path, binary ? "wb" : "w");
+    if (fp == NULL) {
+        perror(path);
+        return false;
+    }
+    if (binary) {
+        // Two receivers stay version 1 so older tools still read them
+        uint8_t hdr[12] = {0};
+        memcpy(hdr, TRACE_BIN_MAGIC, 4);
+        if (t->rx_count == 2) {
+            trace_put_le(hdr + 4, 1, 2);
+        } else {
+            trace_put_le(hdr + 4, TRACE_BIN_VERSION, 2);
+            trace_put_le(hdr + 6, (uint32_t)t->rx_count, 2);
+        }
+        trace_put_le(hdr + 8, (uint32_t)t->count, 4);
+        fwrite(hdr, 1, sizeof(hdr), fp);
+        size_t rec_size = 4 + 2 * (size_t)t->rx_count;
+        for (size_t i = 0; i < t->count; i++) {
+            uint8_t rec[4 + 2 * TRACE_MAX_RX];
+            trace_put_le(rec, (uint32_t)t->frame[i].t_us, 4);
+            for (int rx = 0; rx < t->rx_count; rx++) {
+                trace_put_le(rec + 4 + 2 * rx, t->frame[i].rssi[rx], 2);
+            }
+            fwrite(rec, 1, rec_size, fp);
+        }
+    } else {
+        fprintf(fp, "t_us");
+        for (int rx = 0; rx < t->rx_count; rx++) {
+            fprintf(fp, ",rssi_%c", 'a' + rx);
+        }
+        fprintf(fp, "\n");
+        for (size_t i = 0; i < t->count; i++) {
+            fprintf(fp, "%lld", (long long)t->frame[i].t_us);
+            for (int rx = 0; rx < t->rx_count; rx++) {
+                fprintf(fp, ",%u", t->frame[i].rssi[rx]);
+            }
+            fprintf(fp, "\n");
+        }
+    }
+    bool ok = !ferror(fp);
+    return (fclose(fp) == 0) && ok;
+}
+
+/**
+ * @brief Build a synthetic 60 s, 1 kHz scenario for @p rx_count receivers
+ *
+ * Levels are raw ADC counts; fades are in dB scaled to counts, roughly how
+ * the RX5808 RSSI output tracks input power.
+ *   multipath:  all antennas ~2600 with independent fast Rayleigh fading
+ *               (5 Hz Doppler, 35 counts/dB), so one side notches while the
+ *               other usually holds
+ *   obstacle:   mild fading plus blockages of one antenna at a time (A for
+ *               7 s, B for 4 s, a quick A/B/A alternation, a partial A shade;
+ *               receiver n >= 2 for 3 s from 3 + 7n s)
+ *   long-range: all fade from 3000 to 800; the antenna patterns drift
+ *               against each other with an 8 s period
+ *
+ * The random sequence per receiver does not depend on @p rx_count, so A and
+ * B are the same in every receiver count.
+ */
+bool trace_generate(trace_t* t, trace_scenario_t scenario, uint32_t seed, int rx_count)
+{
+    if (scenario >= TRACE_SCENARIO_COUNT || rx_count < 2 || rx_count > TRACE_MAX_RX) {
+        return false;
+    }
+    memset(t, 0, sizeof(*t));
+    t->rx_count = rx_count;
+    uint32_t rng = seed ? seed : 1;
+    trace_fader_t fade[TRACE_MAX_RX];
+    double doppler_hz = (scenario == TRACE_SCENARIO_MULTIPATH) ? 5.0
+                      : (scenario == TRACE_SCENARIO_OBSTACLE)  ? 1.0 : 0.5;
+    double counts_per_db = (scenario == TRACE_SCENARIO_MULTIPATH) ? 35.0
+                         : (scenario == TRACE_SCENARIO_OBSTACLE)  ? 10.0 : 20.0;
+    for (int rx = 0; rx < rx_count; rx++) {
+        trace_fader_init(&fade[rx], doppler_hz, &rng);
+    }
+
+    size_t count = (size_t)TRACE_DURATION_S * (1000000 / TRACE_PERIOD_US);
+    if (!trace_reserve(t, count)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int64_t t_us = (int64_t)(i + 1) * TRACE_PERIOD_US;
+        double s = t_us / 1e6;
+        double v[TRACE_MAX_RX];
+
+        switch (scenario) {
+        case TRACE_SCENARIO_MULTIPATH:
+            for (int rx = 0; rx < rx_count; rx++) {
+                v[rx] = 2600.0;
+            }
+            break;
+        case TRACE_SCENARIO_OBSTACLE:
+            v[0] = 2800.0 - 1400.0 * trace_window(s, 8.0, 15.0, 0.4)
+                          - 1400.0 * trace_window(s, 35.0, 36.5, 0.2)
+                          - 1400.0 * trace_window(s, 38.0, 39.5, 0.2)
+                          -  700.0 * trace_window(s, 48.0, 55.0, 1.0);
+            v[1] = 2800.0 - 1400.0 * trace_window(s, 22.0, 26.0, 0.4)
+                          - 1400.0 * trace_window(s, 36.5, 38.0, 0.2);
+            for (int rx = 2; rx < rx_count; rx++) {
+                double start = 3.0 + 7.0 * rx;
+                v[rx] = 2800.0 - 1400.0 * trace_window(s, start, start + 3.0, 0.4);
+            }
+            break;
+        default: {
+            // Receivers pair up in antiphase (A = level + pattern, B = level -
+            // pattern), the pairs offset by pi / pairs
+            double level = 3000.0 - (3000.0 - 800.0) * s / TRACE_DURATION_S;
+            int pairs = (rx_count + 1) / 2;
+            for (int rx = 0; rx < rx_count; rx++) {
+                double pattern = 150.0 * sin(2.0 * M_PI * s / 8.0 + M_PI * (rx / 2) / pairs);
+                v[rx] = (rx % 2) ? level - pattern : level + pattern;
+            }
+            break;
+        }
+        }
+        uint16_t rssi[TRACE_MAX_RX];
+        for (int rx = 0; rx < rx_count; rx++) {
+            v[rx] += counts_per_db * trace_fader_db(&fade[rx], s) + 25.0 * trace_rand_gauss(&rng);
+            rssi[rx] = trace_clamp(v[rx]);
+        }
+        trace_append(t, t_us, rssi);
+    }
+    snprintf(t->name, sizeof(t->name), "%s", scenario_names[scenario]);
+    return true;
+}
+
+const char* trace_scenario_name(trace_scenario_t scenario)
+{
+    return (scenario < TRACE_SCENARIO_COUNT) ? scenario_names[scenario] : "?";
+}
+
+bool trace_scenario_from_name(const char* name, trace_scenario_t* out)
+{
+    for (int i = 0; i < TRACE_SCENARIO_COUNT; i++) {
+        if (strcmp(name, scenario_names[i]) == 0) {
+            *out = (trace_scenario_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void trace_free(trace_t* t)
+{
+    free(t->frame);
+    t->frame    = NULL;
+    t->count    = 0;
+    t->capacity = 0;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file trace.h
+ * @brief Timestamped RSSI traces for the diversity simulator
+ *
+ * A trace is a list of frames {t_us, rssi[rx_count]} in raw 12-bit ADC
+ * units, as the RF service would publish them.  Two receivers (A, B) is
+ * the hardware; up to TRACE_MAX_RX for the N-receiver builds.  Traces come
+ * from:
+ *   - CSV:    one "t_us,rssi_a,rssi_b[,rssi_c...]" line per frame, the same
+ *             column count on every line; a header line and '#' comments
+ *             are skipped
+ *   - binary: "DVTR", u16 version, u16 rx count (version 1: reserved, two
+ *             receivers), u32 count, then count records of
+ *             {u32 t_us, u16 rssi[rx count]}, little endian.  Two-receiver
+ *             traces are written as version 1.
+ *   - a built-in synthetic scenario (trace_generate())
+ */
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TRACE_BIN_MAGIC     "DVTR"
+#define TRACE_BIN_VERSION   2       // Version 1 (two receivers) is still read and written
+#define TRACE_MAX_RX        8
+
+/** @brief One RSSI frame */
+typedef struct {
+    int64_t  t_us;
+    uint16_t rssi[TRACE_MAX_RX];    // Receiver 0 = A, 1 = B, ...
+} trace_frame_t;
+
+/** @brief A loaded or generated trace */
+typedef struct {
+    trace_frame_t* frame;
+    size_t         count;
+    size_t         capacity;
+    int            rx_count;        // Receivers per frame, 1 .. TRACE_MAX_RX
+    char           name[64];
+} trace_t;
+
+/** @brief Built-in synthetic fading scenarios */
+typedef enum {
+    TRACE_SCENARIO_MULTIPATH = 0,   // Fast independent notches on every antenna
+    TRACE_SCENARIO_OBSTACLE,        // Alternating long blockages of one antenna
+    TRACE_SCENARIO_LONG_RANGE,      // Slow fade-out with a drifting antenna pattern
+    TRACE_SCENARIO_COUNT
+} trace_scenario_t;
+
+bool        trace_load(trace_t* t, const char* path);
+bool        trace_save(const trace_t* t, const char* path);
+bool        trace_generate(trace_t* t, trace_scenario_t scenario, uint32_t seed, int rx_count);
+const char* trace_scenario_name(trace_scenario_t scenario);
+bool        trace_scenario_from_name(const char* name, trace_scenario_t* out);
+void        trace_free(trace_t* t);
+
+#endif // __TRACE_H
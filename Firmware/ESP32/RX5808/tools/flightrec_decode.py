@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Decode a flight recorder dump (main/hardware/flightrec.c) to CSV.
+
+The dump is produced by typing "frdump" on the receiver's serial console.
+Either capture it yourself and pass the file, or let this script fetch it:
+
+    flightrec_decode.py capture.bin -o flight.csv
+    flightrec_decode.py --port /dev/ttyUSB0 -o flight.csv      (needs pyserial)
+
+Blocks are located by their magic, so log text around them is ignored;
+blocks whose CRC does not match are reported and skipped.  --trace writes
+one boot's RSSI as a diversity simulator trace (sim/README.md).
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+MAGIC = b"FRB1"
+HDR = struct.Struct("<4sIHHIHHI")   # magic seq boot count t0_ms len version crc
+VERSION = 1
+FIELDS = ("dt", "raw_a", "raw_b", "norm_a", "norm_b", "score_a", "score_b", "state")
+CLASS_BITS = (0, 4, 8, 16)
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0          # bit position
+
+    def get(self, n):
+        v = 0
+        for i in range(n):
+            byte = self.data[(self.pos + i) >> 3]
+            v |= ((byte >> ((self.pos + i) & 7)) & 1) << i
+        self.pos += n
+        return v
+
+    def delta(self):
+        z = self.get(CLASS_BITS[self.get(2)])
+        return (z >> 1) ^ -(z & 1)
+
+
+def decode_block(hdr, payload):
+    _, seq, boot, count, t0_ms, _, _, _ = hdr
+    bits = BitReader(payload)
+    prev = [0] * len(FIELDS)
+    t_ms = t0_ms
+    rows = []
+    for _ in range(count):
+        for i in range(len(FIELDS)):
+            prev[i] += bits.delta()
+        t_ms += prev[0]
+        state = prev[7]
+        rows.append({
+            "boot": boot, "seq": seq, "t_ms": t_ms,
+            "raw_a": prev[1], "raw_b": prev[2],
+            "norm_a": prev[3], "norm_b": prev[4],
+            "score_a": prev[5], "score_b": prev[6],
+            "active": "AB"[state & 1],
+            "freq_shift_state": (state >> 1) & 3,
+            "freq_shift_offset": ((state >> 3) & 3) - 1,
+        })
+    return rows
+
+
+def find_blocks(data):
+    blocks = {}
+    bad = 0
+    i = data.find(MAGIC)
+    while i >= 0:
+        if i + HDR.size <= len(data):
+            hdr = HDR.unpack_from(data, i)
+            length = hdr[5]
+            payload = data[i + HDR.size:i + HDR.size + length]
+            if hdr[6] == VERSION and len(payload) == length and zlib.crc32(payload) == hdr[7]:
+                blocks[hdr[1]] = (hdr, payload)
+                i = data.find(MAGIC, i + HDR.size + length)
+                continue
+            bad += 1
+        i = data.find(MAGIC, i + 1)
+    return [blocks[s] for s in sorted(blocks)], bad
+
+
+def fetch(port, baud, timeout):
+    import serial
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"\nfrdump\n")
+        data = bytearray()
+        while not data.endswith(b"FRDUMP END\n"):
+            chunk = ser.read(4096)
+            if not chunk:
+                raise SystemExit("timed out waiting for FRDUMP END (%d bytes read)" % len(data))
+            data += chunk
+        return bytes(data)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("capture", nargs="?", help="raw dump captured from the serial console")
+    ap.add_argument("--port", help="serial port to request the dump from")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--timeout", type=float, default=5.0, help="serial read timeout, s")
+    ap.add_argument("--save", help="also store the raw dump fetched with --port")
+    ap.add_argument("-o", "--output", help="CSV output (default stdout)")
+    ap.add_argument("--trace", help="write one boot as a simulator trace (t_us,rssi_a,rssi_b)")
+    ap.add_argument("--boot", type=int, help="boot for --trace (default: the last one)")
+    args = ap.parse_args()
+
+    if args.port:
+        data = fetch(args.port, args.baud, args.timeout)
+        if args.save:
+            with open(args.save, "wb") as f:
+                f.write(data)
+    elif args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        ap.error("give a capture file or --port")
+
+    blocks, bad = find_blocks(data)
+    rows = [r for hdr, payload in blocks for r in decode_block(hdr, payload)]
+    print("%d blocks, %d records, %d corrupt blocks skipped" % (len(blocks), len(rows), bad), file=sys.stderr)
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    w = csv.writer(out)
+    w.writerow(["boot", "seq", "t_ms", "raw_a", "raw_b", "norm_a", "norm_b", "score_a", "score_b",
+                "active", "freq_shift_state", "freq_shift_offset", "event"])
+    last = None
+    for r in rows:
+        events = []
+        if last is not None and last["boot"] == r["boot"]:
+            if r["active"] != last["active"]:
+                events.append("switch")
+            if (r["freq_shift_state"], r["freq_shift_offset"]) != (last["freq_shift_state"], last["freq_shift_offset"]):
+                events.append("freq_shift")
+        w.writerow([r["boot"], r["seq"], r["t_ms"], r["raw_a"], r["raw_b"], r["norm_a"], r["norm_b"],
+                    r["score_a"], r["score_b"], r["active"], r["freq_shift_state"],
+                    r["freq_shift_offset"], "+".join(events)])
+        last = r
+    if out is not sys.stdout:
+        out.close()
+
+    if args.trace and rows:
+        boot = args.boot if args.boot is not None else rows[-1]["boot"]
+        with open(args.trace, "w") as f:
+            f.write("t_us,rssi_a,rssi_b\n")
+            prev_t = None
+            for r in rows:
+                if r["boot"] == boot and r["t_ms"] != prev_t:
+                    f.write("%d,%d,%d\n" % (r["t_ms"] * 1000, r["raw_a"], r["raw_b"]))
+                    prev_t = r["t_ms"]
+
+
+if __name__ == "__main__":
+    main()